@@ -0,0 +1,182 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "Math.hpp"
+#include "Resource.hpp"
+
+// A bone's transform relative to its parent, the form clips are sampled and blended in.
+struct BonePose
+{
+	Vector3    Position;
+	Quaternion Rotation;
+	Vector3    Scale = Vector3::One;
+
+	// Moves a_T of the way from a_From to a_To, rotations along the shorter arc.
+	static BonePose Blend( const BonePose& a_From, const BonePose& a_To, float a_T )
+	{
+		BonePose Result;
+		Result.Position = a_From.Position + ( a_To.Position - a_From.Position ) * a_T;
+		Result.Scale = a_From.Scale + ( a_To.Scale - a_From.Scale ) * a_T;
+		Result.Rotation = Blend( a_From.Rotation, a_To.Rotation, a_T );
+		return Result;
+	}
+
+	// Normalised lerp, close enough to a slerp between neighbouring keys and cheaper.
+	static Quaternion Blend( const Quaternion& a_From, const Quaternion& a_To, float a_T )
+	{
+		float Sign = ( a_From.w * a_To.w + a_From.x * a_To.x + a_From.y * a_To.y + a_From.z * a_To.z ) < 0.0f ? -1.0f : 1.0f;
+		Quaternion Result(
+			a_From.w + ( a_To.w * Sign - a_From.w ) * a_T,
+			a_From.x + ( a_To.x * Sign - a_From.x ) * a_T,
+			a_From.y + ( a_To.y * Sign - a_From.y ) * a_T,
+			a_From.z + ( a_To.z * Sign - a_From.z ) * a_T );
+		float Length = Math::Sqrt( Result.w * Result.w + Result.x * Result.x + Result.y * Result.y + Result.z * Result.z );
+
+		if ( Length > 0.0f )
+		{
+			Result.w /= Length;
+			Result.x /= Length;
+			Result.y /= Length;
+			Result.z /= Length;
+		}
+
+		return Result;
+	}
+
+	inline Matrix4 ToMatrix() const
+	{
+		return Matrix4::CreateTransform( Position, Rotation, Scale );
+	}
+};
+
+// Keyframed bone transforms over time. Bones without a channel keep whatever pose they are sampled over.
+class AnimationClip : public Resource
+{
+public:
+
+	template < typename T >
+	struct Key
+	{
+		float Time;
+		T     Value;
+	};
+
+	struct Channel
+	{
+		uint32_t                          Bone;
+		std::vector< Key< Vector3    > > Positions;
+		std::vector< Key< Quaternion > > Rotations;
+		std::vector< Key< Vector3    > > Scales;
+
+		template < typename _Serializer >
+		void Serialize( _Serializer& a_Serializer ) const
+		{
+			a_Serializer << Bone << Positions << Rotations << Scales;
+		}
+
+		template < typename _Deserializer >
+		void Deserialize( _Deserializer& a_Deserializer )
+		{
+			a_Deserializer >> Bone >> Positions >> Rotations >> Scales;
+		}
+
+		template < typename _Sizer >
+		void SizeOf( _Sizer& a_Sizer ) const
+		{
+			a_Sizer & Bone & Positions & Rotations & Scales;
+		}
+	};
+
+	// Length in seconds.
+	inline float GetDuration() const
+	{
+		return m_Duration;
+	}
+
+	inline const std::vector< Channel >& GetChannels() const
+	{
+		return m_Channels;
+	}
+
+	// Overwrites the animated bones of io_Pose with the clip at a_Time seconds, clamped to the clip.
+	void Sample( float a_Time, std::vector< BonePose >& io_Pose ) const
+	{
+		for ( const auto& Entry : m_Channels )
+		{
+			if ( Entry.Bone >= io_Pose.size() )
+			{
+				continue;
+			}
+
+			BonePose& Target = io_Pose[ Entry.Bone ];
+
+			if ( !Entry.Positions.empty() )
+			{
+				Target.Position = Sample( Entry.Positions, a_Time, []( const Vector3& a_From, const Vector3& a_To, float a_T ) { return a_From + ( a_To - a_From ) * a_T; } );
+			}
+
+			if ( !Entry.Rotations.empty() )
+			{
+				Target.Rotation = Sample( Entry.Rotations, a_Time, []( const Quaternion& a_From, const Quaternion& a_To, float a_T ) { return BonePose::Blend( a_From, a_To, a_T ); } );
+			}
+
+			if ( !Entry.Scales.empty() )
+			{
+				Target.Scale = Sample( Entry.Scales, a_Time, []( const Vector3& a_From, const Vector3& a_To, float a_T ) { return a_From + ( a_To - a_From ) * a_T; } );
+			}
+		}
+	}
+
+private:
+
+	friend class ResourcePackager;
+	friend class Serialization;
+
+	// Interpolates between the two keys either side of a_Time.
+	template < typename T, typename _Interpolate >
+	static T Sample( const std::vector< Key< T > >& a_Keys, float a_Time, const _Interpolate& a_Interpolate )
+	{
+		auto Next = std::upper_bound( a_Keys.begin(), a_Keys.end(), a_Time, []( float a_Value, const Key< T >& a_Key ) { return a_Value < a_Key.Time; } );
+
+		if ( Next == a_Keys.begin() )
+		{
+			return Next->Value;
+		}
+
+		if ( Next == a_Keys.end() )
+		{
+			return a_Keys.back().Value;
+		}
+
+		auto Previous = Next - 1;
+		float Span = Next->Time - Previous->Time;
+		return a_Interpolate( Previous->Value, Next->Value, Span > 0.0f ? ( a_Time - Previous->Time ) / Span : 0.0f );
+	}
+
+	template < typename _Serializer >
+	void Serialize( _Serializer& a_Serializer ) const
+	{
+		a_Serializer << *static_cast< const Resource* >( this );
+		a_Serializer << m_Duration;
+		a_Serializer << m_Channels;
+	}
+
+	template < typename _Deserializer >
+	void Deserialize( _Deserializer& a_Deserializer )
+	{
+		a_Deserializer >> *static_cast< Resource* >( this );
+		a_Deserializer >> m_Duration;
+		a_Deserializer >> m_Channels;
+	}
+
+	template < typename _Sizer >
+	void SizeOf( _Sizer& a_Sizer ) const
+	{
+		a_Sizer & *static_cast< const Resource* >( this );
+		a_Sizer & m_Duration;
+		a_Sizer & m_Channels;
+	}
+
+	float                  m_Duration = 0.0f;
+	std::vector< Channel > m_Channels;
+};
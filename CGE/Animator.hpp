@@ -0,0 +1,239 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "Component.hpp"
+#include "Skeleton.hpp"
+#include "AnimationClip.hpp"
+#include "Time.hpp"
+
+// Plays animation clips on a skeleton and blends them into the bone matrices skinned meshes below it are drawn with.
+// Any number of clips can play at once, each fading towards its own weight.
+DefineComponent( Animator, Component )
+{
+public:
+
+	// Fades every other clip out and a_Clip in over a_FadeTime seconds, from its start.
+	void Play( ResourceHandle< AnimationClip > a_Clip, float a_FadeTime = 0.0f )
+	{
+		for ( auto& Entry : m_States )
+		{
+			Fade( Entry, 0.0f, a_FadeTime );
+		}
+
+		State& Started = FindState( a_Clip );
+		Fade( Started, 1.0f, a_FadeTime );
+		Started.Time = 0.0f;
+	}
+
+	// Fades a_Clip towards a_Weight over a_FadeTime seconds, leaving other clips alone. Weights are normalised
+	// when blended, so two clips at 1 mix evenly.
+	void Blend( ResourceHandle< AnimationClip > a_Clip, float a_Weight, float a_FadeTime = 0.0f )
+	{
+		Fade( FindState( a_Clip ), Math::Max( a_Weight, 0.0f ), a_FadeTime );
+	}
+
+	// Stops every clip, the skeleton returns to its rest pose.
+	inline void Stop()
+	{
+		m_States.clear();
+	}
+
+	inline float GetSpeed() const
+	{
+		return m_Speed;
+	}
+
+	inline void SetSpeed( float a_Speed )
+	{
+		m_Speed = a_Speed;
+	}
+
+	inline bool IsLooping() const
+	{
+		return m_Looping;
+	}
+
+	inline void SetLooping( bool a_Looping )
+	{
+		m_Looping = a_Looping;
+	}
+
+	const Skeleton* GetSkeleton() const
+	{
+		return m_Skeleton.Assure();
+	}
+
+	void SetSkeleton( ResourceHandle< Skeleton > a_Skeleton )
+	{
+		m_Skeleton = a_Skeleton;
+		m_BindPose.clear();
+	}
+
+	// Played on the first frame if nothing else was by then.
+	void SetDefaultClip( ResourceHandle< AnimationClip > a_Clip )
+	{
+		m_DefaultClip = a_Clip;
+	}
+
+	// Bone space to mesh space for every bone this frame, relative to this object. Advances the clips the first time
+	// it is asked for each frame, so every mesh sharing the skeleton sees the same pose.
+	const std::vector< Matrix4 >& GetSkinMatrices() const
+	{
+		const_cast< Animator* >( this )->Evaluate();
+		return m_SkinMatrices;
+	}
+
+private:
+
+	friend class ResourcePackager;
+	friend class Serialization;
+
+	struct State
+	{
+		ResourceHandle< AnimationClip > Clip;
+		float                           Time;
+		float                           Weight;
+		float                           Target;
+		float                           FadeRate; // Weight per second.
+	};
+
+	// The state playing a_Clip, added silent if it isn't playing yet.
+	State& FindState( ResourceHandle< AnimationClip > a_Clip )
+	{
+		const AnimationClip* Source = a_Clip.Assure();
+		auto Where = std::find_if( m_States.begin(), m_States.end(), [ & ]( const State& a_State ) { return a_State.Clip.Assure() == Source; } );
+
+		if ( Where != m_States.end() )
+		{
+			return *Where;
+		}
+
+		m_States.push_back( { a_Clip, 0.0f, 0.0f, 0.0f, 0.0f } );
+		return m_States.back();
+	}
+
+	// Without a fade time the weight changes right away, even while paused.
+	inline static void Fade( State& o_State, float a_Target, float a_FadeTime )
+	{
+		o_State.Target = a_Target;
+		o_State.FadeRate = a_FadeTime > 0.0f ? 1.0f / a_FadeTime : 0.0f;
+
+		if ( a_FadeTime <= 0.0f )
+		{
+			o_State.Weight = a_Target;
+		}
+	}
+
+	void Evaluate()
+	{
+		const Skeleton* Bones = m_Skeleton.Assure();
+
+		if ( !Bones || m_EvaluatedFrame == Time::GetFrameCount() )
+		{
+			return;
+		}
+
+		bool FirstEvaluation = m_EvaluatedFrame == uint64_t( -1 );
+		m_EvaluatedFrame = Time::GetFrameCount();
+
+		if ( FirstEvaluation && m_States.empty() && m_DefaultClip.Assure() )
+		{
+			Play( m_DefaultClip );
+		}
+
+		float DeltaTime = FirstEvaluation ? 0.0f : Time::GetDeltaTime() * m_Speed;
+		uint32_t BoneCount = Bones->GetBoneCount();
+
+		if ( m_BindPose.size() != BoneCount )
+		{
+			m_BindPose.resize( BoneCount );
+
+			for ( uint32_t i = 0; i < BoneCount; ++i )
+			{
+				Matrix4::Decompose( Bones->GetBone( i ).LocalBind, m_BindPose[ i ].Position, m_BindPose[ i ].Rotation, m_BindPose[ i ].Scale );
+			}
+		}
+
+		// Advance and fade, clips that faded out are dropped.
+		for ( auto Begin = m_States.begin(); Begin != m_States.end(); )
+		{
+			const AnimationClip* Clip = Begin->Clip.Assure();
+			float Step = Math::Abs( DeltaTime ) * Begin->FadeRate;
+			Begin->Weight = Begin->Weight < Begin->Target ? Math::Min( Begin->Weight + Step, Begin->Target ) : Math::Max( Begin->Weight - Step, Begin->Target );
+			Begin->Time += DeltaTime;
+
+			if ( Clip && Clip->GetDuration() > 0.0f )
+			{
+				Begin->Time = m_Looping ?
+					Begin->Time - Math::Floor( Begin->Time / Clip->GetDuration() ) * Clip->GetDuration() :
+					Math::Clamp( Begin->Time, 0.0f, Clip->GetDuration() );
+			}
+
+			Begin = !Clip || ( Begin->Weight <= 0.0f && Begin->Target <= 0.0f ) ? m_States.erase( Begin ) : std::next( Begin );
+		}
+
+		// Each clip is sampled over the rest pose and folded into the running blend by its share of the weight so far.
+		m_Pose = m_BindPose;
+		float Accumulated = 0.0f;
+
+		for ( const auto& Entry : m_States )
+		{
+			if ( Entry.Weight <= 0.0f )
+			{
+				continue;
+			}
+
+			m_Sampled = m_BindPose;
+			Entry.Clip.Assure()->Sample( Entry.Time, m_Sampled );
+			Accumulated += Entry.Weight;
+			float Share = Entry.Weight / Accumulated;
+
+			for ( uint32_t i = 0; i < BoneCount; ++i )
+			{
+				m_Pose[ i ] = BonePose::Blend( m_Pose[ i ], m_Sampled[ i ], Share );
+			}
+		}
+
+		// Parents come first, so one pass resolves the hierarchy.
+		m_Globals.resize( BoneCount );
+		m_SkinMatrices.resize( BoneCount );
+
+		for ( uint32_t i = 0; i < BoneCount; ++i )
+		{
+			const Skeleton::Bone& Current = Bones->GetBone( i );
+			Matrix4 Local = m_Pose[ i ].ToMatrix();
+			m_Globals[ i ] = Current.Parent >= 0 ? Math::Multiply( m_Globals[ Current.Parent ], Local ) : Local;
+			m_SkinMatrices[ i ] = Math::Multiply( m_Globals[ i ], Current.InverseBind );
+		}
+	}
+
+	template < typename _Serializer >
+	void Serialize( _Serializer& a_Serializer ) const
+	{
+		a_Serializer << m_Skeleton << m_DefaultClip << m_Speed << m_Looping;
+	}
+
+	template < typename _Deserializer >
+	void Deserialize( _Deserializer& a_Deserializer )
+	{
+		a_Deserializer >> m_Skeleton >> m_DefaultClip >> m_Speed >> m_Looping;
+	}
+
+	template < typename _Sizer >
+	void SizeOf( _Sizer& a_Sizer ) const
+	{
+		a_Sizer & m_Skeleton & m_DefaultClip & m_Speed & m_Looping;
+	}
+
+	ResourceHandle< Skeleton >      m_Skeleton;
+	ResourceHandle< AnimationClip > m_DefaultClip;
+	float                           m_Speed = 1.0f;
+	bool                            m_Looping = true;
+	std::vector< State >            m_States;
+	uint64_t                        m_EvaluatedFrame = uint64_t( -1 );
+	std::vector< BonePose >         m_BindPose;
+	std::vector< BonePose >         m_Pose;
+	std::vector< BonePose >         m_Sampled;
+	std::vector< Matrix4 >          m_Globals;
+	std::vector< Matrix4 >          m_SkinMatrices;
+};
@@ -3,6 +3,7 @@
 #include "AudioListener.hpp"
 #include "Component.hpp"
 #include "Transform.hpp"
+#include <cassert>
 
 SoLoud::Soloud AudioEngine::s_SoLoud;
 
@@ -20,7 +21,7 @@ void AudioEngine::Tick()
     }
 
     auto audioListeners = Component::GetExactComponents<AudioListener>();
-    _STL_ASSERT(audioListeners.size() <= 1, "Only one audio listener allowed!");
+    assert(audioListeners.size() <= 1 && "Only one audio listener allowed!");
     if (audioListeners.size() > 0) 
     {
         auto* audioListener = *audioListeners.begin();
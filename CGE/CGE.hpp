@@ -1,5 +1,5 @@
 #pragma once
-#include <Windows.h>
+#include "Platform.hpp"
 #include <string>
 #include "ConsoleWindow.hpp"
 #include "Delegate.hpp"
@@ -7,6 +7,7 @@
 #include "Time.hpp"
 #include "Scene.hpp"
 #include "RenderPipeline.hpp"
+#include "RenderCapture.hpp"
 #include "AudioEngine.hpp"
 
 class CGE
@@ -22,12 +23,13 @@ public:
         AudioEngine::Init();
     }
 
-    // Begin ticking.
-    static void Run( const Action<>& a_Action )
+    // Begin ticking, until Quit or for a_FrameCount frames when it isn't zero. Headless runs pair it with
+    // Time::SetSimulatedDeltaTime to render the same frames every time.
+    static void Run( const Action<>& a_Action, uint64_t a_FrameCount = 0 )
     {
         s_Running = true;
 
-        while ( s_Running )
+        for ( uint64_t Frame = 0; s_Running && ( !a_FrameCount || Frame < a_FrameCount ); ++Frame )
         {
             Input::Tick();
             AudioEngine::Tick();
@@ -40,8 +42,10 @@ public:
             RenderPipeline::Tick();
             
             ConsoleWindow::SwapBuffers( ConsoleWindow::GetCurrentContext() );
+            RenderCapture::Tick();
         }
 
+        s_Running = false;
         AudioEngine::Deinitialize();
         Input::Deinitialize();
     }
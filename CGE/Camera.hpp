@@ -4,11 +4,26 @@
 #include "ScreenBuffer.hpp"
 #include "GameObject.hpp"
 #include "Transform.hpp"
+#include "Rect.hpp"
 
 DefineComponent( Camera, Component )
 {
 public:
 
+	ICamera()
+		: m_View( Matrix4::Identity )
+		, m_ViewSource( Matrix4::Identity )
+		, m_FOV( Math::Radians( 75.0f ) )
+		, m_Aspect( 1.0f )
+		, m_NearZ( 0.1f )
+		, m_FarZ( 100.0f )
+		, m_Dirty( true )
+		, m_ViewDirty( true )
+		, m_Viewport( 0.0f, 0.0f, 1.0f, 1.0f )
+		, m_LayerMask( uint32_t( -1 ) )
+		, m_Depth( 0 )
+	{ }
+
 	inline Matrix4 GetProjectionMatrix() const
 	{
 		if ( m_Dirty )
@@ -20,10 +35,21 @@ public:
 		return m_Projection;
 	}
 
+	// Only rebuilt when the owner's global matrix has changed.
 	inline Matrix4 GetViewMatrix() const
 	{
 		const Transform* OwnerTransform = this->GetOwner().GetTransform();
-		return Matrix4::CreateView( OwnerTransform->GetGlobalPosition(), OwnerTransform->GetGlobalRotation() );
+		const Matrix4& Source = OwnerTransform->GetGlobalMatrix();
+
+		if ( m_ViewDirty || Source != m_ViewSource )
+		{
+			auto* Mutable = const_cast< Camera* >( this );
+			Mutable->m_View = Matrix4::CreateView( OwnerTransform->GetGlobalPosition(), OwnerTransform->GetGlobalRotation() );
+			Mutable->m_ViewSource = Source;
+			Mutable->m_ViewDirty = false;
+		}
+
+		return m_View;
 	}
 
 	inline Matrix4 GetProjectionViewMatrix() const
@@ -55,7 +81,7 @@ public:
 
 	inline float GetNearZ() const
 	{
-		return m_FarZ;
+		return m_NearZ;
 	}
 
 	inline void SetNearZ( float a_NearZ )
@@ -72,7 +98,40 @@ public:
 	inline void SetFarZ( float a_FarZ )
 	{
 		m_FarZ = a_FarZ;
-		m_Dirty;
+		m_Dirty = true;
+	}
+
+	// Normalized to the window, ( 0, 0, 1, 1 ) covers all of it.
+	inline const Rect& GetViewport() const
+	{
+		return m_Viewport;
+	}
+
+	inline void SetViewport( const Rect& a_Viewport )
+	{
+		m_Viewport = a_Viewport;
+	}
+
+	// Renderers are drawn when the bit of their layer is set.
+	inline uint32_t GetLayerMask() const
+	{
+		return m_LayerMask;
+	}
+
+	inline void SetLayerMask( uint32_t a_LayerMask )
+	{
+		m_LayerMask = a_LayerMask;
+	}
+
+	// Cameras are drawn in ascending depth, later cameras draw over earlier ones.
+	inline int32_t GetDepth() const
+	{
+		return m_Depth;
+	}
+
+	inline void SetDepth( int32_t a_Depth )
+	{
+		m_Depth = a_Depth;
 	}
 
 	inline static void SetMainCamera( const Camera* a_Camera )
@@ -87,12 +146,18 @@ public:
 
 private:
 
-	Matrix4 m_Projection;
-	float   m_FOV;
-	float   m_Aspect;
-	float   m_NearZ;
-	float   m_FarZ;
-	bool    m_Dirty;
+	Matrix4  m_Projection;
+	Matrix4  m_View;
+	Matrix4  m_ViewSource;
+	float    m_FOV;
+	float    m_Aspect;
+	float    m_NearZ;
+	float    m_FarZ;
+	bool     m_Dirty;
+	bool     m_ViewDirty;
+	Rect     m_Viewport;
+	uint32_t m_LayerMask;
+	int32_t  m_Depth;
 
 	inline static GameObjectID s_MainCamera = GameObjectID( -1 );
 };
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+#include "Math.hpp"
+#include "Rect.hpp"
+#include "Camera.hpp"
+#include "Frustum.hpp"
+
+// Everything a frame needs from a camera, computed once per camera per frame.
+struct CameraBlock
+{
+	CameraBlock( const Camera& a_Camera, Vector2Int a_ScreenSize )
+		: Source( &a_Camera )
+		, View( a_Camera.GetViewMatrix() )
+		, Projection( a_Camera.GetProjectionMatrix() )
+		, ProjectionView( Math::Multiply( Projection, View ) )
+		, ViewFrustum( ProjectionView )
+		, Position( a_Camera.GetOwner().GetTransform()->GetGlobalPosition() )
+		, LayerMask( a_Camera.GetLayerMask() )
+	{
+		const Rect& Normalized = a_Camera.GetViewport();
+		int32_t Left = Math::Clamp( static_cast< int32_t >( Normalized.GetLeft() * a_ScreenSize.x ), 0, a_ScreenSize.x );
+		int32_t Bottom = Math::Clamp( static_cast< int32_t >( Normalized.GetBottom() * a_ScreenSize.y ), 0, a_ScreenSize.y );
+		int32_t Right = Math::Clamp( static_cast< int32_t >( Normalized.GetRight() * a_ScreenSize.x ), 0, a_ScreenSize.x );
+		int32_t Top = Math::Clamp( static_cast< int32_t >( Normalized.GetTop() * a_ScreenSize.y ), 0, a_ScreenSize.y );
+		Viewport = RectInt( Left, Bottom, Right - Left, Top - Bottom );
+	}
+
+	const Camera* Source;
+	Matrix4       View;
+	Matrix4       Projection;
+	Matrix4       ProjectionView;
+	Frustum       ViewFrustum;
+	Vector3       Position;
+	RectInt       Viewport;
+	uint32_t      LayerMask;
+};
@@ -1,27 +1,54 @@
 #pragma once
-#include <Windows.h>
+#include "Platform.hpp"
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include "Math.hpp"
 #include "Colour.hpp"
 #include "ScreenBuffer.hpp"
-#include "PixelColourMap.hpp"
-
+#include "FrameExporter.hpp"
+#if CGE_HEADLESS
+#include "HeadlessScreen.hpp"
+#elif CGE_WINDOWS
+#include "WindowsConsole.hpp"
+#else
+#include "PosixTerminal.hpp"
+#endif
+
+// The window the engine draws into, presented by the platform's backend on a thread of its own.
 class ConsoleWindow
 {
 public:
 
-    typedef HANDLE      ConsoleHandle;
-    typedef HWND        WindowHandle;
-    typedef SMALL_RECT  WindowRegion;
-    typedef std::thread Thread;
+#if CGE_HEADLESS
+    typedef HeadlessScreen                Backend;
+#elif CGE_WINDOWS
+    typedef WindowsConsole                Backend;
+    typedef WindowsConsole::ConsoleHandle ConsoleHandle;
+    typedef WindowsConsole::WindowHandle  WindowHandle;
+#else
+    typedef PosixTerminal                 Backend;
+#endif
+    typedef std::thread                   Thread;
+
+    enum class FramePacing
+    {
+        LATEST, // Frames are handed over as soon as they are resolved, the console shows the newest it can.
+        CAPPED  // SwapBuffers waits out the rest of each interval like vsync, no more frames are drawn than the cap.
+    };
+
+    struct PresentStatistics
+    {
+        uint64_t Presented; // Frames written to the console.
+        uint64_t Dropped;   // Frames replaced by a newer one before the console got to them.
+        uint64_t Late;      // Capped frames that missed their interval.
+    };
 
     void SetTitle( const char* a_Title )
     {
-        size_t Length = strlen( a_Title ) + 1;
-        Length = Length > 64 ? 64 : Length;
-        mbstowcs_s( nullptr, m_TitleBuffer, Length, a_Title, Length );
-        SetConsoleTitleW( m_TitleBuffer );
+        m_Backend.SetTitle( a_Title );
     }
 
     inline Vector2Int GetSize()
@@ -29,17 +56,17 @@ public:
         return m_ScreenBuffer.GetSize();
     }
 
-    inline short GetArea()
+    inline int32_t GetArea()
     {
         return m_ScreenBuffer.GetArea();
     }
 
-    inline short GetWidth()
+    inline int32_t GetWidth()
     {
         return m_ScreenBuffer.GetWidth();
     }
 
-    inline short GetHeight()
+    inline int32_t GetHeight()
     {
         return m_ScreenBuffer.GetHeight();
     }
@@ -59,111 +86,67 @@ public:
         return m_PixelSize.y;
     }
 
+#if CGE_WINDOWS && !CGE_HEADLESS
     inline ConsoleHandle GetConsoleHandle()
     {
-        return m_ConsoleHandle;
+        return m_Backend.GetConsoleHandle();
     }
 
     inline WindowHandle GetWindowHandle()
     {
-        return m_WindowHandle;
+        return m_Backend.GetWindowHandle();
     }
+#endif
 
-    static ConsoleWindow* Create( const char* a_Title, Vector< short, 2 > a_Size, Vector< short, 2 > a_PixelSize )
+    inline FramePacing GetFramePacing() const
     {
-        ConsoleWindow* NewWindow = new ConsoleWindow();
-
-        // Retrieve handles for console window.
-        NewWindow->m_ConsoleHandle = GetStdHandle( STD_OUTPUT_HANDLE );
-
-        if ( NewWindow->m_ConsoleHandle == INVALID_HANDLE_VALUE )
-        {
-            AllocConsole();
-            NewWindow->m_ConsoleHandle = GetStdHandle( STD_OUTPUT_HANDLE );
-        }
-
-        NewWindow->m_WindowHandle = GetConsoleWindow();
-
-        // Set console font.
-        a_PixelSize.x = Math::Min( a_PixelSize.x, static_cast< short >( 8 ) );
-        a_PixelSize.y = Math::Min( a_PixelSize.y, static_cast< short >( 8 ) );
-        CONSOLE_FONT_INFOEX FontInfo;
-        FontInfo.cbSize = sizeof( FontInfo );
-        FontInfo.nFont = 0;
-        FontInfo.dwFontSize = { a_PixelSize.x, a_PixelSize.y };
-        FontInfo.FontFamily = FF_DONTCARE;
-        FontInfo.FontWeight = FW_NORMAL;
-        wcscpy_s( FontInfo.FaceName, L"Terminal" );
-        SetCurrentConsoleFontEx( NewWindow->m_ConsoleHandle, false, &FontInfo );
-        NewWindow->m_PixelSize = a_PixelSize;
-
-        // Get screen buffer info object.
-        CONSOLE_SCREEN_BUFFER_INFOEX ScreenBufferInfo;
-        ScreenBufferInfo.cbSize = sizeof( ScreenBufferInfo );
-        GetConsoleScreenBufferInfoEx( NewWindow->m_ConsoleHandle, &ScreenBufferInfo );
+        return m_Pacing;
+    }
 
-        for ( int i = 0; i < 16; ++i )
-        {
-            COLORREF& ColourRef = ScreenBufferInfo.ColorTable[ i ];
-            Colour SeedColour = PixelColourMap::SeedColours[ i ];
-            ColourRef =
-                SeedColour.B << 16 |
-                SeedColour.G << 8  |
-                SeedColour.R;
-        }
+    // a_FramesPerSecond only applies to CAPPED pacing.
+    void SetFramePacing( FramePacing a_Pacing, float a_FramesPerSecond = 60.0f )
+    {
+        m_Pacing = a_Pacing;
+        m_Interval = std::chrono::duration_cast< Clock::duration >( std::chrono::duration< float >( 1.0f / Math::Max( a_FramesPerSecond, 1.0f ) ) );
+        m_NextFrame = Clock::time_point();
+    }
 
-        SetConsoleScreenBufferInfoEx( NewWindow->m_ConsoleHandle, &ScreenBufferInfo );
+    PresentStatistics GetPresentStatistics() const
+    {
+        return { m_PresentedFrames.load(), m_DroppedFrames.load(), m_LateFrames.load() };
+    }
 
-        // Get largest possible window size that can fit on screen.
-        COORD LargestWindow = GetLargestConsoleWindowSize( NewWindow->m_ConsoleHandle );
+    static ConsoleWindow* Create( const char* a_Title, Vector2Int a_Size, Vector< short, 2 > a_PixelSize )
+    {
+        ConsoleWindow* NewWindow = new ConsoleWindow();
 
-        // If smaller than requested size, exit.
-        if ( LargestWindow.X < a_Size.x ||
-             LargestWindow.Y < a_Size.y )
+        if ( !NewWindow->m_Backend.Open( a_Title, a_Size, a_PixelSize ) )
         {
+            delete NewWindow;
             return nullptr;
         }
 
-        // Set screen buffer.
+        NewWindow->m_PixelSize = a_PixelSize;
         NewWindow->m_ScreenBuffer.Initialize( a_Size );
-        COORD WindowSize = { NewWindow->GetWidth(), NewWindow->GetHeight() };
-
-        // Set window region rect.
-        NewWindow->m_WindowRegion.Left = 0;
-        NewWindow->m_WindowRegion.Top = 0;
-        NewWindow->m_WindowRegion.Right = WindowSize.X - 1;
-        NewWindow->m_WindowRegion.Bottom = WindowSize.Y - 1;
-
-        // Set console attributes.
-        SetConsoleScreenBufferSize( NewWindow->m_ConsoleHandle, { a_Size.x, a_Size.y } );
-        SetConsoleWindowInfo( NewWindow->m_ConsoleHandle, true, &NewWindow->m_WindowRegion );
-        GetConsoleScreenBufferInfoEx( NewWindow->m_ConsoleHandle, &ScreenBufferInfo );
-        SetConsoleScreenBufferSize( NewWindow->m_ConsoleHandle, { a_Size.x, a_Size.y } );
-        
-        // Set cursor attributes.
-        CONSOLE_CURSOR_INFO CursorInfo;
-        GetConsoleCursorInfo( NewWindow->m_ConsoleHandle, &CursorInfo );
-        CursorInfo.bVisible = false;
-        SetConsoleCursorInfo( NewWindow->m_ConsoleHandle, &CursorInfo );
-
-        // Set window attributes.
-        SetWindowLong( NewWindow->m_WindowHandle, GWL_STYLE, WS_CAPTION | DS_MODALFRAME | WS_MINIMIZEBOX | WS_SYSMENU );
-        SetWindowPos( NewWindow->m_WindowHandle, 0, 0, 0, 0, 0, SWP_FRAMECHANGED | SWP_NOSIZE | SWP_NOMOVE | SWP_NOZORDER | SWP_SHOWWINDOW );
-        NewWindow->SetTitle( a_Title );
+
+#if !CGE_HEADLESS
         NewWindow->m_Thread = new Thread( []( ConsoleWindow* a_ConsoleWindow )
                                           {
+                                              ScreenBuffer& Buffer = a_ConsoleWindow->m_ScreenBuffer;
+
                                               while ( true )
                                               {
-                                                  std::unique_lock< std::mutex > Locker( a_ConsoleWindow->m_Mutex );
-                                                  a_ConsoleWindow->m_ConditionVariable.wait( Locker );
-                                                  
-                                                  if ( a_ConsoleWindow->m_BufferReady )
+                                                  // The lock only covers the wait, frames are written without it.
                                                   {
-                                                      a_ConsoleWindow->WriteBuffer();
-                                                      a_ConsoleWindow->m_BufferReady = false;
+                                                      std::unique_lock< std::mutex > Locker( a_ConsoleWindow->m_Mutex );
+                                                      a_ConsoleWindow->m_ConditionVariable.wait( Locker, [ & ]() { return Buffer.IsPublished(); } );
                                                   }
+
+                                                  a_ConsoleWindow->Present();
                                               }
                                           }, NewWindow );
+#endif
+
         return NewWindow;
     }
 
@@ -172,6 +155,25 @@ public:
         return m_ScreenBuffer;
     }
 
+    // Publishes every resolved frame, colours and console cells, to shared memory under a_Name for viewers and
+    // recorders, see FrameExporter. Null stops.
+    bool ExportFrames( const char* a_Name )
+    {
+        if ( !a_Name )
+        {
+            m_Exporter.Close();
+            return true;
+        }
+
+        return m_Exporter.Open( a_Name, m_ScreenBuffer.GetSize(), CGE_CONSOLE_CELLS ? sizeof( ScreenBuffer::Cell ) : 0 );
+    }
+
+    // Headless runs read their frames back through it.
+    inline Backend& GetBackend()
+    {
+        return m_Backend;
+    }
+
     static ConsoleWindow* GetCurrentContext()
     {
         return s_ActiveWindow;
@@ -182,42 +184,132 @@ public:
         s_ActiveWindow = a_Window;
     }
 
+    // Resolves the frame and hands it to the writer thread, never waiting for the console. Headless frames are
+    // presented right away instead, so every frame is seen.
     static void SwapBuffers( ConsoleWindow* a_Window )
     {
-        a_Window->m_ScreenBuffer.SwapPixelBuffer();
+        a_Window->m_ScreenBuffer.Resolve();
+        a_Window->Export();
+        a_Window->Pace();
+
+        if ( !a_Window->m_ScreenBuffer.PublishPixelBuffer() )
+        {
+            ++a_Window->m_DroppedFrames;
+        }
+
+#if CGE_HEADLESS
+        a_Window->Present();
+#else
         a_Window->DrawBuffer();
+#endif
+        a_Window->Resize();
     }
 
 private:
 
+    typedef std::chrono::steady_clock Clock;
+
+    // Holds capped frames back until their interval comes up. A late frame goes out at once and the
+    // intervals restart from it rather than hurrying the frames after it.
+    void Pace()
+    {
+        if ( m_Pacing != FramePacing::CAPPED )
+        {
+            return;
+        }
+
+        Clock::time_point Now = Clock::now();
+
+        if ( Now > m_NextFrame )
+        {
+            if ( m_NextFrame != Clock::time_point() )
+            {
+                ++m_LateFrames;
+            }
+
+            m_NextFrame = Now + m_Interval;
+            return;
+        }
+
+        std::this_thread::sleep_until( m_NextFrame );
+        m_NextFrame += m_Interval;
+    }
+
+    // The back buffer still holds the frame just resolved, it is only handed over after.
+    void Export()
+    {
+        if ( !m_Exporter.IsOpen() )
+        {
+            return;
+        }
+
+#if CGE_CONSOLE_CELLS
+        const void* Cells = m_ScreenBuffer.GetPixelBuffer();
+#else
+        const void* Cells = nullptr;
+#endif
+        m_Exporter.Write( m_ScreenBuffer.GetColourBuffer(), Cells, m_ScreenBuffer.GetSize(), m_ScreenBuffer.GetPitch() );
+    }
+
+    void Present()
+    {
+        // Held while writing so the buffers aren't resized under the backend.
+        std::lock_guard< std::mutex > Lock( m_PresentMutex );
+
+        if ( m_ScreenBuffer.AcquirePixelBuffer() )
+        {
+            m_Backend.Write( m_ScreenBuffer.GetPresentBuffer(), m_ScreenBuffer.GetSize(), m_ScreenBuffer.GetPitch() );
+            ++m_PresentedFrames;
+        }
+    }
+
     void DrawBuffer()
     {
-        m_BufferReady = true;
-        m_ConditionVariable.notify_one();
+        // Passing through the lock means the writer is either before its check, and sees the frame, or waiting,
+        // and gets the notification. The writer never holds it while writing.
+        {
+            std::lock_guard< std::mutex > Lock( m_Mutex );
+        }
 
-        //while ( m_BufferReady );
+        m_ConditionVariable.notify_one();
     }
 
-    void WriteBuffer()
+    // Takes a new size from the backend between frames, the next frame is drawn at it and presented whole.
+    void Resize()
     {
-        WriteConsoleOutput(
-            m_ConsoleHandle,
-            m_ScreenBuffer.GetPixelBuffer(),
-            { m_ScreenBuffer.GetWidth(), m_ScreenBuffer.GetHeight() },
-            { 0, 0 },
-            &m_WindowRegion );
+        Vector2Int NewSize;
+
+        if ( !m_Backend.PollResize( NewSize ) )
+        {
+            return;
+        }
+
+        {
+            std::lock_guard< std::mutex > Lock( m_PresentMutex );
+            m_ScreenBuffer.Initialize( NewSize );
+        }
+
+        // Readers see the old memory closed and open the name again.
+        if ( m_Exporter.IsOpen() && !m_Exporter.Fits( NewSize ) )
+        {
+            std::string Name = m_Exporter.GetName();
+            m_Exporter.Open( Name.c_str(), NewSize, CGE_CONSOLE_CELLS ? sizeof( ScreenBuffer::Cell ) : 0 );
+        }
     }
 
-    bool                         m_BufferReady;
-    ConsoleHandle                m_ConsoleHandle;
-    WindowHandle                 m_WindowHandle;
-    WindowRegion                 m_WindowRegion;
+    Backend                      m_Backend;
     Vector< short, 2 >           m_PixelSize;
-    wchar_t                      m_TitleBuffer[ 64 ];
-    std::string                  m_Title;
     ScreenBuffer                 m_ScreenBuffer;
-    Thread*                      m_Thread;
+    Thread*                      m_Thread = nullptr;
     std::condition_variable      m_ConditionVariable;
     std::mutex                   m_Mutex;
+    std::mutex                   m_PresentMutex;
+    FrameExporter                m_Exporter;
+    FramePacing                  m_Pacing = FramePacing::LATEST;
+    Clock::duration              m_Interval = std::chrono::duration_cast< Clock::duration >( std::chrono::duration< float >( 1.0f / 60.0f ) );
+    Clock::time_point            m_NextFrame;
+    std::atomic< uint64_t >      m_PresentedFrames = 0;
+    std::atomic< uint64_t >      m_DroppedFrames = 0;
+    std::atomic< uint64_t >      m_LateFrames = 0;
     inline static ConsoleWindow* s_ActiveWindow;
 };
\ No newline at end of file
@@ -0,0 +1,208 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Math.hpp"
+#include "Colour.hpp"
+#include "Rendering.hpp"
+#include "Shader.hpp"
+#include "Camera.hpp"
+#include "Transform.hpp"
+
+// Immediate mode debug drawing. Everything submitted during a frame is uploaded as one vertex stream and
+// drawn by the render pipeline at the end of the frame in a single line draw. Points are lines of no length,
+// which rasterize to one pixel.
+class DebugDraw
+{
+public:
+
+	static void Line( const Vector3& a_Begin, const Vector3& a_End, Colour a_Colour = Colour::WHITE )
+	{
+		s_Vertices.push_back( { a_Begin, a_Colour } );
+		s_Vertices.push_back( { a_End, a_Colour } );
+	}
+
+	static void Point( const Vector3& a_Position, Colour a_Colour = Colour::WHITE )
+	{
+		Line( a_Position, a_Position, a_Colour );
+	}
+
+	static void Box( const Vector3& a_Min, const Vector3& a_Max, Colour a_Colour = Colour::WHITE )
+	{
+		Box( Matrix4::Identity, a_Min, a_Max, a_Colour );
+	}
+
+	// Oriented box, the corners are transformed by a_Model.
+	static void Box( const Matrix4& a_Model, const Vector3& a_Min, const Vector3& a_Max, Colour a_Colour = Colour::WHITE )
+	{
+		Vector3 Corners[ 8 ];
+
+		for ( uint32_t i = 0; i < 8; ++i )
+		{
+			Vector4 Corner = {
+				( i & 1 ) ? a_Max.x : a_Min.x,
+				( i & 2 ) ? a_Max.y : a_Min.y,
+				( i & 4 ) ? a_Max.z : a_Min.z,
+				1.0f };
+
+			Corners[ i ] = Vector3( Math::Multiply( a_Model, Corner ) );
+		}
+
+		Cube( Corners, a_Colour );
+	}
+
+	static void Sphere( const Vector3& a_Centre, float a_Radius, Colour a_Colour = Colour::WHITE, uint32_t a_Segments = 16 )
+	{
+		float Step = Math::Radians( 360.0f ) / a_Segments;
+
+		for ( uint32_t i = 0; i < a_Segments; ++i )
+		{
+			float A = Step * i, B = Step * ( i + 1 );
+			Vector2 PA = { Math::Cos( A ) * a_Radius, Math::Sin( A ) * a_Radius };
+			Vector2 PB = { Math::Cos( B ) * a_Radius, Math::Sin( B ) * a_Radius };
+
+			Line( a_Centre + Vector3( PA.x, PA.y, 0.0f ), a_Centre + Vector3( PB.x, PB.y, 0.0f ), a_Colour );
+			Line( a_Centre + Vector3( PA.x, 0.0f, PA.y ), a_Centre + Vector3( PB.x, 0.0f, PB.y ), a_Colour );
+			Line( a_Centre + Vector3( 0.0f, PA.x, PA.y ), a_Centre + Vector3( 0.0f, PB.x, PB.y ), a_Colour );
+		}
+	}
+
+	// Unprojects the corners of clip space through the inverse projection view matrix.
+	static void Frustum( const Matrix4& a_ProjectionView, Colour a_Colour = Colour::YELLOW )
+	{
+		Matrix4 InverseProjectionView = Math::Inverse( a_ProjectionView );
+		Vector3 Corners[ 8 ];
+
+		for ( uint32_t i = 0; i < 8; ++i )
+		{
+			Vector4 Corner = Math::Multiply( InverseProjectionView, Vector4(
+				( i & 1 ) ? 1.0f : -1.0f,
+				( i & 2 ) ? 1.0f : -1.0f,
+				( i & 4 ) ? 1.0f : -1.0f,
+				1.0f ) );
+
+			Corners[ i ] = Vector3( Corner ) / Corner.w;
+		}
+
+		Cube( Corners, a_Colour );
+	}
+
+	static void Frustum( const Camera& a_Camera, Colour a_Colour = Colour::YELLOW )
+	{
+		Frustum( a_Camera.GetProjectionViewMatrix(), a_Colour );
+	}
+
+	static void Axes( const Matrix4& a_Model, float a_Scale = 1.0f )
+	{
+		Vector3 Origin = { a_Model.Data[ 3 ], a_Model.Data[ 7 ], a_Model.Data[ 11 ] };
+		Line( Origin, Origin + Vector3( a_Model.Data[ 0 ], a_Model.Data[ 4 ], a_Model.Data[ 8 ] ) * a_Scale, Colour::RED );
+		Line( Origin, Origin + Vector3( a_Model.Data[ 1 ], a_Model.Data[ 5 ], a_Model.Data[ 9 ] ) * a_Scale, Colour::GREEN );
+		Line( Origin, Origin + Vector3( a_Model.Data[ 2 ], a_Model.Data[ 6 ], a_Model.Data[ 10 ] ) * a_Scale, Colour::BLUE );
+	}
+
+	// Draws the axes of a transform and a line to each of its children, recursively.
+	static void Hierarchy( Transform* a_Transform, float a_Scale = 0.25f )
+	{
+		Axes( a_Transform->GetGlobalMatrix(), a_Scale );
+		Point( a_Transform->GetGlobalPosition(), Colour::WHITE );
+
+		for ( size_t i = 0; i < a_Transform->GetChildCount(); ++i )
+		{
+			Transform* Child = a_Transform->GetChild( i );
+			Line( a_Transform->GetGlobalPosition(), Child->GetGlobalPosition(), Colour::LIGHT_GREY );
+			Hierarchy( Child, a_Scale );
+		}
+	}
+
+	static void Clear()
+	{
+		s_Vertices.clear();
+	}
+
+private:
+
+	friend class RenderPipeline;
+
+	struct DebugVertex
+	{
+		DebugVertex( const Vector3& a_Position, Colour a_Colour )
+			: Position( a_Position )
+			, VertexColour( a_Colour )
+		{}
+
+		Vector3 Position;
+		Vector4 VertexColour;
+	};
+
+	// Corner index bits are x, y, z.
+	static void Cube( const Vector3* a_Corners, Colour a_Colour )
+	{
+		static constexpr uint8_t _Edges[ 12 ][ 2 ] = {
+			{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+			{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+			{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } };
+
+		for ( auto& Edge : _Edges )
+		{
+			Line( a_Corners[ Edge[ 0 ] ], a_Corners[ Edge[ 1 ] ], a_Colour );
+		}
+	}
+
+	static void Flush( const Matrix4& a_ProjectionView )
+	{
+		if ( s_Vertices.empty() )
+		{
+			return;
+		}
+
+		if ( !s_ArrayHandle )
+		{
+			Rendering::GenVertexArrays( 1, &s_ArrayHandle );
+			Rendering::GenBuffers( 1, &s_BufferHandle );
+		}
+
+		Rendering::BindVertexArray( s_ArrayHandle );
+		Rendering::BindBuffer( BufferTarget::ARRAY_BUFFER, s_BufferHandle );
+		Rendering::BufferData( BufferTarget::ARRAY_BUFFER, s_Vertices.size() * sizeof( DebugVertex ), s_Vertices.data(), DataUsage::DRAW );
+		Rendering::VertexAttribPointer( 0, 3, DataType::FLOAT, false, sizeof( DebugVertex ), ( void* )offsetof( DebugVertex, Position ) );
+		Rendering::EnableVertexAttribArray( 0 );
+		Rendering::VertexAttribPointer( 2, 4, DataType::FLOAT, false, sizeof( DebugVertex ), ( void* )offsetof( DebugVertex, VertexColour ) );
+		Rendering::EnableVertexAttribArray( 2 );
+
+		Shader::VertexColour.Compile();
+		Rendering::UseProgram( Shader::VertexColour.GetProgramHandle() );
+
+		if ( int32_t PVMLocation = Rendering::GetUniformLocation( Shader::VertexColour.GetProgramHandle(), "u_PVM" ); PVMLocation >= 0 )
+		{
+			Rendering::UniformMatrix4fv( PVMLocation, 1, false, a_ProjectionView.Data );
+		}
+
+		// Put back whatever the caller had, not the defaults.
+		bool CullFace, Blend, DepthWrite;
+		Rendering::GetBooleanv( RenderSetting::CULL_FACE, &CullFace );
+		Rendering::GetBooleanv( RenderSetting::BLEND, &Blend );
+		Rendering::GetBooleanv( RenderSetting::DEPTH_WRITEMASK, &DepthWrite );
+
+		Rendering::Disable( RenderSetting::CULL_FACE );
+		Rendering::Disable( RenderSetting::BLEND );
+		Rendering::DepthMask( true );
+
+		Rendering::DrawArrays( RenderMode::LINE, 0, static_cast< uint32_t >( s_Vertices.size() ) );
+
+		if ( CullFace )
+		{
+			Rendering::Enable( RenderSetting::CULL_FACE );
+		}
+
+		if ( Blend )
+		{
+			Rendering::Enable( RenderSetting::BLEND );
+		}
+
+		Rendering::DepthMask( DepthWrite );
+		Clear();
+	}
+
+	inline static std::vector< DebugVertex > s_Vertices;
+	inline static ArrayHandle                s_ArrayHandle;
+	inline static BufferHandle               s_BufferHandle;
+};
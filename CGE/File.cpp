@@ -1,4 +1,5 @@
 #include "File.hpp"
+#include "Platform.hpp"
 
 #include <filesystem>
 #undef DestroyFile
@@ -0,0 +1,243 @@
+#pragma once
+#include "Platform.hpp"
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#if CGE_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#include "Math.hpp"
+#include "Colour.hpp"
+
+// Publishes resolved frames into named shared memory, for viewers and recorders in other processes. The memory
+// holds a header and a ring of slots, each guarded by a sequence counter that is odd while the slot is written.
+// A reader takes Header::Latest, reads its slot's sequence, copies the slot, and keeps the copy only if the
+// sequence was even and is unchanged afterwards, otherwise it tries again. The engine never waits on readers.
+class FrameExporter
+{
+public:
+
+    // Reads "CGEF" in memory on little-endian machines, the only byte order the exporter writes.
+    static constexpr uint32_t Magic   = 'C' | 'G' << 8 | 'E' << 16 | 'F' << 24;
+    static constexpr uint32_t Version = 1;
+
+    struct Header
+    {
+        uint32_t                Magic;
+        uint32_t                Version;
+        uint32_t                SlotCount;
+        uint32_t                SlotSize;  // Bytes from one slot to the next, the first follows the header.
+        uint16_t                Width;     // The largest frame a slot holds.
+        uint16_t                Height;
+        uint16_t                CellSize;  // Bytes per console cell after the colours, zero without console cells.
+        uint16_t                Reserved;
+        std::atomic< uint64_t > Latest;    // Number of the newest complete frame, slot Latest % SlotCount.
+        std::atomic< uint32_t > Closed;    // Set before the engine lets go, readers open the name again.
+        uint32_t                Padding;
+    };
+
+    struct Slot
+    {
+        std::atomic< uint64_t > Sequence;
+        uint64_t                Frame;
+        uint64_t                Time;   // Nanoseconds since the exporter opened.
+        uint16_t                Width;
+        uint16_t                Height;
+        uint32_t                Padding;
+        // Width * Height RGBA colours, then Width * Height cells of CellSize bytes.
+    };
+
+    static_assert( std::atomic< uint64_t >::is_always_lock_free, "Sequence counters are shared between processes." );
+    static_assert( sizeof( Header ) == 40 && sizeof( Slot ) == 32, "Readers rely on the layout." );
+
+    ~FrameExporter()
+    {
+        Close();
+    }
+
+    // Creates the shared memory for frames up to a_Size, a_SlotCount of them in flight. Opening again, to
+    // grow after a resize, closes the previous memory first. Frames wider or taller than the header holds, or
+    // slots past 4GB, aren't exported.
+    bool Open( const char* a_Name, Vector2Int a_Size, uint32_t a_CellSize, uint32_t a_SlotCount = 4 )
+    {
+        Close();
+
+        size_t Area = static_cast< size_t >( a_Size.x ) * a_Size.y;
+        size_t SlotSize = ( sizeof( Slot ) + Area * ( sizeof( Colour ) + a_CellSize ) + 63 ) & ~size_t( 63 );
+
+        if ( a_Size.x > UINT16_MAX || a_Size.y > UINT16_MAX || SlotSize > UINT32_MAX )
+        {
+            return false;
+        }
+
+        m_Name = a_Name;
+        m_Bytes = sizeof( Header ) + SlotSize * a_SlotCount;
+
+#if CGE_WINDOWS
+        m_Mapping = CreateFileMappingA( INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast< DWORD >( static_cast< uint64_t >( m_Bytes ) >> 32 ), static_cast< DWORD >( m_Bytes ), a_Name );
+        m_View = m_Mapping ? MapViewOfFile( m_Mapping, FILE_MAP_ALL_ACCESS, 0, 0, m_Bytes ) : nullptr;
+#else
+        // Shared memory names are a single path component.
+        if ( m_Name.empty() || m_Name[ 0 ] != '/' )
+        {
+            m_Name.insert( 0, 1, '/' );
+        }
+
+        shm_unlink( m_Name.c_str() );
+        int File = shm_open( m_Name.c_str(), O_CREAT | O_RDWR, 0644 );
+
+        if ( File >= 0 )
+        {
+            if ( ftruncate( File, static_cast< off_t >( m_Bytes ) ) == 0 )
+            {
+                void* View = mmap( nullptr, m_Bytes, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0 );
+                m_View = View != MAP_FAILED ? View : nullptr;
+            }
+
+            // The mapping outlives the descriptor.
+            close( File );
+        }
+#endif
+
+        if ( !m_View )
+        {
+            Close();
+            return false;
+        }
+
+        Header* Shared = new ( m_View ) Header();
+        Shared->Magic = Magic;
+        Shared->Version = Version;
+        Shared->SlotCount = a_SlotCount;
+        Shared->SlotSize = static_cast< uint32_t >( SlotSize );
+        Shared->Width = static_cast< uint16_t >( a_Size.x );
+        Shared->Height = static_cast< uint16_t >( a_Size.y );
+        Shared->CellSize = a_CellSize;
+        Shared->Latest.store( 0, std::memory_order_relaxed );
+        Shared->Closed.store( 0, std::memory_order_relaxed );
+
+        for ( uint32_t i = 0; i < a_SlotCount; ++i )
+        {
+            new ( GetSlot( i ) ) Slot();
+        }
+
+        m_Size = a_Size;
+        m_CellSize = a_CellSize;
+        m_Frame = 0;
+        m_Opened = Clock::now();
+        return true;
+    }
+
+    void Close()
+    {
+        if ( m_View )
+        {
+            static_cast< Header* >( m_View )->Closed.store( 1, std::memory_order_release );
+        }
+
+#if CGE_WINDOWS
+        if ( m_View )
+        {
+            UnmapViewOfFile( m_View );
+        }
+
+        if ( m_Mapping )
+        {
+            CloseHandle( m_Mapping );
+            m_Mapping = nullptr;
+        }
+#else
+        if ( m_View )
+        {
+            munmap( m_View, m_Bytes );
+            shm_unlink( m_Name.c_str() );
+        }
+#endif
+
+        m_View = nullptr;
+    }
+
+    inline bool IsOpen() const
+    {
+        return m_View != nullptr;
+    }
+
+    inline const std::string& GetName() const
+    {
+        return m_Name;
+    }
+
+    // Whether frames of a_Size fit the slots, Open again with the new size when they don't.
+    inline bool Fits( Vector2Int a_Size ) const
+    {
+        return a_Size.x <= m_Size.x && a_Size.y <= m_Size.y;
+    }
+
+    // Copies a frame into the next slot, a_Cells may be null when there are no console cells. Source rows are
+    // a_Pitch cells apart, slots hold them packed. Frames that don't fit are skipped.
+    void Write( const Colour* a_Colours, const void* a_Cells, Vector2Int a_Size, int32_t a_Pitch )
+    {
+        if ( !m_View || !Fits( a_Size ) )
+        {
+            return;
+        }
+
+        Header* Shared = static_cast< Header* >( m_View );
+        uint64_t Frame = ++m_Frame;
+        Slot* Target = GetSlot( static_cast< uint32_t >( Frame % Shared->SlotCount ) );
+        size_t Area = static_cast< size_t >( a_Size.x ) * a_Size.y;
+        char* Data = reinterpret_cast< char* >( Target + 1 );
+        const char* Cells = static_cast< const char* >( a_Cells );
+
+        // Odd while the slot is written, readers that saw it odd or see it change drop what they copied.
+        uint64_t Sequence = Target->Sequence.load( std::memory_order_relaxed );
+        Target->Sequence.store( Sequence + 1, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_release );
+
+        Target->Frame = Frame;
+        Target->Time = static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( Clock::now() - m_Opened ).count() );
+        Target->Width = static_cast< uint16_t >( a_Size.x );
+        Target->Height = static_cast< uint16_t >( a_Size.y );
+
+        for ( int32_t y = 0; y < a_Size.y; ++y )
+        {
+            size_t Row = static_cast< size_t >( y ) * a_Size.x;
+            size_t Source = static_cast< size_t >( y ) * a_Pitch;
+            std::memcpy( Data + Row * sizeof( Colour ), a_Colours + Source, a_Size.x * sizeof( Colour ) );
+
+            if ( Cells && m_CellSize )
+            {
+                std::memcpy( Data + Area * sizeof( Colour ) + Row * m_CellSize, Cells + Source * m_CellSize, a_Size.x * m_CellSize );
+            }
+        }
+
+        Target->Sequence.store( Sequence + 2, std::memory_order_release );
+        Shared->Latest.store( Frame, std::memory_order_release );
+    }
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    inline Slot* GetSlot( uint32_t a_Index ) const
+    {
+        Header* Shared = static_cast< Header* >( m_View );
+        return reinterpret_cast< Slot* >( static_cast< char* >( m_View ) + sizeof( Header ) + static_cast< size_t >( a_Index ) * Shared->SlotSize );
+    }
+
+    std::string        m_Name;
+    size_t             m_Bytes = 0;
+    void*              m_View = nullptr;
+#if CGE_WINDOWS
+    HANDLE             m_Mapping = nullptr;
+#endif
+    Vector2Int         m_Size;
+    uint32_t           m_CellSize = 0;
+    uint64_t           m_Frame = 0;
+    Clock::time_point  m_Opened;
+};
@@ -5,41 +5,37 @@
 struct Frustum
 {
 	Frustum( const Camera& a_Camera )
-	{
-		const Transform* CameraTransform = a_Camera.GetOwner().GetTransform();
-		Vector2 FarSize;
-		FarSize.y = a_Camera.GetFarZ() * Math::Tan( a_Camera.GetFOV() * 0.5f );
-		FarSize.x = FarSize.y * a_Camera.GetAspect();
-		Vector3 CameraPosition = CameraTransform->GetGlobalPosition();
-		Vector3 CameraForward = CameraTransform->GetGlobalForward();
-		Vector3 CameraRight = CameraTransform->GetGlobalRight();
-		Vector3 CameraUp = CameraTransform->GetGlobalUp();
-		Vector3 NearP = a_Camera.GetNearZ() * CameraForward;
-		Vector3 FarP = a_Camera.GetFarZ() * CameraForward;
-
-		// Front
-		Front.normal = CameraForward;
-		Front.distance = Math::Dot( CameraPosition + NearP, Front.normal );
-
-		// Back
-		Back.normal = -CameraForward;
-		Back.distance = Math::Dot( CameraPosition + FarP, Back.normal );
+		: Frustum( a_Camera.GetProjectionViewMatrix() )
+	{ }
 
-		// Right
-		Right.normal = Math::Cross( CameraUp, FarP + CameraRight * FarSize.x );
-		Right.distance = Math::Dot( CameraPosition, Right.normal );
+	// Gribb-Hartmann, planes are taken from the rows of the projection view matrix and face inwards.
+	Frustum( const Matrix4& a_ProjectionView )
+	{
+		auto Row = [ & ]( uint32_t a_Row )
+		{
+			return Vector4( a_ProjectionView.Data[ a_Row * 4 + 0 ], a_ProjectionView.Data[ a_Row * 4 + 1 ], a_ProjectionView.Data[ a_Row * 4 + 2 ], a_ProjectionView.Data[ a_Row * 4 + 3 ] );
+		};
 
-		// Left
-		Left.normal = Math::Cross( CameraUp, FarP - CameraRight * FarSize.x );
-		Left.distance = Math::Dot( CameraPosition, Left.normal );
+		Vector4 X = Row( 0 ), Y = Row( 1 ), Z = Row( 2 ), W = Row( 3 );
+		Left   = Geometry::Normalize( Plane( W + X ) );
+		Right  = Geometry::Normalize( Plane( W - X ) );
+		Top    = Geometry::Normalize( Plane( W - Y ) );
+		Bottom = Geometry::Normalize( Plane( W + Y ) );
+		Front  = Geometry::Normalize( Plane( W + Z ) );
+		Back   = Geometry::Normalize( Plane( W - Z ) );
+	}
 
-		// Top
-		Top.normal = Math::Cross( CameraRight, FarP - CameraUp * FarSize.y );
-		Top.distance = Math::Dot( CameraPosition, Top.normal );
+	inline bool Intersects( const Vector3& a_Centre, float a_Radius ) const
+	{
+		for ( const auto& FrustumPlane : Planes )
+		{
+			if ( Geometry::DistanceFromPlane( FrustumPlane, a_Centre ) < -a_Radius )
+			{
+				return false;
+			}
+		}
 
-		// Bottom
-		Bottom.normal = Math::Cross( FarP + CameraUp * FarSize.y, CameraRight );
-		Bottom.distance = Math::Dot( CameraPosition, Bottom.normal );
+		return true;
 	}
 
 	union
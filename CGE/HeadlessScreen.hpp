@@ -0,0 +1,161 @@
+#pragma once
+#include "Platform.hpp"
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include "Math.hpp"
+#include "Hash.hpp"
+#include "Colour.hpp"
+
+// ConsoleWindow's backend when built with CGE_HEADLESS: frames are kept in memory rather than shown, for
+// rendering regression tests and benchmarks on machines without a console. Frames are presented on the game
+// thread as they are swapped, so none are dropped and each can be checked against a golden image.
+class HeadlessScreen
+{
+public:
+
+    // Keeps the requested size, there is nothing to fit it to.
+    bool Open( const char* a_Title, Vector2Int& io_Size, Vector< short, 2 >& io_PixelSize )
+    {
+        SetTitle( a_Title );
+        m_LastWrite = Clock::now();
+        return true;
+    }
+
+    void SetTitle( const char* a_Title )
+    {
+        m_Title = a_Title;
+    }
+
+    inline bool PollResize( Vector2Int& o_Size )
+    {
+        return false;
+    }
+
+    // Rows are a_Pitch colours apart in a_Frame, the kept frame has them packed.
+    void Write( const Colour* a_Frame, Vector2Int a_Size, int32_t a_Pitch )
+    {
+        m_Frame.resize( static_cast< size_t >( a_Size.x ) * a_Size.y );
+        m_Size = a_Size;
+
+        for ( int32_t y = 0; y < a_Size.y; ++y )
+        {
+            const Colour* Row = a_Frame + static_cast< size_t >( y ) * a_Pitch;
+            std::copy( Row, Row + a_Size.x, m_Frame.data() + static_cast< size_t >( y ) * a_Size.x );
+        }
+
+        m_Checksums.push_back( Checksum( m_Frame.data(), m_Frame.size() ) );
+
+        Clock::time_point Now = Clock::now();
+        m_FrameTimes.push_back( std::chrono::duration< float, std::milli >( Now - m_LastWrite ).count() );
+        m_LastWrite = Now;
+
+        if ( !m_CapturePath.empty() )
+        {
+            char Path[ 512 ];
+            snprintf( Path, sizeof( Path ), m_CapturePath.c_str(), static_cast< unsigned long long >( m_Checksums.size() - 1 ) );
+            SavePPM( Path );
+        }
+    }
+
+    inline const std::string& GetTitle() const
+    {
+        return m_Title;
+    }
+
+    // The last frame presented, row by row from the top.
+    inline const Colour* GetFrame() const
+    {
+        return m_Frame.data();
+    }
+
+    inline Vector2Int GetFrameSize() const
+    {
+        return m_Size;
+    }
+
+    // CRC32 of the red, green and blue of every pixel of each frame presented, in order. Alpha is left out,
+    // it never reaches the screen.
+    inline const std::vector< uint32_t >& GetChecksums() const
+    {
+        return m_Checksums;
+    }
+
+    inline uint32_t GetChecksum() const
+    {
+        return m_Checksums.empty() ? 0 : m_Checksums.back();
+    }
+
+    // Real milliseconds from each frame presented back to the one before, the first from Open. Simulated
+    // deltas don't change these, so benchmark runs can be deterministic and still timed.
+    inline const std::vector< float >& GetFrameTimes() const
+    {
+        return m_FrameTimes;
+    }
+
+    // Saves every frame presented from now on, a_PathFormat takes the frame's index as %llu. Empty stops.
+    inline void SetCapturePath( const char* a_PathFormat )
+    {
+        m_CapturePath = a_PathFormat ? a_PathFormat : "";
+    }
+
+    // Saves the last frame as a binary PPM, which image tools and diff scripts read without a library.
+    bool SavePPM( const char* a_Path ) const
+    {
+        FILE* File = nullptr;
+
+        if ( fopen_s( &File, a_Path, "wb" ) != 0 || !File )
+        {
+            return false;
+        }
+
+        fprintf( File, "P6\n%d %d\n255\n", m_Size.x, m_Size.y );
+        std::vector< unsigned char > Row( static_cast< size_t >( m_Size.x ) * 3 );
+        bool Written = true;
+
+        for ( int32_t y = 0; y < m_Size.y && Written; ++y )
+        {
+            const Colour* Source = m_Frame.data() + static_cast< size_t >( y ) * m_Size.x;
+
+            for ( int32_t x = 0; x < m_Size.x; ++x )
+            {
+                Row[ x * 3 + 0 ] = Source[ x ].R;
+                Row[ x * 3 + 1 ] = Source[ x ].G;
+                Row[ x * 3 + 2 ] = Source[ x ].B;
+            }
+
+            Written = fwrite( Row.data(), 1, Row.size(), File ) == Row.size();
+        }
+
+        fclose( File );
+        return Written;
+    }
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    static uint32_t Checksum( const Colour* a_Frame, size_t a_Count )
+    {
+        uint32_t Crc = ~0u;
+
+        for ( size_t i = 0; i < a_Count; ++i )
+        {
+            Crc = crc_table[ ( Crc ^ a_Frame[ i ].R ) & 0xFF ] ^ ( Crc >> 8 );
+            Crc = crc_table[ ( Crc ^ a_Frame[ i ].G ) & 0xFF ] ^ ( Crc >> 8 );
+            Crc = crc_table[ ( Crc ^ a_Frame[ i ].B ) & 0xFF ] ^ ( Crc >> 8 );
+        }
+
+        return ~Crc;
+    }
+
+    std::string             m_Title;
+    std::string             m_CapturePath;
+    std::vector< Colour >   m_Frame;
+    Vector2Int              m_Size;
+    std::vector< uint32_t > m_Checksums;
+    std::vector< float >    m_FrameTimes;
+    Clock::time_point       m_LastWrite;
+};
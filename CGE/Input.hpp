@@ -1,5 +1,5 @@
 #pragma once
-#include <Windows.h>
+#include "Platform.hpp"
 #include <bitset>
 #include <thread>
 #include "Math.hpp"
@@ -131,12 +131,12 @@ public:
 
 	inline static bool IsKeyDown( KeyCode a_KeyCode )
 	{
-		return GetKeyState( KeyCodes[ static_cast< unsigned char >( a_KeyCode ) ] ) & 0x8000;
+		return IsHeld( KeyCodes[ static_cast< unsigned char >( a_KeyCode ) ] );
 	}
 
 	inline static bool IsKeyUp( KeyCode a_KeyCode )
 	{
-		return !( GetKeyState( KeyCodes[ static_cast< unsigned char >( a_KeyCode ) ] ) & 0x8000 );
+		return !IsHeld( KeyCodes[ static_cast< unsigned char >( a_KeyCode ) ] );
 	}
 
 	inline static bool IsKeyPressed( KeyCode a_KeyCode )
@@ -151,12 +151,12 @@ public:
 
 	inline static bool IsMouseDown( MouseCode a_MouseCode )
 	{
-		return GetKeyState( MouseCodes[ static_cast< unsigned char >( a_MouseCode ) ] ) & 0x8000;
+		return IsHeld( MouseCodes[ static_cast< unsigned char >( a_MouseCode ) ] );
 	}
 
 	inline static bool IsMouseUp( MouseCode a_MouseCode )
 	{
-		return !( GetKeyState( MouseCodes[ static_cast< unsigned char >( a_MouseCode ) ] ) & 0x8000 );
+		return !IsHeld( MouseCodes[ static_cast< unsigned char >( a_MouseCode ) ] );
 	}
 	
 	inline static bool IsMousePressed( MouseCode a_MouseCode )
@@ -171,6 +171,12 @@ public:
 
 	static Vector2 GetMousePosition()
 	{
+#if CGE_HEADLESS
+		return Vector2::Zero;
+#elif CGE_POSIX
+		Vector2 Coordinates = PosixTerminal::GetMousePosition();
+		return Vector2( Coordinates.x, ConsoleWindow::GetCurrentContext()->GetHeight() - Coordinates.y );
+#else
 		POINT Coordinates = { 0, 0 };
 
 		if ( !GetCursorPos( &Coordinates ) )
@@ -184,6 +190,7 @@ public:
 		}
 
 		return Vector2( Coordinates.x, ConsoleWindow::GetCurrentContext()->GetHeight() - Coordinates.y );
+#endif
 	}
 
 	inline static Vector2 GetMouseDelta()
@@ -195,19 +202,36 @@ private:
 
 	friend class CGE;
 
+	// Terminals report keys as input rather than state, see PosixTerminal::IsHeld. Headless runs have no input.
+	inline static bool IsHeld( unsigned char a_Code )
+	{
+#if CGE_HEADLESS
+		return false;
+#elif CGE_WINDOWS
+		return GetKeyState( a_Code ) & 0x8000;
+#else
+		return PosixTerminal::IsHeld( a_Code );
+#endif
+	}
+
 	static void Tick()
 	{
 		for ( int i = 0; i < KeyStates.size(); ++i )
 		{
-			KeyStates[ i ] = GetKeyState( KeyCodes[ i ] ) & 0x8000;
+			KeyStates[ i ] = IsHeld( KeyCodes[ i ] );
 		}
 
 		for ( int i = 0; i < MouseStates.size(); ++i )
 		{
-			MouseStates[ i ] = GetKeyState( MouseCodes[ i ] ) & 0x8000;
+			MouseStates[ i ] = IsHeld( MouseCodes[ i ] );
 		}
 
 		MousePosition = GetMousePosition();
+
+#if CGE_POSIX && !CGE_HEADLESS
+		// After the states are kept, so the next frame compares against them.
+		PosixTerminal::PollInput();
+#endif
 	}
 
 	static unsigned char     KeyCodes  [ 99 ];
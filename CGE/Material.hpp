@@ -112,6 +112,8 @@ private:
 
 	friend class Serialization;
 	friend class Material;
+	friend class MaterialPropertyBlock;
+	friend class RenderPipeline;
 
 	template < typename T >
 	void SetImpl( const T* a_Values, size_t a_Count )
@@ -283,6 +285,7 @@ public:
 		, m_Resource{}
 		, m_Handle( 0 )
 		, m_Location( -1 )
+		, m_Unit( 0 )
 	{ }
 
 	const Name& GetName() const
@@ -299,6 +302,7 @@ private:
 
 	friend class Serialization;
 	friend class Material;
+	friend class MaterialPropertyBlock;
 
 	template < typename T >
 	void Serialize( T& a_Serializer ) const
@@ -322,14 +326,25 @@ private:
 	ResourceHandle< Texture2D > m_Resource;
 	TextureHandle               m_Handle;
 	int32_t                     m_Location;
+	uint32_t                    m_Unit; // The texture unit the material last bound it to.
 };
 
 class Material : public Resource
 {
 public:
 
+	enum class BlendMode : uint8_t
+	{
+		Opaque,
+		AlphaBlend,
+		Additive,
+		Premultiplied
+	};
+
 	Material()
 		: m_Shader( &Shader::Default )
+		, m_BlendMode( BlendMode::Opaque )
+		, m_Revision( 0 )
 	{}
 
 	template < typename T >
@@ -338,6 +353,7 @@ public:
 		auto& NewProperty = m_Attributes[ a_Key.HashCode() ];
 		NewProperty.SetName( a_Key );
 		NewProperty.Set( a_Value );
+		++m_Revision;
 
 		if ( !m_Shader->GetProgramHandle() )
 		{
@@ -369,6 +385,7 @@ public:
 		if ( Iter != m_Attributes.end() )
 		{
 			Iter->second.Set( a_Value );
+			++m_Revision;
 			return true;
 		}
 
@@ -382,6 +399,7 @@ public:
 		if ( Iter != m_Attributes.end() )
 		{
 			m_Attributes.erase( Iter );
+			++m_Revision;
 			return true;
 		}
 
@@ -398,6 +416,7 @@ public:
 		auto& NewProperty = m_Textures[ a_Key ];
 		NewProperty.m_Name = a_Key;
 		NewProperty.m_Resource = a_Texture;
+		++m_Revision;
 
 		if ( !m_Shader->GetProgramHandle() )
 		{
@@ -407,7 +426,7 @@ public:
 		NewProperty.m_Location = Rendering::GetUniformLocation( m_Shader->GetProgramHandle(), a_Key.Data() );
 	}
 
-	ResourceHandle< Texture2D > GetTexture( Hash a_Key )
+	ResourceHandle< Texture2D > GetTexture( Hash a_Key ) const
 	{
 		auto Iter = m_Textures.find( a_Key );
 		return Iter != m_Textures.end() ? Iter->second.m_Resource : ResourceHandle< Texture2D >{};
@@ -420,6 +439,7 @@ public:
 		if ( Iter != m_Textures.end() )
 		{
 			Iter->second.m_Resource = a_Texture;
+			++m_Revision;
 			return true;
 		}
 
@@ -433,13 +453,14 @@ public:
 		if ( Iter != m_Textures.end() )
 		{
 			m_Textures.erase( Iter );
+			++m_Revision;
 			return true;
 		}
 
 		return false;
 	}
 
-	inline bool HasTexture( Hash a_Key )
+	inline bool HasTexture( Hash a_Key ) const
 	{
 		return m_Textures.find( a_Key ) != m_Textures.end();
 	}
@@ -452,6 +473,30 @@ public:
 	void SetShader( const Shader& a_Shader )
 	{
 		m_Shader = &a_Shader;
+		++m_Revision;
+	}
+
+	inline BlendMode GetBlendMode() const
+	{
+		return m_BlendMode;
+	}
+
+	inline void SetBlendMode( BlendMode a_BlendMode )
+	{
+		m_BlendMode = a_BlendMode;
+		++m_Revision;
+	}
+
+	// Bumped by every change that affects how the material draws.
+	inline uint32_t GetRevision() const
+	{
+		return m_Revision;
+	}
+
+	// Transparent materials are drawn after opaque ones, back to front.
+	inline bool IsTransparent() const
+	{
+		return m_BlendMode != BlendMode::Opaque;
 	}
 
 private:
@@ -459,6 +504,7 @@ private:
 	friend class Serialization;
 	friend class ResourcePackager;
 	friend class RenderPipeline;
+	friend class MaterialPropertyBlock;
 
 	// All of the uniform functions really should be delegated to the Shader object.
 	void Apply() const
@@ -467,86 +513,58 @@ private:
 		{
 			const_cast< Shader* >( const_cast< Material* >( this )->m_Shader )->Compile();
 			const_cast< Material* >( this )->FindLocations();
-			Rendering::UseProgram( GetShader().GetProgramHandle() );
 		}
 
-		for ( auto Begin = m_Attributes.begin(), End = m_Attributes.end(); Begin != End; ++Begin )
+		Rendering::UseProgram( GetShader().GetProgramHandle() );
+
+		switch ( m_BlendMode )
 		{
-			if ( Begin->second.m_Location < 0 )
+			case BlendMode::AlphaBlend:
 			{
-				continue;
+				Rendering::Enable( RenderSetting::BLEND );
+				Rendering::BlendFunc( BlendFactor::SRC_ALPHA, BlendFactor::ONE_MINUS_SRC_ALPHA );
+				Rendering::DepthMask( false );
+				break;
+			}
+			case BlendMode::Additive:
+			{
+				Rendering::Enable( RenderSetting::BLEND );
+				Rendering::BlendFunc( BlendFactor::SRC_ALPHA, BlendFactor::ONE );
+				Rendering::DepthMask( false );
+				break;
+			}
+			case BlendMode::Premultiplied:
+			{
+				Rendering::Enable( RenderSetting::BLEND );
+				Rendering::BlendFunc( BlendFactor::ONE, BlendFactor::ONE_MINUS_SRC_ALPHA );
+				Rendering::DepthMask( false );
+				break;
+			}
+			default:
+			{
+				Rendering::Disable( RenderSetting::BLEND );
+				Rendering::DepthMask( true );
+				break;
 			}
+		}
 
-			auto Type = Begin->second.GetType();
+		Rendering::BlendEquation( ::BlendEquation::ADD );
 
-			if ( Type == MaterialProperty::Type::STRING )
+		for ( auto Begin = m_Attributes.begin(), End = m_Attributes.end(); Begin != End; ++Begin )
+		{
+			if ( Begin->second.m_Location < 0 )
 			{
 				continue;
 			}
 
-			switch ( Type )
-			{
-				case MaterialProperty::Type::INT:
-				{
-					switch ( Begin->second.m_Size )
-					{
-						case 1:
-						{
-							Rendering::Uniform1iv( Begin->second.m_Location, Begin->second.m_Size, Begin->second.Get< int32_t >() );
-							break;
-						}
-						case 2:
-						{
-							Rendering::Uniform2iv( Begin->second.m_Location, Begin->second.m_Size, Begin->second.Get< int32_t >() );
-							break;
-						}
-						case 3:
-						{
-							Rendering::Uniform3iv( Begin->second.m_Location, Begin->second.m_Size, Begin->second.Get< int32_t >() );
-							break;
-						}
-						case 4:
-						{
-							Rendering::Uniform4iv( Begin->second.m_Location, Begin->second.m_Size, Begin->second.Get< int32_t >() );
-							break;
-						}
-						default:
-							break;
-					}
-					break;
-				}
-				case MaterialProperty::Type::FLOAT:
-				{
-					switch ( Begin->second.m_Size )
-					{
-						case 1:
-						{
-							Rendering::Uniform1fv( Begin->second.m_Location, Begin->second.m_Size, Begin->second.Get< float >() );
-							break;
-						}
-						case 2:
-						{
-							Rendering::Uniform2fv( Begin->second.m_Location, Begin->second.m_Size, Begin->second.Get< float >() );
-							break;
-						}
-						case 3:
-						{
-							Rendering::Uniform3fv( Begin->second.m_Location, Begin->second.m_Size, Begin->second.Get< float >() );
-							break;
-						}
-						case 4:
-						{
-							Rendering::Uniform4fv( Begin->second.m_Location, Begin->second.m_Size, Begin->second.Get< float >() );
-							break;
-						}
-						default:
-							break;
-					}
-					break;
-				}
-			}
+			Upload( Begin->second.m_Location, Begin->second.GetType(), Begin->second.m_Size, Begin->second.GetType() == MaterialProperty::Type::INT ?
+				static_cast< const void* >( Begin->second.Get< int32_t >() ) :
+				static_cast< const void* >( Begin->second.Get< float >() ) );
 		}
 
+		// One texture unit per sampler, so a material can sample a diffuse texture and a lightmap together.
+		uint32_t Unit = 0;
+
 		for ( auto
 			  Begin = const_cast< Material* >( this )->m_Textures.begin(),
 			  End = const_cast< Material* >( this )->m_Textures.end();
@@ -557,15 +575,54 @@ private:
 				continue;
 			}
 
+			Rendering::ActiveTexture( Unit );
+
 			if ( !Begin->second.m_Handle )
 			{
 				Rendering::GenTextures( 1, &Begin->second.m_Handle );
-				Rendering::ActiveTexture( 0 );
 				Rendering::BindTexture( TextureTarget::TEXTURE_2D, Begin->second.m_Handle );
 				Rendering::TexImage2D( TextureTarget::TEXTURE_2D, 0, TextureFormat( 0 ), Begin->second.m_Resource.Assure()->GetWidth(), Begin->second.m_Resource.Assure()->GetHeight(), 0, TextureFormat( 0 ), TextureSetting( 0 ), Begin->second.m_Resource.Assure()->GetData() );
 			}
+			else
+			{
+				Rendering::BindTexture( TextureTarget::TEXTURE_2D, Begin->second.m_Handle );
+			}
 
-			Rendering::Uniform1i( Begin->second.m_Location, 0 );
+			Begin->second.m_Unit = Unit;
+			Rendering::Uniform1i( Begin->second.m_Location, Unit++ );
+		}
+
+		Rendering::ActiveTexture( 0 );
+	}
+
+	// Sets the uniform at a_Location to a_Size ints or floats, strings and larger sizes aren't uniforms.
+	static void Upload( int32_t a_Location, MaterialProperty::Type a_Type, size_t a_Size, const void* a_Data )
+	{
+		if ( a_Type == MaterialProperty::Type::INT )
+		{
+			const int32_t* Data = static_cast< const int32_t* >( a_Data );
+
+			switch ( a_Size )
+			{
+				case 1: Rendering::Uniform1iv( a_Location, 1, Data ); break;
+				case 2: Rendering::Uniform2iv( a_Location, 1, Data ); break;
+				case 3: Rendering::Uniform3iv( a_Location, 1, Data ); break;
+				case 4: Rendering::Uniform4iv( a_Location, 1, Data ); break;
+				default: break;
+			}
+		}
+		else if ( a_Type == MaterialProperty::Type::FLOAT )
+		{
+			const float* Data = static_cast< const float* >( a_Data );
+
+			switch ( a_Size )
+			{
+				case 1: Rendering::Uniform1fv( a_Location, 1, Data ); break;
+				case 2: Rendering::Uniform2fv( a_Location, 1, Data ); break;
+				case 3: Rendering::Uniform3fv( a_Location, 1, Data ); break;
+				case 4: Rendering::Uniform4fv( a_Location, 1, Data ); break;
+				default: break;
+			}
 		}
 	}
 
@@ -588,24 +645,34 @@ private:
 	void Serialize( _Serializer& a_Serializer ) const
 	{
 		a_Serializer << *static_cast< const Resource* >( this );
-		a_Serializer << m_Attributes << m_Textures;
+		a_Serializer << m_Attributes << m_Textures << m_BlendMode;
+		a_Serializer << GetShader().GetName().HashCode();
 	}
 
+	// Only built in shaders can be referred to by name, anything else falls back to the default.
 	template < typename _Deserializer >
 	void Deserialize( _Deserializer& a_Deserializer )
 	{
+		Hash ShaderName;
 		a_Deserializer >> *static_cast< Resource* >( this );
-		a_Deserializer >> m_Attributes >> m_Textures;
+		a_Deserializer >> m_Attributes >> m_Textures >> m_BlendMode;
+		a_Deserializer >> ShaderName;
+		const Shader* Found = Shader::Find( ShaderName );
+		m_Shader = Found ? Found : &Shader::Default;
+		++m_Revision;
 	}
 
 	template < typename _Sizer >
 	void SizeOf( _Sizer& a_Sizer ) const
 	{
 		a_Sizer&* static_cast< const Resource* >( this );
-		a_Sizer& m_Attributes& m_Textures;
+		a_Sizer& m_Attributes& m_Textures& m_BlendMode;
+		a_Sizer & GetShader().GetName().HashCode();
 	}
 
 	const Shader* m_Shader;
+	BlendMode     m_BlendMode;
+	uint32_t      m_Revision;
 	std::map< Hash, MaterialProperty > m_Attributes;
 	std::map< Hash, TextureProperty  > m_Textures;
 
@@ -0,0 +1,376 @@
+#pragma once
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include "Material.hpp"
+
+// Overrides of a shared material's properties and textures for a single renderer, set over the material for its
+// draw and put back after it. The material isn't copied, so draws still sort and instance by material. Only what
+// the material itself has is overridden, keyed by the same hash as its properties. Override textures are
+// uploaded once however many blocks use them, and freed when the last block lets go.
+class MaterialPropertyBlock
+{
+public:
+
+	MaterialPropertyBlock() = default;
+
+	// Copies take their own references to the uploaded textures when they are first applied.
+	MaterialPropertyBlock( const MaterialPropertyBlock& a_Other )
+		: m_Properties( a_Other.m_Properties )
+		, m_Textures( a_Other.m_Textures )
+		, m_Revision( a_Other.m_Revision )
+	{
+		Forget();
+	}
+
+	MaterialPropertyBlock& operator=( const MaterialPropertyBlock& a_Other )
+	{
+		if ( this != &a_Other )
+		{
+			ReleaseAll();
+			m_Properties = a_Other.m_Properties;
+			m_Textures = a_Other.m_Textures;
+			++m_Revision;
+			Forget();
+		}
+
+		return *this;
+	}
+
+	~MaterialPropertyBlock()
+	{
+		ReleaseAll();
+	}
+
+	inline void SetProperty( Hash a_Key, int32_t a_Value )
+	{
+		Set( a_Key, MaterialProperty::Type::INT, &a_Value, 1 );
+	}
+
+	inline void SetProperty( Hash a_Key, float a_Value )
+	{
+		Set( a_Key, MaterialProperty::Type::FLOAT, &a_Value, 1 );
+	}
+
+	template < size_t S >
+	inline void SetProperty( Hash a_Key, const Vector< int32_t, S >& a_Value )
+	{
+		Set( a_Key, MaterialProperty::Type::INT, &a_Value[ 0 ], S );
+	}
+
+	template < size_t S >
+	inline void SetProperty( Hash a_Key, const Vector< float, S >& a_Value )
+	{
+		Set( a_Key, MaterialProperty::Type::FLOAT, &a_Value[ 0 ], S );
+	}
+
+	// Tints the instancing shaders can take per instance, see IsInstanceable.
+	inline void SetColour( const Vector4& a_Colour )
+	{
+		SetProperty( "diffuse_colour"_N, a_Colour );
+	}
+
+	template < typename T, size_t S >
+	bool GetProperty( Hash a_Key, Vector< T, S >& o_Value ) const
+	{
+		const Property* Found = Find( m_Properties, a_Key );
+
+		if ( !Found )
+		{
+			return false;
+		}
+
+		for ( size_t i = 0; i < S && i < Found->Size; ++i )
+		{
+			o_Value[ i ] = Found->Type == MaterialProperty::Type::INT ? static_cast< T >( Found->Ints[ i ] ) : static_cast< T >( Found->Floats[ i ] );
+		}
+
+		return true;
+	}
+
+	bool RemoveProperty( Hash a_Key )
+	{
+		return Remove( m_Properties, a_Key );
+	}
+
+	inline bool HasProperty( Hash a_Key ) const
+	{
+		return Find( m_Properties, a_Key ) != nullptr;
+	}
+
+	void SetTexture( Hash a_Key, ResourceHandle< Texture2D > a_Texture )
+	{
+		Texture* Found = const_cast< Texture* >( Find( m_Textures, a_Key ) );
+
+		if ( !Found )
+		{
+			Found = &m_Textures.emplace_back();
+			Found->Key = a_Key;
+		}
+
+		Release( *Found );
+		Found->Resource = a_Texture;
+		++m_Revision;
+	}
+
+	bool RemoveTexture( Hash a_Key )
+	{
+		if ( const Texture* Found = Find( m_Textures, a_Key ) )
+		{
+			Release( *const_cast< Texture* >( Found ) );
+		}
+
+		return Remove( m_Textures, a_Key );
+	}
+
+	inline bool HasTexture( Hash a_Key ) const
+	{
+		return Find( m_Textures, a_Key ) != nullptr;
+	}
+
+	void Clear()
+	{
+		ReleaseAll();
+		m_Properties.clear();
+		m_Textures.clear();
+		++m_Revision;
+	}
+
+	inline bool IsEmpty() const
+	{
+		return m_Properties.empty() && m_Textures.empty();
+	}
+
+	// Bumped by every change, so a changed block redraws the area its renderer covers.
+	inline uint32_t GetRevision() const
+	{
+		return m_Revision;
+	}
+
+	// Whether draws with this block can still be instanced, the instanced shaders take a colour per instance
+	// and nothing else.
+	inline bool IsInstanceable() const
+	{
+		return m_Textures.empty() && m_Properties.size() <= 1 && ( m_Properties.empty() || m_Properties.front().Key == "diffuse_colour"_H );
+	}
+
+private:
+
+	friend class RenderPipeline;
+
+	struct Property
+	{
+		Hash                   Key;
+		MaterialProperty::Type Type;
+		uint32_t               Size;
+
+		union
+		{
+			int32_t Ints[ 4 ];
+			float   Floats[ 4 ];
+		};
+	};
+
+	struct Texture
+	{
+		Hash                        Key;
+		ResourceHandle< Texture2D > Resource;
+		TextureHandle               Handle = 0;         // Held in s_Uploads, zero until first applied.
+		const Texture2D*            Uploaded = nullptr;
+	};
+
+	struct Upload
+	{
+		TextureHandle Handle;
+		uint32_t      Users;
+	};
+
+	// The handle a_Source is uploaded to, uploading it for the first user. Zero when the texture registry is full.
+	static TextureHandle Acquire( const Texture2D* a_Source )
+	{
+		auto Where = s_Uploads.find( a_Source );
+
+		if ( Where != s_Uploads.end() )
+		{
+			++Where->second.Users;
+			return Where->second.Handle;
+		}
+
+		TextureHandle Handle = 0;
+		Rendering::GenTextures( 1, &Handle );
+
+		if ( !Handle )
+		{
+			return 0;
+		}
+
+		Rendering::BindTexture( TextureTarget::TEXTURE_2D, Handle );
+		Rendering::TexImage2D( TextureTarget::TEXTURE_2D, 0, TextureFormat( 0 ), a_Source->GetWidth(), a_Source->GetHeight(), 0, TextureFormat( 0 ), TextureSetting( 0 ), a_Source->GetData() );
+		s_Uploads.emplace( a_Source, Upload{ Handle, 1 } );
+		return Handle;
+	}
+
+	static void Release( Texture& io_Entry )
+	{
+		auto Where = io_Entry.Handle ? s_Uploads.find( io_Entry.Uploaded ) : s_Uploads.end();
+
+		if ( Where != s_Uploads.end() && --Where->second.Users == 0 )
+		{
+			Rendering::DeleteTextures( 1, &Where->second.Handle );
+			s_Uploads.erase( Where );
+		}
+
+		io_Entry.Handle = 0;
+		io_Entry.Uploaded = nullptr;
+	}
+
+	void ReleaseAll()
+	{
+		for ( auto& Entry : m_Textures )
+		{
+			Release( Entry );
+		}
+	}
+
+	// Drops copied handles without releasing them, they belong to the block copied from.
+	void Forget()
+	{
+		for ( auto& Entry : m_Textures )
+		{
+			Entry.Handle = 0;
+			Entry.Uploaded = nullptr;
+		}
+	}
+
+	template < typename T >
+	void Set( Hash a_Key, MaterialProperty::Type a_Type, const T* a_Values, uint32_t a_Size )
+	{
+		Property* Found = const_cast< Property* >( Find( m_Properties, a_Key ) );
+
+		if ( !Found )
+		{
+			Found = &m_Properties.emplace_back();
+			Found->Key = a_Key;
+		}
+
+		Found->Type = a_Type;
+		Found->Size = Math::Min( a_Size, 4u );
+		std::memcpy( Found->Ints, a_Values, sizeof( T ) * Found->Size );
+		++m_Revision;
+	}
+
+	template < typename T >
+	inline static const T* Find( const std::vector< T >& a_Entries, Hash a_Key )
+	{
+		auto Where = std::find_if( a_Entries.begin(), a_Entries.end(), [ & ]( const T& a_Entry ) { return a_Entry.Key == a_Key; } );
+		return Where != a_Entries.end() ? &*Where : nullptr;
+	}
+
+	template < typename T >
+	bool Remove( std::vector< T >& io_Entries, Hash a_Key )
+	{
+		auto Where = std::find_if( io_Entries.begin(), io_Entries.end(), [ & ]( const T& a_Entry ) { return a_Entry.Key == a_Key; } );
+
+		if ( Where == io_Entries.end() )
+		{
+			return false;
+		}
+
+		io_Entries.erase( Where );
+		++m_Revision;
+		return true;
+	}
+
+	// Sets the overridden uniforms and textures of a_Material, which has to be the one applied last.
+	void Apply( const Material& a_Material ) const
+	{
+		for ( const auto& Entry : m_Properties )
+		{
+			auto Where = a_Material.m_Attributes.find( Entry.Key );
+
+			if ( Where != a_Material.m_Attributes.end() && Where->second.m_Location >= 0 )
+			{
+				Material::Upload( Where->second.m_Location, Entry.Type, Entry.Size, Entry.Ints );
+			}
+		}
+
+		for ( const auto& Entry : m_Textures )
+		{
+			auto Where = a_Material.m_Textures.find( Entry.Key );
+			const Texture2D* Source = Entry.Resource.Assure();
+
+			if ( Where == a_Material.m_Textures.end() || Where->second.m_Location < 0 || !Source )
+			{
+				continue;
+			}
+
+			Rendering::ActiveTexture( Where->second.m_Unit );
+
+			// The material's own texture is already uploaded.
+			if ( Where->second.m_Handle && Where->second.m_Resource.Assure() == Source )
+			{
+				Rendering::BindTexture( TextureTarget::TEXTURE_2D, Where->second.m_Handle );
+				continue;
+			}
+
+			Texture& Mutable = const_cast< Texture& >( Entry );
+
+			// The resource may have been swapped for another since it was uploaded.
+			if ( Mutable.Handle && Mutable.Uploaded != Source )
+			{
+				Release( Mutable );
+			}
+
+			if ( !Mutable.Handle )
+			{
+				Mutable.Handle = Acquire( Source );
+				Mutable.Uploaded = Mutable.Handle ? Source : nullptr;
+			}
+
+			// Without a free texture slot the material's texture stays bound.
+			if ( Mutable.Handle )
+			{
+				Rendering::BindTexture( TextureTarget::TEXTURE_2D, Mutable.Handle );
+			}
+		}
+
+		Rendering::ActiveTexture( 0 );
+	}
+
+	// Puts back what Apply overrode.
+	void Restore( const Material& a_Material ) const
+	{
+		for ( const auto& Entry : m_Properties )
+		{
+			auto Where = a_Material.m_Attributes.find( Entry.Key );
+
+			if ( Where != a_Material.m_Attributes.end() && Where->second.m_Location >= 0 )
+			{
+				const MaterialProperty& Source = Where->second;
+				Material::Upload( Source.m_Location, Source.GetType(), Source.m_Size, Source.GetType() == MaterialProperty::Type::INT ?
+					static_cast< const void* >( Source.Get< int32_t >() ) :
+					static_cast< const void* >( Source.Get< float >() ) );
+			}
+		}
+
+		for ( const auto& Entry : m_Textures )
+		{
+			auto Where = a_Material.m_Textures.find( Entry.Key );
+
+			if ( Where != a_Material.m_Textures.end() && Where->second.m_Location >= 0 && Where->second.m_Handle )
+			{
+				Rendering::ActiveTexture( Where->second.m_Unit );
+				Rendering::BindTexture( TextureTarget::TEXTURE_2D, Where->second.m_Handle );
+			}
+		}
+
+		Rendering::ActiveTexture( 0 );
+	}
+
+	std::vector< Property > m_Properties;
+	std::vector< Texture  > m_Textures;
+	uint32_t                m_Revision = 0;
+
+	inline static std::unordered_map< const Texture2D*, Upload > s_Uploads;
+};
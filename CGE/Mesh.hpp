@@ -13,6 +13,7 @@ public:
 		: m_Outermost( size_t( -1 ) )
 		, m_ActiveColourChannel( 0 )
 		, m_ActiveTexelChannel( 0 )
+		, m_Revision( 0 )
 	{ }
 
 	void GetVertex( size_t a_Index, Vertex& o_Vertex ) const
@@ -130,6 +131,97 @@ public:
 		return !m_Texels[ a_Channel ].empty();
 	}
 
+	// Up to four skeleton bones per vertex and their weights, which sum to one.
+	inline const Vector4Int* GetBoneIndices() const
+	{
+		return m_BoneIndices.data();
+	}
+
+	inline const Vector4* GetBoneWeights() const
+	{
+		return m_BoneWeights.data();
+	}
+
+	inline bool HasBones() const
+	{
+		return !m_BoneWeights.empty();
+	}
+
+	// Anything that writes a mesh's streams in place calls this after each change, or draws keep using the
+	// vertices the vertex cache holds for the old contents. Draws are compared by revision too, since a
+	// mesh's addresses never change.
+	inline void MarkModified()
+	{
+		++m_Revision;
+		m_Outermost = uint32_t( -1 );
+	}
+
+	inline uint32_t GetRevision() const
+	{
+		return m_Revision;
+	}
+
+	inline bool IsDynamic() const
+	{
+		return m_Revision != 0;
+	}
+
+	// Appends a_Mesh transformed by a_Transform. Streams missing on either side are zero filled.
+	void Append( const Mesh& a_Mesh, const Matrix4& a_Transform )
+	{
+		uint32_t BaseVertex = GetVertexCount();
+		uint32_t AddedVertices = a_Mesh.GetVertexCount();
+
+		auto AppendStream = [ & ]( auto& o_Target, const auto& a_Source, auto a_Convert )
+		{
+			if ( a_Source.empty() && o_Target.empty() )
+			{
+				return;
+			}
+
+			o_Target.resize( BaseVertex );
+
+			if ( a_Source.empty() )
+			{
+				o_Target.resize( BaseVertex + AddedVertices );
+				return;
+			}
+
+			for ( const auto& Value : a_Source )
+			{
+				o_Target.push_back( a_Convert( Value ) );
+			}
+		};
+
+		auto TransformPoint = [ & ]( const Vector3& a_Point ) { return Vector3( Math::Multiply( a_Transform, Vector4( a_Point, 1.0f ) ) ); };
+		auto TransformDirection = [ & ]( const Vector3& a_Direction ) { return Math::Normalize( Vector3( Math::Multiply( a_Transform, Vector4( a_Direction, 0.0f ) ) ) ); };
+		auto Copy = []( const auto& a_Value ) { return a_Value; };
+
+		AppendStream( m_Normals, a_Mesh.m_Normals, TransformDirection );
+		AppendStream( m_Tangents, a_Mesh.m_Tangents, TransformDirection );
+		AppendStream( m_Bitangents, a_Mesh.m_Bitangents, TransformDirection );
+		AppendStream( m_BoneIndices, a_Mesh.m_BoneIndices, Copy );
+		AppendStream( m_BoneWeights, a_Mesh.m_BoneWeights, Copy );
+
+		for ( uint32_t i = 0; i < 8; ++i )
+		{
+			AppendStream( m_Texels[ i ], a_Mesh.m_Texels[ i ], Copy );
+			AppendStream( m_Colours[ i ], a_Mesh.m_Colours[ i ], Copy );
+		}
+
+		// Positions last, every other stream sizes itself from the old vertex count.
+		AppendStream( m_Positions, a_Mesh.m_Positions, TransformPoint );
+
+		m_Indices.reserve( m_Indices.size() + a_Mesh.m_Indices.size() );
+
+		for ( uint32_t Index : a_Mesh.m_Indices )
+		{
+			m_Indices.push_back( BaseVertex + Index );
+		}
+
+		m_Outermost = uint32_t( -1 );
+	}
+
 //private:
 
 	friend class ResourcePackager;
@@ -146,6 +238,8 @@ public:
 		a_Serializer << m_Tangents;
 		a_Serializer << m_Bitangents;
 		a_Serializer << m_Texels;
+		a_Serializer << m_BoneIndices;
+		a_Serializer << m_BoneWeights;
 	}
 
 	template < typename _Deserializer >
@@ -159,6 +253,8 @@ public:
 		a_Deserializer >> m_Tangents;
 		a_Deserializer >> m_Bitangents;
 		a_Deserializer >> m_Texels;
+		a_Deserializer >> m_BoneIndices;
+		a_Deserializer >> m_BoneWeights;
 	}
 
 	template < typename _Sizer >
@@ -172,6 +268,8 @@ public:
 		a_Sizer & m_Tangents;
 		a_Sizer & m_Bitangents;
 		a_Sizer & m_Texels;
+		a_Sizer & m_BoneIndices;
+		a_Sizer & m_BoneWeights;
 	}
 
 	std::vector< uint32_t >                 m_Indices;
@@ -181,7 +279,10 @@ public:
 	std::vector< Vector3  >                 m_Bitangents;
 	std::array< std::vector< Vector2 >, 8 > m_Texels;
 	std::array< std::vector< Vector4 >, 8 > m_Colours;
+	std::vector< Vector4Int >               m_BoneIndices;
+	std::vector< Vector4  >                 m_BoneWeights;
 	uint32_t                                m_Outermost;
 	uint32_t                                m_ActiveColourChannel;
 	uint32_t                                m_ActiveTexelChannel;
+	uint32_t                                m_Revision;
 };
\ No newline at end of file
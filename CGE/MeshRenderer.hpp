@@ -2,6 +2,7 @@
 #include "Renderer.hpp"
 #include "Mesh.hpp"
 #include "Material.hpp"
+#include "MaterialPropertyBlock.hpp"
 #include "Transform.hpp"
 #include "Material.hpp"
 #include "Rendering.hpp"
@@ -20,7 +21,8 @@ public:
 
 	void OnRender( RenderQueue & a_Queue ) const override
 	{
-		if ( !Camera::GetMainCamera() )
+		// Static batches are drawn by the pipeline.
+		if ( m_IsBatched )
 		{
 			return;
 		}
@@ -30,30 +32,6 @@ public:
 			return;
 		}
 
-		Frustum ViewFrustum = *Camera::GetMainCamera();
-		float Radius = m_Mesh->GetRadius();
-		bool Collided = false;
-
-		// Perform broadphase frustum culling.
-
-		// THIS IS NOT WORKING, IT NEVER REJECTS.
-		for ( const auto& FrustumPlane : ViewFrustum.Planes )
-		{
-			float dist = Geometry::DistanceFromPlane( FrustumPlane, this->GetOwner().GetTransform()->GetGlobalPosition() );
-
-			if ( dist > -Radius )
-			{
-				Collided = true;
-				break;
-			}
-		}
-
-		// THIS NEVER GETS HIT FOR SOME REASON, INVESTIGATE FURTHER.
-		if ( !Collided )
-		{
-			return;
-		}
-
 		RenderInstruction Instruction;
 		Instruction.Modification = RenderInstruction::Modification::SET;
 		Instruction.Object = RenderInstruction::Object::Mesh;
@@ -70,6 +48,21 @@ public:
 		Instruction.ResourceSource = &this->GetOwner().GetTransform()->GetGlobalMatrix();
 		a_Queue += Instruction;
 
+		// Frustum culling and layer masks are applied per camera by the pipeline.
+		Instruction.Modification = RenderInstruction::Modification::SET;
+		Instruction.Object = RenderInstruction::Object::Layer;
+		Instruction.Index = this->m_Layer;
+		a_Queue += Instruction;
+
+		// Like layers, a property block only applies to the draw it precedes.
+		if ( !m_PropertyBlock.IsEmpty() )
+		{
+			Instruction.Modification = RenderInstruction::Modification::SET;
+			Instruction.Object = RenderInstruction::Object::PropertyBlock;
+			Instruction.ResourceSource = &m_PropertyBlock;
+			a_Queue += Instruction;
+		}
+
 		Instruction.Modification = RenderInstruction::Modification::DRAW;
 		Instruction.Object = RenderInstruction::Object::None;
 		Instruction.ResourceSource = nullptr;
@@ -96,29 +89,49 @@ public:
 		m_Material = a_Material;
 	}
 
+	// Overrides of the shared material for this renderer alone. Static renderers with overrides aren't batched,
+	// which is decided when the batches are built.
+	MaterialPropertyBlock& GetPropertyBlock()
+	{
+		return m_PropertyBlock;
+	}
+
+	const MaterialPropertyBlock& GetPropertyBlock() const
+	{
+		return m_PropertyBlock;
+	}
+
+	void SetPropertyBlock( const MaterialPropertyBlock& a_PropertyBlock )
+	{
+		m_PropertyBlock = a_PropertyBlock;
+	}
+
 private:
 
 	friend class ResourcePackager;
 	friend class Serialization;
+	friend class StaticBatching;
 
 	template < typename _Serializer >
 	void Serialize( _Serializer & a_Serializer ) const
 	{
-		a_Serializer << m_Mesh << m_Material;
+		a_Serializer << m_Mesh << m_Material << this->m_Layer;
 	}
 
 	template < typename _Deserializer >
 	void Deserialize( _Deserializer & a_Deserializer )
 	{
-		a_Deserializer >> m_Mesh >> m_Material;
+		a_Deserializer >> m_Mesh >> m_Material >> this->m_Layer;
 	}
 
 	template < typename _Sizer >
 	void SizeOf( _Sizer & a_Sizer ) const
 	{
-		a_Sizer& m_Mesh& m_Material;
+		a_Sizer& m_Mesh& m_Material& this->m_Layer;
 	}
 
 	ResourceHandle< Mesh     > m_Mesh;
 	ResourceHandle< Material > m_Material;
+	MaterialPropertyBlock      m_PropertyBlock;
+	bool                       m_IsBatched = false;
 };
\ No newline at end of file
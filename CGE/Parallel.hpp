@@ -0,0 +1,184 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include "Math.hpp"
+
+// A fixed pool of worker threads for data parallel loops. A loop is split into contiguous chunks
+// which the workers and the calling thread take in turn until none are left.
+class Parallel
+{
+public:
+
+	// Calls a_Function( Begin, End ) over [ a_Begin, a_End ) in chunks of at least a_MinimumChunk and returns
+	// once every chunk has run. Loops started from inside a chunk run serially on that thread.
+	template < typename _Function >
+	static void For( int32_t a_Begin, int32_t a_End, const _Function& a_Function, int32_t a_MinimumChunk = 1 )
+	{
+		int32_t Count = a_End - a_Begin;
+
+		if ( Count <= 0 )
+		{
+			return;
+		}
+
+		Pool& Workers = GetPool();
+		int32_t Threads = static_cast< int32_t >( Workers.Threads.size() ) + 1;
+
+		// A few chunks per thread evens out rows that cost more than others.
+		int32_t ChunkSize = Math::Max( Math::Max( a_MinimumChunk, 1 ), ( Count + Threads * 4 - 1 ) / ( Threads * 4 ) );
+		int32_t ChunkCount = ( Count + ChunkSize - 1 ) / ChunkSize;
+
+		if ( ChunkCount <= 1 || Workers.Threads.empty() || s_InsideLoop )
+		{
+			a_Function( a_Begin, a_End );
+			return;
+		}
+
+		std::lock_guard< std::mutex > Submit( Workers.SubmitMutex );
+
+		Job Current;
+		Current.Context = &a_Function;
+		Current.Invoke = []( const void* a_Context, int32_t a_ChunkBegin, int32_t a_ChunkEnd )
+		{
+			( *static_cast< const _Function* >( a_Context ) )( a_ChunkBegin, a_ChunkEnd );
+		};
+		Current.Begin = a_Begin;
+		Current.End = a_End;
+		Current.ChunkSize = ChunkSize;
+		Current.ChunkCount = ChunkCount;
+		Current.NextChunk = 0;
+		Current.Remaining = ChunkCount;
+
+		{
+			std::lock_guard< std::mutex > Lock( Workers.Mutex );
+			Workers.Current = &Current;
+			++Workers.Generation;
+		}
+
+		Workers.Wake.notify_all();
+
+		s_InsideLoop = true;
+		RunChunks( Current );
+		s_InsideLoop = false;
+
+		// The job lives on this stack, so wait for every worker that picked it up to let go of it.
+		std::unique_lock< std::mutex > Lock( Workers.Mutex );
+		Workers.Done.wait( Lock, [ & ]() { return Current.Remaining.load() == 0 && Workers.Active == 0; } );
+		Workers.Current = nullptr;
+	}
+
+	inline static uint32_t GetWorkerCount()
+	{
+		return static_cast< uint32_t >( GetPool().Threads.size() );
+	}
+
+private:
+
+	struct Job
+	{
+		const void*            Context;
+		void                 ( *Invoke )( const void*, int32_t, int32_t );
+		int32_t                Begin;
+		int32_t                End;
+		int32_t                ChunkSize;
+		int32_t                ChunkCount;
+		std::atomic< int32_t > NextChunk;
+		std::atomic< int32_t > Remaining;
+	};
+
+	struct Pool
+	{
+		Pool()
+		{
+			uint32_t Count = Math::Max( std::thread::hardware_concurrency(), 1u ) - 1;
+
+			for ( uint32_t i = 0; i < Count; ++i )
+			{
+				Threads.emplace_back( Work, std::ref( *this ) );
+			}
+		}
+
+		~Pool()
+		{
+			{
+				std::lock_guard< std::mutex > Lock( Mutex );
+				Stop = true;
+			}
+
+			Wake.notify_all();
+
+			for ( auto& Thread : Threads )
+			{
+				Thread.join();
+			}
+		}
+
+		std::vector< std::thread > Threads;
+		std::mutex                 SubmitMutex;
+		std::mutex                 Mutex;
+		std::condition_variable    Wake;
+		std::condition_variable    Done;
+		Job*                       Current = nullptr;
+		uint64_t                   Generation = 0;
+		uint32_t                   Active = 0;
+		bool                       Stop = false;
+	};
+
+	static Pool& GetPool()
+	{
+		static Pool Instance;
+		return Instance;
+	}
+
+	static void RunChunks( Job& a_Job )
+	{
+		for ( int32_t Chunk = a_Job.NextChunk++; Chunk < a_Job.ChunkCount; Chunk = a_Job.NextChunk++ )
+		{
+			int32_t ChunkBegin = a_Job.Begin + Chunk * a_Job.ChunkSize;
+			int32_t ChunkEnd = Math::Min( ChunkBegin + a_Job.ChunkSize, a_Job.End );
+			a_Job.Invoke( a_Job.Context, ChunkBegin, ChunkEnd );
+			--a_Job.Remaining;
+		}
+	}
+
+	static void Work( Pool& a_Pool )
+	{
+		s_InsideLoop = true;
+		uint64_t Seen = 0;
+
+		while ( true )
+		{
+			std::unique_lock< std::mutex > Lock( a_Pool.Mutex );
+			a_Pool.Wake.wait( Lock, [ & ]() { return a_Pool.Stop || a_Pool.Generation != Seen; } );
+
+			if ( a_Pool.Stop )
+			{
+				return;
+			}
+
+			Seen = a_Pool.Generation;
+			Job* Current = a_Pool.Current;
+
+			// Woken too late, the caller already finished the job.
+			if ( !Current )
+			{
+				continue;
+			}
+
+			++a_Pool.Active;
+			Lock.unlock();
+
+			RunChunks( *Current );
+
+			Lock.lock();
+			--a_Pool.Active;
+			Lock.unlock();
+			a_Pool.Done.notify_all();
+		}
+	}
+
+	inline static thread_local bool s_InsideLoop = false;
+};
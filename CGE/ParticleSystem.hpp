@@ -0,0 +1,483 @@
+#pragma once
+#include <vector>
+#include <limits>
+#if defined( _M_X64 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+#include "Renderer.hpp"
+#include "Mesh.hpp"
+#include "Material.hpp"
+#include "Shader.hpp"
+#include "Transform.hpp"
+#include "Camera.hpp"
+#include "Parallel.hpp"
+#include "Time.hpp"
+
+// An emitter of many short lived particles, simulated without any per particle objects. Particles live in world
+// space in one array per attribute and are advanced four at a time across the worker threads. Every emitter is
+// drawn as a single mesh of points or quads facing the main camera, rebuilt each frame.
+DefineComponent( ParticleSystem, Renderer )
+{
+public:
+
+	enum class Shape : uint8_t
+	{
+		Points,
+		Quads
+	};
+
+	void OnRender( RenderQueue& a_Queue ) const override
+	{
+		auto* Mutable = const_cast< ParticleSystem* >( this );
+		Mutable->Simulate( Time::GetDeltaTime() );
+
+		if ( m_Count == 0 )
+		{
+			return;
+		}
+
+		Mutable->BuildMesh();
+		const Material* Source = m_Material.Assure() ? m_Material.Get() : &GetDefaultMaterial();
+
+		RenderInstruction Instruction;
+		Instruction.Modification = RenderInstruction::Modification::SET;
+		Instruction.Object = RenderInstruction::Object::Mesh;
+		Instruction.ResourceSource = &m_Mesh;
+		a_Queue += Instruction;
+
+		Instruction.Modification = RenderInstruction::Modification::SET;
+		Instruction.Object = RenderInstruction::Object::Material;
+		Instruction.ResourceSource = Source;
+		a_Queue += Instruction;
+
+		Instruction.Modification = RenderInstruction::Modification::SET;
+		Instruction.Object = RenderInstruction::Object::Model;
+		Instruction.ResourceSource = &m_Model;
+		a_Queue += Instruction;
+
+		Instruction.Modification = RenderInstruction::Modification::SET;
+		Instruction.Object = RenderInstruction::Object::Layer;
+		Instruction.Index = this->m_Layer;
+		a_Queue += Instruction;
+
+		if ( m_Shape == Shape::Points )
+		{
+			Instruction.Modification = RenderInstruction::Modification::SET;
+			Instruction.Object = RenderInstruction::Object::RenderMode;
+			Instruction.Index = static_cast< uint32_t >( RenderMode::POINT );
+			a_Queue += Instruction;
+		}
+
+		Instruction.Modification = RenderInstruction::Modification::DRAW;
+		Instruction.Object = RenderInstruction::Object::None;
+		Instruction.ResourceSource = nullptr;
+		a_Queue += Instruction;
+	}
+
+	// Spawns a_Count particles at once, for bursts like explosions.
+	void Emit( uint32_t a_Count )
+	{
+		a_Count = Math::Min( a_Count, m_MaxParticles - Math::Min( m_Count, m_MaxParticles ) );
+		Reserve( m_Count + a_Count );
+
+		const Matrix4& Global = this->GetOwner()->GetTransform()->GetGlobalMatrix();
+		Vector4 Direction = Math::Multiply( Global, Vector4( m_Direction.x, m_Direction.y, m_Direction.z, 0.0f ) );
+		Vector3 Forward = Math::Normalize( Vector3( Direction.x, Direction.y, Direction.z ) );
+
+		for ( uint32_t i = 0; i < a_Count; ++i, ++m_Count )
+		{
+			Vector4 Position = Math::Multiply( Global, Vector4(
+				( Random() - 0.5f ) * m_EmitterSize.x,
+				( Random() - 0.5f ) * m_EmitterSize.y,
+				( Random() - 0.5f ) * m_EmitterSize.z,
+				1.0f ) );
+
+			Vector3 Velocity = Math::Normalize( Forward + ( RandomDirection() - Forward ) * m_Spread );
+			Velocity = Velocity * ( m_SpeedRange.x + ( m_SpeedRange.y - m_SpeedRange.x ) * Random() );
+
+			m_PositionX[ m_Count ] = Position.x;
+			m_PositionY[ m_Count ] = Position.y;
+			m_PositionZ[ m_Count ] = Position.z;
+			m_VelocityX[ m_Count ] = Velocity.x;
+			m_VelocityY[ m_Count ] = Velocity.y;
+			m_VelocityZ[ m_Count ] = Velocity.z;
+			m_Age      [ m_Count ] = 0.0f;
+			m_Lifetime [ m_Count ] = m_LifetimeRange.x + ( m_LifetimeRange.y - m_LifetimeRange.x ) * Random();
+		}
+	}
+
+	// Removes every live particle.
+	inline void Clear()
+	{
+		m_Count = 0;
+		m_Pending = 0.0f;
+	}
+
+	inline uint32_t GetParticleCount() const
+	{
+		return m_Count;
+	}
+
+	inline bool IsEmitting() const
+	{
+		return m_Emitting;
+	}
+
+	// Continuous emission, bursts from Emit are spawned either way.
+	inline void SetEmitting( bool a_Emitting )
+	{
+		m_Emitting = a_Emitting;
+	}
+
+	Material* GetMaterial()
+	{
+		return m_Material.Assure();
+	}
+
+	// Without a material particles draw their vertex colours, alpha blended.
+	void SetMaterial( ResourceHandle< Material > a_Material )
+	{
+		m_Material = a_Material;
+	}
+
+	inline Shape GetShape() const
+	{
+		return m_Shape;
+	}
+
+	inline void SetShape( Shape a_Shape )
+	{
+		m_Shape = a_Shape;
+		m_Mesh.m_Indices.clear();
+	}
+
+	inline uint32_t GetMaxParticles() const
+	{
+		return m_MaxParticles;
+	}
+
+	inline void SetMaxParticles( uint32_t a_MaxParticles )
+	{
+		m_MaxParticles = a_MaxParticles;
+		m_Count = Math::Min( m_Count, m_MaxParticles );
+	}
+
+	// Particles spawned per second while emitting.
+	inline float GetEmissionRate() const
+	{
+		return m_EmissionRate;
+	}
+
+	inline void SetEmissionRate( float a_Rate )
+	{
+		m_EmissionRate = Math::Max( a_Rate, 0.0f );
+	}
+
+	// Seconds a particle lives, picked between the two at random.
+	inline void SetLifetime( float a_Minimum, float a_Maximum )
+	{
+		m_LifetimeRange = { Math::Max( a_Minimum, 0.001f ), Math::Max( a_Maximum, a_Minimum ) };
+	}
+
+	inline void SetSpeed( float a_Minimum, float a_Maximum )
+	{
+		m_SpeedRange = { a_Minimum, Math::Max( a_Maximum, a_Minimum ) };
+	}
+
+	// Local direction particles leave the emitter in. A spread of 0 keeps them on it, 1 sends them anywhere.
+	inline void SetDirection( const Vector3& a_Direction, float a_Spread )
+	{
+		m_Direction = a_Direction;
+		m_Spread = Math::Clamp( a_Spread, 0.0f, 1.0f );
+	}
+
+	// Local box particles spawn in, centred on the emitter.
+	inline void SetEmitterSize( const Vector3& a_Size )
+	{
+		m_EmitterSize = a_Size;
+	}
+
+	// World space acceleration.
+	inline void SetGravity( const Vector3& a_Gravity )
+	{
+		m_Gravity = a_Gravity;
+	}
+
+	// Fraction of velocity lost per second.
+	inline void SetDrag( float a_Drag )
+	{
+		m_Drag = Math::Max( a_Drag, 0.0f );
+	}
+
+	// Colour and world size at birth and at death, blended linearly over each particle's life.
+	inline void SetColour( const Vector4& a_Start, const Vector4& a_End )
+	{
+		m_StartColour = a_Start;
+		m_EndColour = a_End;
+	}
+
+	inline void SetSize( float a_Start, float a_End )
+	{
+		m_StartSize = a_Start;
+		m_EndSize = a_End;
+	}
+
+private:
+
+	// Spawns, ages, accelerates and moves every particle, then removes the dead ones.
+	void Simulate( float a_DeltaTime )
+	{
+		if ( m_Emitting )
+		{
+			m_Pending += m_EmissionRate * a_DeltaTime;
+			uint32_t Spawned = static_cast< uint32_t >( m_Pending );
+			m_Pending -= Spawned;
+			Emit( Spawned );
+		}
+
+		// Whole groups of four, the tail of the last group is padding nobody reads.
+		int32_t Groups = static_cast< int32_t >( ( m_Count + 3 ) / 4 );
+		float Damping = Math::Max( 1.0f - m_Drag * a_DeltaTime, 0.0f );
+
+		Parallel::For( 0, Groups, [ & ]( int32_t a_Begin, int32_t a_End )
+		{
+#if defined( _M_X64 ) || defined( __SSE2__ )
+			__m128 Delta = _mm_set1_ps( a_DeltaTime );
+			__m128 Damp = _mm_set1_ps( Damping );
+			__m128 GravityX = _mm_set1_ps( m_Gravity.x * a_DeltaTime );
+			__m128 GravityY = _mm_set1_ps( m_Gravity.y * a_DeltaTime );
+			__m128 GravityZ = _mm_set1_ps( m_Gravity.z * a_DeltaTime );
+
+			for ( int32_t i = a_Begin * 4; i < a_End * 4; i += 4 )
+			{
+				__m128 VelocityX = _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( &m_VelocityX[ i ] ), GravityX ), Damp );
+				__m128 VelocityY = _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( &m_VelocityY[ i ] ), GravityY ), Damp );
+				__m128 VelocityZ = _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( &m_VelocityZ[ i ] ), GravityZ ), Damp );
+				_mm_storeu_ps( &m_VelocityX[ i ], VelocityX );
+				_mm_storeu_ps( &m_VelocityY[ i ], VelocityY );
+				_mm_storeu_ps( &m_VelocityZ[ i ], VelocityZ );
+				_mm_storeu_ps( &m_PositionX[ i ], _mm_add_ps( _mm_loadu_ps( &m_PositionX[ i ] ), _mm_mul_ps( VelocityX, Delta ) ) );
+				_mm_storeu_ps( &m_PositionY[ i ], _mm_add_ps( _mm_loadu_ps( &m_PositionY[ i ] ), _mm_mul_ps( VelocityY, Delta ) ) );
+				_mm_storeu_ps( &m_PositionZ[ i ], _mm_add_ps( _mm_loadu_ps( &m_PositionZ[ i ] ), _mm_mul_ps( VelocityZ, Delta ) ) );
+				_mm_storeu_ps( &m_Age[ i ], _mm_add_ps( _mm_loadu_ps( &m_Age[ i ] ), Delta ) );
+			}
+#else
+			for ( int32_t i = a_Begin * 4; i < a_End * 4; ++i )
+			{
+				m_VelocityX[ i ] = ( m_VelocityX[ i ] + m_Gravity.x * a_DeltaTime ) * Damping;
+				m_VelocityY[ i ] = ( m_VelocityY[ i ] + m_Gravity.y * a_DeltaTime ) * Damping;
+				m_VelocityZ[ i ] = ( m_VelocityZ[ i ] + m_Gravity.z * a_DeltaTime ) * Damping;
+				m_PositionX[ i ] += m_VelocityX[ i ] * a_DeltaTime;
+				m_PositionY[ i ] += m_VelocityY[ i ] * a_DeltaTime;
+				m_PositionZ[ i ] += m_VelocityZ[ i ] * a_DeltaTime;
+				m_Age[ i ] += a_DeltaTime;
+			}
+#endif
+		}, 256 );
+
+		// The last particle takes each dead one's place.
+		for ( uint32_t i = 0; i < m_Count; )
+		{
+			if ( m_Age[ i ] < m_Lifetime[ i ] )
+			{
+				++i;
+				continue;
+			}
+
+			--m_Count;
+			m_PositionX[ i ] = m_PositionX[ m_Count ];
+			m_PositionY[ i ] = m_PositionY[ m_Count ];
+			m_PositionZ[ i ] = m_PositionZ[ m_Count ];
+			m_VelocityX[ i ] = m_VelocityX[ m_Count ];
+			m_VelocityY[ i ] = m_VelocityY[ m_Count ];
+			m_VelocityZ[ i ] = m_VelocityZ[ m_Count ];
+			m_Age      [ i ] = m_Age      [ m_Count ];
+			m_Lifetime [ i ] = m_Lifetime [ m_Count ];
+		}
+	}
+
+	// Writes the live particles into the mesh, relative to the centre of their bounds so the pipeline can cull
+	// the emitter as a whole.
+	void BuildMesh()
+	{
+		Vector3 Min = Vector3::One * std::numeric_limits< float >::max();
+		Vector3 Max = -Min;
+
+		for ( uint32_t i = 0; i < m_Count; ++i )
+		{
+			Min = { Math::Min( Min.x, m_PositionX[ i ] ), Math::Min( Min.y, m_PositionY[ i ] ), Math::Min( Min.z, m_PositionZ[ i ] ) };
+			Max = { Math::Max( Max.x, m_PositionX[ i ] ), Math::Max( Max.y, m_PositionY[ i ] ), Math::Max( Max.z, m_PositionZ[ i ] ) };
+		}
+
+		Vector3 Centre = ( Min + Max ) * 0.5f;
+		m_Model = Matrix4::CreateTranslation( Centre );
+
+		bool Quads = m_Shape == Shape::Quads;
+		uint32_t Corners = Quads ? 4 : 1;
+		uint32_t IndicesPer = Quads ? 6 : 1;
+		uint32_t OldIndexCount = static_cast< uint32_t >( m_Mesh.m_Indices.size() );
+
+		m_Mesh.m_Positions.resize( m_Count * Corners );
+		m_Mesh.m_Colours[ 0 ].resize( m_Count * Corners );
+		m_Mesh.m_Indices.resize( m_Count * IndicesPer );
+
+		// Index and texel patterns only depend on the slot, so only newly used slots are written.
+		for ( uint32_t i = OldIndexCount / IndicesPer; i < m_Count; ++i )
+		{
+			if ( Quads )
+			{
+				uint32_t Base = i * 4;
+				uint32_t* Indices = &m_Mesh.m_Indices[ i * 6 ];
+				Indices[ 0 ] = Base; Indices[ 1 ] = Base + 1; Indices[ 2 ] = Base + 2;
+				Indices[ 3 ] = Base; Indices[ 4 ] = Base + 2; Indices[ 5 ] = Base + 3;
+			}
+			else
+			{
+				m_Mesh.m_Indices[ i ] = i;
+			}
+		}
+
+		if ( Quads )
+		{
+			size_t OldTexelCount = m_Mesh.m_Texels[ 0 ].size();
+			m_Mesh.m_Texels[ 0 ].resize( m_Count * 4 );
+
+			for ( size_t i = OldTexelCount; i < m_Mesh.m_Texels[ 0 ].size(); ++i )
+			{
+				static const Vector2 Texels[ 4 ] = { { 0.0f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, 0.0f } };
+				m_Mesh.m_Texels[ 0 ][ i ] = Texels[ i & 3 ];
+			}
+		}
+		else
+		{
+			m_Mesh.m_Texels[ 0 ].clear();
+		}
+
+		// Quads face the main camera, clockwise on screen like every other front face.
+		Vector3 Right = Vector3::Right;
+		Vector3 Up = Vector3::Up;
+
+		if ( const Camera* Viewer = Camera::GetMainCamera() )
+		{
+			Right = Viewer->GetOwner().GetTransform()->GetGlobalRight();
+			Up = Viewer->GetOwner().GetTransform()->GetGlobalUp();
+		}
+
+		Parallel::For( 0, static_cast< int32_t >( m_Count ), [ & ]( int32_t a_Begin, int32_t a_End )
+		{
+			for ( int32_t i = a_Begin; i < a_End; ++i )
+			{
+				float Life = m_Age[ i ] / m_Lifetime[ i ];
+				Vector4 Tint = m_StartColour + ( m_EndColour - m_StartColour ) * Life;
+				Vector3 Position = Vector3( m_PositionX[ i ], m_PositionY[ i ], m_PositionZ[ i ] ) - Centre;
+
+				if ( !Quads )
+				{
+					m_Mesh.m_Positions[ i ] = Position;
+					m_Mesh.m_Colours[ 0 ][ i ] = Tint;
+					continue;
+				}
+
+				float HalfSize = 0.5f * ( m_StartSize + ( m_EndSize - m_StartSize ) * Life );
+				Vector3 Across = Right * HalfSize;
+				Vector3 Along = Up * HalfSize;
+				Vector3* Positions = &m_Mesh.m_Positions[ i * 4 ];
+				Vector4* Colours = &m_Mesh.m_Colours[ 0 ][ i * 4 ];
+				Positions[ 0 ] = Position - Across - Along;
+				Positions[ 1 ] = Position - Across + Along;
+				Positions[ 2 ] = Position + Across + Along;
+				Positions[ 3 ] = Position + Across - Along;
+				Colours[ 0 ] = Colours[ 1 ] = Colours[ 2 ] = Colours[ 3 ] = Tint;
+			}
+		}, 1024 );
+
+		m_Mesh.MarkModified();
+	}
+
+	// Grows every attribute array to hold a_Count particles, padded to a whole group of four.
+	void Reserve( uint32_t a_Count )
+	{
+		size_t Size = ( a_Count + 3 ) & ~size_t( 3 );
+
+		if ( Size <= m_Age.size() )
+		{
+			return;
+		}
+
+		for ( auto* Attribute : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ, &m_Age } )
+		{
+			Attribute->resize( Size, 0.0f );
+		}
+
+		// Padding never dies, so it never swaps into the live range.
+		m_Lifetime.resize( Size, std::numeric_limits< float >::max() );
+	}
+
+	// Xorshift, in [ 0, 1 ).
+	inline float Random()
+	{
+		m_Seed ^= m_Seed << 13;
+		m_Seed ^= m_Seed >> 17;
+		m_Seed ^= m_Seed << 5;
+		return ( m_Seed >> 8 ) * ( 1.0f / 16777216.0f );
+	}
+
+	inline Vector3 RandomDirection()
+	{
+		Vector3 Direction;
+
+		do
+		{
+			Direction = { Random() * 2.0f - 1.0f, Random() * 2.0f - 1.0f, Random() * 2.0f - 1.0f };
+		}
+		while ( Math::LengthSqrd( Direction ) > 1.0f || Math::LengthSqrd( Direction ) < 0.0001f );
+
+		return Math::Normalize( Direction );
+	}
+
+	static const Material& GetDefaultMaterial()
+	{
+		static Material Default = []()
+		{
+			Material Result;
+			Result.SetShader( Shader::VertexColour );
+			Result.SetBlendMode( Material::BlendMode::AlphaBlend );
+			return Result;
+		}();
+
+		return Default;
+	}
+
+	ResourceHandle< Material > m_Material;
+	Shape                      m_Shape = Shape::Quads;
+	uint32_t                   m_MaxParticles = 10000;
+	float                      m_EmissionRate = 100.0f;
+	bool                       m_Emitting = true;
+	Vector2                    m_LifetimeRange = Vector2( 1.0f, 2.0f );
+	Vector2                    m_SpeedRange = Vector2( 1.0f, 2.0f );
+	Vector3                    m_Direction = Vector3::Up;
+	float                      m_Spread = 0.25f;
+	Vector3                    m_EmitterSize = Vector3::Zero;
+	Vector3                    m_Gravity = Vector3( 0.0f, -9.81f, 0.0f );
+	float                      m_Drag = 0.0f;
+	Vector4                    m_StartColour = Vector4::One;
+	Vector4                    m_EndColour = Vector4( 1.0f, 1.0f, 1.0f, 0.0f );
+	float                      m_StartSize = 0.1f;
+	float                      m_EndSize = 0.1f;
+	float                      m_Pending = 0.0f;
+	uint32_t                   m_Seed = 2463534242u;
+	uint32_t                   m_Count = 0;
+
+	// One array per attribute, so four particles load into one register.
+	std::vector< float >       m_PositionX;
+	std::vector< float >       m_PositionY;
+	std::vector< float >       m_PositionZ;
+	std::vector< float >       m_VelocityX;
+	std::vector< float >       m_VelocityY;
+	std::vector< float >       m_VelocityZ;
+	std::vector< float >       m_Age;
+	std::vector< float >       m_Lifetime;
+
+	Mesh                       m_Mesh;
+	Matrix4                    m_Model;
+};
@@ -1,7 +1,27 @@
 #pragma once
-#include <Windows.h>
+#include <cstdint>
+#include "Platform.hpp"
 #include "ConsoleColour.hpp"
 
+#if CGE_POSIX
+// The Windows console's cell, so pixels are built the same way everywhere. Terminals are drawn from colours
+// rather than these, they are only kept for the colour map.
+typedef char     CHAR;
+typedef uint16_t WCHAR;
+typedef uint16_t WORD;
+
+struct CHAR_INFO
+{
+	union
+	{
+		WCHAR UnicodeChar;
+		CHAR  AsciiChar;
+	} Char;
+
+	WORD Attributes;
+};
+#endif
+
 struct Pixel : protected CHAR_INFO
 {
 	Pixel() : CHAR_INFO()
@@ -57,4 +77,5 @@ struct Pixel : protected CHAR_INFO
 private:
 
 	friend class ConsoleWindow;
+	friend class WindowsConsole;
 };
\ No newline at end of file
@@ -1,20 +1,36 @@
 ﻿#pragma once
 #include <fstream>
+#include <vector>
+#include <cfloat>
+#if defined( _M_X64 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+#include "Platform.hpp"
+#if CGE_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include "Colour.hpp"
 #include "Pixel.hpp"
 #include "Math.hpp"
+#include "Parallel.hpp"
 
+// Maps colours to the console pixel that looks closest to them. Colours are looked up 6 bits a channel, the two
+// bits dropped move a colour less than the seed colours are apart. The table holds the index of the nearest seed,
+// it is saved to colours.map and mapped straight from it on later runs.
 class PixelColourMap
 {
 public:
 
-	PixelColourMap()
-		: m_PixelMap( new Pixel[ 16777216 ] )
-	{ }
+	PixelColourMap() = default;
+	PixelColourMap( const PixelColourMap& ) = delete;
+	PixelColourMap& operator =( const PixelColourMap& ) = delete;
 
 	~PixelColourMap()
 	{
-		delete[] m_PixelMap;
+		Unmap();
 	}
 
 	static bool Init()
@@ -53,6 +69,8 @@ public:
 			c.B = 255 * n.z;
 		}*/
 
+		BuildSeeds();
+
 		if ( s_Active.Load() )
 		{
 			return true;
@@ -61,91 +79,37 @@ public:
 		return s_Active.BuildAndSave();
 	}
 
+	// Finds the nearest seed to the centre of every cell, split across the workers.
 	void Build()
 	{
-		auto Convert = []( Colour a_Colour )
-		{
-			return 
-				static_cast< int >( a_Colour.R ) +
-				static_cast< int >( a_Colour.G ) * 256 +
-				static_cast< int >( a_Colour.B ) * 65536;
-		};
+		BuildSeeds();
+		SeedTable Seeds;
 
-		// Set initial colours.
-		for ( int i = 0; i < 16; ++i )
+		for ( uint32_t i = 0; i < SeedCount; ++i )
 		{
-			Pixel NewPixel;
-			NewPixel.SetForegroundColour( ConsoleColours[ i ] );
-			NewPixel.Unicode() = L'\x2588'; // Block
-			m_PixelMap[ Convert( SeedColours[ i ] ) ] = NewPixel;
+			Seeds.R[ i ] = SeedColours[ i ].R;
+			Seeds.G[ i ] = SeedColours[ i ].G;
+			Seeds.B[ i ] = SeedColours[ i ].B;
 		}
 
-		size_t Index = 16;
+		Unmap();
+		m_Built.resize( CellCount );
+		m_SeedMap = m_Built.data();
 
-		// Set remaining colours.
-		for ( int i = 0; i < 16; ++i )
+		// One row of red per green and blue pair.
+		Parallel::For( 0, Resolution * Resolution, [ & ]( int32_t a_Begin, int32_t a_End )
 		{
-			Colour Background = SeedColours[ i ];
-			Pixel NewPixel;
-
-			for ( int j = i + 1; j < 16; ++j )
+			for ( int32_t i = a_Begin; i < a_End; ++i )
 			{
-				Colour Foreground = SeedColours[ j ];
+				float G = static_cast< float >( Centre( i % Resolution ) );
+				float B = static_cast< float >( Centre( i / Resolution ) );
 
-				for ( int k = 1; k < 4; ++k )
+				for ( int32_t R = 0; R < Resolution; ++R )
 				{
-					// Set alpha.
-					Foreground.A = ( k - 1 ) * 64 + 63;
-					
-					// Create and set Colour Seed.
-					Colour& SeedColour = SeedColours[ Index++ ];
-					SeedColour = Background + Foreground;
-
-					// Set Pixel.
-					NewPixel.SetBackgroundColour( ConsoleColours[ i ] );
-					NewPixel.SetForegroundColour( ConsoleColours[ j ] );
-					NewPixel.Unicode() = L'\x2590' + k; // Dithering characters.
-					m_PixelMap[ Convert( SeedColour ) ] = NewPixel;
-				}
-			}
-		}
-
-		// Extrapolate to empty regions in cube.
-		for ( int B = 0; B < 256; ++B )
-		{
-			for ( int G = 0; G < 256; ++G )
-			{
-				for ( int R = 0; R < 256; ++R )
-				{
-					Vector3Int DiffVector;
-					int MinDistSqrd = 16777216;
-					Pixel& Current = m_PixelMap[ Convert( Colour( R, G, B ) ) ];
-					Pixel Closest;
-
-					for ( Colour Seed : SeedColours )
-					{
-						DiffVector.x = R - Seed.R;
-						DiffVector.y = G - Seed.G;
-						DiffVector.z = B - Seed.B;
-						int DistSqrd = Math::LengthSqrd( DiffVector );
-
-						if ( DistSqrd == 0 )
-						{
-							Closest = Current;
-							break;
-						}
-
-						if ( DistSqrd < MinDistSqrd )
-						{
-							MinDistSqrd = DistSqrd;
-							Closest = m_PixelMap[ Convert( Seed ) ];
-						}
-					}
-
-					Current = Closest;
+					m_Built[ i * Resolution + R ] = static_cast< uint16_t >( Nearest( Seeds, static_cast< float >( Centre( R ) ), G, B ) );
 				}
 			}
-		}
+		}, 16 );
 	}
 
 	bool BuildAndSave()
@@ -154,23 +118,63 @@ public:
 		return Save();
 	}
 
+	// Maps colours.map, a file from another build of the table is rejected.
 	bool Load()
 	{
-		std::fstream File;
-		File.open( "colours.map", std::ios::binary | std::ios::in );
+		Unmap();
 
-		if ( !File.is_open() )
+#if CGE_WINDOWS
+		m_File = CreateFileA( "colours.map", GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+		if ( m_File == INVALID_HANDLE_VALUE )
 		{
 			return false;
 		}
 
-		File.read( reinterpret_cast< char* >( m_PixelMap ), 16777216 * sizeof( Pixel ) );
-		File.close();
+		LARGE_INTEGER FileSize;
+
+		if ( GetFileSizeEx( m_File, &FileSize ) && FileSize.QuadPart == static_cast< LONGLONG >( FileSizeBytes ) )
+		{
+			m_Mapping = CreateFileMappingA( m_File, nullptr, PAGE_READONLY, 0, 0, nullptr );
+			m_View = m_Mapping ? MapViewOfFile( m_Mapping, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+		}
+#else
+		int File = open( "colours.map", O_RDONLY );
+
+		if ( File < 0 )
+		{
+			return false;
+		}
+
+		struct stat Status;
+
+		if ( fstat( File, &Status ) == 0 && static_cast< size_t >( Status.st_size ) == FileSizeBytes )
+		{
+			void* View = mmap( nullptr, FileSizeBytes, PROT_READ, MAP_PRIVATE, File, 0 );
+			m_View = View != MAP_FAILED ? View : nullptr;
+		}
+
+		// The mapping outlives the descriptor.
+		close( File );
+#endif
+
+		if ( !m_View || *static_cast< const FileHeader* >( m_View ) != FileHeader() )
+		{
+			Unmap();
+			return false;
+		}
+
+		m_SeedMap = reinterpret_cast< const uint16_t* >( static_cast< const char* >( m_View ) + sizeof( FileHeader ) );
 		return true;
 	}
 
 	bool Save()
 	{
+		if ( m_Built.size() != CellCount )
+		{
+			return false;
+		}
+
 		std::fstream File;
 		File.open( "colours.map", std::ios::binary | std::ios::out );
 
@@ -179,17 +183,30 @@ public:
 			return false;
 		}
 
-		File.write( reinterpret_cast< char* >( m_PixelMap ), 16777216 * sizeof( Pixel ) );
+		FileHeader Header;
+		File.write( reinterpret_cast< const char* >( &Header ), sizeof( Header ) );
+		File.write( reinterpret_cast< const char* >( m_Built.data() ), CellCount * sizeof( uint16_t ) );
 		File.close();
 		return true;
 	}
 
-	Pixel ConvertColour( Colour a_Colour ) const
+	inline Pixel ConvertColour( Colour a_Colour ) const
 	{
-		return m_PixelMap[
-			static_cast< int >( a_Colour.R ) +
-			static_cast< int >( a_Colour.G ) * 256 +
-			static_cast< int >( a_Colour.B ) * 65536 ];
+		return s_SeedPixels[ FindSeed( a_Colour ) ];
+	}
+
+	// The index of the seed a_Colour is drawn as, SeedColours holds the colour it shows.
+	inline uint32_t FindSeed( Colour a_Colour ) const
+	{
+		return m_SeedMap[
+			( static_cast< int >( a_Colour.R ) >> Shift ) +
+			( static_cast< int >( a_Colour.G ) >> Shift ) * Resolution +
+			( static_cast< int >( a_Colour.B ) >> Shift ) * Resolution * Resolution ];
+	}
+
+	inline static Pixel GetSeedPixel( uint32_t a_Seed )
+	{
+		return s_SeedPixels[ a_Seed ];
 	}
 
 	static const PixelColourMap& Get()
@@ -219,6 +236,186 @@ public:
 
 private:
 
-	Pixel*                m_PixelMap;
-	static PixelColourMap s_Active;
+	static constexpr int32_t  Bits       = 6;
+	static constexpr int32_t  Shift      = 8 - Bits;
+	static constexpr int32_t  Resolution = 1 << Bits;
+	static constexpr size_t   CellCount  = size_t( Resolution ) * Resolution * Resolution;
+	static constexpr uint32_t SeedCount  = 376;
+
+	// Written ahead of the table, so a map from a different layout is rebuilt rather than misread.
+	struct FileHeader
+	{
+		uint32_t Magic     = 0x4D454743; // CGEM
+		uint32_t Bits      = PixelColourMap::Bits;
+		uint32_t EntrySize = sizeof( uint16_t );
+		uint32_t SeedCount = PixelColourMap::SeedCount;
+
+		inline bool operator !=( const FileHeader& a_Other ) const
+		{
+			return Magic != a_Other.Magic || Bits != a_Other.Bits || EntrySize != a_Other.EntrySize || SeedCount != a_Other.SeedCount;
+		}
+	};
+
+	static constexpr size_t FileSizeBytes = sizeof( FileHeader ) + CellCount * sizeof( uint16_t );
+
+	// Seed channels laid out for four at a time comparisons.
+	struct SeedTable
+	{
+		alignas( 16 ) float R[ SeedCount ];
+		alignas( 16 ) float G[ SeedCount ];
+		alignas( 16 ) float B[ SeedCount ];
+	};
+
+	static_assert( SeedCount % 4 == 0, "Seeds are compared four at a time." );
+
+	// Blends the 16 console colours into the rest of the seeds, each drawn as a shading glyph of one over another.
+	static void BuildSeeds()
+	{
+		// Set initial colours.
+		for ( int i = 0; i < 16; ++i )
+		{
+			s_SeedPixels[ i ] = Pixel();
+			s_SeedPixels[ i ].SetForegroundColour( ConsoleColours[ i ] );
+			s_SeedPixels[ i ].Unicode() = L'\x2588'; // Block
+		}
+
+		size_t Index = 16;
+
+		// Set remaining colours.
+		for ( int i = 0; i < 16; ++i )
+		{
+			Colour Background = SeedColours[ i ];
+			Pixel NewPixel;
+
+			for ( int j = i + 1; j < 16; ++j )
+			{
+				Colour Foreground = SeedColours[ j ];
+
+				for ( int k = 1; k < 4; ++k )
+				{
+					// Set alpha.
+					Foreground.A = ( k - 1 ) * 64 + 63;
+
+					// Create and set Colour Seed.
+					SeedColours[ Index ] = Background + Foreground;
+
+					// Set Pixel.
+					NewPixel.SetBackgroundColour( ConsoleColours[ i ] );
+					NewPixel.SetForegroundColour( ConsoleColours[ j ] );
+					NewPixel.Unicode() = L'\x2590' + k; // Dithering characters.
+					s_SeedPixels[ Index++ ] = NewPixel;
+				}
+			}
+		}
+	}
+
+	// The middle of the range of colours a cell covers.
+	inline static int32_t Centre( int32_t a_Cell )
+	{
+		return ( a_Cell << Shift ) + ( 1 << Shift ) / 2;
+	}
+
+	// The index of the closest seed to a colour, ties going to the lower index.
+#if defined( _M_X64 ) || defined( __SSE2__ )
+	static uint32_t Nearest( const SeedTable& a_Seeds, float a_R, float a_G, float a_B )
+	{
+		__m128 R = _mm_set1_ps( a_R );
+		__m128 G = _mm_set1_ps( a_G );
+		__m128 B = _mm_set1_ps( a_B );
+		__m128 Best = _mm_set1_ps( FLT_MAX );
+		__m128 BestIndex = _mm_setzero_ps();
+		__m128 Index = _mm_set_ps( 3.0f, 2.0f, 1.0f, 0.0f );
+		const __m128 Step = _mm_set1_ps( 4.0f );
+
+		for ( uint32_t i = 0; i < SeedCount; i += 4, Index = _mm_add_ps( Index, Step ) )
+		{
+			__m128 DR = _mm_sub_ps( R, _mm_load_ps( a_Seeds.R + i ) );
+			__m128 DG = _mm_sub_ps( G, _mm_load_ps( a_Seeds.G + i ) );
+			__m128 DB = _mm_sub_ps( B, _mm_load_ps( a_Seeds.B + i ) );
+			__m128 Distance = _mm_add_ps( _mm_add_ps( _mm_mul_ps( DR, DR ), _mm_mul_ps( DG, DG ) ), _mm_mul_ps( DB, DB ) );
+			__m128 Closer = _mm_cmplt_ps( Distance, Best );
+			Best = _mm_min_ps( Distance, Best );
+			BestIndex = _mm_or_ps( _mm_and_ps( Closer, Index ), _mm_andnot_ps( Closer, BestIndex ) );
+		}
+
+		alignas( 16 ) float Distances[ 4 ];
+		alignas( 16 ) float Indices[ 4 ];
+		_mm_store_ps( Distances, Best );
+		_mm_store_ps( Indices, BestIndex );
+		uint32_t Lane = 0;
+
+		for ( uint32_t i = 1; i < 4; ++i )
+		{
+			if ( Distances[ i ] < Distances[ Lane ] || ( Distances[ i ] == Distances[ Lane ] && Indices[ i ] < Indices[ Lane ] ) )
+			{
+				Lane = i;
+			}
+		}
+
+		return static_cast< uint32_t >( Indices[ Lane ] );
+	}
+#else
+	static uint32_t Nearest( const SeedTable& a_Seeds, float a_R, float a_G, float a_B )
+	{
+		float Best = FLT_MAX;
+		uint32_t BestIndex = 0;
+
+		for ( uint32_t i = 0; i < SeedCount; ++i )
+		{
+			float DR = a_R - a_Seeds.R[ i ];
+			float DG = a_G - a_Seeds.G[ i ];
+			float DB = a_B - a_Seeds.B[ i ];
+			float Distance = DR * DR + DG * DG + DB * DB;
+
+			if ( Distance < Best )
+			{
+				Best = Distance;
+				BestIndex = i;
+			}
+		}
+
+		return BestIndex;
+	}
+#endif
+
+	void Unmap()
+	{
+#if CGE_WINDOWS
+		if ( m_View )
+		{
+			UnmapViewOfFile( m_View );
+			m_View = nullptr;
+		}
+
+		if ( m_Mapping )
+		{
+			CloseHandle( m_Mapping );
+			m_Mapping = nullptr;
+		}
+
+		if ( m_File != INVALID_HANDLE_VALUE )
+		{
+			CloseHandle( m_File );
+			m_File = INVALID_HANDLE_VALUE;
+		}
+#else
+		if ( m_View )
+		{
+			munmap( const_cast< void* >( m_View ), FileSizeBytes );
+			m_View = nullptr;
+		}
+#endif
+
+		m_SeedMap = m_Built.empty() ? nullptr : m_Built.data();
+	}
+
+	const uint16_t*         m_SeedMap = nullptr;
+	std::vector< uint16_t > m_Built;
+#if CGE_WINDOWS
+	HANDLE                  m_File = INVALID_HANDLE_VALUE;
+	HANDLE                  m_Mapping = nullptr;
+#endif
+	const void*             m_View = nullptr;
+	inline static Pixel     s_SeedPixels[ SeedCount ];
+	static PixelColourMap   s_Active;
 };
\ No newline at end of file
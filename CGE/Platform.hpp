@@ -0,0 +1,29 @@
+#pragma once
+
+// CGE_WINDOWS builds on the Windows console, CGE_POSIX on any terminal that understands ANSI escapes. Only MSVC
+// compiles the engine so far, GCC and Clang stop in Math.hpp and others, see the root CMakeLists.txt.
+#if defined( _WIN32 )
+#define CGE_WINDOWS 1
+#define CGE_POSIX   0
+#include <Windows.h>
+#else
+#define CGE_WINDOWS 0
+#define CGE_POSIX   1
+#include <cstdio>
+#include <cerrno>
+
+// The checked fopen the engine's file code uses, only MSVC's runtime has it.
+inline int fopen_s( FILE** o_File, const char* a_Path, const char* a_Mode )
+{
+	*o_File = fopen( a_Path, a_Mode );
+	return *o_File ? 0 : errno;
+}
+#endif
+
+// CGE_HEADLESS renders into memory without a console or terminal, for unattended runs. Set by the build.
+#ifndef CGE_HEADLESS
+#define CGE_HEADLESS 0
+#endif
+
+// Whether frames are resolved into glyphs over the 16 console colours, everywhere else shows the colours.
+#define CGE_CONSOLE_CELLS ( CGE_WINDOWS && !CGE_HEADLESS )
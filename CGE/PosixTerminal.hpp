@@ -0,0 +1,564 @@
+#pragma once
+#include "Platform.hpp"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "Math.hpp"
+#include "Colour.hpp"
+
+// Any terminal that understands ANSI escapes as ConsoleWindow's backend. Each cell is an upper half block in
+// 24 bit colour, the top pixel as its foreground and the bottom one as its background, so a cell holds two
+// pixels stacked and the frame is twice as tall as the terminal has rows.
+class PosixTerminal
+{
+public:
+
+    ~PosixTerminal()
+    {
+        Restore();
+    }
+
+    // Takes the terminal over and sizes io_Size to fill it, io_Size is only kept when the terminal can't be
+    // asked. The cell size isn't known, so io_PixelSize is left as requested.
+    bool Open( const char* a_Title, Vector2Int& io_Size, Vector< short, 2 >& io_PixelSize )
+    {
+        // Keys arrive as they are typed and aren't echoed, Ctrl+C still interrupts. Reads return at once
+        // rather than the descriptor being made non-blocking, it is shared with stdout.
+        if ( isatty( STDIN_FILENO ) && tcgetattr( STDIN_FILENO, &s_Saved ) == 0 )
+        {
+            termios Raw = s_Saved;
+            Raw.c_lflag &= ~( ICANON | ECHO );
+            Raw.c_iflag &= ~( IXON | ICRNL );
+            Raw.c_cc[ VMIN ] = 0;
+            Raw.c_cc[ VTIME ] = 0;
+            s_Raw = tcsetattr( STDIN_FILENO, TCSAFLUSH, &Raw ) == 0;
+        }
+
+        if ( !s_Opened.exchange( true ) )
+        {
+            std::atexit( &PosixTerminal::Restore );
+
+            // Signals that end the process skip atexit, so they put the terminal back themselves. Handlers the
+            // program already installed, or an ignored signal, are left alone.
+            for ( int Signal : { SIGINT, SIGTERM, SIGHUP } )
+            {
+                struct sigaction Previous;
+
+                if ( sigaction( Signal, nullptr, &Previous ) == 0 && Previous.sa_handler == SIG_DFL )
+                {
+                    struct sigaction Action = {};
+                    Action.sa_handler = &PosixTerminal::OnSignal;
+                    Action.sa_flags = SA_RESETHAND;
+                    sigemptyset( &Action.sa_mask );
+                    sigaction( Signal, &Action, nullptr );
+                }
+            }
+        }
+
+        struct sigaction Action = {};
+        Action.sa_handler = []( int ) { s_Resized = true; };
+        sigemptyset( &Action.sa_mask );
+        sigaction( SIGWINCH, &Action, nullptr );
+
+        // Alternate screen, hidden cursor and every mouse event in SGR form.
+        static const char Setup[] = "\x1b[?1049h\x1b[?25l\x1b[?1003h\x1b[?1006h";
+        Send( Setup, sizeof( Setup ) - 1 );
+
+        if ( !QuerySize( io_Size ) )
+        {
+            io_Size.y += io_Size.y & 1;
+        }
+
+        SetTitle( a_Title );
+        return true;
+    }
+
+    void SetTitle( const char* a_Title )
+    {
+        std::string Title = "\x1b]0;";
+        Title += a_Title;
+        Title += '\x07';
+        Send( Title.data(), Title.size() );
+    }
+
+    // The new size in pixels when the terminal was resized since the last poll.
+    inline bool PollResize( Vector2Int& o_Size )
+    {
+        return s_Resized.exchange( false ) && QuerySize( o_Size );
+    }
+
+    // Writes only the cells that changed since the last write, moving the cursor only over skipped cells and
+    // changing colour only between cells that differ. The frame goes out in one write so the terminal never
+    // shows half of it. The first write after a resize clears and covers the whole terminal. Rows are a_Pitch
+    // colours apart, the copy of what was shown keeps the same layout.
+    void Write( const Colour* a_Frame, Vector2Int a_Size, int32_t a_Pitch )
+    {
+        int32_t Width = a_Size.x;
+        int32_t Rows = a_Size.y / 2;
+        size_t Area = static_cast< size_t >( a_Pitch ) * Rows * 2;
+        bool Redraw = m_Presented.size() != Area || m_Width != Width;
+        m_Output.clear();
+
+        if ( Redraw )
+        {
+            m_Presented.assign( a_Frame, a_Frame + Area );
+            m_Width = Width;
+            m_Output += "\x1b[0m\x1b[2J";
+        }
+
+        int32_t CursorX = -1;
+        int32_t CursorY = -1;
+        bool HasForeground = false;
+        bool HasBackground = false;
+        Colour Foreground;
+        Colour Background;
+
+        for ( int32_t y = 0; y < Rows; ++y )
+        {
+            const Colour* Top = a_Frame + static_cast< size_t >( y ) * 2 * a_Pitch;
+            const Colour* Bottom = Top + a_Pitch;
+            Colour* ShownTop = m_Presented.data() + static_cast< size_t >( y ) * 2 * a_Pitch;
+            Colour* ShownBottom = ShownTop + a_Pitch;
+
+            for ( int32_t x = 0; x < Width; ++x )
+            {
+                if ( !Redraw && Same( Top[ x ], ShownTop[ x ] ) && Same( Bottom[ x ], ShownBottom[ x ] ) )
+                {
+                    continue;
+                }
+
+                ShownTop[ x ] = Top[ x ];
+                ShownBottom[ x ] = Bottom[ x ];
+
+                if ( x != CursorX || y != CursorY )
+                {
+                    m_Output += "\x1b[";
+                    AppendNumber( y + 1 );
+                    m_Output += ';';
+                    AppendNumber( x + 1 );
+                    m_Output += 'H';
+                }
+
+                if ( !HasBackground || !Same( Background, Bottom[ x ] ) )
+                {
+                    AppendColour( "\x1b[48;2;", Bottom[ x ] );
+                    Background = Bottom[ x ];
+                    HasBackground = true;
+                }
+
+                // A cell of one colour is a space, whatever the foreground is.
+                if ( Same( Top[ x ], Bottom[ x ] ) )
+                {
+                    m_Output += ' ';
+                }
+                else
+                {
+                    if ( !HasForeground || !Same( Foreground, Top[ x ] ) )
+                    {
+                        AppendColour( "\x1b[38;2;", Top[ x ] );
+                        Foreground = Top[ x ];
+                        HasForeground = true;
+                    }
+
+                    m_Output += "\xE2\x96\x80";
+                }
+
+                CursorX = x + 1;
+                CursorY = y;
+            }
+        }
+
+        if ( !m_Output.empty() )
+        {
+            Send( m_Output.data(), m_Output.size() );
+        }
+    }
+
+    // Reads whatever input arrived since the last poll, call once a frame before asking IsHeld. Only a terminal
+    // put in raw mode is read, anything else on stdin would block the read.
+    static void PollInput()
+    {
+        char Buffer[ 256 ];
+        ssize_t Read;
+        size_t Received = 0;
+
+        while ( s_Raw && ( Read = ::read( STDIN_FILENO, Buffer, sizeof( Buffer ) ) ) > 0 )
+        {
+            s_Pending.append( Buffer, Read );
+            Received += Read;
+        }
+
+        s_PolledAt = Clock::now();
+        size_t Offset = 0;
+
+        // Sequences are sent whole, one still cut short after a poll without input was a lone Esc.
+        while ( Offset < s_Pending.size() )
+        {
+            size_t Used = Parse( s_Pending.data() + Offset, s_Pending.size() - Offset, Received == 0 );
+
+            if ( !Used )
+            {
+                break;
+            }
+
+            Offset += Used;
+        }
+
+        s_Pending.erase( 0, Offset );
+    }
+
+    // Whether a virtual-key code is down. Terminals only report presses, so a key counts as held for a while
+    // after each: long enough to bridge the delay before auto repeat, then the repeat interval. A key let go
+    // reads as held for up to that long, and a held modifier only shows with the keys pressed alongside it.
+    static bool IsHeld( unsigned char a_Code )
+    {
+        switch ( a_Code )
+        {
+        case 0x01: return s_MouseButtons[ 0 ];
+        case 0x04: return s_MouseButtons[ 1 ];
+        case 0x02: return s_MouseButtons[ 2 ];
+        default:   return s_PolledAt < s_HeldUntil[ a_Code ];
+        }
+    }
+
+    // The cell the mouse was last reported over, in pixels down from the top.
+    static Vector2 GetMousePosition()
+    {
+        return Vector2( s_MouseCell.x, s_MouseCell.y * 2 );
+    }
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    inline static bool Same( Colour a_Left, Colour a_Right )
+    {
+        return a_Left.R == a_Right.R && a_Left.G == a_Right.G && a_Left.B == a_Right.B;
+    }
+
+    void AppendNumber( uint32_t a_Value )
+    {
+        char Digits[ 10 ];
+        int Count = 0;
+
+        do
+        {
+            Digits[ Count++ ] = '0' + a_Value % 10;
+            a_Value /= 10;
+        } while ( a_Value );
+
+        while ( Count )
+        {
+            m_Output += Digits[ --Count ];
+        }
+    }
+
+    void AppendColour( const char* a_Prefix, Colour a_Colour )
+    {
+        m_Output += a_Prefix;
+        AppendNumber( a_Colour.R );
+        m_Output += ';';
+        AppendNumber( a_Colour.G );
+        m_Output += ';';
+        AppendNumber( a_Colour.B );
+        m_Output += 'm';
+    }
+
+    static bool QuerySize( Vector2Int& o_Size )
+    {
+        winsize Window;
+
+        if ( ioctl( STDOUT_FILENO, TIOCGWINSZ, &Window ) != 0 || !Window.ws_col || !Window.ws_row )
+        {
+            return false;
+        }
+
+        o_Size.x = static_cast< int32_t >( Window.ws_col );
+        o_Size.y = static_cast< int32_t >( Window.ws_row ) * 2;
+        return true;
+    }
+
+    // Writes all of a_Data, resuming after partial writes and signals.
+    static void Send( const char* a_Data, size_t a_Size )
+    {
+        std::lock_guard< std::mutex > Lock( s_OutputMutex );
+
+        while ( a_Size > 0 )
+        {
+            ssize_t Written = ::write( STDOUT_FILENO, a_Data, a_Size );
+
+            if ( Written < 0 )
+            {
+                if ( errno == EINTR )
+                {
+                    continue;
+                }
+
+                return;
+            }
+
+            a_Data += Written;
+            a_Size -= Written;
+        }
+    }
+
+    static void Restore()
+    {
+        if ( !s_Opened.exchange( false ) )
+        {
+            return;
+        }
+
+        Send( s_Reset, sizeof( s_Reset ) - 1 );
+
+        if ( s_Raw )
+        {
+            tcsetattr( STDIN_FILENO, TCSAFLUSH, &s_Saved );
+            s_Raw = false;
+        }
+    }
+
+    // Only async signal safe calls, the output mutex may be held by the thread that was interrupted. The
+    // handler was reset to the default on entry, so raising the signal again ends the process as it would have.
+    static void OnSignal( int a_Signal )
+    {
+        if ( s_Opened.exchange( false ) )
+        {
+            ssize_t Written = ::write( STDOUT_FILENO, s_Reset, sizeof( s_Reset ) - 1 );
+            ( void )Written;
+
+            if ( s_Raw )
+            {
+                tcsetattr( STDIN_FILENO, TCSAFLUSH, &s_Saved );
+            }
+        }
+
+        raise( a_Signal );
+    }
+
+    static void Press( unsigned char a_Code, bool a_Shift = false, bool a_Ctrl = false, bool a_Alt = false )
+    {
+        // The first press has to outlast the delay before auto repeat, repeats only the interval between them.
+        auto Hold = []( unsigned char a_Key )
+        {
+            bool Repeat = s_PolledAt < s_HeldUntil[ a_Key ];
+            s_HeldUntil[ a_Key ] = s_PolledAt + std::chrono::milliseconds( Repeat ? 100 : 550 );
+        };
+
+        Hold( a_Code );
+
+        if ( a_Shift )
+        {
+            Hold( 0x10 );
+        }
+
+        if ( a_Ctrl )
+        {
+            Hold( 0x11 );
+        }
+
+        if ( a_Alt )
+        {
+            Hold( 0x12 );
+        }
+    }
+
+    static void PressCharacter( unsigned char a_Character, bool a_Alt )
+    {
+        static const char          Plain  [] = ";=,-./`[\\]'";
+        static const char          Shifted[] = ":+<_>?~{|}\"";
+        static const char          Symbols[] = ")!@#$%^&*(";
+        static const unsigned char Codes  [] = { 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF, 0xC0, 0xDB, 0xDC, 0xDD, 0xDE };
+
+        if ( a_Character >= 'a' && a_Character <= 'z' )
+        {
+            Press( 0x41 + a_Character - 'a', false, false, a_Alt );
+        }
+        else if ( a_Character >= 'A' && a_Character <= 'Z' )
+        {
+            Press( 0x41 + a_Character - 'A', true, false, a_Alt );
+        }
+        else if ( a_Character >= '0' && a_Character <= '9' )
+        {
+            Press( a_Character, false, false, a_Alt );
+        }
+        else if ( a_Character == ' ' || a_Character == '\t' || a_Character == 0x1B )
+        {
+            Press( a_Character, false, false, a_Alt );
+        }
+        else if ( a_Character == '\r' || a_Character == '\n' )
+        {
+            Press( 0x0D, false, false, a_Alt );
+        }
+        else if ( a_Character == 0x7F || a_Character == 0x08 )
+        {
+            Press( 0x08, false, false, a_Alt );
+        }
+        else if ( a_Character >= 0x01 && a_Character <= 0x1A )
+        {
+            Press( 0x40 + a_Character, false, true, a_Alt );
+        }
+        else if ( const char* Found = a_Character ? std::strchr( Symbols, a_Character ) : nullptr )
+        {
+            Press( '0' + static_cast< unsigned char >( Found - Symbols ), true, false, a_Alt );
+        }
+        else if ( const char* Found = a_Character ? std::strchr( Plain, a_Character ) : nullptr )
+        {
+            Press( Codes[ Found - Plain ], false, false, a_Alt );
+        }
+        else if ( const char* Found = a_Character ? std::strchr( Shifted, a_Character ) : nullptr )
+        {
+            Press( Codes[ Found - Shifted ], true, false, a_Alt );
+        }
+    }
+
+    // Handles the input at the front of a_Data and returns how many bytes it took, none when a sequence
+    // isn't complete yet. a_Stale gives up waiting on the rest.
+    static size_t Parse( const char* a_Data, size_t a_Size, bool a_Stale )
+    {
+        if ( a_Data[ 0 ] != 0x1B )
+        {
+            PressCharacter( a_Data[ 0 ], false );
+            return 1;
+        }
+
+        if ( a_Size == 1 )
+        {
+            if ( a_Stale )
+            {
+                Press( 0x1B );
+                return 1;
+            }
+
+            return 0;
+        }
+
+        // Esc before anything but a sequence is that key with Alt.
+        if ( a_Data[ 1 ] != '[' && a_Data[ 1 ] != 'O' )
+        {
+            PressCharacter( a_Data[ 1 ], true );
+            return 2;
+        }
+
+        // Parameters and intermediates until the final byte.
+        size_t End = 2;
+
+        while ( End < a_Size && ( a_Data[ End ] < 0x40 || a_Data[ End ] > 0x7E ) )
+        {
+            ++End;
+        }
+
+        if ( End == a_Size )
+        {
+            return a_Stale ? a_Size : 0;
+        }
+
+        ParseSequence( a_Data + 2, End - 2, a_Data[ End ] );
+        return End + 1;
+    }
+
+    static void ParseSequence( const char* a_Parameters, size_t a_Length, char a_Final )
+    {
+        int Values[ 3 ] = {};
+        int Count = 0;
+        bool Mouse = a_Length > 0 && a_Parameters[ 0 ] == '<';
+
+        for ( size_t i = Mouse ? 1 : 0; i < a_Length && Count < 3; ++i )
+        {
+            if ( a_Parameters[ i ] == ';' )
+            {
+                ++Count;
+            }
+            else if ( a_Parameters[ i ] >= '0' && a_Parameters[ i ] <= '9' )
+            {
+                Values[ Count ] = Values[ Count ] * 10 + a_Parameters[ i ] - '0';
+            }
+        }
+
+        // Button, column and row, one based. Wheel events and motion don't change the buttons.
+        if ( Mouse )
+        {
+            if ( a_Final != 'M' && a_Final != 'm' )
+            {
+                return;
+            }
+
+            s_MouseCell.x = static_cast< float >( Values[ 1 ] - 1 );
+            s_MouseCell.y = static_cast< float >( Values[ 2 ] - 1 );
+            int Button = Values[ 0 ] & 3;
+
+            if ( !( Values[ 0 ] & ( 32 | 64 ) ) && Button < 3 )
+            {
+                s_MouseButtons[ Button ] = a_Final == 'M';
+            }
+
+            return;
+        }
+
+        // The modifier parameter is one more than a mask of shift, alt and ctrl.
+        int Modifiers = Values[ 1 ] > 0 ? Values[ 1 ] - 1 : 0;
+        unsigned char Code = 0;
+
+        switch ( a_Final )
+        {
+        case 'A': Code = 0x26; break;
+        case 'B': Code = 0x28; break;
+        case 'C': Code = 0x27; break;
+        case 'D': Code = 0x25; break;
+        case 'H': Code = 0x24; break;
+        case 'F': Code = 0x23; break;
+        case 'P': Code = 0x70; break;
+        case 'Q': Code = 0x71; break;
+        case 'R': Code = 0x72; break;
+        case 'S': Code = 0x73; break;
+        case '~':
+            switch ( Values[ 0 ] )
+            {
+            case 1:  Code = 0x24; break;
+            case 2:  Code = 0x2D; break;
+            case 3:  Code = 0x2E; break;
+            case 4:  Code = 0x23; break;
+            case 5:  Code = 0x21; break;
+            case 6:  Code = 0x22; break;
+            case 15: Code = 0x74; break;
+            case 17: Code = 0x75; break;
+            case 18: Code = 0x76; break;
+            case 19: Code = 0x77; break;
+            case 20: Code = 0x78; break;
+            case 21: Code = 0x79; break;
+            case 23: Code = 0x7A; break;
+            case 24: Code = 0x7B; break;
+            }
+            break;
+        }
+
+        if ( Code )
+        {
+            Press( Code, Modifiers & 1, Modifiers & 4, Modifiers & 2 );
+        }
+    }
+
+    std::vector< Colour >             m_Presented; // What the terminal shows, only touched by the presenting thread.
+    std::string                       m_Output;
+    int32_t                           m_Width = 0;
+    inline static constexpr char      s_Reset[] = "\x1b[0m\x1b[?1006l\x1b[?1003l\x1b[?25h\x1b[?1049l";
+    inline static termios             s_Saved;
+    inline static bool                s_Raw = false;
+    inline static std::atomic< bool > s_Opened = false;
+    inline static std::atomic< bool > s_Resized = false;
+    inline static std::mutex          s_OutputMutex;
+    inline static std::string         s_Pending;
+    inline static Clock::time_point   s_PolledAt;
+    inline static Clock::time_point   s_HeldUntil[ 256 ];
+    inline static bool                s_MouseButtons[ 3 ] = {};
+    inline static Vector2             s_MouseCell;
+};
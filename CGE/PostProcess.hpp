@@ -0,0 +1,220 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#if defined( _M_X64 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+#include "Math.hpp"
+#include "Colour.hpp"
+#include "Parallel.hpp"
+
+// One full screen effect over the RGBA frame, before it is converted to console colours.
+// A pass runs in one or more stages, each stage reads the whole output of the previous one.
+class PostProcessPass
+{
+public:
+
+	virtual ~PostProcessPass() = default;
+
+	virtual const char* GetName() const = 0;
+
+	// Stages are separated so effects like a separable blur can read rows other threads wrote.
+	virtual uint32_t GetStageCount() const
+	{
+		return 1;
+	}
+
+	// Called once a frame before any rows are processed.
+	virtual void Prepare( Vector2Int a_Size ) { }
+
+	// Writes rows [ a_RowBegin, a_RowEnd ) of o_Destination. Runs on several threads at once.
+	virtual void Apply( uint32_t a_Stage, const Colour* a_Source, Colour* o_Destination, Vector2Int a_Size, int32_t a_RowBegin, int32_t a_RowEnd ) const = 0;
+
+	inline bool IsEnabled() const
+	{
+		return m_Enabled;
+	}
+
+	inline void SetEnabled( bool a_Enabled )
+	{
+		m_Enabled = a_Enabled;
+	}
+
+	// Seconds spent in this pass last frame.
+	inline float GetLastTime() const
+	{
+		return m_LastTime;
+	}
+
+protected:
+
+	// Channels as four floats in [ 0, 255 ], one pixel per register where SSE2 is available.
+#if defined( _M_X64 ) || defined( __SSE2__ )
+	typedef __m128 Texel;
+
+	inline static Texel Load( Colour a_Colour )
+	{
+		__m128i Bytes = _mm_cvtsi32_si128( *reinterpret_cast< const int32_t* >( &a_Colour ) );
+		Bytes = _mm_unpacklo_epi8( Bytes, _mm_setzero_si128() );
+		return _mm_cvtepi32_ps( _mm_unpacklo_epi16( Bytes, _mm_setzero_si128() ) );
+	}
+
+	inline static Colour Store( Texel a_Texel )
+	{
+		__m128i Integers = _mm_cvtps_epi32( a_Texel );
+		Integers = _mm_packs_epi32( Integers, Integers );
+		int32_t Packed = _mm_cvtsi128_si32( _mm_packus_epi16( Integers, Integers ) );
+		return *reinterpret_cast< Colour* >( &Packed );
+	}
+
+	inline static Texel Splat( float a_Value )                         { return _mm_set1_ps( a_Value ); }
+	inline static Texel Add( Texel a_A, Texel a_B )                    { return _mm_add_ps( a_A, a_B ); }
+	inline static Texel Subtract( Texel a_A, Texel a_B )               { return _mm_sub_ps( a_A, a_B ); }
+	inline static Texel Multiply( Texel a_A, Texel a_B )               { return _mm_mul_ps( a_A, a_B ); }
+	inline static Texel Divide( Texel a_A, Texel a_B )                 { return _mm_div_ps( a_A, a_B ); }
+	inline static Texel Lerp( Texel a_A, Texel a_B, float a_T )        { return _mm_add_ps( a_A, _mm_mul_ps( _mm_sub_ps( a_B, a_A ), _mm_set1_ps( a_T ) ) ); }
+
+	// Alpha from a_Source, colour from a_Result.
+	inline static Texel KeepAlpha( Texel a_Result, Texel a_Source )
+	{
+		static const __m128 Mask = _mm_castsi128_ps( _mm_set_epi32( 0, -1, -1, -1 ) );
+		return _mm_or_ps( _mm_and_ps( Mask, a_Result ), _mm_andnot_ps( Mask, a_Source ) );
+	}
+
+	inline static float Luminance( Texel a_Texel )
+	{
+		alignas( 16 ) float Channels[ 4 ];
+		_mm_store_ps( Channels, a_Texel );
+		return 0.2126f * Channels[ 0 ] + 0.7152f * Channels[ 1 ] + 0.0722f * Channels[ 2 ];
+	}
+#else
+	typedef Vector4 Texel;
+
+	inline static Texel Load( Colour a_Colour )                        { return { static_cast< float >( a_Colour.R ), static_cast< float >( a_Colour.G ), static_cast< float >( a_Colour.B ), static_cast< float >( a_Colour.A ) }; }
+	inline static Colour Store( Texel a_Texel )                        { a_Texel = Math::Clamp( a_Texel + Splat( 0.5f ), 0.0f, 255.0f ); return Colour( static_cast< Colour::Channel >( a_Texel.x ), static_cast< Colour::Channel >( a_Texel.y ), static_cast< Colour::Channel >( a_Texel.z ), static_cast< Colour::Channel >( a_Texel.w ) ); }
+	inline static Texel Splat( float a_Value )                         { return { a_Value, a_Value, a_Value, a_Value }; }
+	inline static Texel Add( Texel a_A, Texel a_B )                    { return a_A + a_B; }
+	inline static Texel Subtract( Texel a_A, Texel a_B )               { return a_A - a_B; }
+	inline static Texel Multiply( Texel a_A, Texel a_B )               { return a_A * a_B; }
+	inline static Texel Divide( Texel a_A, Texel a_B )                 { return { a_A.x / a_B.x, a_A.y / a_B.y, a_A.z / a_B.z, a_A.w / a_B.w }; }
+	inline static Texel Lerp( Texel a_A, Texel a_B, float a_T )        { return a_A + ( a_B - a_A ) * a_T; }
+	inline static Texel KeepAlpha( Texel a_Result, Texel a_Source )    { a_Result.w = a_Source.w; return a_Result; }
+	inline static float Luminance( Texel a_Texel )                     { return 0.2126f * a_Texel.x + 0.7152f * a_Texel.y + 0.0722f * a_Texel.z; }
+#endif
+
+	// Edge pixels repeat outwards.
+	inline static Colour Fetch( const Colour* a_Source, Vector2Int a_Size, int32_t a_X, int32_t a_Y )
+	{
+		a_X = Math::Clamp( a_X, 0, a_Size.x - 1 );
+		a_Y = Math::Clamp( a_Y, 0, a_Size.y - 1 );
+		return a_Source[ a_Y * a_Size.x + a_X ];
+	}
+
+private:
+
+	friend class PostProcess;
+
+	bool  m_Enabled = true;
+	float m_LastTime = 0.0f;
+};
+
+// The chain of passes run over every frame before it reaches the console. Passes run in the order they were added,
+// each stage split across the worker threads by rows.
+class PostProcess
+{
+public:
+
+	template < typename T, typename... _Args >
+	static T& Add( _Args&&... a_Args )
+	{
+		s_Passes.push_back( std::make_unique< T >( std::forward< _Args >( a_Args )... ) );
+		return static_cast< T& >( *s_Passes.back() );
+	}
+
+	static void Remove( const PostProcessPass& a_Pass )
+	{
+		s_Passes.erase( std::remove_if( s_Passes.begin(), s_Passes.end(), [ & ]( const auto& a_Entry ) { return a_Entry.get() == &a_Pass; } ), s_Passes.end() );
+	}
+
+	static void Clear()
+	{
+		s_Passes.clear();
+	}
+
+	inline static size_t GetPassCount()
+	{
+		return s_Passes.size();
+	}
+
+	inline static PostProcessPass& GetPass( size_t a_Index )
+	{
+		return *s_Passes[ a_Index ];
+	}
+
+	// True when any pass is enabled, the pipeline then draws offscreen.
+	static bool IsActive()
+	{
+		return std::any_of( s_Passes.begin(), s_Passes.end(), []( const auto& a_Pass ) { return a_Pass->IsEnabled(); } );
+	}
+
+	// Seconds spent in all passes last frame.
+	inline static float GetLastTime()
+	{
+		return s_LastTime;
+	}
+
+private:
+
+	friend class RenderPipeline;
+
+	// Runs every enabled pass over a_Frame, which is left untouched, and returns the buffer holding the result.
+	static const Colour* Run( const Colour* a_Frame, Vector2Int a_Size )
+	{
+		size_t Area = static_cast< size_t >( a_Size.x ) * a_Size.y;
+		const Colour* Source = a_Frame;
+		uint32_t Target = 0;
+		s_LastTime = 0.0f;
+
+		for ( auto& Buffer : s_Buffers )
+		{
+			Buffer.resize( Area );
+		}
+
+		for ( auto& Pass : s_Passes )
+		{
+			if ( !Pass->IsEnabled() )
+			{
+				Pass->m_LastTime = 0.0f;
+				continue;
+			}
+
+			auto Begin = std::chrono::high_resolution_clock::now();
+			Pass->Prepare( a_Size );
+
+			for ( uint32_t Stage = 0; Stage < Pass->GetStageCount(); ++Stage )
+			{
+				Colour* Destination = s_Buffers[ Target ].data();
+				const PostProcessPass& Current = *Pass;
+
+				Parallel::For( 0, a_Size.y, [ & ]( int32_t a_RowBegin, int32_t a_RowEnd )
+				{
+					Current.Apply( Stage, Source, Destination, a_Size, a_RowBegin, a_RowEnd );
+				}, 4 );
+
+				Source = Destination;
+				Target ^= 1;
+			}
+
+			Pass->m_LastTime = 0.000000001f * ( std::chrono::high_resolution_clock::now() - Begin ).count();
+			s_LastTime += Pass->m_LastTime;
+		}
+
+		return Source;
+	}
+
+	inline static std::vector< std::unique_ptr< PostProcessPass > > s_Passes;
+	inline static std::vector< Colour >                             s_Buffers[ 2 ];
+	inline static float                                             s_LastTime = 0.0f;
+};
@@ -0,0 +1,354 @@
+#pragma once
+#include <vector>
+#include "PostProcess.hpp"
+#include "Texture.hpp"
+
+// Extended Reinhard on exposed colour, a_WhitePoint is the exposed value that maps to full brightness.
+class ToneMapping : public PostProcessPass
+{
+public:
+
+	ToneMapping( float a_Exposure = 1.0f, float a_WhitePoint = 2.0f )
+		: m_Exposure( a_Exposure )
+		, m_WhitePoint( a_WhitePoint )
+	{ }
+
+	const char* GetName() const override
+	{
+		return "ToneMapping";
+	}
+
+	void SetExposure( float a_Exposure )
+	{
+		m_Exposure = a_Exposure;
+	}
+
+	void SetWhitePoint( float a_WhitePoint )
+	{
+		m_WhitePoint = Math::Max( a_WhitePoint, 0.0001f );
+	}
+
+	void Apply( uint32_t a_Stage, const Colour* a_Source, Colour* o_Destination, Vector2Int a_Size, int32_t a_RowBegin, int32_t a_RowEnd ) const override
+	{
+		Texel Exposure = Splat( m_Exposure / 255.0f );
+		Texel InverseWhite = Splat( 1.0f / ( m_WhitePoint * m_WhitePoint ) );
+		Texel One = Splat( 1.0f );
+		Texel Scale = Splat( 255.0f );
+
+		for ( int32_t i = a_RowBegin * a_Size.x, End = a_RowEnd * a_Size.x; i < End; ++i )
+		{
+			Texel Source = Load( a_Source[ i ] );
+			Texel X = Multiply( Source, Exposure );
+			Texel Y = Divide( Multiply( X, Add( One, Multiply( X, InverseWhite ) ) ), Add( One, X ) );
+			o_Destination[ i ] = Store( KeepAlpha( Multiply( Y, Scale ), Source ) );
+		}
+	}
+
+private:
+
+	float m_Exposure;
+	float m_WhitePoint;
+};
+
+// Darkens towards the corners. Distance is measured in half screens from the centre, so the corners sit at about 1.4.
+class Vignette : public PostProcessPass
+{
+public:
+
+	Vignette( float a_Intensity = 0.5f, float a_Inner = 0.6f, float a_Outer = 1.4f )
+		: m_Intensity( a_Intensity )
+		, m_Inner( a_Inner )
+		, m_Outer( a_Outer )
+	{ }
+
+	const char* GetName() const override
+	{
+		return "Vignette";
+	}
+
+	void SetIntensity( float a_Intensity )
+	{
+		m_Intensity = a_Intensity;
+	}
+
+	void SetRange( float a_Inner, float a_Outer )
+	{
+		m_Inner = a_Inner;
+		m_Outer = Math::Max( a_Outer, a_Inner + 0.0001f );
+	}
+
+	// Squared distances per column and row, so rows only add two numbers per pixel.
+	void Prepare( Vector2Int a_Size ) override
+	{
+		m_Columns.resize( a_Size.x );
+		m_Rows.resize( a_Size.y );
+
+		for ( int32_t x = 0; x < a_Size.x; ++x )
+		{
+			float U = ( 2.0f * x + 1.0f ) / a_Size.x - 1.0f;
+			m_Columns[ x ] = U * U;
+		}
+
+		for ( int32_t y = 0; y < a_Size.y; ++y )
+		{
+			float V = ( 2.0f * y + 1.0f ) / a_Size.y - 1.0f;
+			m_Rows[ y ] = V * V;
+		}
+	}
+
+	void Apply( uint32_t a_Stage, const Colour* a_Source, Colour* o_Destination, Vector2Int a_Size, int32_t a_RowBegin, int32_t a_RowEnd ) const override
+	{
+		float Range = 1.0f / ( m_Outer - m_Inner );
+
+		for ( int32_t y = a_RowBegin; y < a_RowEnd; ++y )
+		{
+			const Colour* Source = a_Source + y * a_Size.x;
+			Colour* Destination = o_Destination + y * a_Size.x;
+
+			for ( int32_t x = 0; x < a_Size.x; ++x )
+			{
+				float T = Math::Clamp( ( Math::Sqrt( m_Columns[ x ] + m_Rows[ y ] ) - m_Inner ) * Range, 0.0f, 1.0f );
+				float Factor = 1.0f - m_Intensity * T * T * ( 3.0f - 2.0f * T );
+				Texel Value = Load( Source[ x ] );
+				Destination[ x ] = Store( KeepAlpha( Multiply( Value, Splat( Factor ) ), Value ) );
+			}
+		}
+	}
+
+private:
+
+	float                m_Intensity;
+	float                m_Inner;
+	float                m_Outer;
+	std::vector< float > m_Columns;
+	std::vector< float > m_Rows;
+};
+
+// Separable box blur, horizontal then vertical.
+class Blur : public PostProcessPass
+{
+public:
+
+	Blur( int32_t a_Radius = 1 )
+		: m_Radius( Math::Max( a_Radius, 0 ) )
+	{ }
+
+	const char* GetName() const override
+	{
+		return "Blur";
+	}
+
+	void SetRadius( int32_t a_Radius )
+	{
+		m_Radius = Math::Max( a_Radius, 0 );
+	}
+
+	uint32_t GetStageCount() const override
+	{
+		return 2;
+	}
+
+	void Apply( uint32_t a_Stage, const Colour* a_Source, Colour* o_Destination, Vector2Int a_Size, int32_t a_RowBegin, int32_t a_RowEnd ) const override
+	{
+		Texel Weight = Splat( 1.0f / ( 2 * m_Radius + 1 ) );
+
+		for ( int32_t y = a_RowBegin; y < a_RowEnd; ++y )
+		{
+			Colour* Destination = o_Destination + y * a_Size.x;
+
+			if ( a_Stage == 0 )
+			{
+				// Sliding window along the row.
+				Texel Sum = Splat( 0.0f );
+
+				for ( int32_t i = -m_Radius; i <= m_Radius; ++i )
+				{
+					Sum = Add( Sum, Load( Fetch( a_Source, a_Size, i, y ) ) );
+				}
+
+				for ( int32_t x = 0; x < a_Size.x; ++x )
+				{
+					Destination[ x ] = Store( Multiply( Sum, Weight ) );
+					Sum = Add( Sum, Subtract( Load( Fetch( a_Source, a_Size, x + m_Radius + 1, y ) ), Load( Fetch( a_Source, a_Size, x - m_Radius, y ) ) ) );
+				}
+			}
+			else
+			{
+				// Columns are summed a row at a time so each thread only writes its own rows.
+				for ( int32_t x = 0; x < a_Size.x; ++x )
+				{
+					Texel Sum = Splat( 0.0f );
+
+					for ( int32_t i = -m_Radius; i <= m_Radius; ++i )
+					{
+						Sum = Add( Sum, Load( Fetch( a_Source, a_Size, x, y + i ) ) );
+					}
+
+					Destination[ x ] = Store( Multiply( Sum, Weight ) );
+				}
+			}
+		}
+	}
+
+private:
+
+	int32_t m_Radius;
+};
+
+// Sobel on colour, pixels whose luminance gradient passes a_Threshold fade into the outline colour over a_Softness.
+class EdgeDetect : public PostProcessPass
+{
+public:
+
+	EdgeDetect( Colour a_Outline = Colour( 0, 0, 0 ), float a_Threshold = 0.15f, float a_Softness = 0.1f )
+		: m_Outline( a_Outline )
+		, m_Threshold( a_Threshold )
+		, m_Softness( a_Softness )
+	{ }
+
+	const char* GetName() const override
+	{
+		return "EdgeDetect";
+	}
+
+	void SetOutline( Colour a_Outline )
+	{
+		m_Outline = a_Outline;
+	}
+
+	void SetThreshold( float a_Threshold, float a_Softness )
+	{
+		m_Threshold = a_Threshold;
+		m_Softness = Math::Max( a_Softness, 0.0001f );
+	}
+
+	void Apply( uint32_t a_Stage, const Colour* a_Source, Colour* o_Destination, Vector2Int a_Size, int32_t a_RowBegin, int32_t a_RowEnd ) const override
+	{
+		Texel Outline = Load( m_Outline );
+		Texel Two = Splat( 2.0f );
+
+		// The largest gradient either way is four full steps.
+		float Normalize = 1.0f / ( 4.0f * 255.0f );
+
+		for ( int32_t y = a_RowBegin; y < a_RowEnd; ++y )
+		{
+			for ( int32_t x = 0; x < a_Size.x; ++x )
+			{
+				Texel TL = Load( Fetch( a_Source, a_Size, x - 1, y - 1 ) ), T = Load( Fetch( a_Source, a_Size, x, y - 1 ) ), TR = Load( Fetch( a_Source, a_Size, x + 1, y - 1 ) );
+				Texel L  = Load( Fetch( a_Source, a_Size, x - 1, y ) ),                                                    R  = Load( Fetch( a_Source, a_Size, x + 1, y ) );
+				Texel BL = Load( Fetch( a_Source, a_Size, x - 1, y + 1 ) ), B = Load( Fetch( a_Source, a_Size, x, y + 1 ) ), BR = Load( Fetch( a_Source, a_Size, x + 1, y + 1 ) );
+
+				Texel GX = Subtract( Add( Add( TR, Multiply( R, Two ) ), BR ), Add( Add( TL, Multiply( L, Two ) ), BL ) );
+				Texel GY = Subtract( Add( Add( BL, Multiply( B, Two ) ), BR ), Add( Add( TL, Multiply( T, Two ) ), TR ) );
+				float LX = Luminance( GX ) * Normalize, LY = Luminance( GY ) * Normalize;
+				float Edge = Math::Clamp( ( Math::Sqrt( LX * LX + LY * LY ) - m_Threshold ) / m_Softness, 0.0f, 1.0f );
+
+				Texel Centre = Load( a_Source[ y * a_Size.x + x ] );
+				o_Destination[ y * a_Size.x + x ] = Store( KeepAlpha( Lerp( Centre, Outline, Edge ), Centre ) );
+			}
+		}
+	}
+
+private:
+
+	Colour m_Outline;
+	float  m_Threshold;
+	float  m_Softness;
+};
+
+// Colour grading through a 3D lookup table with trilinear filtering. The table is read from an unwrapped strip
+// a_Resolution * a_Resolution wide and a_Resolution high: red runs along x within a slice, green down y and blue across slices.
+class ColourGrade : public PostProcessPass
+{
+public:
+
+	// Starts as the identity table.
+	ColourGrade( uint32_t a_Resolution = 16, float a_Intensity = 1.0f )
+		: m_Resolution( Math::Max( a_Resolution, 2u ) )
+		, m_Intensity( a_Intensity )
+	{
+		m_Table.resize( m_Resolution * m_Resolution * m_Resolution );
+		float Step = 255.0f / ( m_Resolution - 1 );
+
+		for ( uint32_t b = 0; b < m_Resolution; ++b )
+		for ( uint32_t g = 0; g < m_Resolution; ++g )
+		for ( uint32_t r = 0; r < m_Resolution; ++r )
+		{
+			m_Table[ Index( r, g, b ) ] = Colour(
+				static_cast< Colour::Channel >( r * Step + 0.5f ),
+				static_cast< Colour::Channel >( g * Step + 0.5f ),
+				static_cast< Colour::Channel >( b * Step + 0.5f ) );
+		}
+	}
+
+	ColourGrade( const Texture2D& a_Table, float a_Intensity = 1.0f )
+		: ColourGrade( static_cast< uint32_t >( a_Table.GetHeight() ), a_Intensity )
+	{
+		SetTable( a_Table );
+	}
+
+	const char* GetName() const override
+	{
+		return "ColourGrade";
+	}
+
+	// Tables that aren't a strip of the current resolution are ignored.
+	bool SetTable( const Texture2D& a_Table )
+	{
+		if ( a_Table.GetHeight() != static_cast< int >( m_Resolution ) || a_Table.GetWidth() != static_cast< int >( m_Resolution * m_Resolution ) )
+		{
+			return false;
+		}
+
+		for ( uint32_t b = 0; b < m_Resolution; ++b )
+		for ( uint32_t g = 0; g < m_Resolution; ++g )
+		for ( uint32_t r = 0; r < m_Resolution; ++r )
+		{
+			m_Table[ Index( r, g, b ) ] = a_Table[ g * a_Table.GetWidth() + b * m_Resolution + r ];
+		}
+
+		return true;
+	}
+
+	// Blend between the ungraded and graded colour.
+	void SetIntensity( float a_Intensity )
+	{
+		m_Intensity = Math::Clamp( a_Intensity, 0.0f, 1.0f );
+	}
+
+	void Apply( uint32_t a_Stage, const Colour* a_Source, Colour* o_Destination, Vector2Int a_Size, int32_t a_RowBegin, int32_t a_RowEnd ) const override
+	{
+		float Scale = ( m_Resolution - 1 ) / 255.0f;
+		uint32_t Last = m_Resolution - 1;
+
+		for ( int32_t i = a_RowBegin * a_Size.x, End = a_RowEnd * a_Size.x; i < End; ++i )
+		{
+			Colour Source = a_Source[ i ];
+			float R = Source.R * Scale, G = Source.G * Scale, B = Source.B * Scale;
+			uint32_t R0 = static_cast< uint32_t >( R ), G0 = static_cast< uint32_t >( G ), B0 = static_cast< uint32_t >( B );
+			uint32_t R1 = Math::Min( R0 + 1, Last ), G1 = Math::Min( G0 + 1, Last ), B1 = Math::Min( B0 + 1, Last );
+			float TR = R - R0, TG = G - G0, TB = B - B0;
+
+			Texel Near = Lerp(
+				Lerp( Load( m_Table[ Index( R0, G0, B0 ) ] ), Load( m_Table[ Index( R1, G0, B0 ) ] ), TR ),
+				Lerp( Load( m_Table[ Index( R0, G1, B0 ) ] ), Load( m_Table[ Index( R1, G1, B0 ) ] ), TR ), TG );
+			Texel Far = Lerp(
+				Lerp( Load( m_Table[ Index( R0, G0, B1 ) ] ), Load( m_Table[ Index( R1, G0, B1 ) ] ), TR ),
+				Lerp( Load( m_Table[ Index( R0, G1, B1 ) ] ), Load( m_Table[ Index( R1, G1, B1 ) ] ), TR ), TG );
+
+			Texel Original = Load( Source );
+			o_Destination[ i ] = Store( KeepAlpha( Lerp( Original, Lerp( Near, Far, TB ), m_Intensity ), Original ) );
+		}
+	}
+
+private:
+
+	inline uint32_t Index( uint32_t a_R, uint32_t a_G, uint32_t a_B ) const
+	{
+		return ( a_B * m_Resolution + a_G ) * m_Resolution + a_R;
+	}
+
+	uint32_t              m_Resolution;
+	float                 m_Intensity;
+	std::vector< Colour > m_Table;
+};
@@ -0,0 +1,1088 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <numeric>
+#include <limits>
+#include <cstring>
+#if defined( _M_X64 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+#include "Math.hpp"
+#include "Colour.hpp"
+#include "Mesh.hpp"
+#include "Material.hpp"
+#include "Texture.hpp"
+#include "Light.hpp"
+#include "CameraBlock.hpp"
+#include "Rendering.hpp"
+#include "RenderQueue.hpp"
+#include "Parallel.hpp"
+
+// Renders the scene by tracing rays instead of rasterizing it. Every mesh gets a bounding volume hierarchy of its own,
+// built once, and the draws of a frame sit in a second hierarchy over those. Rays are traced four at a time through
+// both, one 2x2 block of pixels per packet, with rows of blocks split across the worker threads.
+// Surfaces read the same material properties as the shaders: diffuse_colour, texture_diffuse and, for materials
+// whose shader reads u_SunLight, the sun. Lit surfaces send a shadow ray to the sun, and surfaces with a
+// reflectivity property send a reflected ray.
+class RayTracer
+{
+public:
+
+	// The pipeline traces every camera instead of rasterizing while enabled.
+	static void SetEnabled( bool a_Enabled )
+	{
+		s_Enabled = a_Enabled;
+	}
+
+	inline static bool IsEnabled()
+	{
+		return s_Enabled;
+	}
+
+	// Reflections of reflections followed before giving up, 0 turns reflections off.
+	static void SetMaxBounces( uint32_t a_Bounces )
+	{
+		s_MaxBounces = a_Bounces;
+	}
+
+	inline static uint32_t GetMaxBounces()
+	{
+		return s_MaxBounces;
+	}
+
+	// The colour of rays that hit nothing.
+	static void SetBackground( const Vector4& a_Colour )
+	{
+		s_Background = a_Colour;
+	}
+
+	inline static const Vector4& GetBackground()
+	{
+		return s_Background;
+	}
+
+	// Mesh hierarchies are kept while their mesh is drawn. Call after changing a mesh's contents in place.
+	static void FlushMeshes()
+	{
+		s_Meshes.clear();
+	}
+
+	// Triangles in the scene traced last frame.
+	inline static size_t GetTriangleCount()
+	{
+		return s_TriangleCount;
+	}
+
+private:
+
+	friend class RenderPipeline;
+
+	// Four floats worked on together, one lane per ray of a packet. Comparisons give lanes with every bit set or none.
+	struct Float4
+	{
+#if defined( _M_X64 ) || defined( __SSE2__ )
+		__m128 Value;
+
+		Float4() = default;
+		Float4( __m128 a_Value ) : Value( a_Value ) { }
+		Float4( float a_Value ) : Value( _mm_set1_ps( a_Value ) ) { }
+
+		inline static Float4 Load( const float* a_Values )                  { return _mm_loadu_ps( a_Values ); }
+		inline void Store( float* o_Values ) const                          { _mm_storeu_ps( o_Values, Value ); }
+		inline int Mask() const                                             { return _mm_movemask_ps( Value ); }
+
+		inline friend Float4 operator+( Float4 a_A, Float4 a_B )            { return _mm_add_ps( a_A.Value, a_B.Value ); }
+		inline friend Float4 operator-( Float4 a_A, Float4 a_B )            { return _mm_sub_ps( a_A.Value, a_B.Value ); }
+		inline friend Float4 operator*( Float4 a_A, Float4 a_B )            { return _mm_mul_ps( a_A.Value, a_B.Value ); }
+		inline friend Float4 operator/( Float4 a_A, Float4 a_B )            { return _mm_div_ps( a_A.Value, a_B.Value ); }
+		inline friend Float4 operator<( Float4 a_A, Float4 a_B )            { return _mm_cmplt_ps( a_A.Value, a_B.Value ); }
+		inline friend Float4 operator<=( Float4 a_A, Float4 a_B )           { return _mm_cmple_ps( a_A.Value, a_B.Value ); }
+		inline friend Float4 operator>( Float4 a_A, Float4 a_B )            { return _mm_cmpgt_ps( a_A.Value, a_B.Value ); }
+		inline friend Float4 operator>=( Float4 a_A, Float4 a_B )           { return _mm_cmpge_ps( a_A.Value, a_B.Value ); }
+		inline friend Float4 operator&( Float4 a_A, Float4 a_B )            { return _mm_and_ps( a_A.Value, a_B.Value ); }
+		inline friend Float4 operator|( Float4 a_A, Float4 a_B )            { return _mm_or_ps( a_A.Value, a_B.Value ); }
+
+		inline static Float4 AndNot( Float4 a_Mask, Float4 a_Value )        { return _mm_andnot_ps( a_Mask.Value, a_Value.Value ); }
+		inline static Float4 Min( Float4 a_A, Float4 a_B )                  { return _mm_min_ps( a_A.Value, a_B.Value ); }
+		inline static Float4 Max( Float4 a_A, Float4 a_B )                  { return _mm_max_ps( a_A.Value, a_B.Value ); }
+		inline static Float4 Sqrt( Float4 a_A )                             { return _mm_sqrt_ps( a_A.Value ); }
+		inline static Float4 Abs( Float4 a_A )                              { return _mm_andnot_ps( _mm_set1_ps( -0.0f ), a_A.Value ); }
+		inline static Float4 Select( Float4 a_Mask, Float4 a_A, Float4 a_B ) { return _mm_or_ps( _mm_and_ps( a_Mask.Value, a_A.Value ), _mm_andnot_ps( a_Mask.Value, a_B.Value ) ); }
+		inline static Float4 FromMask( int a_Mask )                         { return _mm_castsi128_ps( _mm_set_epi32( -( ( a_Mask >> 3 ) & 1 ), -( ( a_Mask >> 2 ) & 1 ), -( ( a_Mask >> 1 ) & 1 ), -( a_Mask & 1 ) ) ); }
+#else
+		float Value[ 4 ];
+
+		Float4() = default;
+		Float4( float a_Value ) : Value{ a_Value, a_Value, a_Value, a_Value } { }
+
+		inline static Float4 Load( const float* a_Values )                  { Float4 Result; std::memcpy( Result.Value, a_Values, sizeof( Result.Value ) ); return Result; }
+		inline void Store( float* o_Values ) const                          { std::memcpy( o_Values, Value, sizeof( Value ) ); }
+		inline int Mask() const                                             { int Result = 0; for ( int i = 0; i < 4; ++i ) Result |= ( Bits( Value[ i ] ) >> 31 ) << i; return Result; }
+
+		inline friend Float4 operator+( Float4 a_A, Float4 a_B )            { return Each( a_A, a_B, []( float a, float b ) { return a + b; } ); }
+		inline friend Float4 operator-( Float4 a_A, Float4 a_B )            { return Each( a_A, a_B, []( float a, float b ) { return a - b; } ); }
+		inline friend Float4 operator*( Float4 a_A, Float4 a_B )            { return Each( a_A, a_B, []( float a, float b ) { return a * b; } ); }
+		inline friend Float4 operator/( Float4 a_A, Float4 a_B )            { return Each( a_A, a_B, []( float a, float b ) { return a / b; } ); }
+		inline friend Float4 operator<( Float4 a_A, Float4 a_B )            { return Each( a_A, a_B, []( float a, float b ) { return Lane( a < b ); } ); }
+		inline friend Float4 operator<=( Float4 a_A, Float4 a_B )           { return Each( a_A, a_B, []( float a, float b ) { return Lane( a <= b ); } ); }
+		inline friend Float4 operator>( Float4 a_A, Float4 a_B )            { return Each( a_A, a_B, []( float a, float b ) { return Lane( a > b ); } ); }
+		inline friend Float4 operator>=( Float4 a_A, Float4 a_B )           { return Each( a_A, a_B, []( float a, float b ) { return Lane( a >= b ); } ); }
+		inline friend Float4 operator&( Float4 a_A, Float4 a_B )            { return Each( a_A, a_B, []( float a, float b ) { return Float( Bits( a ) & Bits( b ) ); } ); }
+		inline friend Float4 operator|( Float4 a_A, Float4 a_B )            { return Each( a_A, a_B, []( float a, float b ) { return Float( Bits( a ) | Bits( b ) ); } ); }
+
+		inline static Float4 AndNot( Float4 a_Mask, Float4 a_Value )        { return Each( a_Mask, a_Value, []( float a, float b ) { return Float( ~Bits( a ) & Bits( b ) ); } ); }
+		inline static Float4 Min( Float4 a_A, Float4 a_B )                  { return Each( a_A, a_B, []( float a, float b ) { return a < b ? a : b; } ); }
+		inline static Float4 Max( Float4 a_A, Float4 a_B )                  { return Each( a_A, a_B, []( float a, float b ) { return a > b ? a : b; } ); }
+		inline static Float4 Sqrt( Float4 a_A )                             { return Each( a_A, a_A, []( float a, float ) { return Math::Sqrt( a ); } ); }
+		inline static Float4 Abs( Float4 a_A )                              { return Each( a_A, a_A, []( float a, float ) { return Math::Abs( a ); } ); }
+		inline static Float4 Select( Float4 a_Mask, Float4 a_A, Float4 a_B ) { return ( a_Mask & a_A ) | AndNot( a_Mask, a_B ); }
+		inline static Float4 FromMask( int a_Mask )                         { Float4 Result; for ( int i = 0; i < 4; ++i ) Result.Value[ i ] = Lane( ( a_Mask >> i ) & 1 ); return Result; }
+
+		template < typename _Function >
+		inline static Float4 Each( Float4 a_A, Float4 a_B, const _Function& a_Function )
+		{
+			Float4 Result;
+
+			for ( int i = 0; i < 4; ++i )
+			{
+				Result.Value[ i ] = a_Function( a_A.Value[ i ], a_B.Value[ i ] );
+			}
+
+			return Result;
+		}
+
+		inline static uint32_t Bits( float a_Value )  { uint32_t Result; std::memcpy( &Result, &a_Value, sizeof( Result ) ); return Result; }
+		inline static float Float( uint32_t a_Bits )  { float Result; std::memcpy( &Result, &a_Bits, sizeof( Result ) ); return Result; }
+		inline static float Lane( bool a_Set )        { return Float( a_Set ? ~0u : 0u ); }
+#endif
+	};
+
+	struct Bounds
+	{
+		Vector3 Min;
+		Vector3 Max;
+
+		static Bounds Empty()
+		{
+			float Large = std::numeric_limits< float >::max();
+			return { Vector3( Large, Large, Large ), Vector3( -Large, -Large, -Large ) };
+		}
+
+		inline void Grow( const Vector3& a_Point )
+		{
+			for ( int Axis = 0; Axis < 3; ++Axis )
+			{
+				Min[ Axis ] = Math::Min( Min[ Axis ], a_Point[ Axis ] );
+				Max[ Axis ] = Math::Max( Max[ Axis ], a_Point[ Axis ] );
+			}
+		}
+
+		inline void Grow( const Bounds& a_Bounds )
+		{
+			Grow( a_Bounds.Min );
+			Grow( a_Bounds.Max );
+		}
+
+		// Half the surface area, the constant doesn't matter for comparing splits.
+		inline float Area() const
+		{
+			Vector3 Extent = Max - Min;
+			return Extent.x < 0.0f ? 0.0f : Extent.x * Extent.y + Extent.y * Extent.z + Extent.z * Extent.x;
+		}
+	};
+
+	struct Node
+	{
+		Vector3  Min;
+		uint32_t First; // First entry of a leaf in Order, otherwise the left child with the right one after it.
+		Vector3  Max;
+		uint32_t Count; // Zero for inner nodes.
+	};
+
+	// Leaves hold a range of Order, which indexes the primitives the hierarchy was built from.
+	struct Hierarchy
+	{
+		std::vector< Node >     Nodes;
+		std::vector< uint32_t > Order;
+	};
+
+	// Edges are stored rather than the other corners, it's what the intersection test wants.
+	struct Triangle
+	{
+		Vector3  Corner;
+		Vector3  Edge1;
+		Vector3  Edge2;
+		uint32_t Index; // First of its three entries in the mesh's index array.
+	};
+
+	// A mesh's triangles in object space, in the order the leaves of its hierarchy reference them.
+	struct MeshTree
+	{
+		Hierarchy               Tree;
+		std::vector< Triangle > Triangles;
+		uint32_t                IndexCount;
+		uint32_t                VertexCount;
+		uint32_t                Revision;
+		bool                    Used;
+	};
+
+	// What the shaders would read from a material.
+	struct Surface
+	{
+		Vector4          Colour;
+		const Texture2D* Diffuse;
+		float            Reflectivity;
+		bool             Lit;
+	};
+
+	struct Instance
+	{
+		const Mesh*     SourceMesh;
+		const MeshTree* Geometry;
+		Matrix4         Model;
+		Matrix4         InverseModel;
+		uint32_t        Layer;
+		uint32_t        SurfaceIndex;
+	};
+
+	struct RayPacket
+	{
+		Float4 Origin[ 3 ];
+		Float4 Direction[ 3 ];
+		Float4 Inverse[ 3 ];
+		Float4 Distance; // Hits further away are ignored, shortened by every hit found.
+		Float4 Active;
+	};
+
+	struct PacketHit
+	{
+		Float4   U;
+		Float4   V;
+		uint32_t Instance[ 4 ];
+		uint32_t Triangle[ 4 ];
+	};
+
+	static constexpr uint32_t _Miss = ~0u;
+	static constexpr uint32_t _MaxDepth = 48;
+	static constexpr uint32_t _BinCount = 12;
+	static constexpr float    _Offset = 0.001f;
+
+	// Builds the top level hierarchy over every draw in the queue, building hierarchies for meshes seen for the first time.
+	static void Build( const RenderQueue& a_Queue )
+	{
+		s_Instances.clear();
+		s_Surfaces.clear();
+		s_SurfaceIndices.clear();
+		s_TriangleCount = 0;
+
+		for ( auto& Entry : s_Meshes )
+		{
+			Entry.second.Used = false;
+		}
+
+		const Mesh* ActiveMesh = nullptr;
+		const Material* ActiveMaterial = nullptr;
+		const Matrix4* ActiveModel = nullptr;
+		uint32_t Layer = 0;
+		RenderMode Mode = RenderMode::TRIANGLE;
+
+		for ( auto& Instruction : a_Queue.m_RenderInstructions )
+		{
+			if ( Instruction.Modification == RenderInstruction::Modification::SET )
+			{
+				switch ( Instruction.Object )
+				{
+					case RenderInstruction::Object::Mesh:     ActiveMesh = static_cast< const Mesh* >( Instruction.ResourceSource );         break;
+					case RenderInstruction::Object::Material: ActiveMaterial = static_cast< const Material* >( Instruction.ResourceSource ); break;
+					case RenderInstruction::Object::Model:    ActiveModel = static_cast< const Matrix4* >( Instruction.ResourceSource );     break;
+					case RenderInstruction::Object::Layer:    Layer = Instruction.Index;                                                   break;
+					case RenderInstruction::Object::RenderMode: Mode = static_cast< RenderMode >( Instruction.Index );                       break;
+					default: break;
+				}
+
+				continue;
+			}
+
+			if ( Instruction.Modification != RenderInstruction::Modification::DRAW )
+			{
+				continue;
+			}
+
+			// Points and lines have no surface to hit.
+			if ( Mode == RenderMode::TRIANGLE && ActiveMesh && ActiveMaterial && ActiveMesh->HasPositions() && ActiveMesh->GetIndexCount() >= 3 )
+			{
+				Instance New;
+				New.SourceMesh = ActiveMesh;
+				New.Geometry = &GetMeshTree( *ActiveMesh );
+				New.Model = ActiveModel ? *ActiveModel : Matrix4::Identity;
+				New.InverseModel = Math::Inverse( New.Model );
+				New.Layer = Layer;
+				New.SurfaceIndex = GetSurface( *ActiveMaterial );
+
+				if ( !New.Geometry->Tree.Nodes.empty() )
+				{
+					s_Instances.push_back( New );
+					s_TriangleCount += New.Geometry->Triangles.size();
+				}
+			}
+
+			Layer = 0;
+			Mode = RenderMode::TRIANGLE;
+		}
+
+		// Meshes that weren't drawn may be gone, their addresses reused.
+		for ( auto Begin = s_Meshes.begin(); Begin != s_Meshes.end(); )
+		{
+			Begin = Begin->second.Used ? std::next( Begin ) : s_Meshes.erase( Begin );
+		}
+
+		std::vector< Bounds > InstanceBounds;
+		InstanceBounds.reserve( s_Instances.size() );
+
+		for ( const auto& Entry : s_Instances )
+		{
+			const Node& Root = Entry.Geometry->Tree.Nodes.front();
+			Bounds World = Bounds::Empty();
+
+			for ( uint32_t i = 0; i < 8; ++i )
+			{
+				Vector4 Corner = Math::Multiply( Entry.Model, Vector4(
+					( i & 1 ) ? Root.Max.x : Root.Min.x,
+					( i & 2 ) ? Root.Max.y : Root.Min.y,
+					( i & 4 ) ? Root.Max.z : Root.Min.z,
+					1.0f ) );
+				World.Grow( Vector3( Corner.x, Corner.y, Corner.z ) );
+			}
+
+			InstanceBounds.push_back( World );
+		}
+
+		BuildHierarchy( InstanceBounds, s_Top );
+	}
+
+	// Traces the camera's viewport into the bound draw framebuffer.
+	static void Render( const CameraBlock& a_Camera )
+	{
+		const RectInt& Viewport = a_Camera.Viewport;
+
+		if ( Viewport.Size.x <= 0 || Viewport.Size.y <= 0 )
+		{
+			return;
+		}
+
+		s_Pixels.resize( static_cast< size_t >( Viewport.Size.x ) * Viewport.Size.y );
+
+		if ( const Light* Sun = Light::GetSun() )
+		{
+			s_SunDirection = Sun->GetDirection();
+			s_HasSun = Math::LengthSqrd( s_SunDirection ) > 0.0f;
+			s_SunDirection = s_HasSun ? Math::Normalize( s_SunDirection ) : s_SunDirection;
+		}
+		else
+		{
+			s_HasSun = false;
+		}
+
+		Matrix4 InverseProjectionView = Math::Inverse( a_Camera.ProjectionView );
+		int32_t BlockRows = ( Viewport.Size.y + 1 ) / 2;
+
+		Parallel::For( 0, BlockRows, [ & ]( int32_t a_Begin, int32_t a_End )
+		{
+			for ( int32_t BlockY = a_Begin; BlockY < a_End; ++BlockY )
+			{
+				for ( int32_t BlockX = 0; BlockX < Viewport.Size.x; BlockX += 2 )
+				{
+					TraceBlock( a_Camera, InverseProjectionView, BlockX, BlockY * 2 );
+				}
+			}
+		} );
+
+		Rendering::DrawPixels( Viewport.Origin.x, Viewport.Origin.y, Viewport.Size.x, Viewport.Size.y, s_Pixels.data() );
+	}
+
+	// Pixel rows count down from the top like the rasterizer's, through pixel centres.
+	static void TraceBlock( const CameraBlock& a_Camera, const Matrix4& a_InverseProjectionView, int32_t a_X, int32_t a_Y )
+	{
+		Vector2Int Size = a_Camera.Viewport.Size;
+		float X[ 4 ], Y[ 4 ];
+		int Inside = 0;
+
+		for ( int Lane = 0; Lane < 4; ++Lane )
+		{
+			int32_t PixelX = a_X + ( Lane & 1 );
+			int32_t PixelY = a_Y + ( Lane >> 1 );
+			X[ Lane ] = ( PixelX + 0.5f ) / Size.x * 2.0f - 1.0f;
+			Y[ Lane ] = 1.0f - ( PixelY + 0.5f ) / Size.y * 2.0f;
+			Inside |= ( PixelX < Size.x && PixelY < Size.y ) << Lane;
+		}
+
+		// Points on the near and far planes give the ray.
+		const float* M = a_InverseProjectionView.Data;
+		Float4 NX = Float4::Load( X ), NY = Float4::Load( Y );
+		Float4 Near[ 4 ], Far[ 4 ];
+
+		for ( int Row = 0; Row < 4; ++Row )
+		{
+			Float4 Shared = NX * Float4( M[ Row * 4 + 0 ] ) + NY * Float4( M[ Row * 4 + 1 ] ) + Float4( M[ Row * 4 + 3 ] );
+			Near[ Row ] = Shared - Float4( M[ Row * 4 + 2 ] );
+			Far[ Row ] = Shared + Float4( M[ Row * 4 + 2 ] );
+		}
+
+		RayPacket Rays;
+
+		for ( int Axis = 0; Axis < 3; ++Axis )
+		{
+			Rays.Origin[ Axis ] = Near[ Axis ] / Near[ 3 ];
+			Rays.Direction[ Axis ] = Far[ Axis ] / Far[ 3 ] - Rays.Origin[ Axis ];
+		}
+
+		Normalize( Rays.Direction );
+		Rays.Distance = Float4( std::numeric_limits< float >::max() );
+		Rays.Active = Float4::FromMask( Inside );
+
+		Vector4 Colours[ 4 ];
+		Trace( Rays, a_Camera.LayerMask, 0, Colours );
+
+		for ( int Lane = 0; Lane < 4; ++Lane )
+		{
+			if ( Inside & ( 1 << Lane ) )
+			{
+				int32_t PixelX = a_X + ( Lane & 1 );
+				int32_t PixelY = a_Y + ( Lane >> 1 );
+				s_Pixels[ static_cast< size_t >( PixelY ) * Size.x + PixelX ] = Colour( Math::Clamp( Colours[ Lane ], 0.0f, 1.0f ) );
+			}
+		}
+	}
+
+	// Colours the active lanes of a_Rays in o_Colours, misses get the background.
+	static void Trace( RayPacket& a_Rays, uint32_t a_LayerMask, uint32_t a_Bounce, Vector4* o_Colours )
+	{
+		for ( int Axis = 0; Axis < 3; ++Axis )
+		{
+			a_Rays.Inverse[ Axis ] = Float4( 1.0f ) / a_Rays.Direction[ Axis ];
+		}
+
+		PacketHit Hit;
+		Hit.U = Float4( 0.0f );
+		Hit.V = Float4( 0.0f );
+		std::fill( Hit.Instance, Hit.Instance + 4, _Miss );
+		Intersect( a_Rays, Hit, a_LayerMask, false );
+
+		int Active = a_Rays.Active.Mask();
+		float U[ 4 ], V[ 4 ], Distance[ 4 ];
+		Hit.U.Store( U );
+		Hit.V.Store( V );
+		a_Rays.Distance.Store( Distance );
+
+		Vector3 Points[ 4 ], Normals[ 4 ];
+		float Reflectivity[ 4 ] = {};
+		int Lit = 0, Reflective = 0;
+
+		for ( int Lane = 0; Lane < 4; ++Lane )
+		{
+			if ( !( Active & ( 1 << Lane ) ) )
+			{
+				continue;
+			}
+
+			if ( Hit.Instance[ Lane ] == _Miss )
+			{
+				o_Colours[ Lane ] = s_Background;
+				continue;
+			}
+
+			const Instance& Target = s_Instances[ Hit.Instance[ Lane ] ];
+			const Surface& Properties = s_Surfaces[ Target.SurfaceIndex ];
+			const Mesh& Source = *Target.SourceMesh;
+			const uint32_t* Indices = Source.GetIndices() + Target.Geometry->Triangles[ Hit.Triangle[ Lane ] ].Index;
+			float W = 1.0f - U[ Lane ] - V[ Lane ];
+			Vector3 Direction = GetLane( a_Rays.Direction, Lane );
+
+			Points[ Lane ] = GetLane( a_Rays.Origin, Lane ) + Direction * Distance[ Lane ];
+
+			// Normals go through the model matrix as in the shaders, and face back along the ray.
+			Vector3 Normal;
+
+			if ( Source.HasNormals() )
+			{
+				const Vector3* Vertices = Source.GetNormals();
+				Normal = Vertices[ Indices[ 0 ] ] * W + Vertices[ Indices[ 1 ] ] * U[ Lane ] + Vertices[ Indices[ 2 ] ] * V[ Lane ];
+			}
+			else
+			{
+				const Triangle& Face = Target.Geometry->Triangles[ Hit.Triangle[ Lane ] ];
+				Normal = Math::Cross( Face.Edge1, Face.Edge2 );
+			}
+
+			Vector4 World = Math::Multiply( Target.Model, Vector4( Normal.x, Normal.y, Normal.z, 0.0f ) );
+			Normal = Vector3( World.x, World.y, World.z );
+			Normal = Math::LengthSqrd( Normal ) > 0.0f ? Math::Normalize( Normal ) : -Direction;
+			Normals[ Lane ] = Math::Dot( Normal, Direction ) > 0.0f ? -Normal : Normal;
+
+			Vector4 Albedo = Properties.Colour;
+
+			if ( Properties.Diffuse && Source.HasTexels() )
+			{
+				const Vector2* Texels = Source.GetTexels();
+				Albedo = Albedo * SampleTexture( *Properties.Diffuse, Texels[ Indices[ 0 ] ] * W + Texels[ Indices[ 1 ] ] * U[ Lane ] + Texels[ Indices[ 2 ] ] * V[ Lane ] );
+			}
+
+			if ( Source.HasColours() )
+			{
+				const Vector4* Colours = Source.GetColours();
+				Albedo = Albedo * ( Colours[ Indices[ 0 ] ] * W + Colours[ Indices[ 1 ] ] * U[ Lane ] + Colours[ Indices[ 2 ] ] * V[ Lane ] );
+			}
+
+			o_Colours[ Lane ] = Albedo;
+			Lit |= Properties.Lit << Lane;
+
+			if ( Properties.Reflectivity > 0.0f && a_Bounce < s_MaxBounces )
+			{
+				Reflectivity[ Lane ] = Properties.Reflectivity;
+				Reflective |= 1 << Lane;
+			}
+		}
+
+		if ( Lit )
+		{
+			ApplySun( Lit, Points, Normals, a_LayerMask, o_Colours );
+		}
+
+		if ( Reflective )
+		{
+			RayPacket Reflected;
+			float Origin[ 3 ][ 4 ] = {}, Direction[ 3 ][ 4 ] = {};
+
+			for ( int Lane = 0; Lane < 4; ++Lane )
+			{
+				if ( Reflective & ( 1 << Lane ) )
+				{
+					Vector3 Bounce = Math::Reflect( GetLane( a_Rays.Direction, Lane ), Normals[ Lane ] );
+
+					for ( int Axis = 0; Axis < 3; ++Axis )
+					{
+						Origin[ Axis ][ Lane ] = Points[ Lane ][ Axis ] + Normals[ Lane ][ Axis ] * _Offset;
+						Direction[ Axis ][ Lane ] = Bounce[ Axis ];
+					}
+				}
+			}
+
+			for ( int Axis = 0; Axis < 3; ++Axis )
+			{
+				Reflected.Origin[ Axis ] = Float4::Load( Origin[ Axis ] );
+				Reflected.Direction[ Axis ] = Float4::Load( Direction[ Axis ] );
+			}
+
+			Reflected.Distance = Float4( std::numeric_limits< float >::max() );
+			Reflected.Active = Float4::FromMask( Reflective );
+
+			Vector4 Colours[ 4 ];
+			Trace( Reflected, a_LayerMask, a_Bounce + 1, Colours );
+
+			for ( int Lane = 0; Lane < 4; ++Lane )
+			{
+				if ( Reflective & ( 1 << Lane ) )
+				{
+					float Alpha = o_Colours[ Lane ].w;
+					o_Colours[ Lane ] = Math::Lerp( Reflectivity[ Lane ], o_Colours[ Lane ], Colours[ Lane ] );
+					o_Colours[ Lane ].w = Alpha;
+				}
+			}
+		}
+	}
+
+	// The lit shaders' falloff, zero where a shadow ray towards the sun is blocked.
+	static void ApplySun( int a_Lanes, const Vector3* a_Points, const Vector3* a_Normals, uint32_t a_LayerMask, Vector4* io_Colours )
+	{
+		float Intensity[ 4 ] = {};
+		float Origin[ 3 ][ 4 ] = {};
+		int Facing = 0;
+
+		for ( int Lane = 0; Lane < 4; ++Lane )
+		{
+			if ( !( a_Lanes & ( 1 << Lane ) ) || !s_HasSun )
+			{
+				continue;
+			}
+
+			Intensity[ Lane ] = Math::Clamp( -Math::Dot( s_SunDirection, a_Normals[ Lane ] ), 0.0f, 1.0f );
+			Facing |= ( Intensity[ Lane ] > 0.0f ) << Lane;
+
+			for ( int Axis = 0; Axis < 3; ++Axis )
+			{
+				Origin[ Axis ][ Lane ] = a_Points[ Lane ][ Axis ] + a_Normals[ Lane ][ Axis ] * _Offset;
+			}
+		}
+
+		if ( Facing )
+		{
+			RayPacket Shadow;
+
+			for ( int Axis = 0; Axis < 3; ++Axis )
+			{
+				Shadow.Origin[ Axis ] = Float4::Load( Origin[ Axis ] );
+				Shadow.Direction[ Axis ] = Float4( -s_SunDirection[ Axis ] );
+				Shadow.Inverse[ Axis ] = Float4( 1.0f ) / Shadow.Direction[ Axis ];
+			}
+
+			Shadow.Distance = Float4( std::numeric_limits< float >::max() );
+			Shadow.Active = Float4::FromMask( Facing );
+
+			PacketHit Ignored;
+			Intersect( Shadow, Ignored, a_LayerMask, true );
+
+			// Lanes still active found nothing in the way.
+			Facing &= Shadow.Active.Mask();
+		}
+
+		for ( int Lane = 0; Lane < 4; ++Lane )
+		{
+			if ( a_Lanes & ( 1 << Lane ) )
+			{
+				float Amount = ( Facing & ( 1 << Lane ) ) ? Intensity[ Lane ] : 0.0f;
+				io_Colours[ Lane ].x *= Amount;
+				io_Colours[ Lane ].y *= Amount;
+				io_Colours[ Lane ].z *= Amount;
+			}
+		}
+	}
+
+	// Finds the closest hit of every active lane. With a_AnyHit lanes are deactivated by the first hit instead,
+	// and the search stops once none are left.
+	static void Intersect( RayPacket& a_Rays, PacketHit& o_Hit, uint32_t a_LayerMask, bool a_AnyHit )
+	{
+		if ( s_Top.Nodes.empty() )
+		{
+			return;
+		}
+
+		uint32_t Stack[ _MaxDepth + 2 ];
+		uint32_t Depth = 0;
+		Stack[ Depth++ ] = 0;
+
+		while ( Depth > 0 )
+		{
+			const Node& Current = s_Top.Nodes[ Stack[ --Depth ] ];
+
+			if ( !IntersectBounds( Current, a_Rays ).Mask() )
+			{
+				continue;
+			}
+
+			if ( Current.Count == 0 )
+			{
+				Stack[ Depth++ ] = Current.First + 1;
+				Stack[ Depth++ ] = Current.First;
+				continue;
+			}
+
+			for ( uint32_t i = Current.First; i < Current.First + Current.Count; ++i )
+			{
+				uint32_t Index = s_Top.Order[ i ];
+				const Instance& Target = s_Instances[ Index ];
+
+				if ( !( a_LayerMask & ( 1u << Target.Layer ) ) )
+				{
+					continue;
+				}
+
+				IntersectInstance( Target, Index, a_Rays, o_Hit, a_AnyHit );
+
+				if ( a_AnyHit && !a_Rays.Active.Mask() )
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	// Rays go into the mesh's space rather than the mesh into the world. Directions aren't normalized there,
+	// so distances along them stay the same.
+	static void IntersectInstance( const Instance& a_Instance, uint32_t a_Index, RayPacket& a_Rays, PacketHit& o_Hit, bool a_AnyHit )
+	{
+		const float* M = a_Instance.InverseModel.Data;
+		RayPacket Local;
+
+		for ( int Row = 0; Row < 3; ++Row )
+		{
+			Float4 X( M[ Row * 4 + 0 ] ), Y( M[ Row * 4 + 1 ] ), Z( M[ Row * 4 + 2 ] );
+			Local.Origin[ Row ] = a_Rays.Origin[ 0 ] * X + a_Rays.Origin[ 1 ] * Y + a_Rays.Origin[ 2 ] * Z + Float4( M[ Row * 4 + 3 ] );
+			Local.Direction[ Row ] = a_Rays.Direction[ 0 ] * X + a_Rays.Direction[ 1 ] * Y + a_Rays.Direction[ 2 ] * Z;
+			Local.Inverse[ Row ] = Float4( 1.0f ) / Local.Direction[ Row ];
+		}
+
+		Local.Distance = a_Rays.Distance;
+		Local.Active = a_Rays.Active;
+
+		const Hierarchy& Tree = a_Instance.Geometry->Tree;
+		const Triangle* Triangles = a_Instance.Geometry->Triangles.data();
+		uint32_t Stack[ _MaxDepth + 2 ];
+		uint32_t Depth = 0;
+		Stack[ Depth++ ] = 0;
+
+		while ( Depth > 0 )
+		{
+			const Node& Current = Tree.Nodes[ Stack[ --Depth ] ];
+
+			if ( !IntersectBounds( Current, Local ).Mask() )
+			{
+				continue;
+			}
+
+			if ( Current.Count == 0 )
+			{
+				Stack[ Depth++ ] = Current.First + 1;
+				Stack[ Depth++ ] = Current.First;
+				continue;
+			}
+
+			for ( uint32_t i = Current.First; i < Current.First + Current.Count; ++i )
+			{
+				IntersectTriangle( Triangles[ i ], i, a_Index, Local, o_Hit, a_AnyHit );
+			}
+
+			if ( a_AnyHit && !Local.Active.Mask() )
+			{
+				break;
+			}
+		}
+
+		a_Rays.Distance = Local.Distance;
+		a_Rays.Active = Local.Active;
+	}
+
+	// Slab test, lanes whose ray enters the box before their closest hit so far.
+	inline static Float4 IntersectBounds( const Node& a_Node, const RayPacket& a_Rays )
+	{
+		Float4 Near( 0.0f );
+		Float4 Far = a_Rays.Distance;
+
+		for ( int Axis = 0; Axis < 3; ++Axis )
+		{
+			Float4 T0 = ( Float4( a_Node.Min[ Axis ] ) - a_Rays.Origin[ Axis ] ) * a_Rays.Inverse[ Axis ];
+			Float4 T1 = ( Float4( a_Node.Max[ Axis ] ) - a_Rays.Origin[ Axis ] ) * a_Rays.Inverse[ Axis ];
+			Near = Float4::Max( Near, Float4::Min( T0, T1 ) );
+			Far = Float4::Min( Far, Float4::Max( T0, T1 ) );
+		}
+
+		return ( Near <= Far ) & a_Rays.Active;
+	}
+
+	// Moller-Trumbore against all four rays at once. Triangles are two sided.
+	inline static void IntersectTriangle( const Triangle& a_Triangle, uint32_t a_TriangleIndex, uint32_t a_InstanceIndex, RayPacket& io_Rays, PacketHit& o_Hit, bool a_AnyHit )
+	{
+		const Float4* D = io_Rays.Direction;
+		Float4 E1[ 3 ] = { a_Triangle.Edge1.x, a_Triangle.Edge1.y, a_Triangle.Edge1.z };
+		Float4 E2[ 3 ] = { a_Triangle.Edge2.x, a_Triangle.Edge2.y, a_Triangle.Edge2.z };
+
+		Float4 P[ 3 ] = {
+			D[ 1 ] * E2[ 2 ] - D[ 2 ] * E2[ 1 ],
+			D[ 2 ] * E2[ 0 ] - D[ 0 ] * E2[ 2 ],
+			D[ 0 ] * E2[ 1 ] - D[ 1 ] * E2[ 0 ] };
+		Float4 Determinant = E1[ 0 ] * P[ 0 ] + E1[ 1 ] * P[ 1 ] + E1[ 2 ] * P[ 2 ];
+		Float4 InverseDeterminant = Float4( 1.0f ) / Determinant;
+
+		Float4 T[ 3 ] = {
+			io_Rays.Origin[ 0 ] - Float4( a_Triangle.Corner.x ),
+			io_Rays.Origin[ 1 ] - Float4( a_Triangle.Corner.y ),
+			io_Rays.Origin[ 2 ] - Float4( a_Triangle.Corner.z ) };
+		Float4 U = ( T[ 0 ] * P[ 0 ] + T[ 1 ] * P[ 1 ] + T[ 2 ] * P[ 2 ] ) * InverseDeterminant;
+
+		Float4 Q[ 3 ] = {
+			T[ 1 ] * E1[ 2 ] - T[ 2 ] * E1[ 1 ],
+			T[ 2 ] * E1[ 0 ] - T[ 0 ] * E1[ 2 ],
+			T[ 0 ] * E1[ 1 ] - T[ 1 ] * E1[ 0 ] };
+		Float4 V = ( D[ 0 ] * Q[ 0 ] + D[ 1 ] * Q[ 1 ] + D[ 2 ] * Q[ 2 ] ) * InverseDeterminant;
+		Float4 Distance = ( E2[ 0 ] * Q[ 0 ] + E2[ 1 ] * Q[ 1 ] + E2[ 2 ] * Q[ 2 ] ) * InverseDeterminant;
+
+		Float4 Hit = io_Rays.Active &
+			( Float4::Abs( Determinant ) > Float4( 1e-12f ) ) &
+			( U >= Float4( 0.0f ) ) & ( V >= Float4( 0.0f ) ) & ( U + V <= Float4( 1.0f ) ) &
+			( Distance > Float4( 0.0f ) ) & ( Distance < io_Rays.Distance );
+		int Mask = Hit.Mask();
+
+		if ( !Mask )
+		{
+			return;
+		}
+
+		if ( a_AnyHit )
+		{
+			io_Rays.Active = Float4::AndNot( Hit, io_Rays.Active );
+			return;
+		}
+
+		io_Rays.Distance = Float4::Select( Hit, Distance, io_Rays.Distance );
+		o_Hit.U = Float4::Select( Hit, U, o_Hit.U );
+		o_Hit.V = Float4::Select( Hit, V, o_Hit.V );
+
+		for ( int Lane = 0; Lane < 4; ++Lane )
+		{
+			if ( Mask & ( 1 << Lane ) )
+			{
+				o_Hit.Instance[ Lane ] = a_InstanceIndex;
+				o_Hit.Triangle[ Lane ] = a_TriangleIndex;
+			}
+		}
+	}
+
+	inline static void Normalize( Float4* io_Vector )
+	{
+		Float4 Length = Float4::Sqrt( io_Vector[ 0 ] * io_Vector[ 0 ] + io_Vector[ 1 ] * io_Vector[ 1 ] + io_Vector[ 2 ] * io_Vector[ 2 ] );
+
+		for ( int Axis = 0; Axis < 3; ++Axis )
+		{
+			io_Vector[ Axis ] = io_Vector[ Axis ] / Length;
+		}
+	}
+
+	inline static Vector3 GetLane( const Float4* a_Vector, int a_Lane )
+	{
+		float Values[ 3 ][ 4 ];
+
+		for ( int Axis = 0; Axis < 3; ++Axis )
+		{
+			a_Vector[ Axis ].Store( Values[ Axis ] );
+		}
+
+		return Vector3( Values[ 0 ][ a_Lane ], Values[ 1 ][ a_Lane ], Values[ 2 ][ a_Lane ] );
+	}
+
+	// Nearest texel, wrapping like the rasterizer's REPEAT.
+	static Vector4 SampleTexture( const Texture2D& a_Texture, Vector2 a_UV )
+	{
+		if ( a_Texture.GetWidth() <= 0 || a_Texture.GetHeight() <= 0 || !a_Texture.GetData() )
+		{
+			return Vector4::One;
+		}
+
+		a_UV = { a_UV.x - Math::Floor( a_UV.x ), a_UV.y - Math::Floor( a_UV.y ) };
+		int32_t X = Math::Clamp( static_cast< int32_t >( ( a_Texture.GetWidth() - 1 ) * a_UV.x ), 0, a_Texture.GetWidth() - 1 );
+		int32_t Y = Math::Clamp( static_cast< int32_t >( ( a_Texture.GetHeight() - 1 ) * a_UV.y ), 0, a_Texture.GetHeight() - 1 );
+		Colour Texel = a_Texture.GetData()[ Y * a_Texture.GetWidth() + X ];
+		return Vector4( Texel.R, Texel.G, Texel.B, Texel.A ) * ( 1.0f / 255.0f );
+	}
+
+	// Surfaces are read once per material per frame, on the main thread, so lighting can ask the shader for u_SunLight.
+	static uint32_t GetSurface( const Material& a_Material )
+	{
+		auto Where = s_SurfaceIndices.find( &a_Material );
+
+		if ( Where != s_SurfaceIndices.end() )
+		{
+			return Where->second;
+		}
+
+		Surface New;
+		New.Colour = Vector4::One;
+		New.Diffuse = nullptr;
+		New.Reflectivity = 0.0f;
+		a_Material.GetProperty( "diffuse_colour"_N, New.Colour );
+		a_Material.GetProperty( "reflectivity"_N, New.Reflectivity );
+		New.Reflectivity = Math::Clamp( New.Reflectivity, 0.0f, 1.0f );
+
+		if ( a_Material.HasTexture( "texture_diffuse"_N ) )
+		{
+			auto Texture = a_Material.GetTexture( "texture_diffuse"_N );
+			New.Diffuse = Texture.IsLoaded() ? Texture.Get() : nullptr;
+		}
+
+		Shader& Program = const_cast< Shader& >( a_Material.GetShader() );
+		Program.Compile();
+		New.Lit = Rendering::GetUniformLocation( Program.GetProgramHandle(), "u_SunLight" ) >= 0;
+
+		s_Surfaces.push_back( New );
+		uint32_t Index = static_cast< uint32_t >( s_Surfaces.size() - 1 );
+		s_SurfaceIndices.emplace( &a_Material, Index );
+		return Index;
+	}
+
+	static MeshTree& GetMeshTree( const Mesh& a_Mesh )
+	{
+		MeshTree& Entry = s_Meshes[ &a_Mesh ];
+
+		if ( Entry.Tree.Nodes.empty() || Entry.IndexCount != a_Mesh.GetIndexCount() || Entry.VertexCount != a_Mesh.GetVertexCount() || Entry.Revision != a_Mesh.GetRevision() )
+		{
+			Entry.IndexCount = a_Mesh.GetIndexCount();
+			Entry.VertexCount = a_Mesh.GetVertexCount();
+			Entry.Revision = a_Mesh.GetRevision();
+
+			const Vector3* Positions = a_Mesh.GetPositions();
+			const uint32_t* Indices = a_Mesh.GetIndices();
+			std::vector< Triangle > Triangles;
+			std::vector< Bounds > TriangleBounds;
+
+			for ( uint32_t i = 0; i + 2 < Entry.IndexCount; i += 3 )
+			{
+				const Vector3& A = Positions[ Indices[ i ] ];
+				const Vector3& B = Positions[ Indices[ i + 1 ] ];
+				const Vector3& C = Positions[ Indices[ i + 2 ] ];
+				Triangles.push_back( { A, B - A, C - A, i } );
+
+				Bounds Box = Bounds::Empty();
+				Box.Grow( A );
+				Box.Grow( B );
+				Box.Grow( C );
+				TriangleBounds.push_back( Box );
+			}
+
+			BuildHierarchy( TriangleBounds, Entry.Tree );
+
+			// Leaves then reference contiguous triangles.
+			Entry.Triangles.resize( Triangles.size() );
+
+			for ( size_t i = 0; i < Entry.Tree.Order.size(); ++i )
+			{
+				Entry.Triangles[ i ] = Triangles[ Entry.Tree.Order[ i ] ];
+			}
+		}
+
+		Entry.Used = true;
+		return Entry;
+	}
+
+	static void BuildHierarchy( const std::vector< Bounds >& a_Primitives, Hierarchy& o_Tree )
+	{
+		uint32_t Count = static_cast< uint32_t >( a_Primitives.size() );
+		o_Tree.Nodes.clear();
+		o_Tree.Order.resize( Count );
+		std::iota( o_Tree.Order.begin(), o_Tree.Order.end(), 0u );
+
+		if ( Count == 0 )
+		{
+			return;
+		}
+
+		// A binary tree over n leaves never has more than 2n - 1 nodes, so references into it stay valid.
+		o_Tree.Nodes.reserve( Count * 2 );
+		o_Tree.Nodes.push_back( { Vector3::Zero, 0, Vector3::Zero, Count } );
+		Subdivide( a_Primitives, o_Tree, 0, 0 );
+	}
+
+	// Binned surface area heuristic, a node stays a leaf when no split is cheaper than testing everything in it.
+	static void Subdivide( const std::vector< Bounds >& a_Primitives, Hierarchy& io_Tree, uint32_t a_NodeIndex, uint32_t a_Depth )
+	{
+		Node& Current = io_Tree.Nodes[ a_NodeIndex ];
+		Bounds Box = Bounds::Empty();
+		Bounds Centres = Bounds::Empty();
+
+		for ( uint32_t i = Current.First; i < Current.First + Current.Count; ++i )
+		{
+			const Bounds& Primitive = a_Primitives[ io_Tree.Order[ i ] ];
+			Box.Grow( Primitive );
+			Centres.Grow( ( Primitive.Min + Primitive.Max ) * 0.5f );
+		}
+
+		Current.Min = Box.Min;
+		Current.Max = Box.Max;
+
+		if ( Current.Count <= 2 || a_Depth >= _MaxDepth )
+		{
+			return;
+		}
+
+		struct Bin
+		{
+			Bounds   Box = Bounds::Empty();
+			uint32_t Count = 0;
+		};
+
+		float BestCost = Box.Area() * Current.Count;
+		int32_t BestAxis = -1;
+		uint32_t BestSplit = 0;
+
+		for ( int32_t Axis = 0; Axis < 3; ++Axis )
+		{
+			float Extent = Centres.Max[ Axis ] - Centres.Min[ Axis ];
+
+			if ( Extent <= 0.0f )
+			{
+				continue;
+			}
+
+			Bin Bins[ _BinCount ];
+			float Scale = _BinCount / Extent;
+
+			for ( uint32_t i = Current.First; i < Current.First + Current.Count; ++i )
+			{
+				const Bounds& Primitive = a_Primitives[ io_Tree.Order[ i ] ];
+				uint32_t Index = Math::Min( static_cast< uint32_t >( ( ( Primitive.Min[ Axis ] + Primitive.Max[ Axis ] ) * 0.5f - Centres.Min[ Axis ] ) * Scale ), _BinCount - 1 );
+				Bins[ Index ].Box.Grow( Primitive );
+				++Bins[ Index ].Count;
+			}
+
+			// Sweep from both ends for the cost of splitting after every bin.
+			float LeftArea[ _BinCount - 1 ], RightArea[ _BinCount - 1 ];
+			uint32_t LeftCount[ _BinCount - 1 ], RightCount[ _BinCount - 1 ];
+			Bounds Left = Bounds::Empty(), Right = Bounds::Empty();
+			uint32_t LeftSum = 0, RightSum = 0;
+
+			for ( uint32_t i = 0; i < _BinCount - 1; ++i )
+			{
+				LeftSum += Bins[ i ].Count;
+				Left.Grow( Bins[ i ].Box );
+				LeftCount[ i ] = LeftSum;
+				LeftArea[ i ] = Left.Area();
+
+				RightSum += Bins[ _BinCount - 1 - i ].Count;
+				Right.Grow( Bins[ _BinCount - 1 - i ].Box );
+				RightCount[ _BinCount - 2 - i ] = RightSum;
+				RightArea[ _BinCount - 2 - i ] = Right.Area();
+			}
+
+			for ( uint32_t i = 0; i < _BinCount - 1; ++i )
+			{
+				if ( LeftCount[ i ] == 0 || RightCount[ i ] == 0 )
+				{
+					continue;
+				}
+
+				float Cost = LeftCount[ i ] * LeftArea[ i ] + RightCount[ i ] * RightArea[ i ];
+
+				if ( Cost < BestCost )
+				{
+					BestCost = Cost;
+					BestAxis = Axis;
+					BestSplit = i + 1;
+				}
+			}
+		}
+
+		if ( BestAxis < 0 )
+		{
+			return;
+		}
+
+		float Scale = _BinCount / ( Centres.Max[ BestAxis ] - Centres.Min[ BestAxis ] );
+		auto Begin = io_Tree.Order.begin() + Current.First;
+		auto Middle = std::partition( Begin, Begin + Current.Count, [ & ]( uint32_t a_Index )
+		{
+			const Bounds& Primitive = a_Primitives[ a_Index ];
+			uint32_t Index = Math::Min( static_cast< uint32_t >( ( ( Primitive.Min[ BestAxis ] + Primitive.Max[ BestAxis ] ) * 0.5f - Centres.Min[ BestAxis ] ) * Scale ), _BinCount - 1 );
+			return Index < BestSplit;
+		} );
+
+		uint32_t LeftCount = static_cast< uint32_t >( Middle - Begin );
+		uint32_t Children = static_cast< uint32_t >( io_Tree.Nodes.size() );
+		io_Tree.Nodes.push_back( { Vector3::Zero, Current.First, Vector3::Zero, LeftCount } );
+		io_Tree.Nodes.push_back( { Vector3::Zero, Current.First + LeftCount, Vector3::Zero, Current.Count - LeftCount } );
+		Current.First = Children;
+		Current.Count = 0;
+
+		Subdivide( a_Primitives, io_Tree, Children, a_Depth + 1 );
+		Subdivide( a_Primitives, io_Tree, Children + 1, a_Depth + 1 );
+	}
+
+	inline static bool                                            s_Enabled = false;
+	inline static uint32_t                                        s_MaxBounces = 1;
+	inline static Vector4                                         s_Background = Vector4( 0.0f, 0.0f, 0.0f, 1.0f );
+	inline static std::unordered_map< const Mesh*, MeshTree >     s_Meshes;
+	inline static std::vector< Instance >                         s_Instances;
+	inline static std::vector< Surface >                          s_Surfaces;
+	inline static std::unordered_map< const Material*, uint32_t > s_SurfaceIndices;
+	inline static Hierarchy                                       s_Top;
+	inline static size_t                                          s_TriangleCount = 0;
+	inline static std::vector< Colour >                           s_Pixels;
+	inline static Vector3                                         s_SunDirection;
+	inline static bool                                            s_HasSun = false;
+};
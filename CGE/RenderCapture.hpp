@@ -0,0 +1,1304 @@
+#pragma once
+#include "Platform.hpp"
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <type_traits>
+#include "Hash.hpp"
+#include "Invoker.hpp"
+#include "Rendering.hpp"
+#include "ConsoleWindow.hpp"
+
+// Records the calls made to Rendering into a file, and plays them back in another process to time and inspect
+// each draw on its own. Begin writes the resources and state that are already live as the calls that would make
+// them, then every call that changes state is recorded, so a capture can start at any frame. Draws are recorded
+// for the frames asked for, along with the contents of the buffers they read. The file holds the game's handles,
+// the replay maps each one to the handle its own call gave out.
+class RenderCapture
+{
+public:
+
+	// Reads "CGER" in the file on little-endian machines, the only byte order captures are written or read in.
+	static constexpr uint32_t Magic   = 'C' | 'G' << 8 | 'E' << 16 | 'R' << 24;
+	static constexpr uint32_t Version = 2;
+
+	enum class Call : uint16_t
+	{
+		GEN_BUFFERS,
+		BIND_BUFFER,
+		DELETE_BUFFERS,
+		BUFFER_DATA,
+		BUFFER_CONTENTS,
+		GEN_VERTEX_ARRAYS,
+		BIND_VERTEX_ARRAY,
+		DELETE_VERTEX_ARRAYS,
+		ENABLE_VERTEX_ATTRIB_ARRAY,
+		DISABLE_VERTEX_ATTRIB_ARRAY,
+		VERTEX_ATTRIB_POINTER,
+		VERTEX_ATTRIB_DIVISOR,
+		FLUSH_VERTEX_CACHE,
+		USE_PROGRAM,
+		CLEAR,
+		CLEAR_COLOUR,
+		CLEAR_DEPTH,
+		DRAW_ARRAYS,
+		DRAW_ELEMENTS,
+		DRAW_ELEMENTS_INSTANCED,
+		ENABLE,
+		DISABLE,
+		CULL_FACE,
+		DEPTH_FUNC,
+		DEPTH_MASK,
+		SCISSOR,
+		VIEWPORT,
+		GEN_FRAMEBUFFERS,
+		BIND_FRAMEBUFFER,
+		DELETE_FRAMEBUFFERS,
+		FRAMEBUFFER_TEXTURE_2D,
+		BLIT_FRAMEBUFFER,
+		DRAW_PIXELS,
+		BLEND_FUNC,
+		BLEND_EQUATION,
+		ACTIVE_TEXTURE,
+		GEN_TEXTURES,
+		BIND_TEXTURE,
+		TEX_PARAMETER,
+		TEXTURE_PARAMETER,
+		TEX_IMAGE_2D,
+		CREATE_SHADER,
+		SHADER_SOURCE,
+		COMPILE_SHADER,
+		CREATE_PROGRAM,
+		ATTACH_SHADER,
+		LINK_PROGRAM,
+		DETACH_SHADER,
+		DELETE_SHADER,
+		DELETE_PROGRAM,
+		UNIFORM,
+		FRAME,
+		VERTEX_CACHE_TAG,
+		DELETE_TEXTURES,
+		TEXTURE_STATE,
+		BOUND_STATE
+	};
+
+	struct Header
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		int32_t  Width;  // Size of the window the frames were drawn to.
+		int32_t  Height;
+		uint32_t Frames; // Frames with draws in them.
+		uint32_t Reserved;
+	};
+
+	// What one draw, clear, blit or DrawPixels cost when replayed, and the state it ran with.
+	struct DrawRecord
+	{
+		uint32_t            Frame;
+		uint32_t            Index;   // Within the frame.
+		Call                Type;
+		uint32_t            Count;   // Vertices or indices, pixels for the others.
+		uint32_t            Instances;
+		ShaderProgramHandle Program; // Handles are the replay's.
+		ArrayHandle         Array;
+		FramebufferHandle   Target;
+		bool                DepthTest;
+		bool                CullFace;
+		bool                Blend;
+		bool                ScissorTest;
+		double              Milliseconds;
+		RenderStatistics    Statistics;
+	};
+
+	// Starts recording to a_Path. Frames before a_FirstFrame, counted from here, only have their state changes
+	// kept, draws are kept for the a_FrameCount frames that follow. The file is finished after the last one.
+	static bool Begin( const char* a_Path, uint32_t a_FirstFrame = 0, uint32_t a_FrameCount = 1 )
+	{
+		End();
+
+		if ( fopen_s( &s_File, a_Path, "wb" ) != 0 || !s_File )
+		{
+			s_File = nullptr;
+			return false;
+		}
+
+		Vector2Int Size = ConsoleWindow::GetCurrentContext()->GetSize();
+		Header FileHeader = { Magic, Version, Size.x, Size.y, a_FrameCount, 0 };
+		fwrite( &FileHeader, sizeof( FileHeader ), 1, s_File );
+
+		s_Frame = 0;
+		s_FirstFrame = a_FirstFrame;
+		s_LastFrame = a_FirstFrame + a_FrameCount;
+		s_BufferSums.fill( 0 );
+		RecordLiveResources();
+
+		if ( a_FirstFrame == 0 )
+		{
+			RecordUniforms();
+		}
+
+		return true;
+	}
+
+	static void End()
+	{
+		if ( s_File )
+		{
+			fclose( s_File );
+			s_File = nullptr;
+		}
+	}
+
+	inline static bool IsRecording()
+	{
+		return s_File != nullptr;
+	}
+
+	// Called once a frame has been swapped.
+	static void Tick()
+	{
+		if ( !s_File )
+		{
+			return;
+		}
+
+		if ( IsCapturingDraws() )
+		{
+			Record( Call::FRAME, s_Frame - s_FirstFrame );
+		}
+
+		if ( ++s_Frame == s_FirstFrame )
+		{
+			RecordUniforms();
+		}
+
+		if ( s_Frame >= s_LastFrame )
+		{
+			End();
+		}
+	}
+
+	static bool ReadHeader( const char* a_Path, Header& o_Header )
+	{
+		FILE* File = nullptr;
+
+		if ( fopen_s( &File, a_Path, "rb" ) != 0 || !File )
+		{
+			return false;
+		}
+
+		bool Read = fread( &o_Header, sizeof( o_Header ), 1, File ) == 1;
+		fclose( File );
+		return Read && o_Header.Magic == Magic && o_Header.Version == Version;
+	}
+
+	// Plays a capture back against the current window, which should be the size in its header, with Rendering
+	// initialised. a_OnDraw is told about each draw as it finishes, a_OnFrame about each frame once it is
+	// swapped. Shaders are found by name, so the replaying program links the same ones.
+	static bool Replay( const char* a_Path, const Action< const DrawRecord& >& a_OnDraw, const Action< uint32_t >& a_OnFrame = Action< uint32_t >() )
+	{
+		FILE* File = nullptr;
+
+		if ( fopen_s( &File, a_Path, "rb" ) != 0 || !File )
+		{
+			return false;
+		}
+
+		Header FileHeader;
+
+		if ( fread( &FileHeader, sizeof( FileHeader ), 1, File ) != 1 || FileHeader.Magic != Magic || FileHeader.Version != Version )
+		{
+			fclose( File );
+			return false;
+		}
+
+		// Replayed buffers and textures point in here, as they pointed at the game's memory when recorded.
+		std::array< std::vector< uint8_t >, 32 > Buffers;
+		std::array< std::vector< uint8_t >, 32 > Textures;
+		std::vector< uint8_t > Payload;
+		uint32_t Frame = 0;
+		uint32_t DrawIndex = 0;
+
+		Rendering::Enable( RenderSetting::DEBUG_COUNTERS );
+
+		// Times a_Draw and reports it.
+		auto Measure = [ & ]( Call a_Type, uint32_t a_Count, uint32_t a_Instances, auto&& a_Draw )
+		{
+			Rendering::ResetStatistics();
+			auto Start = std::chrono::steady_clock::now();
+			a_Draw();
+			auto Finish = std::chrono::steady_clock::now();
+
+			DrawRecord Record;
+			Record.Frame = Frame;
+			Record.Index = DrawIndex++;
+			Record.Type = a_Type;
+			Record.Count = a_Count;
+			Record.Instances = a_Instances;
+			Record.Program = Rendering::s_ActiveShaderProgram;
+			Record.Array = Rendering::s_ActiveArray;
+			Record.Target = Rendering::s_DrawFramebuffer;
+			Record.DepthTest = Rendering::s_RenderState.DepthTest;
+			Record.CullFace = Rendering::s_RenderState.CullFace;
+			Record.Blend = Rendering::s_RenderState.AlphaBlend;
+			Record.ScissorTest = Rendering::s_RenderState.ScissorTest;
+			Record.Milliseconds = std::chrono::duration< double, std::milli >( Finish - Start ).count();
+			Record.Statistics = Rendering::GetStatistics();
+			a_OnDraw.Invoke( Record );
+		};
+
+		// Recorded handles are looked up in the map of their kind. Deleted ones keep their entry, so a stale handle
+		// stays stale, and ones never created come out as zero.
+		HandleMap BufferMap = {}, ArrayMap = {}, TextureMap = {}, FramebufferMap = {}, ShaderMap = {}, ProgramMap = {};
+
+		auto Map = []( const HandleMap& a_Map, uint32_t a_Recorded )
+		{
+			return a_Recorded < a_Map.size() ? a_Map[ a_Recorded ] : 0u;
+		};
+
+		auto Remember = []( HandleMap& o_Map, uint32_t a_Recorded, uint32_t a_Replayed )
+		{
+			if ( a_Recorded < o_Map.size() )
+			{
+				o_Map[ a_Recorded ] = a_Replayed;
+			}
+		};
+
+		RecordHeader Entry;
+		size_t HeaderRead;
+
+		while ( ( HeaderRead = fread( &Entry, 1, sizeof( Entry ), File ) ) == sizeof( Entry ) )
+		{
+			Payload.resize( Entry.Size );
+			Reader In{ Payload.data(), Payload.data() + Payload.size() };
+
+			if ( Entry.Size && fread( Payload.data(), 1, Entry.Size, File ) != Entry.Size )
+			{
+				In.Failed = true;
+			}
+
+			switch ( Entry.Type )
+			{
+				case Call::GEN_BUFFERS:
+				case Call::GEN_VERTEX_ARRAYS:
+				case Call::GEN_FRAMEBUFFERS:
+				case Call::GEN_TEXTURES:
+				{
+					uint32_t Count = In.Read< uint32_t >();
+
+					if ( !In.Has( static_cast< size_t >( Count ) * sizeof( uint32_t ) ) )
+					{
+						break;
+					}
+
+					std::vector< uint32_t > Handles( Count );
+					HandleMap* Created;
+
+					switch ( Entry.Type )
+					{
+						case Call::GEN_BUFFERS:       Rendering::GenBuffers( Count, Handles.data() );      Created = &BufferMap;      break;
+						case Call::GEN_VERTEX_ARRAYS: Rendering::GenVertexArrays( Count, Handles.data() ); Created = &ArrayMap;       break;
+						case Call::GEN_FRAMEBUFFERS:  Rendering::GenFramebuffers( Count, Handles.data() ); Created = &FramebufferMap; break;
+						default:                      Rendering::GenTextures( Count, Handles.data() );     Created = &TextureMap;     break;
+					}
+
+					for ( uint32_t i = 0; i < Count; ++i )
+					{
+						Remember( *Created, In.Read< uint32_t >(), Handles[ i ] );
+					}
+
+					break;
+				}
+				case Call::DELETE_BUFFERS:
+				case Call::DELETE_VERTEX_ARRAYS:
+				case Call::DELETE_FRAMEBUFFERS:
+				case Call::DELETE_TEXTURES:
+				{
+					uint32_t Count = In.Read< uint32_t >();
+
+					if ( !In.Has( static_cast< size_t >( Count ) * sizeof( uint32_t ) ) )
+					{
+						break;
+					}
+
+					std::vector< uint32_t > Handles( Count );
+					const HandleMap& Deleted = Entry.Type == Call::DELETE_BUFFERS ? BufferMap : Entry.Type == Call::DELETE_VERTEX_ARRAYS ? ArrayMap : Entry.Type == Call::DELETE_TEXTURES ? TextureMap : FramebufferMap;
+
+					for ( uint32_t i = 0; i < Count; ++i )
+					{
+						Handles[ i ] = Map( Deleted, In.Read< uint32_t >() );
+					}
+
+					switch ( Entry.Type )
+					{
+						case Call::DELETE_BUFFERS:       Rendering::DeleteBuffers( Count, Handles.data() );      break;
+						case Call::DELETE_VERTEX_ARRAYS: Rendering::DeleteVertexArrays( Count, Handles.data() ); break;
+						case Call::DELETE_TEXTURES:      Rendering::DeleteTextures( Count, Handles.data() );     break;
+						default:                         Rendering::DeleteFramebuffers( Count, Handles.data() ); break;
+					}
+
+					break;
+				}
+				case Call::BIND_BUFFER:
+				{
+					BufferTarget Target = In.Read< BufferTarget >();
+					Rendering::BindBuffer( Target, Map( BufferMap, In.Read< BufferHandle >() ) );
+					break;
+				}
+				case Call::BUFFER_DATA:
+				{
+					BufferHandle Handle = Map( BufferMap, In.Read< BufferHandle >() );
+					uint64_t Size = In.Read< uint64_t >();
+					DataUsage Usage = In.Read< DataUsage >();
+
+					// Handles that didn't map to a replayed one have no storage slot.
+					if ( !Handle )
+					{
+						break;
+					}
+
+					auto& Storage = Buffers[ ( Handle - 1 ) % 32 ];
+					Storage.assign( Size, 0 );
+					Rendering::NamedBufferData( Handle, Size, Storage.data(), Usage );
+					break;
+				}
+				case Call::BUFFER_CONTENTS:
+				{
+					BufferHandle Handle = Map( BufferMap, In.Read< BufferHandle >() );
+					size_t Size;
+					const void* Data = In.ReadBytes( Size );
+
+					if ( !Handle )
+					{
+						break;
+					}
+
+					auto& Storage = Buffers[ ( Handle - 1 ) % 32 ];
+
+					if ( Storage.size() < Size )
+					{
+						Storage.resize( Size );
+						Rendering::NamedBufferData( Handle, Size, Storage.data(), DataUsage::STATIC );
+					}
+
+					memcpy( Storage.data(), Data, Size );
+					break;
+				}
+				case Call::BIND_VERTEX_ARRAY:           Rendering::BindVertexArray( Map( ArrayMap, In.Read< ArrayHandle >() ) ); break;
+				case Call::ENABLE_VERTEX_ATTRIB_ARRAY:  Rendering::EnableVertexAttribArray( In.Read< uint32_t >() );         break;
+				case Call::DISABLE_VERTEX_ATTRIB_ARRAY: Rendering::DisableVertexAttribArray( In.Read< uint32_t >() );        break;
+				case Call::VERTEX_ATTRIB_POINTER:
+				{
+					uint32_t Index = In.Read< uint32_t >();
+					uint32_t Size = In.Read< uint32_t >();
+					DataType Type = In.Read< DataType >();
+					bool Normalized = In.Read< bool >();
+					uint64_t Stride = In.Read< uint64_t >();
+					uint64_t Offset = In.Read< uint64_t >();
+					Rendering::VertexAttribPointer( Index, Size, Type, Normalized, Stride, reinterpret_cast< void* >( Offset ) );
+					break;
+				}
+				case Call::VERTEX_ATTRIB_DIVISOR:
+				{
+					uint32_t Index = In.Read< uint32_t >();
+					Rendering::VertexAttribDivisor( Index, In.Read< uint32_t >() );
+					break;
+				}
+				case Call::FLUSH_VERTEX_CACHE: Rendering::FlushVertexCache();                      break;
+				case Call::VERTEX_CACHE_TAG:   Rendering::VertexCacheTag( In.Read< uint64_t >() ); break;
+				case Call::USE_PROGRAM:        Rendering::UseProgram( Map( ProgramMap, In.Read< ShaderProgramHandle >() ) ); break;
+				case Call::CLEAR:
+				{
+					uint8_t Flags = In.Read< uint8_t >();
+					Vector2Int Size = ConsoleWindow::GetCurrentContext()->GetSize();
+					Measure( Entry.Type, static_cast< uint32_t >( Size.x ) * Size.y, 1, [ & ]() { Rendering::Clear( Flags ); } );
+					break;
+				}
+				case Call::CLEAR_COLOUR:
+				{
+					float Values[ 4 ];
+					In.ReadArray( Values );
+					Rendering::ClearColour( Values[ 0 ], Values[ 1 ], Values[ 2 ], Values[ 3 ] );
+					break;
+				}
+				case Call::CLEAR_DEPTH: Rendering::ClearDepth( In.Read< float >() ); break;
+				case Call::DRAW_ARRAYS:
+				{
+					RenderMode Mode = In.Read< RenderMode >();
+					uint32_t First = In.Read< uint32_t >();
+					uint32_t Count = In.Read< uint32_t >();
+					Measure( Entry.Type, Count, 1, [ & ]() { Rendering::DrawArrays( Mode, First, Count ); } );
+					break;
+				}
+				case Call::DRAW_ELEMENTS:
+				case Call::DRAW_ELEMENTS_INSTANCED:
+				{
+					RenderMode Mode = In.Read< RenderMode >();
+					uint32_t Count = In.Read< uint32_t >();
+					DataType Type = In.Read< DataType >();
+					uint64_t Offset = In.Read< uint64_t >();
+					uint32_t Instances = In.Read< uint32_t >();
+					size_t Size;
+					const void* ClientIndices = In.ReadBytes( Size );
+					const void* Indices = Size ? ClientIndices : reinterpret_cast< const void* >( Offset );
+
+					if ( In.Failed )
+					{
+						break;
+					}
+
+					Measure( Entry.Type, Count, Instances, [ & ]()
+					{
+						if ( Entry.Type == Call::DRAW_ELEMENTS )
+						{
+							Rendering::DrawElements( Mode, Count, Type, Indices );
+						}
+						else
+						{
+							Rendering::DrawElementsInstanced( Mode, Count, Type, Indices, Instances );
+						}
+					} );
+					break;
+				}
+				case Call::ENABLE: Rendering::Enable( In.Read< RenderSetting >() ); break;
+				case Call::DISABLE:
+				{
+					// The counters stay on, they are what the replay reports.
+					RenderSetting Setting = In.Read< RenderSetting >();
+
+					if ( Setting != RenderSetting::DEBUG_COUNTERS )
+					{
+						Rendering::Disable( Setting );
+					}
+
+					break;
+				}
+				case Call::CULL_FACE:  Rendering::CullFace( In.Read< CullFaceMode >() );    break;
+				case Call::DEPTH_FUNC: Rendering::DepthFunc( In.Read< TextureSetting >() ); break;
+				case Call::DEPTH_MASK: Rendering::DepthMask( In.Read< bool >() );           break;
+				case Call::SCISSOR:
+				case Call::VIEWPORT:
+				{
+					int32_t X = In.Read< int32_t >();
+					int32_t Y = In.Read< int32_t >();
+					uint32_t Width = In.Read< uint32_t >();
+					uint32_t Height = In.Read< uint32_t >();
+					( Entry.Type == Call::SCISSOR ? Rendering::Scissor : Rendering::Viewport )( X, Y, Width, Height );
+					break;
+				}
+				case Call::BIND_FRAMEBUFFER:
+				{
+					FramebufferTarget Target = In.Read< FramebufferTarget >();
+					Rendering::BindFramebuffer( Target, Map( FramebufferMap, In.Read< FramebufferHandle >() ) );
+					break;
+				}
+				case Call::FRAMEBUFFER_TEXTURE_2D:
+				{
+					FramebufferTarget Target = In.Read< FramebufferTarget >();
+					FramebufferAttachment Attachment = In.Read< FramebufferAttachment >();
+					TextureTarget Texturing = In.Read< TextureTarget >();
+					TextureHandle Texture = Map( TextureMap, In.Read< TextureHandle >() );
+					Rendering::FramebufferTexture2D( Target, Attachment, Texturing, Texture, In.Read< uint8_t >() );
+					break;
+				}
+				case Call::BLIT_FRAMEBUFFER:
+				{
+					int32_t Corners[ 8 ];
+					In.ReadArray( Corners );
+					uint8_t Mask = In.Read< uint8_t >();
+					TextureSetting Filter = In.Read< TextureSetting >();
+					uint32_t Area = static_cast< uint32_t >( std::abs( ( Corners[ 6 ] - Corners[ 4 ] ) * ( Corners[ 7 ] - Corners[ 5 ] ) ) );
+
+					Measure( Entry.Type, Area, 1, [ & ]()
+					{
+						Rendering::BlitFramebuffer( Corners[ 0 ], Corners[ 1 ], Corners[ 2 ], Corners[ 3 ], Corners[ 4 ], Corners[ 5 ], Corners[ 6 ], Corners[ 7 ], Mask, Filter );
+					} );
+					break;
+				}
+				case Call::DRAW_PIXELS:
+				{
+					int32_t Rectangle[ 4 ];
+					In.ReadArray( Rectangle );
+					size_t Size;
+					const Colour* Pixels = static_cast< const Colour* >( In.ReadBytes( Size ) );
+
+					Measure( Entry.Type, static_cast< uint32_t >( Size / sizeof( Colour ) ), 1, [ & ]()
+					{
+						Rendering::DrawPixels( Rectangle[ 0 ], Rectangle[ 1 ], Rectangle[ 2 ], Rectangle[ 3 ], Pixels );
+					} );
+					break;
+				}
+				case Call::BLEND_FUNC:
+				{
+					BlendFactor Source = In.Read< BlendFactor >();
+					Rendering::BlendFunc( Source, In.Read< BlendFactor >() );
+					break;
+				}
+				case Call::BLEND_EQUATION: Rendering::BlendEquation( In.Read< BlendEquation >() ); break;
+				case Call::ACTIVE_TEXTURE: Rendering::ActiveTexture( In.Read< uint32_t >() ); break;
+				case Call::BIND_TEXTURE:
+				{
+					TextureTarget Target = In.Read< TextureTarget >();
+					Rendering::BindTexture( Target, Map( TextureMap, In.Read< TextureHandle >() ) );
+					break;
+				}
+				case Call::TEX_PARAMETER:
+				case Call::TEXTURE_PARAMETER:
+				{
+					uint32_t Texture = In.Read< uint32_t >();
+					TextureParameter Parameter = In.Read< TextureParameter >();
+					char Kind = In.Read< char >();
+					uint32_t Values[ 4 ];
+					In.ReadArray( Values );
+
+					// Values go through the pointer overloads, which read four only for the parameters that have four.
+					if ( Entry.Type == Call::TEX_PARAMETER )
+					{
+						TextureTarget Target = static_cast< TextureTarget >( Texture );
+
+						switch ( Kind )
+						{
+							case 'f': Rendering::TexParameterfv( Target, Parameter, reinterpret_cast< const float* >( Values ) );   break;
+							case 'i': Rendering::TexParameteri( Target, Parameter, reinterpret_cast< const int32_t* >( Values ) );  break;
+							default:  Rendering::TexParameterui( Target, Parameter, Values );                                        break;
+						}
+					}
+					else
+					{
+						Texture = Map( TextureMap, Texture );
+
+						switch ( Kind )
+						{
+							case 'f': Rendering::TextureParameterfv( Texture, Parameter, reinterpret_cast< const float* >( Values ) );  break;
+							case 'i': Rendering::TextureParameteri( Texture, Parameter, reinterpret_cast< const int32_t* >( Values ) ); break;
+							default:  Rendering::TextureParameterui( Texture, Parameter, Values );                                       break;
+						}
+					}
+
+					break;
+				}
+				case Call::TEX_IMAGE_2D:
+				{
+					TextureTarget Target = In.Read< TextureTarget >();
+					uint8_t Level = In.Read< uint8_t >();
+					TextureFormat InternalFormat = In.Read< TextureFormat >();
+					int32_t Width = In.Read< int32_t >();
+					int32_t Height = In.Read< int32_t >();
+					int32_t Border = In.Read< int32_t >();
+					TextureFormat Format = In.Read< TextureFormat >();
+					TextureSetting Layout = In.Read< TextureSetting >();
+					size_t Size;
+					const void* Data = In.ReadBytes( Size );
+					TextureHandle Handle = Rendering::s_TextureUnits[ Rendering::s_ActiveTextureUnit ][ ( uint32_t )Target ];
+
+					if ( !Handle )
+					{
+						break;
+					}
+
+					auto& Storage = Textures[ ( Handle - 1 ) % 32 ];
+					Storage.assign( static_cast< const uint8_t* >( Data ), static_cast< const uint8_t* >( Data ) + Size );
+					Rendering::TexImage2D( Target, Level, InternalFormat, Width, Height, Border, Format, Layout, Size ? Storage.data() : nullptr );
+					break;
+				}
+				case Call::CREATE_SHADER:
+				{
+					ShaderType Type = In.Read< ShaderType >();
+					Remember( ShaderMap, In.Read< ShaderHandle >(), Rendering::CreateShader( Type ) );
+					break;
+				}
+				case Call::SHADER_SOURCE:
+				{
+					ShaderHandle Handle = Map( ShaderMap, In.Read< ShaderHandle >() );
+					Hash Name = In.Read< Hash >();
+					auto Where = Internal::ShaderFuncLookup::Value.find( Name );
+					const void* Source = Where != Internal::ShaderFuncLookup::Value.end() ? Where->second : nullptr;
+
+					if ( Name && !Source )
+					{
+						fprintf( stderr, "RenderCapture: shader %08X isn't linked into this program.\n", Name );
+					}
+
+					Rendering::ShaderSource( Handle, 1, &Source, nullptr );
+					break;
+				}
+				case Call::COMPILE_SHADER: Rendering::CompileShader( Map( ShaderMap, In.Read< ShaderHandle >() ) ); break;
+				case Call::CREATE_PROGRAM: Remember( ProgramMap, In.Read< ShaderProgramHandle >(), Rendering::CreateProgram() ); break;
+				case Call::ATTACH_SHADER:
+				case Call::DETACH_SHADER:
+				{
+					ShaderProgramHandle Program = Map( ProgramMap, In.Read< ShaderProgramHandle >() );
+					ShaderHandle Shader = Map( ShaderMap, In.Read< ShaderHandle >() );
+					( Entry.Type == Call::ATTACH_SHADER ? Rendering::AttachShader : Rendering::DetachShader )( Program, Shader );
+					break;
+				}
+				case Call::LINK_PROGRAM:   Rendering::LinkProgram( Map( ProgramMap, In.Read< ShaderProgramHandle >() ) );   break;
+				case Call::DELETE_SHADER:  Rendering::DeleteShader( Map( ShaderMap, In.Read< ShaderHandle >() ) );          break;
+				case Call::DELETE_PROGRAM: Rendering::DeleteProgram( Map( ProgramMap, In.Read< ShaderProgramHandle >() ) ); break;
+				case Call::UNIFORM:
+				{
+					ShaderProgramHandle Program = Map( ProgramMap, In.Read< ShaderProgramHandle >() );
+					uint32_t Location = In.Read< uint32_t >();
+					size_t Size;
+					const void* Value = In.ReadBytes( Size );
+
+					if ( !Rendering::s_ShaderProgramRegistry.Valid( Program ) )
+					{
+						break;
+					}
+
+					auto& Uniforms = Rendering::s_ShaderProgramRegistry[ Program ].m_Uniforms;
+
+					if ( Location < Uniforms.size() )
+					{
+						memcpy( Uniforms[ Location ], Value, Size );
+					}
+
+					break;
+				}
+				case Call::TEXTURE_STATE:
+				{
+					TextureHandle Handle = Map( TextureMap, In.Read< TextureHandle >() );
+					int8_t Target = In.Read< int8_t >();
+					Rendering::Texture State = In.Read< Rendering::Texture >();
+					size_t Size;
+					const uint8_t* Data = static_cast< const uint8_t* >( In.ReadBytes( Size ) );
+
+					if ( In.Failed || !Handle || !Rendering::s_TextureRegistry.Valid( Handle ) )
+					{
+						break;
+					}
+
+					if ( Target != -1 )
+					{
+						Rendering::s_TextureRegistry.Bind( static_cast< TextureTarget >( Target ), Handle );
+					}
+
+					auto& Storage = Textures[ ( Handle - 1 ) % 32 ];
+					Storage.assign( Data, Data + Size );
+					State.Data = Size ? Storage.data() : nullptr;
+					Rendering::s_TextureRegistry[ Handle ] = State;
+					break;
+				}
+				case Call::BOUND_STATE:
+				{
+					auto BufferTargets = In.Read< decltype( Rendering::s_BufferTargets ) >();
+					ArrayHandle Array = In.Read< ArrayHandle >();
+					ShaderProgramHandle Program = In.Read< ShaderProgramHandle >();
+					FramebufferHandle DrawTarget = In.Read< FramebufferHandle >();
+					FramebufferHandle ReadTarget = In.Read< FramebufferHandle >();
+					auto Units = In.Read< decltype( Rendering::s_TextureUnits ) >();
+					uint32_t ActiveUnit = In.Read< uint32_t >();
+					uint32_t ActiveTarget = In.Read< uint32_t >();
+
+					for ( uint32_t i = 0; i < BufferTargets.size(); ++i )
+					{
+						Rendering::BindBuffer( static_cast< BufferTarget >( i ), Map( BufferMap, BufferTargets[ i ] ) );
+					}
+
+					Rendering::BindVertexArray( Map( ArrayMap, Array ) );
+					Rendering::UseProgram( Map( ProgramMap, Program ) );
+					Rendering::BindFramebuffer( FramebufferTarget::DRAW_FRAMEBUFFER, Map( FramebufferMap, DrawTarget ) );
+					Rendering::BindFramebuffer( FramebufferTarget::READ_FRAMEBUFFER, Map( FramebufferMap, ReadTarget ) );
+
+					// Units are set directly, BindTexture files a handle under the target its texture was first bound to.
+					for ( uint32_t i = 0; i < Units.size(); ++i )
+					{
+						for ( uint32_t j = 0; j < Units[ i ].size(); ++j )
+						{
+							Rendering::s_TextureUnits[ i ][ j ] = Map( TextureMap, Units[ i ][ j ] );
+						}
+					}
+
+					Rendering::ActiveTexture( ActiveUnit );
+					Rendering::s_ActiveTextureTarget = ActiveTarget;
+					break;
+				}
+				case Call::FRAME:
+				{
+					ConsoleWindow::SwapBuffers( ConsoleWindow::GetCurrentContext() );
+					a_OnFrame.Invoke( Frame );
+					++Frame;
+					DrawIndex = 0;
+					break;
+				}
+				default:
+					In.Failed = true;
+					break;
+			}
+
+			if ( In.Failed )
+			{
+				fprintf( stderr, "RenderCapture: a record of type %u is cut short or unknown, replay stopped.\n", static_cast< uint32_t >( Entry.Type ) );
+				fclose( File );
+				return false;
+			}
+		}
+
+		// Only a file that ends between records was played in full.
+		bool Ended = HeaderRead == 0 && !ferror( File );
+		fclose( File );
+		return Ended;
+	}
+
+private:
+
+	friend class Rendering;
+
+	// Replayed handles by recorded handle, zero is never given out.
+	typedef std::array< uint32_t, 33 > HandleMap;
+
+	struct RecordHeader
+	{
+		Call     Type;
+		uint16_t Reserved;
+		uint32_t Size; // Bytes of arguments that follow.
+	};
+
+	// Memory written out as a size and its bytes.
+	struct Bytes
+	{
+		const void* Data;
+		size_t      Size;
+	};
+
+	// Reads one record's payload. Reading past its end gives zeros and sets Failed, which stops the replay once
+	// the record is done, so calls that can't take zeros check Failed first.
+	struct Reader
+	{
+		const uint8_t* Position;
+		const uint8_t* End;
+		bool           Failed = false;
+
+		// Whether a_Size more bytes are left, running out sets Failed.
+		bool Has( size_t a_Size )
+		{
+			if ( static_cast< size_t >( End - Position ) < a_Size )
+			{
+				Position = End;
+				Failed = true;
+				return false;
+			}
+
+			return true;
+		}
+
+		template < typename T >
+		T Read()
+		{
+			T Value{};
+
+			if ( Has( sizeof( T ) ) )
+			{
+				memcpy( &Value, Position, sizeof( T ) );
+				Position += sizeof( T );
+			}
+
+			return Value;
+		}
+
+		template < typename T, size_t N >
+		void ReadArray( T( &o_Values )[ N ] )
+		{
+			if ( Has( sizeof( o_Values ) ) )
+			{
+				memcpy( o_Values, Position, sizeof( o_Values ) );
+				Position += sizeof( o_Values );
+			}
+			else
+			{
+				memset( o_Values, 0, sizeof( o_Values ) );
+			}
+		}
+
+		const void* ReadBytes( size_t& o_Size )
+		{
+			uint64_t Size = Read< uint64_t >();
+			const void* Data = Position;
+			o_Size = 0;
+
+			if ( !Failed && Size <= static_cast< uint64_t >( End - Position ) )
+			{
+				o_Size = static_cast< size_t >( Size );
+				Position += o_Size;
+			}
+			else
+			{
+				Failed = true;
+			}
+
+			return Data;
+		}
+	};
+
+	inline static bool IsCapturingDraws()
+	{
+		return s_File && s_Frame >= s_FirstFrame && s_Frame < s_LastFrame;
+	}
+
+	template < typename T >
+	static void Write( const T& a_Value )
+	{
+		static_assert( std::is_trivially_copyable_v< T >, "Arguments are written as they are in memory." );
+		const uint8_t* Data = reinterpret_cast< const uint8_t* >( &a_Value );
+		s_Payload.insert( s_Payload.end(), Data, Data + sizeof( T ) );
+	}
+
+	static void Write( const Bytes& a_Bytes )
+	{
+		Write( static_cast< uint64_t >( a_Bytes.Data ? a_Bytes.Size : 0 ) );
+
+		if ( a_Bytes.Data )
+		{
+			const uint8_t* Data = static_cast< const uint8_t* >( a_Bytes.Data );
+			s_Payload.insert( s_Payload.end(), Data, Data + a_Bytes.Size );
+		}
+	}
+
+	template < typename... T >
+	static void Record( Call a_Call, const T&... a_Values )
+	{
+		if ( !s_File )
+		{
+			return;
+		}
+
+		s_Payload.clear();
+		( Write( a_Values ), ... );
+		Commit( a_Call );
+	}
+
+	static void Commit( Call a_Call )
+	{
+		RecordHeader Entry = { a_Call, 0, static_cast< uint32_t >( s_Payload.size() ) };
+		fwrite( &Entry, sizeof( Entry ), 1, s_File );
+		fwrite( s_Payload.data(), 1, s_Payload.size(), s_File );
+	}
+
+	// Handles come back from the call, so they are written after it.
+	static void RecordHandles( Call a_Call, uint32_t a_Count, const uint32_t* a_Handles )
+	{
+		if ( !s_File )
+		{
+			return;
+		}
+
+		s_Payload.clear();
+		Write( a_Count );
+
+		for ( uint32_t i = 0; i < a_Count; ++i )
+		{
+			Write( a_Handles[ i ] );
+		}
+
+		Commit( a_Call );
+	}
+
+	static void RecordBufferData( BufferHandle a_Handle, size_t a_Size, DataUsage a_DataUsage )
+	{
+		if ( !a_Handle )
+		{
+			return;
+		}
+
+		// Sizes are kept between captures too, Begin writes the live buffers with them.
+		s_BufferSizes[ ( a_Handle - 1 ) % 32 ] = a_Size;
+
+		if ( !s_File )
+		{
+			return;
+		}
+
+		s_BufferSums[ ( a_Handle - 1 ) % 32 ] = 0;
+		Record( Call::BUFFER_DATA, a_Handle, static_cast< uint64_t >( a_Size ), a_DataUsage );
+	}
+
+	// Draws are recorded with the contents of the buffers they read, written again only when they changed.
+	template < typename... T >
+	static void RecordDraw( Call a_Call, const T&... a_Values )
+	{
+		if ( !IsCapturingDraws() )
+		{
+			return;
+		}
+
+		RecordBufferContents( Rendering::s_BufferTargets[ ( uint32_t )BufferTarget::ELEMENT_ARRAY_BUFFER ] );
+
+		if ( Rendering::s_ArrayRegistry.Valid( Rendering::s_ActiveArray ) )
+		{
+			for ( auto& Attribute : Rendering::s_ArrayRegistry[ Rendering::s_ActiveArray ] )
+			{
+				if ( Attribute.Enabled )
+				{
+					RecordBufferContents( Attribute.Buffer );
+				}
+			}
+		}
+
+		Record( a_Call, a_Values... );
+	}
+
+	// Indices are an offset into the element buffer when one is bound, otherwise the game's memory is written.
+	static void RecordDrawElements( Call a_Call, RenderMode a_Mode, uint32_t a_Count, DataType a_DataType, const void* a_Indices, uint32_t a_InstanceCount )
+	{
+		if ( !IsCapturingDraws() )
+		{
+			return;
+		}
+
+		if ( Rendering::s_BufferRegistry.Valid( Rendering::s_BufferTargets[ ( uint32_t )BufferTarget::ELEMENT_ARRAY_BUFFER ] ) )
+		{
+			RecordDraw( a_Call, a_Mode, a_Count, a_DataType, static_cast< uint64_t >( reinterpret_cast< uintptr_t >( a_Indices ) ), a_InstanceCount, Bytes{ nullptr, 0 } );
+			return;
+		}
+
+		size_t IndexSize = a_DataType == DataType::UNSIGNED_BYTE ? 1 : a_DataType == DataType::UNSIGNED_SHORT ? 2 : 4;
+		RecordDraw( a_Call, a_Mode, a_Count, a_DataType, uint64_t( 0 ), a_InstanceCount, Bytes{ a_Indices, a_Count * IndexSize } );
+	}
+
+	static void RecordBufferContents( BufferHandle a_Handle )
+	{
+		if ( !Rendering::s_BufferRegistry.Valid( a_Handle ) || !Rendering::s_BufferRegistry[ a_Handle ] )
+		{
+			return;
+		}
+
+		size_t Size = s_BufferSizes[ a_Handle - 1 ];
+		const uint8_t* Data = Rendering::s_BufferRegistry[ a_Handle ];
+		uint32_t Crc = ~0u;
+
+		for ( size_t i = 0; i < Size; ++i )
+		{
+			Crc = crc_table[ ( Crc ^ Data[ i ] ) & 0xFF ] ^ ( Crc >> 8 );
+		}
+
+		// Zero marks contents not written yet, so it is never a sum.
+		Crc = ~Crc | 1;
+
+		if ( s_BufferSums[ a_Handle - 1 ] != Crc )
+		{
+			s_BufferSums[ a_Handle - 1 ] = Crc;
+			Record( Call::BUFFER_CONTENTS, a_Handle, Bytes{ Data, Size } );
+		}
+	}
+
+	static void RecordShaderSource( ShaderHandle a_Handle, const void* a_Source )
+	{
+		if ( !s_File )
+		{
+			return;
+		}
+
+		Hash Name = 0;
+
+		for ( auto& Entry : Internal::ShaderFuncLookup::Value )
+		{
+			if ( Entry.second == a_Source )
+			{
+				Name = Entry.first;
+				break;
+			}
+		}
+
+		Record( Call::SHADER_SOURCE, a_Handle, Name );
+	}
+
+	// Uniforms are written as the bytes they hold after the call, whatever the setter was.
+	static void RecordUniform( ShaderProgramHandle a_Program, uint32_t a_Location )
+	{
+		if ( !IsCapturingDraws() )
+		{
+			return;
+		}
+
+		ShaderProgram& Program = Rendering::s_ShaderProgramRegistry[ a_Program ];
+
+		for ( auto& Entry : Program.m_UniformLocations )
+		{
+			if ( Entry.second == a_Location )
+			{
+				Record( Call::UNIFORM, a_Program, a_Location, Bytes{ Program.m_Uniforms[ a_Location ], Rendering::s_UniformMap.GetSize( Entry.first ) } );
+				return;
+			}
+		}
+	}
+
+	// Uniforms set before the first captured frame are written as they stand when it starts.
+	static void RecordUniforms()
+	{
+		for ( ShaderProgramHandle Handle = 1; Handle <= 32; ++Handle )
+		{
+			if ( !Rendering::s_ShaderProgramRegistry.Valid( Handle ) )
+			{
+				continue;
+			}
+
+			ShaderProgram& Program = Rendering::s_ShaderProgramRegistry[ Handle ];
+
+			for ( auto& Entry : Program.m_UniformLocations )
+			{
+				Record( Call::UNIFORM, Handle, Entry.second, Bytes{ Program.m_Uniforms[ Entry.second ], Rendering::s_UniformMap.GetSize( Entry.first ) } );
+			}
+		}
+	}
+
+	// Writes what is live when a capture begins as the calls that would make it. Live resources keep their handles,
+	// and textures and bound state are written whole, since no call sets them back exactly.
+	static void RecordLiveResources()
+	{
+		std::vector< uint32_t > Live;
+
+		// Shaders come first, programs are linked from them.
+		for ( ShaderHandle Handle = 1; Handle <= 32; ++Handle )
+		{
+			if ( Rendering::s_ShaderRegistry.Valid( Handle ) )
+			{
+				RecordShader( Handle, Rendering::s_ShaderRegistry[ Handle ].Type, Rendering::s_ShaderRegistry[ Handle ].Callback );
+			}
+		}
+
+		for ( ShaderProgramHandle Handle = 1; Handle <= 32; ++Handle )
+		{
+			if ( Rendering::s_ShaderProgramRegistry.Valid( Handle ) )
+			{
+				RecordProgram( Handle );
+			}
+		}
+
+		for ( BufferHandle Handle = 1; Handle <= 32; ++Handle )
+		{
+			if ( Rendering::s_BufferRegistry.Valid( Handle ) )
+			{
+				Live.push_back( Handle );
+			}
+		}
+
+		RecordHandles( Call::GEN_BUFFERS, static_cast< uint32_t >( Live.size() ), Live.data() );
+
+		// Usage isn't kept, nothing reads it. Contents are written by the first draw that reads them.
+		for ( BufferHandle Handle : Live )
+		{
+			Record( Call::BUFFER_DATA, Handle, static_cast< uint64_t >( s_BufferSizes[ Handle - 1 ] ), DataUsage::STATIC );
+		}
+
+		Live.clear();
+
+		for ( ArrayHandle Handle = 1; Handle <= 32; ++Handle )
+		{
+			if ( Rendering::s_ArrayRegistry.Valid( Handle ) )
+			{
+				Live.push_back( Handle );
+			}
+		}
+
+		RecordHandles( Call::GEN_VERTEX_ARRAYS, static_cast< uint32_t >( Live.size() ), Live.data() );
+
+		for ( ArrayHandle Handle : Live )
+		{
+			Record( Call::BIND_VERTEX_ARRAY, Handle );
+			auto& Attributes = Rendering::s_ArrayRegistry[ Handle ];
+
+			for ( uint32_t i = 0; i < Attributes.size(); ++i )
+			{
+				auto& Attribute = Attributes[ i ];
+
+				if ( !Rendering::s_BufferRegistry.Valid( Attribute.Buffer ) )
+				{
+					continue;
+				}
+
+				Record( Call::BIND_BUFFER, BufferTarget::ARRAY_BUFFER, Attribute.Buffer );
+				Record( Call::VERTEX_ATTRIB_POINTER, i, static_cast< uint32_t >( Attribute.Size + 1 ), static_cast< DataType >( Attribute.Type ), static_cast< bool >( Attribute.Normalized ), static_cast< uint64_t >( Attribute.Stride ), static_cast< uint64_t >( Attribute.Offset ) );
+
+				if ( Attribute.Divisor )
+				{
+					Record( Call::VERTEX_ATTRIB_DIVISOR, i, Attribute.Divisor );
+				}
+
+				if ( Attribute.Enabled )
+				{
+					Record( Call::ENABLE_VERTEX_ATTRIB_ARRAY, i );
+				}
+			}
+		}
+
+		Live.clear();
+
+		for ( TextureHandle Handle = 1; Handle <= 32; ++Handle )
+		{
+			if ( Rendering::s_TextureRegistry.Valid( Handle ) )
+			{
+				Live.push_back( Handle );
+			}
+		}
+
+		RecordHandles( Call::GEN_TEXTURES, static_cast< uint32_t >( Live.size() ), Live.data() );
+
+		for ( TextureHandle Handle : Live )
+		{
+			const Rendering::Texture& State = Rendering::s_TextureRegistry[ Handle ];
+			size_t Size = State.Data ? static_cast< size_t >( State.Dimensions.x ) * State.Dimensions.y * 4 : 0;
+			Record( Call::TEXTURE_STATE, Handle, Rendering::s_TextureRegistry.GetTarget( Handle ), State, Bytes{ State.Data, Size } );
+		}
+
+		Live.clear();
+
+		for ( FramebufferHandle Handle = 1; Handle <= 32; ++Handle )
+		{
+			if ( Rendering::s_FramebufferRegistry.Valid( Handle ) )
+			{
+				Live.push_back( Handle );
+			}
+		}
+
+		RecordHandles( Call::GEN_FRAMEBUFFERS, static_cast< uint32_t >( Live.size() ), Live.data() );
+
+		for ( FramebufferHandle Handle : Live )
+		{
+			auto& Target = Rendering::s_FramebufferRegistry[ Handle ];
+			TextureHandle ColourTexture = Rendering::s_TextureRegistry.Valid( Target.ColourAttachment ) ? Target.ColourAttachment : 0;
+			TextureHandle DepthTexture = Rendering::s_TextureRegistry.Valid( Target.DepthAttachment ) ? Target.DepthAttachment : 0;
+			Record( Call::BIND_FRAMEBUFFER, FramebufferTarget::DRAW_FRAMEBUFFER, Handle );
+			Record( Call::FRAMEBUFFER_TEXTURE_2D, FramebufferTarget::DRAW_FRAMEBUFFER, FramebufferAttachment::COLOUR_ATTACHMENT, TextureTarget::TEXTURE_2D, ColourTexture, uint8_t( 0 ) );
+			Record( Call::FRAMEBUFFER_TEXTURE_2D, FramebufferTarget::DRAW_FRAMEBUFFER, FramebufferAttachment::DEPTH_ATTACHMENT, TextureTarget::TEXTURE_2D, DepthTexture, uint8_t( 0 ) );
+		}
+
+		// Bindings last, making the resources above moved them.
+		Record( Call::BOUND_STATE, Rendering::s_BufferTargets, Rendering::s_ActiveArray, Rendering::s_ActiveShaderProgram, Rendering::s_DrawFramebuffer, Rendering::s_ReadFramebuffer, Rendering::s_TextureUnits, Rendering::s_ActiveTextureUnit, Rendering::s_ActiveTextureTarget );
+
+		auto& State = Rendering::s_RenderState;
+		Record( State.DepthTest ? Call::ENABLE : Call::DISABLE, RenderSetting::DEPTH_TEST );
+		Record( State.CullFace ? Call::ENABLE : Call::DISABLE, RenderSetting::CULL_FACE );
+		Record( State.AlphaBlend ? Call::ENABLE : Call::DISABLE, RenderSetting::BLEND );
+		Record( State.VertexCache ? Call::ENABLE : Call::DISABLE, RenderSetting::VERTEX_CACHE );
+		Record( State.ScissorTest ? Call::ENABLE : Call::DISABLE, RenderSetting::SCISSOR_TEST );
+		Record( Call::CULL_FACE, State.FrontCull ? ( State.BackCull ? CullFaceMode::FRONT_AND_BACK : CullFaceMode::FRONT ) : CullFaceMode::BACK );
+		Record( Call::DEPTH_MASK, static_cast< bool >( State.DepthWrite ) );
+
+		static const std::pair< Rendering::DepthCompareFunc, TextureSetting > DepthFuncs[] =
+		{
+			{ Rendering::DepthCompare_LEQUAL,    TextureSetting::LEQUAL    },
+			{ Rendering::DepthCompare_GEQUAL,    TextureSetting::GEQUAL    },
+			{ Rendering::DepthCompare_LESS,      TextureSetting::LESS      },
+			{ Rendering::DepthCompare_GREATER,   TextureSetting::GREATER   },
+			{ Rendering::DepthCompare_EQUAL,     TextureSetting::EQUAL     },
+			{ Rendering::DepthCompare_NOT_EQUAL, TextureSetting::NOT_EQUAL },
+			{ Rendering::DepthCompare_ALWAYS,    TextureSetting::ALWAYS    },
+			{ Rendering::DepthCompare_NEVER,     TextureSetting::NEVER     }
+		};
+
+		for ( auto& Entry : DepthFuncs )
+		{
+			if ( Entry.first == Rendering::s_DepthCompareFunc )
+			{
+				Record( Call::DEPTH_FUNC, Entry.second );
+			}
+		}
+
+		auto& Scissor = Rendering::s_ScissorRect;
+		auto& Viewport = Rendering::s_ViewportRect;
+		Record( Call::SCISSOR, static_cast< int32_t >( Scissor.Origin.x ), static_cast< int32_t >( Scissor.Origin.y ), static_cast< uint32_t >( Scissor.Size.x ), static_cast< uint32_t >( Scissor.Size.y ) );
+		Record( Call::VIEWPORT, static_cast< int32_t >( Viewport.Origin.x ), static_cast< int32_t >( Viewport.Origin.y ), static_cast< uint32_t >( Viewport.Size.x ), static_cast< uint32_t >( Viewport.Size.y ) );
+		Record( Call::BLEND_FUNC, Rendering::s_BlendState.Source, Rendering::s_BlendState.Destination );
+		Record( Call::BLEND_EQUATION, Rendering::s_BlendState.Equation );
+
+		// Half a step up, so ClearColour truncates back to the same bytes.
+		const Colour& Clear = Rendering::s_ClearColour;
+		Record( Call::CLEAR_COLOUR, ( Clear.R + 0.5f ) / 255.0f, ( Clear.G + 0.5f ) / 255.0f, ( Clear.B + 0.5f ) / 255.0f, ( Clear.A + 0.5f ) / 255.0f );
+		Record( Call::CLEAR_DEPTH, Rendering::s_ClearDepth );
+		Record( Call::VERTEX_CACHE_TAG, Rendering::s_VertexCacheTag );
+	}
+
+	static void RecordShader( ShaderHandle a_Handle, ShaderType a_Type, void( *a_Callback )( ) )
+	{
+		Record( Call::CREATE_SHADER, a_Type, a_Handle );
+
+		if ( a_Callback )
+		{
+			RecordShaderSource( a_Handle, ( const void* )a_Callback );
+			Record( Call::COMPILE_SHADER, a_Handle );
+		}
+	}
+
+	// Shaders are often deleted once their program is linked. Those are made again under a free handle for the
+	// link, and deleted after it.
+	static void RecordProgram( ShaderProgramHandle a_Handle )
+	{
+		ShaderProgram& Program = Rendering::s_ShaderProgramRegistry[ a_Handle ];
+		ShaderHandle Temporary[ 2 ] = {};
+		bool Linked = false;
+		Record( Call::CREATE_PROGRAM, a_Handle );
+
+		for ( uint32_t i = 0; i < 2; ++i )
+		{
+			auto& Entry = Program.m_Shaders[ i ];
+			Linked |= Entry.Callback != nullptr;
+
+			if ( !Entry.Set )
+			{
+				continue;
+			}
+
+			ShaderHandle Shader = Entry.Handle;
+
+			if ( !Rendering::s_ShaderRegistry.Valid( Shader ) )
+			{
+				Shader = 1;
+
+				while ( Shader <= 32 && ( Rendering::s_ShaderRegistry.Valid( Shader ) || Shader == Temporary[ 0 ] ) )
+				{
+					++Shader;
+				}
+
+				if ( Shader > 32 || !Entry.Callback )
+				{
+					continue;
+				}
+
+				Temporary[ i ] = Shader;
+				RecordShader( Shader, static_cast< ShaderType >( i ), Entry.Callback );
+			}
+
+			Record( Call::ATTACH_SHADER, a_Handle, Shader );
+		}
+
+		if ( Linked )
+		{
+			Record( Call::LINK_PROGRAM, a_Handle );
+		}
+
+		for ( ShaderHandle Shader : Temporary )
+		{
+			if ( Shader )
+			{
+				Record( Call::DELETE_SHADER, Shader );
+			}
+		}
+	}
+
+	template < typename T >
+	static void RecordTexParameter( Call a_Call, uint32_t a_Texture, TextureParameter a_Parameter, const T* a_Values )
+	{
+		if ( !s_File )
+		{
+			return;
+		}
+
+		bool Four = a_Parameter == TextureParameter::TEXTURE_BORDER_COLOUR || a_Parameter == TextureParameter::TEXTURE_SWIZZLE_RGBA;
+		uint32_t Values[ 4 ] = {};
+		memcpy( Values, a_Values, ( Four ? 4 : 1 ) * sizeof( T ) );
+		char Kind = std::is_same_v< T, float > ? 'f' : std::is_same_v< T, int32_t > ? 'i' : 'u';
+		Record( a_Call, a_Texture, a_Parameter, Kind, Values );
+	}
+
+	inline static FILE*                      s_File = nullptr;
+	inline static uint32_t                   s_Frame = 0;
+	inline static uint32_t                   s_FirstFrame = 0;
+	inline static uint32_t                   s_LastFrame = 0;
+	inline static std::vector< uint8_t >     s_Payload;
+	inline static std::array< size_t, 32 >   s_BufferSizes = {};
+	inline static std::array< uint32_t, 32 > s_BufferSums;
+};
@@ -25,6 +25,9 @@ struct RenderInstruction
 		BackFaceCulling,
 		DepthTest,
 		Clipping,
+		Instances,
+		Layer,
+		PropertyBlock,
 	};
 
 	Modification Modification = Modification::NONE;
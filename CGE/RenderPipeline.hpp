@@ -1,8 +1,13 @@
 #pragma once
 #include <list>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 #include "Component.hpp"
 #include "Mesh.hpp"
 #include "Frustum.hpp"
+#include "Camera.hpp"
+#include "CameraBlock.hpp"
 #include "Renderer.hpp"
 #include "Rendering.hpp"
 #include "RenderInstruction.hpp"
@@ -10,9 +15,85 @@
 #include "Mesh.hpp"
 #include "Material.hpp"
 #include "Light.hpp"
+#include "DebugDraw.hpp"
+#include "StaticBatching.hpp"
+#include "Time.hpp"
+#include "PostProcess.hpp"
+#include "RayTracing.hpp"
+
+// Rasterizer counters shown in place of the frame's colours, as a heatmap against the busiest pixel or tile.
+enum class DebugView
+{
+	NONE,
+	OVERDRAW,        // Fragments rasterized per pixel.
+	FRAGMENT_SHADER, // Fragment shader invocations per pixel.
+	DEPTH_FAIL,      // Share of each pixel's fragments that failed the depth test.
+	TILE_TRIANGLES,  // Triangles touching each tile.
+};
 
 class RenderPipeline
 {
+public:
+
+	// Requests a full redraw, for changes the pipeline can't see such as edited textures.
+	static void Invalidate()
+	{
+		s_FullRedrawFrames = 1;
+	}
+
+	// Renders below the window resolution and upscales, the scale adjusts every frame to hold a_TargetFrameTime seconds.
+	static void SetDynamicResolution( bool a_Enabled, float a_TargetFrameTime = 1.0f / 30.0f, float a_MinimumScale = 0.5f )
+	{
+		s_DynamicResolution = a_Enabled;
+		s_TargetFrameTime = a_TargetFrameTime;
+		s_MinimumScale = Math::Clamp( a_MinimumScale, 0.1f, 1.0f );
+	}
+
+	inline static bool IsDynamicResolution()
+	{
+		return s_DynamicResolution;
+	}
+
+	// Fraction of the window size rendered, fixed by this when dynamic resolution is off.
+	static void SetResolutionScale( float a_Scale )
+	{
+		s_ResolutionScale = Math::Clamp( a_Scale, 0.1f, 1.0f );
+	}
+
+	inline static float GetResolutionScale()
+	{
+		return s_ResolutionScale;
+	}
+
+	// Frames are drawn whole while a view is set, partial redraws would only count what changed.
+	static void SetDebugView( DebugView a_View )
+	{
+		s_DebugView = a_View;
+		Invalidate();
+	}
+
+	inline static DebugView GetDebugView()
+	{
+		return s_DebugView;
+	}
+
+	// Counts triangles and fragments every frame, debug views count regardless.
+	inline static void SetStatisticsEnabled( bool a_Enabled )
+	{
+		s_StatisticsEnabled = a_Enabled;
+	}
+
+	inline static bool IsStatisticsEnabled()
+	{
+		return s_StatisticsEnabled;
+	}
+
+	// Counts of the last frame that kept them.
+	inline static const RenderStatistics& GetStatistics()
+	{
+		return s_Statistics;
+	}
+
 private:
 
 	friend class CGE;
@@ -28,29 +109,380 @@ private:
 			Renderer->OnRender( Queue );
 		}
 
-		// Sort all render instructions
-		//s_RenderInstructions.sort();
+		StaticBatching::Submit( Queue );
+
+		// Below full scale, or with post processing, the frame is drawn into an offscreen target
+		// and copied to the window afterwards.
+		Vector2Int WindowSize = ConsoleWindow::GetCurrentContext()->GetSize();
+		UpdateResolutionScale();
+		Vector2Int ScreenSize = GetRenderSize( WindowSize );
+		bool Offscreen = ScreenSize != WindowSize || PostProcess::IsActive();
+
+		if ( Offscreen )
+		{
+			PrepareRenderTarget( ScreenSize );
+		}
+
+		// Switching targets leaves nothing to repair from.
+		if ( Offscreen != s_LastOffscreen )
+		{
+			s_LastOffscreen = Offscreen;
+			Invalidate();
+		}
+
+		Rendering::BindFramebuffer( FramebufferTarget::FRAMEBUFFER, Offscreen ? s_Framebuffer : 0 );
+
+		bool Counting = s_StatisticsEnabled || s_DebugView != DebugView::NONE;
+		Rendering::ResetStatistics();
+
+		if ( Counting )
+		{
+			Rendering::Enable( RenderSetting::DEBUG_COUNTERS );
+		}
+
+		if ( s_DebugView != DebugView::NONE )
+		{
+			Invalidate();
+		}
+
+		// Every camera gets its block computed once, later cameras draw over earlier ones.
+		std::vector< CameraBlock > Cameras;
+
+		for ( auto Source : Component::GetComponents< Camera >() )
+		{
+			Cameras.emplace_back( *Source, ScreenSize );
+		}
+
+		std::stable_sort( Cameras.begin(), Cameras.end(), []( const CameraBlock& a_Left, const CameraBlock& a_Right )
+		{
+			return a_Left.Source->GetDepth() < a_Right.Source->GetDepth();
+		} );
+
+		// Sort all render instructions, once per camera.
+		s_Passes.resize( Cameras.size() );
+
+		for ( size_t i = 0; i < Cameras.size(); ++i )
+		{
+			Queue.Sort( Cameras[ i ], s_Passes[ i ] );
+		}
 
 		// Remove this later
 		//Sleep( 33 );
-		Rendering::Clear( ( uint8_t )BufferFlag::COLOUR_BUFFER_BIT );
-		bool DepthTestActive;
-		Rendering::GetBooleanv( RenderSetting::DEPTH_TEST, &DepthTestActive );
 		Rendering::Enable( RenderSetting::CULL_FACE );
 		Rendering::CullFace( CullFaceMode::BACK );
 		Rendering::Enable( RenderSetting::DEPTH_TEST );
+		Rendering::ClearDepth( 1000.0f );
+
+		// Only the parts of the last frame that changed are cleared and drawn again.
+		std::vector< RectInt > DirtyRegions;
+
+		// Shadows and reflections reach past the draw that changed, so traced frames are always drawn whole.
+		bool RayTraced = RayTracer::IsEnabled();
+		bool FullRedraw = RayTraced || UpdateDrawRecords( Cameras, ScreenSize, DirtyRegions );
+
+		if ( RayTraced )
+		{
+			RayTracer::Build( Queue );
+			Rendering::Clear( ( uint8_t )( ( uint8_t )BufferFlag::COLOUR_BUFFER_BIT | ( uint8_t )BufferFlag::DEPTH_BUFFER_BIT ) );
+
+			for ( const auto& Block : Cameras )
+			{
+				Rendering::Viewport( Block.Viewport.Origin.x, Block.Viewport.Origin.y, Block.Viewport.Size.x, Block.Viewport.Size.y );
+				RayTracer::Render( Block );
+			}
+
+			FlushDebugDraw( Cameras );
+
+			// The draw records weren't kept up, rasterizing starts again from a full frame.
+			Invalidate();
+		}
+		else if ( FullRedraw )
+		{
+			Rendering::Clear( ( uint8_t )( ( uint8_t )BufferFlag::COLOUR_BUFFER_BIT | ( uint8_t )BufferFlag::DEPTH_BUFFER_BIT ) );
+
+			for ( size_t i = 0; i < Cameras.size(); ++i )
+			{
+				const RectInt& Viewport = Cameras[ i ].Viewport;
+				Rendering::Viewport( Viewport.Origin.x, Viewport.Origin.y, Viewport.Size.x, Viewport.Size.y );
+
+				// Cameras drawn over another start from a clear depth buffer.
+				if ( i > 0 )
+				{
+					Rendering::Enable( RenderSetting::SCISSOR_TEST );
+					Rendering::Scissor( Viewport.Origin.x, Viewport.Origin.y, Viewport.Size.x, Viewport.Size.y );
+					Rendering::Clear( ( uint8_t )BufferFlag::DEPTH_BUFFER_BIT );
+					Rendering::Disable( RenderSetting::SCISSOR_TEST );
+				}
+
+				s_ActiveCamera = &Cameras[ i ];
+				Execute( s_Passes[ i ], nullptr );
+			}
+
+			FlushDebugDraw( Cameras );
+		}
+		else
+		{
+			Rendering::Enable( RenderSetting::SCISSOR_TEST );
+
+			for ( const auto& Region : DirtyRegions )
+			{
+				Rendering::Scissor( Region.Origin.x, Region.Origin.y, Region.Size.x, Region.Size.y );
+				Rendering::Clear( ( uint8_t )( ( uint8_t )BufferFlag::COLOUR_BUFFER_BIT | ( uint8_t )BufferFlag::DEPTH_BUFFER_BIT ) );
+
+				for ( size_t i = 0; i < Cameras.size(); ++i )
+				{
+					const RectInt& Viewport = Cameras[ i ].Viewport;
+					RectInt Area = Intersect( Region, Viewport );
+
+					if ( Area.Size.x <= 0 || Area.Size.y <= 0 )
+					{
+						continue;
+					}
+
+					Rendering::Viewport( Viewport.Origin.x, Viewport.Origin.y, Viewport.Size.x, Viewport.Size.y );
+					Rendering::Scissor( Area.Origin.x, Area.Origin.y, Area.Size.x, Area.Size.y );
+
+					if ( i > 0 )
+					{
+						Rendering::Clear( ( uint8_t )BufferFlag::DEPTH_BUFFER_BIT );
+					}
+
+					s_ActiveCamera = &Cameras[ i ];
+					Execute( s_Passes[ i ], &Area );
+				}
+			}
+
+			Rendering::Disable( RenderSetting::SCISSOR_TEST );
+		}
 
-		if ( DepthTestActive )
+		if ( Counting )
 		{
-			Rendering::ClearDepth( 1000.0f );
-			Rendering::Clear( ( uint8_t )BufferFlag::DEPTH_BUFFER_BIT );
+			Rendering::Disable( RenderSetting::DEBUG_COUNTERS );
+			s_Statistics = Rendering::GetStatistics();
 		}
 
-		// Process queue.
-		while ( !Queue.Empty() )
+		if ( s_DebugView != DebugView::NONE )
 		{
-			auto& Instruction = Queue.Front();
+			DrawDebugView();
+		}
+
+		DebugDraw::Clear();
+		s_ActiveCamera = nullptr;
+		Rendering::Viewport( 0, 0, 0, 0 );
+
+		if ( Offscreen )
+		{
+			Present( ScreenSize, WindowSize, FullRedraw ? nullptr : &DirtyRegions );
+		}
+
+		// Leave the default opaque state and the window bound for anything drawn outside the pipeline.
+		Rendering::Disable( RenderSetting::BLEND );
+		Rendering::DepthMask( true );
+	}
+
+	// Replaces the frame with the counters of the debug view, so it is presented like any other frame.
+	static void DrawDebugView()
+	{
+		const RenderCounters& Counters = Rendering::GetCounters();
+		Vector2Int Size = Counters.Size;
+
+		if ( Size.x <= 0 || Size.y <= 0 )
+		{
+			return;
+		}
+
+		s_DebugValues.resize( static_cast< size_t >( Size.x ) * Size.y );
+		float Busiest = 0.0f;
+
+		for ( int32_t y = 0; y < Size.y; ++y )
+		{
+			for ( int32_t x = 0; x < Size.x; ++x )
+			{
+				size_t Index = static_cast< size_t >( y ) * Size.x + x;
+				const RenderCounters::Counter& Count = Counters.Pixels[ Index ];
+				float Value = 0.0f;
+
+				switch ( s_DebugView )
+				{
+					case DebugView::OVERDRAW:        Value = static_cast< float >( Count.Fragments ); break;
+					case DebugView::FRAGMENT_SHADER: Value = static_cast< float >( Count.Shaded ); break;
+					case DebugView::DEPTH_FAIL:      Value = Count.Fragments ? static_cast< float >( Count.DepthFailed ) / Count.Fragments : 0.0f; break;
+					case DebugView::TILE_TRIANGLES:  Value = static_cast< float >( Counters.TileTriangles[ ( y / RenderCounters::TileSize ) * Counters.Tiles.x + x / RenderCounters::TileSize ] ); break;
+					default: break;
+				}
+
+				s_DebugValues[ Index ] = Value;
+				Busiest = Math::Max( Busiest, Value );
+			}
+		}
+
+		// Ratios already run from 0 to 1, counts are relative to the busiest.
+		float Scale = s_DebugView == DebugView::DEPTH_FAIL ? 1.0f : 1.0f / Math::Max( Busiest, 1.0f );
+		s_DebugColours.resize( s_DebugValues.size() );
+
+		for ( size_t i = 0; i < s_DebugValues.size(); ++i )
+		{
+			s_DebugColours[ i ] = HeatColour( s_DebugValues[ i ] * Scale );
+		}
+
+		Rendering::DrawPixels( 0, 0, Size.x, Size.y, s_DebugColours.data() );
+	}
+
+	// Black through blue, green and yellow to red.
+	static Colour HeatColour( float a_Heat )
+	{
+		static const Vector4 Stops[] = {
+			{ 0.0f, 0.0f, 0.0f, 1.0f },
+			{ 0.0f, 0.0f, 1.0f, 1.0f },
+			{ 0.0f, 1.0f, 0.0f, 1.0f },
+			{ 1.0f, 1.0f, 0.0f, 1.0f },
+			{ 1.0f, 0.0f, 0.0f, 1.0f },
+		};
+
+		float Position = Math::Clamp( a_Heat, 0.0f, 1.0f ) * 4.0f;
+		uint32_t Stop = Math::Min( static_cast< uint32_t >( Position ), 3u );
+		return Colour( Math::Lerp( Position - Stop, Stops[ Stop ], Stops[ Stop + 1 ] ) );
+	}
+
+	// Debug geometry goes on top of the frame in one stream, seen through the main camera.
+	static void FlushDebugDraw( const std::vector< CameraBlock >& a_Cameras )
+	{
+		if ( a_Cameras.empty() )
+		{
+			return;
+		}
+
+		const Camera* MainCamera = Camera::GetMainCamera();
+		auto Main = std::find_if( a_Cameras.begin(), a_Cameras.end(), [ & ]( const CameraBlock& a_Block ) { return a_Block.Source == MainCamera; } );
+		const CameraBlock& Block = Main != a_Cameras.end() ? *Main : a_Cameras.front();
+
+		Rendering::Viewport( Block.Viewport.Origin.x, Block.Viewport.Origin.y, Block.Viewport.Size.x, Block.Viewport.Size.y );
+		DebugDraw::Flush( Block.ProjectionView );
+	}
+
+	// Scales the resolution by the square root of how far the smoothed frame time is off target, pixel cost
+	// being quadratic in the scale. Steps of a sixteenth keep small swings from resizing the target every frame.
+	static void UpdateResolutionScale()
+	{
+		if ( !s_DynamicResolution )
+		{
+			return;
+		}
+
+		float FrameTime = Time::GetRealDeltaTime();
+
+		if ( FrameTime <= 0.0f )
+		{
+			return;
+		}
+
+		s_SmoothFrameTime = s_SmoothFrameTime > 0.0f ? s_SmoothFrameTime + ( FrameTime - s_SmoothFrameTime ) * 0.1f : FrameTime;
+		float Desired = Math::Clamp( s_ResolutionScale * Math::Sqrt( s_TargetFrameTime / s_SmoothFrameTime ), s_MinimumScale, 1.0f );
+		Desired = Math::Clamp( Math::Round( Desired * 16.0f ) / 16.0f, s_MinimumScale, 1.0f );
 
+		if ( Desired != s_ResolutionScale )
+		{
+			s_ResolutionScale = Desired;
+
+			// The new size only shows up in the frame time once it has been drawn.
+			s_SmoothFrameTime = 0.0f;
+		}
+	}
+
+	static Vector2Int GetRenderSize( Vector2Int a_WindowSize )
+	{
+		return {
+			Math::Max( static_cast< int32_t >( a_WindowSize.x * s_ResolutionScale + 0.5f ), 1 ),
+			Math::Max( static_cast< int32_t >( a_WindowSize.y * s_ResolutionScale + 0.5f ), 1 ) };
+	}
+
+	// Resizes the offscreen attachments when the size frames are drawn at changes.
+	static void PrepareRenderTarget( Vector2Int a_Size )
+	{
+		if ( !s_Framebuffer )
+		{
+			Rendering::GenFramebuffers( 1, &s_Framebuffer );
+			Rendering::GenTextures( 1, &s_ColourAttachment );
+			Rendering::GenTextures( 1, &s_DepthAttachment );
+		}
+
+		if ( a_Size != s_TargetSize )
+		{
+			s_TargetSize = a_Size;
+			s_ColourStorage.assign( static_cast< size_t >( a_Size.x ) * a_Size.y, Colour() );
+			s_DepthStorage.assign( static_cast< size_t >( a_Size.x ) * a_Size.y, 0.0f );
+
+			Rendering::BindTexture( TextureTarget::TEXTURE_2D, s_ColourAttachment );
+			Rendering::TexImage2D( TextureTarget::TEXTURE_2D, 0, TextureFormat::RGBA, a_Size.x, a_Size.y, 0, TextureFormat::RGBA, TextureSetting::UNSIGNED_BYTE, s_ColourStorage.data() );
+			Rendering::BindTexture( TextureTarget::TEXTURE_2D, s_DepthAttachment );
+			Rendering::TexImage2D( TextureTarget::TEXTURE_2D, 0, TextureFormat::DEPTH_COMPONENT, a_Size.x, a_Size.y, 0, TextureFormat::DEPTH_COMPONENT, TextureSetting::FLOAT, s_DepthStorage.data() );
+
+			Rendering::BindFramebuffer( FramebufferTarget::FRAMEBUFFER, s_Framebuffer );
+			Rendering::FramebufferTexture2D( FramebufferTarget::FRAMEBUFFER, FramebufferAttachment::COLOUR_ATTACHMENT, TextureTarget::TEXTURE_2D, s_ColourAttachment, 0 );
+			Rendering::FramebufferTexture2D( FramebufferTarget::FRAMEBUFFER, FramebufferAttachment::DEPTH_ATTACHMENT, TextureTarget::TEXTURE_2D, s_DepthAttachment, 0 );
+			Rendering::BindFramebuffer( FramebufferTarget::FRAMEBUFFER, 0 );
+		}
+	}
+
+	// Upscales the offscreen frame into the window. Partial frames only copy what was redrawn into
+	// the window's colour buffer, which persists between frames. Post processing runs on a copy
+	// of the frame, so the offscreen target stays valid for the next partial frame, and is copied whole.
+	static void Present( Vector2Int a_TargetSize, Vector2Int a_WindowSize, const std::vector< RectInt >* a_Regions )
+	{
+		FramebufferHandle Source = s_Framebuffer;
+
+		if ( PostProcess::IsActive() )
+		{
+			const Colour* Result = PostProcess::Run( s_ColourStorage.data(), a_TargetSize );
+
+			if ( !s_PostFramebuffer )
+			{
+				Rendering::GenFramebuffers( 1, &s_PostFramebuffer );
+				Rendering::GenTextures( 1, &s_PostAttachment );
+			}
+
+			Rendering::BindTexture( TextureTarget::TEXTURE_2D, s_PostAttachment );
+			Rendering::TexImage2D( TextureTarget::TEXTURE_2D, 0, TextureFormat::RGBA, a_TargetSize.x, a_TargetSize.y, 0, TextureFormat::RGBA, TextureSetting::UNSIGNED_BYTE, Result );
+			Rendering::BindFramebuffer( FramebufferTarget::FRAMEBUFFER, s_PostFramebuffer );
+			Rendering::FramebufferTexture2D( FramebufferTarget::FRAMEBUFFER, FramebufferAttachment::COLOUR_ATTACHMENT, TextureTarget::TEXTURE_2D, s_PostAttachment, 0 );
+			Source = s_PostFramebuffer;
+			a_Regions = nullptr;
+		}
+
+		Rendering::BindFramebuffer( FramebufferTarget::READ_FRAMEBUFFER, Source );
+		Rendering::BindFramebuffer( FramebufferTarget::DRAW_FRAMEBUFFER, 0 );
+
+		if ( !a_Regions )
+		{
+			Rendering::BlitFramebuffer( 0, 0, a_TargetSize.x, a_TargetSize.y, 0, 0, a_WindowSize.x, a_WindowSize.y, ( uint8_t )BufferFlag::COLOUR_BUFFER_BIT, TextureSetting::NEAREST );
+		}
+		else
+		{
+			Vector2 Scale = { static_cast< float >( a_WindowSize.x ) / a_TargetSize.x, static_cast< float >( a_WindowSize.y ) / a_TargetSize.y };
+			Rendering::Enable( RenderSetting::SCISSOR_TEST );
+
+			for ( const auto& Region : *a_Regions )
+			{
+				int32_t Left = static_cast< int32_t >( Math::Floor( Region.GetLeft() * Scale.x ) );
+				int32_t Bottom = static_cast< int32_t >( Math::Floor( Region.GetBottom() * Scale.y ) );
+				int32_t Right = static_cast< int32_t >( Math::Ceil( ( Region.GetRight() + 1 ) * Scale.x ) );
+				int32_t Top = static_cast< int32_t >( Math::Ceil( ( Region.GetTop() + 1 ) * Scale.y ) );
+				Rendering::Scissor( Left, Bottom, Right - Left, Top - Bottom );
+				Rendering::BlitFramebuffer( 0, 0, a_TargetSize.x, a_TargetSize.y, 0, 0, a_WindowSize.x, a_WindowSize.y, ( uint8_t )BufferFlag::COLOUR_BUFFER_BIT, TextureSetting::NEAREST );
+			}
+
+			Rendering::Disable( RenderSetting::SCISSOR_TEST );
+		}
+
+		Rendering::BindFramebuffer( FramebufferTarget::FRAMEBUFFER, 0 );
+	}
+
+	static void Execute( RenderPass& a_Pass, const RectInt* a_Region )
+	{
+		uint32_t DrawIndex = 0;
+
+		for ( auto& Instruction : a_Pass.Instructions )
+		{
 			switch ( Instruction.Modification )
 			{
 				case RenderInstruction::Modification::SET:
@@ -60,11 +492,13 @@ private:
 						case RenderInstruction::Object::Mesh:
 						{
 							s_ActiveMesh = static_cast< const Mesh* >( Instruction.ResourceSource );
+							s_MeshDirty = true;
 							break;
 						}
 						case RenderInstruction::Object::Material:
 						{
 							s_ActiveMaterial = static_cast< const Material* >( Instruction.ResourceSource );
+							s_MaterialDirty = true;
 							break;
 						}
 						case RenderInstruction::Object::Model:
@@ -72,33 +506,353 @@ private:
 							s_ActiveModel = static_cast< const Matrix4* >( Instruction.ResourceSource );
 							break;
 						}
+						case RenderInstruction::Object::RenderMode:
+						{
+							s_ActiveRenderMode = static_cast< RenderMode >( Instruction.Index );
+							break;
+						}
+						case RenderInstruction::Object::PropertyBlock:
+						{
+							s_ActiveBlock = static_cast< const MaterialPropertyBlock* >( Instruction.ResourceSource );
+							break;
+						}
 					}
 
-					s_Dirty = true;
 					break;
 				}
 				case RenderInstruction::Modification::DRAW:
 				{
-					Draw();
+					// Draws outside the region being repaired only need their state changes.
+					const RectInt& Bounds = a_Pass.DrawBounds[ DrawIndex++ ];
+
+					if ( !a_Region || Overlaps( Bounds, *a_Region ) )
+					{
+						if ( Instruction.Object == RenderInstruction::Object::Instances )
+						{
+							DrawInstanced( a_Pass.InstanceBatches[ Instruction.Index ], a_Pass.InstanceBlocks[ Instruction.Index ] );
+						}
+						else
+						{
+							Draw();
+						}
+					}
+
+					// Like layers, a render mode and a property block only apply to the draw they precede.
+					s_ActiveRenderMode = RenderMode::TRIANGLE;
+					s_ActiveBlock = nullptr;
 				}
 			}
+		}
+	}
+
+	// Records the screen area and state of every draw this frame, for every camera, and compares them with the last frame.
+	// Returns true when the whole screen has to be drawn, otherwise o_DirtyRegions holds what changed.
+	static bool UpdateDrawRecords( const std::vector< CameraBlock >& a_Cameras, Vector2Int a_ScreenSize, std::vector< RectInt >& o_DirtyRegions )
+	{
+		Vector3 SunDirection = Light::GetSun() ? Light::GetSun()->GetDirection() : Vector3::Zero;
+		bool HasDebugGeometry = !DebugDraw::s_Vertices.empty();
+		bool CamerasChanged = a_Cameras.size() != s_LastCameras.size();
+
+		for ( size_t i = 0; !CamerasChanged && i < a_Cameras.size(); ++i )
+		{
+			CamerasChanged =
+				a_Cameras[ i ].ProjectionView != s_LastCameras[ i ].ProjectionView ||
+				a_Cameras[ i ].Viewport.Origin != s_LastCameras[ i ].Viewport.Origin ||
+				a_Cameras[ i ].Viewport.Size != s_LastCameras[ i ].Viewport.Size;
+		}
+
+		// Anything that changes every pixel forces a full redraw. Debug geometry isn't recorded, so the frame
+		// after the last of it is drawn whole too, or its lines would stay on screen.
+		if ( a_Cameras.empty() ||
+			 CamerasChanged ||
+			 a_ScreenSize != s_LastScreenSize ||
+			 SunDirection != s_LastSunDirection ||
+			 HasDebugGeometry ||
+			 s_LastHadDebugGeometry )
+		{
+			s_FullRedrawFrames = 1;
+		}
+
+		s_LastScreenSize = a_ScreenSize;
+		s_LastSunDirection = SunDirection;
+		s_LastHadDebugGeometry = HasDebugGeometry;
+		s_LastCameras.clear();
 
-			Queue.Pop();
+		for ( const auto& Block : a_Cameras )
+		{
+			s_LastCameras.push_back( { Block.ProjectionView, Block.Viewport } );
 		}
 
+		std::unordered_map< size_t, DrawRecord > Records;
+		std::vector< RectInt > Changed;
+
+		for ( size_t CameraIndex = 0; CameraIndex < a_Cameras.size(); ++CameraIndex )
+		{
+			const CameraBlock& Block = a_Cameras[ CameraIndex ];
+			RenderPass& Pass = s_Passes[ CameraIndex ];
+			const Mesh* ActiveMesh = nullptr;
+			const Material* ActiveMaterial = nullptr;
+			const Matrix4* ActiveModel = nullptr;
+			const MaterialPropertyBlock* ActiveBlock = nullptr;
+
+			auto Record = [ & ]( const Matrix4* a_Model, const MaterialPropertyBlock* a_Block )
+			{
+				DrawRecord New;
+				New.Bounds = a_Model && ActiveMesh ? GetScreenBounds( Block, *a_Model, *ActiveMesh ) : Block.Viewport;
+				New.State = ActiveMaterial ? ActiveMaterial->GetRevision() : 0;
+				HashCombine( New.State, ActiveMesh ? ActiveMesh->GetRevision() : 0 );
+				HashCombine( New.State, a_Block );
+				HashCombine( New.State, a_Block ? a_Block->GetRevision() : 0 );
+
+				for ( float Value : ( a_Model ? *a_Model : Matrix4::Identity ).Data )
+				{
+					HashCombine( New.State, Value );
+				}
+
+				size_t Key = 0;
+				HashCombine( Key, CameraIndex );
+				HashCombine( Key, a_Model );
+				HashCombine( Key, ActiveMesh );
+				HashCombine( Key, ActiveMaterial );
+
+				// The same object drawn twice in a frame keeps both records.
+				while ( Records.find( Key ) != Records.end() )
+				{
+					HashCombine( Key, Key );
+				}
+
+				auto Last = s_DrawRecords.find( Key );
+
+				if ( Last == s_DrawRecords.end() )
+				{
+					Changed.push_back( New.Bounds );
+				}
+				else
+				{
+					if ( Last->second.State != New.State || Last->second.Bounds.Origin != New.Bounds.Origin || Last->second.Bounds.Size != New.Bounds.Size )
+					{
+						Changed.push_back( Last->second.Bounds );
+						Changed.push_back( New.Bounds );
+					}
+
+					s_DrawRecords.erase( Last );
+				}
+
+				Records.emplace( Key, New );
+				return New.Bounds;
+			};
+
+			for ( auto& Instruction : Pass.Instructions )
+			{
+				if ( Instruction.Modification == RenderInstruction::Modification::SET )
+				{
+					switch ( Instruction.Object )
+					{
+						case RenderInstruction::Object::Mesh:     ActiveMesh = static_cast< const Mesh* >( Instruction.ResourceSource );         break;
+						case RenderInstruction::Object::Material: ActiveMaterial = static_cast< const Material* >( Instruction.ResourceSource ); break;
+						case RenderInstruction::Object::Model:    ActiveModel = static_cast< const Matrix4* >( Instruction.ResourceSource );     break;
+						case RenderInstruction::Object::PropertyBlock: ActiveBlock = static_cast< const MaterialPropertyBlock* >( Instruction.ResourceSource ); break;
+						default: break;
+					}
+				}
+				else if ( Instruction.Modification == RenderInstruction::Modification::DRAW )
+				{
+					if ( Instruction.Object == RenderInstruction::Object::Instances )
+					{
+						RectInt Bounds;
+						const auto& Models = Pass.InstanceBatches[ Instruction.Index ];
+						const auto& Blocks = Pass.InstanceBlocks[ Instruction.Index ];
+
+						for ( size_t i = 0; i < Models.size(); ++i )
+						{
+							Bounds = Union( Bounds, Record( Models[ i ], Blocks[ i ] ) );
+						}
+
+						Pass.DrawBounds.push_back( Bounds );
+					}
+					else
+					{
+						Pass.DrawBounds.push_back( Record( ActiveModel, ActiveBlock ) );
+					}
+
+					ActiveBlock = nullptr;
+				}
+			}
+		}
+
+		// Whatever is left was drawn last frame and is gone now.
+		for ( auto& Removed : s_DrawRecords )
+		{
+			Changed.push_back( Removed.second.Bounds );
+		}
+
+		s_DrawRecords.swap( Records );
+
+		// Merge overlapping regions, too many small regions collapse into one.
+		std::vector< RectInt > Regions;
+
+		for ( const auto& Region : Changed )
+		{
+			if ( Region.Size.x <= 0 || Region.Size.y <= 0 )
+			{
+				continue;
+			}
+
+			RectInt Merged = Region;
+
+			for ( auto Begin = Regions.begin(); Begin != Regions.end(); )
+			{
+				if ( Overlaps( *Begin, Merged ) )
+				{
+					Merged = Union( Merged, *Begin );
+					Begin = Regions.erase( Begin );
+				}
+				else
+				{
+					++Begin;
+				}
+			}
+
+			Regions.push_back( Merged );
+		}
+
+		if ( Regions.size() > 4 )
+		{
+			RectInt Merged = Regions.front();
+
+			for ( const auto& Region : Regions )
+			{
+				Merged = Union( Merged, Region );
+			}
+
+			Regions.assign( 1, Merged );
+		}
+
+		// Draws go to the window's colour buffer, which both pixel buffers are resolved from whole,
+		// so only this frame's changes need repairing.
+		o_DirtyRegions = std::move( Regions );
+
+		if ( s_FullRedrawFrames > 0 )
+		{
+			--s_FullRedrawFrames;
+			return true;
+		}
+
+		return false;
+	}
+
+	// Projects the bounding cube of the mesh's bounding sphere into the camera's viewport, in pixel rows from the top
+	// like the rasterizer. Anything crossing the near plane covers the whole viewport.
+	static RectInt GetScreenBounds( const CameraBlock& a_Camera, const Matrix4& a_Model, const Mesh& a_Mesh )
+	{
+		const RectInt& Viewport = a_Camera.Viewport;
+
+		if ( !a_Mesh.HasPositions() )
+		{
+			return RectInt();
+		}
+
+		Vector3 Centre = { a_Model.Data[ 3 ], a_Model.Data[ 7 ], a_Model.Data[ 11 ] };
+		float Scale = Math::Max( Math::Max(
+			Math::Length( Vector3( a_Model.Data[ 0 ], a_Model.Data[ 4 ], a_Model.Data[ 8 ] ) ),
+			Math::Length( Vector3( a_Model.Data[ 1 ], a_Model.Data[ 5 ], a_Model.Data[ 9 ] ) ) ),
+			Math::Length( Vector3( a_Model.Data[ 2 ], a_Model.Data[ 6 ], a_Model.Data[ 10 ] ) ) );
+		float Radius = a_Mesh.GetRadius() * Scale;
+
+		Vector2 Min = { std::numeric_limits< float >::max(), std::numeric_limits< float >::max() };
+		Vector2 Max = -Min;
+		Vector2 FullViewport = Vector2::One * 0.1f + Viewport.Size;
+		Vector2 HalfViewport = 0.5f * FullViewport;
+
+		for ( uint32_t i = 0; i < 8; ++i )
+		{
+			Vector4 Corner = Math::Multiply( a_Camera.ProjectionView, Vector4(
+				Centre.x + ( ( i & 1 ) ? Radius : -Radius ),
+				Centre.y + ( ( i & 2 ) ? Radius : -Radius ),
+				Centre.z + ( ( i & 4 ) ? Radius : -Radius ),
+				1.0f ) );
+
+			if ( Corner.w <= 0.0001f )
+			{
+				return Viewport;
+			}
+
+			Vector2 Point = {
+				Viewport.Origin.x + ( Corner.x / Corner.w + 1.0f ) * HalfViewport.x,
+				Viewport.Origin.y + FullViewport.y - ( Corner.y / Corner.w + 1.0f ) * HalfViewport.y };
+			Min = { Math::Min( Min.x, Point.x ), Math::Min( Min.y, Point.y ) };
+			Max = { Math::Max( Max.x, Point.x ), Math::Max( Max.y, Point.y ) };
+		}
+
+		// One pixel of slack for rasterization rounding.
+		int32_t Left = Math::Max( static_cast< int32_t >( Math::Floor( Min.x ) ) - 1, Viewport.GetLeft() );
+		int32_t Bottom = Math::Max( static_cast< int32_t >( Math::Floor( Min.y ) ) - 1, Viewport.GetBottom() );
+		int32_t Right = Math::Min( static_cast< int32_t >( Math::Ceil( Max.x ) ) + 1, Viewport.GetRight() );
+		int32_t Top = Math::Min( static_cast< int32_t >( Math::Ceil( Max.y ) ) + 1, Viewport.GetTop() );
+
+		if ( Right < Left || Top < Bottom )
+		{
+			return RectInt();
+		}
+
+		return RectInt( Left, Bottom, Right - Left + 1, Top - Bottom + 1 );
+	}
+
+	static RectInt Intersect( const RectInt& a_A, const RectInt& a_B )
+	{
+		int32_t Left = Math::Max( a_A.GetLeft(), a_B.GetLeft() );
+		int32_t Bottom = Math::Max( a_A.GetBottom(), a_B.GetBottom() );
+		int32_t Right = Math::Min( a_A.GetRight(), a_B.GetRight() );
+		int32_t Top = Math::Min( a_A.GetTop(), a_B.GetTop() );
+
+		if ( Right < Left || Top < Bottom )
+		{
+			return RectInt();
+		}
+
+		return RectInt( Left, Bottom, Right - Left + 1, Top - Bottom + 1 );
+	}
+
+	static bool Overlaps( const RectInt& a_A, const RectInt& a_B )
+	{
+		return
+			a_A.Size.x > 0 && a_A.Size.y > 0 &&
+			a_B.Size.x > 0 && a_B.Size.y > 0 &&
+			a_A.GetLeft() <= a_B.GetRight() && a_B.GetLeft() <= a_A.GetRight() &&
+			a_A.GetBottom() <= a_B.GetTop() && a_B.GetBottom() <= a_A.GetTop();
+	}
+
+	// Empty rectangles are ignored.
+	static RectInt Union( const RectInt& a_A, const RectInt& a_B )
+	{
+		if ( a_A.Size.x <= 0 || a_A.Size.y <= 0 )
+		{
+			return a_B;
+		}
+
+		if ( a_B.Size.x <= 0 || a_B.Size.y <= 0 )
+		{
+			return a_A;
+		}
+
+		int32_t Left = Math::Min( a_A.GetLeft(), a_B.GetLeft() );
+		int32_t Bottom = Math::Min( a_A.GetBottom(), a_B.GetBottom() );
+		int32_t Right = Math::Max( a_A.GetRight(), a_B.GetRight() );
+		int32_t Top = Math::Max( a_A.GetTop(), a_B.GetTop() );
+		return RectInt( Left, Bottom, Right - Left + 1, Top - Bottom + 1 );
 	}
 
 	static void ApplyAssets()
 	{
 		// Apply mesh attributes.
-		if ( s_ActiveMesh )
+		if ( s_ActiveMesh && s_MeshDirty )
 		{
 			if ( !s_ArrayHandle )
 			{
 				Rendering::GenVertexArrays( 1, &s_ArrayHandle );
 			}
 
-			for ( uint32_t i = 0; i < 6; ++i )
+			for ( uint32_t i = 0; i < 9; ++i )
 			{
 				if ( !s_BufferHandles[ i ] )
 				{
@@ -157,33 +911,41 @@ private:
 				Rendering::EnableVertexAttribArray( 5 );
 			}
 
+			// Baked lightmaps are addressed by the second texel channel.
+			if ( s_ActiveMesh->HasTexels( 1 ) )
+			{
+				Rendering::BindBuffer( BufferTarget::ARRAY_BUFFER, s_BufferHandles[ 8 ] );
+				Rendering::BufferData( BufferTarget::ARRAY_BUFFER, VertexCount * sizeof( Vector2 ), s_ActiveMesh->GetTexels( 1 ), DataUsage::DRAW );
+				Rendering::VertexAttribPointer( 6, 2, DataType::FLOAT, false, sizeof( Vector2 ), ( void* )0 );
+				Rendering::EnableVertexAttribArray( 6 );
+			}
+
 			Rendering::BindVertexArray( 0 );
 			Rendering::BindVertexArray( s_ArrayHandle );
 		}
 		
 		// Apply material properties.
-		if ( s_ActiveMaterial )
+		if ( s_ActiveMaterial && s_MaterialDirty )
 		{
 			s_ActiveMaterial->Apply();
 		}
+
+		s_MeshDirty = false;
+		s_MaterialDirty = false;
 	}
 
 	static void Draw()
 	{
-		if ( s_Dirty )
+		if ( s_MeshDirty || s_MaterialDirty )
 		{
 			ApplyAssets();
-			s_Dirty = false;
 		}
 
 		// Set PVM
 		if ( s_ActiveModel )
 		{
-			static Matrix4 PV;
-			PV = Camera::GetMainCamera()->GetProjectionViewMatrix();
-
 			static Matrix4 PVM;
-			PVM = Math::Multiply( PV, *s_ActiveModel );
+			PVM = Math::Multiply( s_ActiveCamera->ProjectionView, *s_ActiveModel );
 
 			int32_t PVMLocation = Rendering::GetUniformLocation( s_ActiveMaterial->GetShader().GetProgramHandle(), "u_PVM" );
 
@@ -201,7 +963,32 @@ private:
 		}
 
 		// Set Sun
-		if ( int32_t SunLocation = Rendering::GetUniformLocation( s_ActiveMaterial->GetShader().GetProgramHandle(), "u_SunLight" ); SunLocation >= 0 )
+		ApplySun( s_ActiveMaterial->GetShader().GetProgramHandle() );
+
+		if ( s_ActiveBlock )
+		{
+			s_ActiveBlock->Apply( *s_ActiveMaterial );
+		}
+
+		// Draw code. An unmoved mesh under a still camera skips its vertex stage. Meshes keep their addresses
+		// while their contents change, so the revision tags what the cache holds for them.
+		if ( s_ActiveMesh )
+		{
+			Rendering::VertexCacheTag( s_ActiveMesh->GetRevision() );
+			Rendering::Enable( RenderSetting::VERTEX_CACHE );
+			Rendering::DrawElements( s_ActiveRenderMode, s_ActiveMesh->GetIndexCount(), DataType::UNSIGNED_INT, s_ActiveMesh->GetIndices() );
+			Rendering::Disable( RenderSetting::VERTEX_CACHE );
+		}
+
+		if ( s_ActiveBlock )
+		{
+			s_ActiveBlock->Restore( *s_ActiveMaterial );
+		}
+	}
+
+	static void ApplySun( ShaderProgramHandle a_Program )
+	{
+		if ( int32_t SunLocation = Rendering::GetUniformLocation( a_Program, "u_SunLight" ); SunLocation >= 0 )
 		{
 			Vector3 SunDirection;
 
@@ -216,21 +1003,143 @@ private:
 
 			Rendering::Uniform3f( SunLocation, SunDirection.x, SunDirection.y, SunDirection.z );
 		}
+	}
 
-		
+	// Draws the active mesh once per model through the material's instanced program.
+	// Material uniforms are shared by name, so values applied for the regular program carry over.
+	// Instances tinted by a property block draw with a white diffuse_colour and their tint, or the
+	// material's colour, as the instance colour.
+	static void DrawInstanced( const std::vector< const Matrix4* >& a_Models, const std::vector< const MaterialPropertyBlock* >& a_Blocks )
+	{
+		if ( s_MeshDirty || s_MaterialDirty )
+		{
+			ApplyAssets();
+		}
 
-		// Draw code.
-		if ( s_ActiveMesh )
+		if ( !s_ActiveMesh || !s_ActiveMaterial )
+		{
+			return;
+		}
+
+		uint32_t InstanceCount = static_cast< uint32_t >( a_Models.size() );
+		s_InstanceModels.resize( InstanceCount );
+		s_InstanceColours.assign( InstanceCount, Vector4::One );
+
+		for ( uint32_t i = 0; i < InstanceCount; ++i )
 		{
-			Rendering::DrawElements( RenderMode::TRIANGLE, s_ActiveMesh->GetIndexCount(), DataType::UNSIGNED_INT, s_ActiveMesh->GetIndices() );
+			s_InstanceModels[ i ] = *a_Models[ i ];
+		}
+
+		auto Colour = s_ActiveMaterial->m_Attributes.find( "diffuse_colour"_H );
+		bool Tinted =
+			Colour != s_ActiveMaterial->m_Attributes.end() && Colour->second.m_Location >= 0 &&
+			std::any_of( a_Blocks.begin(), a_Blocks.end(), []( const MaterialPropertyBlock* a_Block ) { return a_Block; } );
+
+		if ( Tinted )
+		{
+			Vector4 Base = Vector4::One;
+			s_ActiveMaterial->GetProperty( "diffuse_colour"_H, Base );
+
+			for ( uint32_t i = 0; i < InstanceCount; ++i )
+			{
+				if ( !a_Blocks[ i ] || !a_Blocks[ i ]->GetProperty( "diffuse_colour"_H, s_InstanceColours[ i ] ) )
+				{
+					s_InstanceColours[ i ] = Base;
+				}
+			}
+
+			Material::Upload( Colour->second.m_Location, MaterialProperty::Type::FLOAT, 4, Vector4::One.Data );
+		}
+
+		Rendering::BindVertexArray( s_ArrayHandle );
+		Rendering::BindBuffer( BufferTarget::ARRAY_BUFFER, s_BufferHandles[ 6 ] );
+		Rendering::BufferData( BufferTarget::ARRAY_BUFFER, InstanceCount * sizeof( Matrix4 ), s_InstanceModels.data(), DataUsage::DRAW );
+		Rendering::VertexAttribPointer( 8, 16, DataType::FLOAT, false, sizeof( Matrix4 ), ( void* )0 );
+		Rendering::VertexAttribDivisor( 8, 1 );
+		Rendering::EnableVertexAttribArray( 8 );
+		Rendering::BindBuffer( BufferTarget::ARRAY_BUFFER, s_BufferHandles[ 7 ] );
+		Rendering::BufferData( BufferTarget::ARRAY_BUFFER, InstanceCount * sizeof( Vector4 ), s_InstanceColours.data(), DataUsage::DRAW );
+		Rendering::VertexAttribPointer( 9, 4, DataType::FLOAT, false, sizeof( Vector4 ), ( void* )0 );
+		Rendering::VertexAttribDivisor( 9, 1 );
+		Rendering::EnableVertexAttribArray( 9 );
+		Rendering::BindVertexArray( s_ArrayHandle );
+
+		ShaderProgramHandle Program = s_ActiveMaterial->GetShader().GetInstancedProgramHandle();
+		Rendering::UseProgram( Program );
+
+		if ( int32_t PVLocation = Rendering::GetUniformLocation( Program, "u_PV" ); PVLocation >= 0 )
+		{
+			Rendering::UniformMatrix4fv( PVLocation, 1, false, s_ActiveCamera->ProjectionView.Data );
+		}
+
+		ApplySun( Program );
+		Rendering::DrawElementsInstanced( RenderMode::TRIANGLE, s_ActiveMesh->GetIndexCount(), DataType::UNSIGNED_INT, s_ActiveMesh->GetIndices(), InstanceCount );
+
+		// Back to per draw state for the next non instanced draw.
+		Rendering::DisableVertexAttribArray( 8 );
+		Rendering::DisableVertexAttribArray( 9 );
+		Rendering::BindVertexArray( s_ArrayHandle );
+		Rendering::UseProgram( s_ActiveMaterial->GetShader().GetProgramHandle() );
+
+		if ( Tinted )
+		{
+			Material::Upload( Colour->second.m_Location, MaterialProperty::Type::FLOAT, Colour->second.m_Size, Colour->second.Get< float >() );
 		}
 	}
 	
-	inline static bool            s_Dirty;
+	inline static bool            s_MeshDirty;
+	inline static bool            s_MaterialDirty;
 	inline static const Mesh*     s_ActiveMesh;
 	inline static const Material* s_ActiveMaterial;
 	inline static const Matrix4*  s_ActiveModel;
-	inline static const Matrix4*  s_ActivePV;
+	inline static const MaterialPropertyBlock* s_ActiveBlock;
+	inline static RenderMode      s_ActiveRenderMode = RenderMode::TRIANGLE;
+	inline static const CameraBlock* s_ActiveCamera;
 	inline static ArrayHandle     s_ArrayHandle;
-	inline static BufferHandle    s_BufferHandles[ 6 ];
+	inline static BufferHandle    s_BufferHandles[ 9 ];
+	inline static std::vector< Matrix4 > s_InstanceModels;
+	inline static std::vector< Vector4 > s_InstanceColours;
+
+	// Screen area and state hash of a draw, used to find what changed between frames.
+	struct DrawRecord
+	{
+		size_t  State;
+		RectInt Bounds;
+	};
+
+	// What a camera covered last frame, any change redraws everything.
+	struct CameraRecord
+	{
+		Matrix4 ProjectionView;
+		RectInt Viewport;
+	};
+
+	inline static bool                 s_DynamicResolution = false;
+	inline static float                s_TargetFrameTime = 1.0f / 30.0f;
+	inline static float                s_MinimumScale = 0.5f;
+	inline static float                s_ResolutionScale = 1.0f;
+	inline static float                s_SmoothFrameTime = 0.0f;
+	inline static FramebufferHandle    s_Framebuffer;
+	inline static TextureHandle        s_ColourAttachment;
+	inline static TextureHandle        s_DepthAttachment;
+	inline static FramebufferHandle    s_PostFramebuffer;
+	inline static TextureHandle        s_PostAttachment;
+	inline static Vector2Int           s_TargetSize;
+	inline static bool                 s_LastOffscreen = false;
+	inline static std::vector< Colour > s_ColourStorage;
+	inline static std::vector< float >  s_DepthStorage;
+
+	inline static std::vector< RenderPass >   s_Passes;
+	inline static std::unordered_map< size_t, DrawRecord > s_DrawRecords;
+	inline static std::vector< CameraRecord > s_LastCameras;
+	inline static uint32_t                    s_FullRedrawFrames = 1;
+	inline static Vector2Int                  s_LastScreenSize;
+	inline static Vector3                     s_LastSunDirection;
+	inline static bool                        s_LastHadDebugGeometry = false;
+
+	inline static DebugView                   s_DebugView = DebugView::NONE;
+	inline static bool                        s_StatisticsEnabled = false;
+	inline static RenderStatistics            s_Statistics;
+	inline static std::vector< float >        s_DebugValues;
+	inline static std::vector< Colour >       s_DebugColours;
 };
\ No newline at end of file
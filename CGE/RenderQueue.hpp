@@ -1,5 +1,26 @@
 #pragma once
+#include <list>
+#include <vector>
+#include <algorithm>
 #include "RenderInstruction.hpp"
+#include "Material.hpp"
+#include "MaterialPropertyBlock.hpp"
+#include "Mesh.hpp"
+#include "Rect.hpp"
+#include "CameraBlock.hpp"
+
+// The instructions a single camera executes, built from the queue by RenderQueue::Sort.
+struct RenderPass
+{
+	std::list< RenderInstruction > Instructions;
+	std::vector< std::vector< const Matrix4* > > InstanceBatches;
+
+	// The property block of each instance, or null, matching InstanceBatches.
+	std::vector< std::vector< const MaterialPropertyBlock* > > InstanceBlocks;
+
+	// Screen bounds of each draw, in order, filled in by the pipeline.
+	std::vector< RectInt > DrawBounds;
+};
 
 class RenderQueue
 {
@@ -17,27 +38,224 @@ public:
 
 private:
 
-	inline void Sort()
+	// The state a single DRAW instruction was issued with.
+	struct DrawPacket
 	{
-		// Need to sort the queue here somehow.
-	}
+		const Mesh*                  SourceMesh;
+		const Material*              SourceMaterial;
+		const Matrix4*               SourceModel;
+		const MaterialPropertyBlock* SourceBlock;
+		uint32_t                     Layer;
+		float                        Depth;
+		uint32_t                     Order;
+		std::vector< RenderInstruction > Preamble;
+	};
 
-	inline RenderInstruction& Front()
+	// Builds the pass for one camera. Draws outside its layer mask or frustum are dropped,
+	// opaque draws are grouped by material then mesh, transparent draws go last and back to front.
+	// The queue itself is left untouched so it can be sorted for every camera.
+	void Sort( const CameraBlock& a_Camera, RenderPass& o_Pass ) const
 	{
-		return m_RenderInstructions.front();
+		std::vector< DrawPacket > Packets;
+		DrawPacket Current{ nullptr, nullptr, nullptr, nullptr, 0, 0.0f, 0 };
+		uint32_t Order = 0;
+
+		for ( auto& Instruction : m_RenderInstructions )
+		{
+			if ( Instruction.Modification == RenderInstruction::Modification::DRAW )
+			{
+				Current.Order = Order++;
+
+				if ( IsVisible( Current, a_Camera ) )
+				{
+					if ( Current.SourceModel )
+					{
+						Vector3 Position = { Current.SourceModel->Data[ 3 ], Current.SourceModel->Data[ 7 ], Current.SourceModel->Data[ 11 ] };
+						Current.Depth = Math::LengthSqrd( Position - a_Camera.Position );
+					}
+
+					Packets.push_back( Current );
+				}
+
+				Current.Preamble.clear();
+				Current.SourceBlock = nullptr;
+				Current.Layer = 0;
+				continue;
+			}
+
+			if ( Instruction.Modification == RenderInstruction::Modification::SET )
+			{
+				switch ( Instruction.Object )
+				{
+					case RenderInstruction::Object::Mesh:          Current.SourceMesh = static_cast< const Mesh* >( Instruction.ResourceSource );                     continue;
+					case RenderInstruction::Object::Material:      Current.SourceMaterial = static_cast< const Material* >( Instruction.ResourceSource );             continue;
+					case RenderInstruction::Object::Model:         Current.SourceModel = static_cast< const Matrix4* >( Instruction.ResourceSource );                 continue;
+					case RenderInstruction::Object::Layer:         Current.Layer = Instruction.Index;                                                               continue;
+					case RenderInstruction::Object::PropertyBlock: Current.SourceBlock = static_cast< const MaterialPropertyBlock* >( Instruction.ResourceSource ); continue;
+					default: break;
+				}
+			}
+
+			Current.Preamble.push_back( Instruction );
+		}
+
+		std::stable_sort( Packets.begin(), Packets.end(), []( const DrawPacket& a_Left, const DrawPacket& a_Right )
+		{
+			bool LeftTransparent = a_Left.SourceMaterial && a_Left.SourceMaterial->IsTransparent();
+			bool RightTransparent = a_Right.SourceMaterial && a_Right.SourceMaterial->IsTransparent();
+
+			if ( LeftTransparent != RightTransparent )
+			{
+				return RightTransparent;
+			}
+
+			if ( LeftTransparent )
+			{
+				return a_Left.Depth > a_Right.Depth;
+			}
+
+			if ( a_Left.SourceMaterial != a_Right.SourceMaterial )
+			{
+				return a_Left.SourceMaterial < a_Right.SourceMaterial;
+			}
+
+			if ( a_Left.SourceMesh != a_Right.SourceMesh )
+			{
+				return a_Left.SourceMesh < a_Right.SourceMesh;
+			}
+
+			return a_Left.Order < a_Right.Order;
+		} );
+
+		// Rebuild the instruction list, only setting resources when they change.
+		std::list< RenderInstruction >& Sorted = o_Pass.Instructions;
+		const Mesh* ActiveMesh = nullptr;
+		const Material* ActiveMaterial = nullptr;
+
+		Sorted.clear();
+		o_Pass.InstanceBatches.clear();
+		o_Pass.InstanceBlocks.clear();
+		o_Pass.DrawBounds.clear();
+
+		for ( auto Begin = Packets.begin(), End = Packets.end(); Begin != End; ++Begin )
+		{
+			auto& Packet = *Begin;
+			Sorted.insert( Sorted.end(), Packet.Preamble.begin(), Packet.Preamble.end() );
+
+			// Runs of opaque draws sharing a mesh and an instancing material collapse into one draw. Property blocks
+			// that only tint are passed as instance colours.
+			auto RunEnd = Begin + 1;
+			auto Instanceable = []( const DrawPacket& a_Packet ) { return !a_Packet.SourceBlock || a_Packet.SourceBlock->IsInstanceable(); };
+
+			if ( Packet.SourceMaterial && !Packet.SourceMaterial->IsTransparent() && Packet.SourceMaterial->GetShader().HasInstancing() && Instanceable( Packet ) )
+			{
+				while ( RunEnd != End &&
+						RunEnd->SourceMesh == Packet.SourceMesh &&
+						RunEnd->SourceMaterial == Packet.SourceMaterial &&
+						RunEnd->SourceModel &&
+						RunEnd->Preamble.empty() &&
+						Instanceable( *RunEnd ) )
+				{
+					++RunEnd;
+				}
+			}
+
+			if ( RunEnd - Begin > 1 && Packet.SourceModel )
+			{
+				if ( Packet.SourceMesh != ActiveMesh )
+				{
+					Sorted.push_back( MakeSet( RenderInstruction::Object::Mesh, Packet.SourceMesh ) );
+					ActiveMesh = Packet.SourceMesh;
+				}
+
+				if ( Packet.SourceMaterial != ActiveMaterial )
+				{
+					Sorted.push_back( MakeSet( RenderInstruction::Object::Material, Packet.SourceMaterial ) );
+					ActiveMaterial = Packet.SourceMaterial;
+				}
+
+				auto& Batch = o_Pass.InstanceBatches.emplace_back();
+				auto& Blocks = o_Pass.InstanceBlocks.emplace_back();
+
+				for ( auto Instance = Begin; Instance != RunEnd; ++Instance )
+				{
+					Batch.push_back( Instance->SourceModel );
+					Blocks.push_back( Instance->SourceBlock );
+				}
+
+				RenderInstruction Draw;
+				Draw.Modification = RenderInstruction::Modification::DRAW;
+				Draw.Object = RenderInstruction::Object::Instances;
+				Draw.Index = static_cast< uint32_t >( o_Pass.InstanceBatches.size() - 1 );
+				Sorted.push_back( Draw );
+
+				Begin = RunEnd - 1;
+				continue;
+			}
+
+			if ( Packet.SourceMesh != ActiveMesh )
+			{
+				Sorted.push_back( MakeSet( RenderInstruction::Object::Mesh, Packet.SourceMesh ) );
+				ActiveMesh = Packet.SourceMesh;
+			}
+
+			if ( Packet.SourceMaterial != ActiveMaterial )
+			{
+				Sorted.push_back( MakeSet( RenderInstruction::Object::Material, Packet.SourceMaterial ) );
+				ActiveMaterial = Packet.SourceMaterial;
+			}
+
+			Sorted.push_back( MakeSet( RenderInstruction::Object::Model, Packet.SourceModel ) );
+
+			if ( Packet.SourceBlock )
+			{
+				Sorted.push_back( MakeSet( RenderInstruction::Object::PropertyBlock, Packet.SourceBlock ) );
+			}
+
+			RenderInstruction Draw;
+			Draw.Modification = RenderInstruction::Modification::DRAW;
+			Draw.Object = RenderInstruction::Object::None;
+			Sorted.push_back( Draw );
+		}
+
+		Sorted.insert( Sorted.end(), Current.Preamble.begin(), Current.Preamble.end() );
 	}
 
-	inline void Pop()
+	// Bounding sphere of the mesh, scaled by the largest axis of the model, against the camera frustum.
+	static bool IsVisible( const DrawPacket& a_Packet, const CameraBlock& a_Camera )
 	{
-		m_RenderInstructions.pop_front();
+		if ( !( a_Camera.LayerMask & ( 1u << a_Packet.Layer ) ) )
+		{
+			return false;
+		}
+
+		if ( !a_Packet.SourceMesh || !a_Packet.SourceModel || !a_Packet.SourceMesh->HasPositions() )
+		{
+			return true;
+		}
+
+		const Matrix4& Model = *a_Packet.SourceModel;
+		float Scale = Math::Max( Math::Max(
+			Math::LengthSqrd( Vector3( Model.Data[ 0 ], Model.Data[ 4 ], Model.Data[ 8 ] ) ),
+			Math::LengthSqrd( Vector3( Model.Data[ 1 ], Model.Data[ 5 ], Model.Data[ 9 ] ) ) ),
+			Math::LengthSqrd( Vector3( Model.Data[ 2 ], Model.Data[ 6 ], Model.Data[ 10 ] ) ) );
+
+		Vector3 Centre = { Model.Data[ 3 ], Model.Data[ 7 ], Model.Data[ 11 ] };
+		return a_Camera.ViewFrustum.Intersects( Centre, a_Packet.SourceMesh->GetRadius() * Math::Sqrt( Scale ) );
 	}
 
-	inline bool Empty()
+	inline static RenderInstruction MakeSet( RenderInstruction::Object a_Object, const void* a_Source )
 	{
-		return m_RenderInstructions.empty();
+		RenderInstruction Instruction;
+		Instruction.Modification = RenderInstruction::Modification::SET;
+		Instruction.Object = a_Object;
+		Instruction.ResourceSource = a_Source;
+		return Instruction;
 	}
 
 	friend class RenderPipeline;
+	friend class StaticBatching;
+	friend class RayTracer;
 
 	std::list< RenderInstruction > m_RenderInstructions;
-};
\ No newline at end of file
+};
@@ -9,4 +9,19 @@ public:
 	friend class RenderPipeline;
 	
 	virtual void OnRender( RenderQueue& a_RenderQueue ) const { };
+
+	// One of 32 layers, cameras skip renderers outside their layer mask.
+	inline uint8_t GetLayer() const
+	{
+		return m_Layer;
+	}
+
+	inline void SetLayer( uint8_t a_Layer )
+	{
+		m_Layer = a_Layer & 31u;
+	}
+
+protected:
+
+	uint8_t m_Layer = 0;
 };
\ No newline at end of file
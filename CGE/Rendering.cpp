@@ -1,23 +1,29 @@
 #include "Rendering.hpp"
 #include "ConsoleWindow.hpp"
+#include "RenderCapture.hpp"
 
 void Rendering::Init()
 {
 	s_DepthBuffer.Init( ConsoleWindow::GetCurrentContext()->GetSize() );
+	UpdateDrawTarget();
 }
 
 void Rendering::GenBuffers( uint32_t a_Count, BufferHandle* a_Handles )
 {
+	uint32_t Count = a_Count;
 	while ( a_Count-- > 0 ) a_Handles[ a_Count ] = s_BufferRegistry.Create();
+	RenderCapture::RecordHandles( RenderCapture::Call::GEN_BUFFERS, Count, a_Handles );
 }
 
 void Rendering::BindBuffer( BufferTarget a_BufferTarget, BufferHandle a_Handle )
 {
+	RenderCapture::Record( RenderCapture::Call::BIND_BUFFER, a_BufferTarget, a_Handle );
 	s_BufferTargets[ ( uint32_t )a_BufferTarget ] = a_Handle;
 }
 
 void Rendering::DeleteBuffers( uint32_t a_Count, BufferHandle* a_Handles )
 {
+	RenderCapture::RecordHandles( RenderCapture::Call::DELETE_BUFFERS, a_Count, a_Handles );
 	while ( a_Count-- > 0 )
 	{
 		// Unbind from buffer target if exists.
@@ -42,19 +48,58 @@ bool Rendering::IsBuffer( BufferHandle a_Handle )
 
 void Rendering::UseProgram( ShaderProgramHandle a_ShaderProgramHandle )
 {
+	RenderCapture::Record( RenderCapture::Call::USE_PROGRAM, a_ShaderProgramHandle );
 	s_ActiveShaderProgram = a_ShaderProgramHandle;
 }
 
 void Rendering::Clear( uint8_t a_Flags )
 {
+	RenderCapture::RecordDraw( RenderCapture::Call::CLEAR, a_Flags );
+
+	// Clears are limited to the scissor rectangle when the test is enabled, the viewport doesn't apply.
+	UpdateDrawTarget();
+	Vector2Int Min, Max;
+	GetWriteBounds( Min, Max );
+	RectInt Area( Min.x, Min.y, Max.x - Min.x + 1, Max.y - Min.y + 1 );
+
+	if ( Area.Size.x <= 0 || Area.Size.y <= 0 )
+	{
+		return;
+	}
+
 	if ( a_Flags & static_cast< uint8_t >( BufferFlag::COLOUR_BUFFER_BIT ) )
 	{
-		ConsoleWindow::GetCurrentContext()->GetScreenBuffer().SetBuffer( s_ClearColour );
+		if ( ScreenBuffer* Screen = s_DrawTarget.Screen )
+		{
+			if ( s_RenderState.ScissorTest )
+			{
+				Screen->SetRect( Rect( Area.Origin.x, Area.Origin.y, Area.Size.x, Area.Size.y ), s_ClearColour );
+			}
+			else
+			{
+				Screen->SetBuffer( s_ClearColour );
+			}
+		}
+		else if ( s_DrawTarget.Colours )
+		{
+			for ( int32_t y = Area.GetBottom(); y <= Area.GetTop(); ++y )
+			{
+				Colour* Begin = s_DrawTarget.Colours + static_cast< size_t >( y ) * s_DrawTarget.Pitch + Area.GetLeft();
+				std::fill( Begin, Begin + Area.Size.x, s_ClearColour );
+			}
+		}
 	}
 
-	if ( a_Flags & static_cast< uint8_t >( BufferFlag::DEPTH_BUFFER_BIT ) )
+	if ( a_Flags & static_cast< uint8_t >( BufferFlag::DEPTH_BUFFER_BIT ) && s_DrawTarget.Depth )
 	{
-		s_DepthBuffer.Reset( s_ClearDepth );
+		if ( s_RenderState.ScissorTest || s_DrawTarget.Depth->GetSize() != s_DrawTarget.Size )
+		{
+			s_DrawTarget.Depth->Reset( s_ClearDepth, Area );
+		}
+		else
+		{
+			s_DrawTarget.Depth->Reset( s_ClearDepth );
+		}
 	}
 
 	if ( a_Flags & static_cast< uint8_t >( BufferFlag::ACCUM_BUFFER_BIT ) )
@@ -70,41 +115,34 @@ void Rendering::Clear( uint8_t a_Flags )
 
 void Rendering::ClearColour( float a_R, float a_G, float a_B, float a_A )
 {
-	s_ClearColour = PixelColourMap::Get().ConvertColour( {
+	RenderCapture::Record( RenderCapture::Call::CLEAR_COLOUR, a_R, a_G, a_B, a_A );
+	s_ClearColour = {
 		static_cast< unsigned char >( 255u * a_R ),
 		static_cast< unsigned char >( 255u * a_G ),
 		static_cast< unsigned char >( 255u * a_B ),
-		static_cast< unsigned char >( 255u * a_A ) } );
+		static_cast< unsigned char >( 255u * a_A ) };
 }
 
 void Rendering::ClearDepth( float a_ClearDepth )
 {
+	RenderCapture::Record( RenderCapture::Call::CLEAR_DEPTH, a_ClearDepth );
 	s_ClearDepth = a_ClearDepth;
 }
 
 void Rendering::DrawArrays( RenderMode a_Mode, uint32_t a_Begin, uint32_t a_Count )
 {
+	RenderCapture::RecordDraw( RenderCapture::Call::DRAW_ARRAYS, a_Mode, a_Begin, a_Count );
 	s_AttributeRegistry.UnsetIndices();
 	UpdateDrawProcessor();
-
-	switch ( a_Mode )
-	{
-		case RenderMode::POINT:
-			break;
-		case RenderMode::LINE:
-			break;
-		case RenderMode::TRIANGLE:
-		{
-			s_DrawProcessorFunc( a_Begin, a_Count );
-			break;
-		}
-		default:
-			break;
-	}
+	s_RenderMode = a_Mode;
+	InstanceID = 0;
+	s_AttributeRegistry.SetInstance( 0 );
+	s_DrawProcessorFunc( a_Begin, a_Count );
 }
 
 void Rendering::BufferData( BufferTarget a_BufferTarget, size_t a_Size, const void* a_Data, DataUsage a_DataUsage )
 {
+	RenderCapture::RecordBufferData( s_BufferTargets[ ( uint32_t )a_BufferTarget ], a_Size, a_DataUsage );
 	Buffer& TargetBuffer = s_BufferRegistry[ s_BufferTargets[ ( uint32_t )a_BufferTarget ] ];
 	//TargetBuffer.resize( a_Size );
 	
@@ -117,6 +155,7 @@ void Rendering::BufferData( BufferTarget a_BufferTarget, size_t a_Size, const vo
 
 void Rendering::NamedBufferData( BufferHandle a_Handle, size_t a_Size, const void* a_Data, DataUsage a_DataUsage )
 {
+	RenderCapture::RecordBufferData( a_Handle, a_Size, a_DataUsage );
 	Buffer& TargetBuffer = s_BufferRegistry[ a_Handle ];
 	//TargetBuffer.resize( a_Size );
 
@@ -129,11 +168,14 @@ void Rendering::NamedBufferData( BufferHandle a_Handle, size_t a_Size, const voi
 
 void Rendering::GenVertexArrays( uint32_t a_Count, ArrayHandle* a_Handles )
 {
+	uint32_t Count = a_Count;
 	while ( a_Count-- > 0 ) a_Handles[ a_Count ] = s_ArrayRegistry.Create();
+	RenderCapture::RecordHandles( RenderCapture::Call::GEN_VERTEX_ARRAYS, Count, a_Handles );
 }
 
 void Rendering::BindVertexArray( ArrayHandle a_Handle )
 {
+	RenderCapture::Record( RenderCapture::Call::BIND_VERTEX_ARRAY, a_Handle );
 	if ( !a_Handle )
 	{
 		s_ActiveArray = 0;
@@ -143,17 +185,23 @@ void Rendering::BindVertexArray( ArrayHandle a_Handle )
 	s_ActiveArray = a_Handle;
 	auto& ActiveArray = s_ArrayRegistry[ a_Handle ];
 	
-	for ( uint8_t i = 0; i < 8; ++i )
+	for ( uint8_t i = 0; i < 16; ++i )
 	{
 		if ( ActiveArray[ i ].Enabled )
 		{
 			s_AttributeRegistry[ i ] = ActiveArray[ i ];
+			s_AttributeRegistry.SetDivisor( i, ActiveArray[ i ].Divisor );
+		}
+		else
+		{
+			s_AttributeRegistry.SetDivisor( i, 0 );
 		}
 	}
 }
 
 void Rendering::DeleteVertexArrays( uint32_t a_Count, ArrayHandle* a_Handles )
 {
+	RenderCapture::RecordHandles( RenderCapture::Call::DELETE_VERTEX_ARRAYS, a_Count, a_Handles );
 	while ( a_Count-- > 0 )
 	{
 		// Unbind bound vertex array if exists.
@@ -169,16 +217,19 @@ void Rendering::DeleteVertexArrays( uint32_t a_Count, ArrayHandle* a_Handles )
 
 void Rendering::EnableVertexAttribArray( uint32_t a_Position )
 {
+	RenderCapture::Record( RenderCapture::Call::ENABLE_VERTEX_ATTRIB_ARRAY, a_Position );
 	s_ArrayRegistry[ s_ActiveArray ][ a_Position ].Enabled = true;
 }
 
 void Rendering::DisableVertexAttribArray( uint32_t a_Position )
 {
+	RenderCapture::Record( RenderCapture::Call::DISABLE_VERTEX_ATTRIB_ARRAY, a_Position );
 	s_ArrayRegistry[ s_ActiveArray ][ a_Position ].Enabled = false;
 }
 
 void Rendering::VertexAttribPointer( uint32_t a_Index, uint32_t a_Size, DataType a_DataType, bool a_Normalized, size_t a_Stride, void* a_Offset )
 {
+	RenderCapture::Record( RenderCapture::Call::VERTEX_ATTRIB_POINTER, a_Index, a_Size, a_DataType, a_Normalized, static_cast< uint64_t >( a_Stride ), static_cast< uint64_t >( reinterpret_cast< uintptr_t >( a_Offset ) ) );
 	auto& Attributes = s_ArrayRegistry[ s_ActiveArray ][ a_Index ];
 	Attributes.Buffer = s_BufferTargets[ ( uint32_t )BufferTarget::ARRAY_BUFFER ];
 	Attributes.Size = a_Size - 1;
@@ -187,10 +238,30 @@ void Rendering::VertexAttribPointer( uint32_t a_Index, uint32_t a_Size, DataType
 	Attributes.Stride = a_Stride;
 	Attributes.Enabled = false;
 	Attributes.Offset = ( uint32_t )a_Offset;
+	Attributes.Divisor = 0;
+}
+
+void Rendering::VertexAttribDivisor( uint32_t a_Index, uint32_t a_Divisor )
+{
+	RenderCapture::Record( RenderCapture::Call::VERTEX_ATTRIB_DIVISOR, a_Index, a_Divisor );
+	s_ArrayRegistry[ s_ActiveArray ][ a_Index ].Divisor = a_Divisor;
+}
+
+void Rendering::FlushVertexCache()
+{
+	RenderCapture::Record( RenderCapture::Call::FLUSH_VERTEX_CACHE );
+	s_VertexCache.clear();
+}
+
+void Rendering::VertexCacheTag( uint64_t a_Tag )
+{
+	RenderCapture::Record( RenderCapture::Call::VERTEX_CACHE_TAG, a_Tag );
+	s_VertexCacheTag = a_Tag;
 }
 
 void Rendering::DrawElements( RenderMode a_Mode, uint32_t a_Count, DataType a_DataType, const void* a_Indices )
 {
+	RenderCapture::RecordDrawElements( RenderCapture::Call::DRAW_ELEMENTS, a_Mode, a_Count, a_DataType, a_Indices, 1 );
 	const void* Indices = nullptr;
 	auto Handle = s_BufferTargets[ ( uint32_t )BufferTarget::ELEMENT_ARRAY_BUFFER ];
 	//Indices = s_BufferRegistry.Valid( Handle ) ? ( s_BufferRegistry[ Handle ].data() + ( uint32_t )a_Indices ) : a_Indices; 
@@ -205,12 +276,42 @@ void Rendering::DrawElements( RenderMode a_Mode, uint32_t a_Count, DataType a_Da
 	}
 
 	UpdateDrawProcessor();
-
+	s_RenderMode = a_Mode;
+	InstanceID = 0;
+	s_AttributeRegistry.SetInstance( 0 );
 	s_DrawProcessorFunc( 0, a_Count );
 }
 
+void Rendering::DrawElementsInstanced( RenderMode a_Mode, uint32_t a_Count, DataType a_DataType, const void* a_Indices, uint32_t a_InstanceCount )
+{
+	RenderCapture::RecordDrawElements( RenderCapture::Call::DRAW_ELEMENTS_INSTANCED, a_Mode, a_Count, a_DataType, a_Indices, a_InstanceCount );
+	const void* Indices = nullptr;
+	auto Handle = s_BufferTargets[ ( uint32_t )BufferTarget::ELEMENT_ARRAY_BUFFER ];
+	Indices = s_BufferRegistry.Valid( Handle ) ? ( s_BufferRegistry[ Handle ] + ( uint32_t )a_Indices ) : a_Indices;
+
+	switch ( a_DataType )
+	{
+		case DataType::UNSIGNED_BYTE:  s_AttributeRegistry.SetIndices( reinterpret_cast< const uint8_t*  >( Indices ) ); break;
+		case DataType::UNSIGNED_SHORT: s_AttributeRegistry.SetIndices( reinterpret_cast< const uint16_t* >( Indices ) ); break;
+		case DataType::UNSIGNED_INT:   s_AttributeRegistry.SetIndices( reinterpret_cast< const uint32_t* >( Indices ) ); break;
+		default: break;
+	}
+
+	UpdateDrawProcessor();
+	s_RenderMode = a_Mode;
+
+	// State and uniforms are resolved once, only the per instance streams move between runs.
+	for ( uint32_t i = 0; i < a_InstanceCount; ++i )
+	{
+		InstanceID = i;
+		s_AttributeRegistry.SetInstance( i );
+		s_DrawProcessorFunc( 0, a_Count );
+	}
+}
+
 void Rendering::Enable( RenderSetting a_RenderSetting )
 {
+	RenderCapture::Record( RenderCapture::Call::ENABLE, a_RenderSetting );
 	switch ( a_RenderSetting )
 	{
 		case RenderSetting::DEPTH_TEST:
@@ -223,6 +324,26 @@ void Rendering::Enable( RenderSetting a_RenderSetting )
 			s_RenderState.CullFace = true;
 			break;
 		}
+		case RenderSetting::BLEND:
+		{
+			s_RenderState.AlphaBlend = true;
+			break;
+		}
+		case RenderSetting::VERTEX_CACHE:
+		{
+			s_RenderState.VertexCache = true;
+			break;
+		}
+		case RenderSetting::SCISSOR_TEST:
+		{
+			s_RenderState.ScissorTest = true;
+			break;
+		}
+		case RenderSetting::DEBUG_COUNTERS:
+		{
+			s_RenderState.DebugCounters = true;
+			break;
+		}
 		default:
 			break;
 	}
@@ -230,6 +351,7 @@ void Rendering::Enable( RenderSetting a_RenderSetting )
 
 void Rendering::Disable( RenderSetting a_RenderSetting )
 {
+	RenderCapture::Record( RenderCapture::Call::DISABLE, a_RenderSetting );
 	switch ( a_RenderSetting )
 	{
 		case RenderSetting::DEPTH_TEST:
@@ -242,6 +364,26 @@ void Rendering::Disable( RenderSetting a_RenderSetting )
 			s_RenderState.CullFace = false;
 			break;
 		}
+		case RenderSetting::BLEND:
+		{
+			s_RenderState.AlphaBlend = false;
+			break;
+		}
+		case RenderSetting::VERTEX_CACHE:
+		{
+			s_RenderState.VertexCache = false;
+			break;
+		}
+		case RenderSetting::SCISSOR_TEST:
+		{
+			s_RenderState.ScissorTest = false;
+			break;
+		}
+		case RenderSetting::DEBUG_COUNTERS:
+		{
+			s_RenderState.DebugCounters = false;
+			break;
+		}
 		default:
 			break;
 	}
@@ -249,6 +391,7 @@ void Rendering::Disable( RenderSetting a_RenderSetting )
 
 void Rendering::CullFace( CullFaceMode a_CullFaceMode )
 {
+	RenderCapture::Record( RenderCapture::Call::CULL_FACE, a_CullFaceMode );
 	switch ( a_CullFaceMode )
 	{
 		case CullFaceMode::FRONT:
@@ -276,6 +419,7 @@ void Rendering::CullFace( CullFaceMode a_CullFaceMode )
 
 void Rendering::DepthFunc( TextureSetting a_TextureSetting )
 {
+	RenderCapture::Record( RenderCapture::Call::DEPTH_FUNC, a_TextureSetting );
 	switch ( a_TextureSetting )
 	{
 		case TextureSetting::LEQUAL:    s_DepthCompareFunc = DepthCompare_LEQUAL;    break;
@@ -290,15 +434,269 @@ void Rendering::DepthFunc( TextureSetting a_TextureSetting )
 	}
 }
 
+void Rendering::DepthMask( bool a_Flag )
+{
+	RenderCapture::Record( RenderCapture::Call::DEPTH_MASK, a_Flag );
+	s_RenderState.DepthWrite = a_Flag;
+}
+
+void Rendering::Scissor( int32_t a_X, int32_t a_Y, uint32_t a_Width, uint32_t a_Height )
+{
+	RenderCapture::Record( RenderCapture::Call::SCISSOR, a_X, a_Y, a_Width, a_Height );
+	s_ScissorRect = RectInt( a_X, a_Y, static_cast< int32_t >( a_Width ), static_cast< int32_t >( a_Height ) );
+}
+
+void Rendering::Viewport( int32_t a_X, int32_t a_Y, uint32_t a_Width, uint32_t a_Height )
+{
+	RenderCapture::Record( RenderCapture::Call::VIEWPORT, a_X, a_Y, a_Width, a_Height );
+	s_ViewportRect = RectInt( a_X, a_Y, static_cast< int32_t >( a_Width ), static_cast< int32_t >( a_Height ) );
+}
+
+void Rendering::GenFramebuffers( uint32_t a_Count, FramebufferHandle* a_Handles )
+{
+	uint32_t Count = a_Count;
+	while ( a_Count-- > 0 ) a_Handles[ a_Count ] = s_FramebufferRegistry.Create();
+	RenderCapture::RecordHandles( RenderCapture::Call::GEN_FRAMEBUFFERS, Count, a_Handles );
+}
+
+void Rendering::BindFramebuffer( FramebufferTarget a_Target, FramebufferHandle a_Handle )
+{
+	RenderCapture::Record( RenderCapture::Call::BIND_FRAMEBUFFER, a_Target, a_Handle );
+	if ( a_Target != FramebufferTarget::READ_FRAMEBUFFER )
+	{
+		s_DrawFramebuffer = a_Handle;
+		UpdateDrawTarget();
+	}
+
+	if ( a_Target != FramebufferTarget::DRAW_FRAMEBUFFER )
+	{
+		s_ReadFramebuffer = a_Handle;
+	}
+}
+
+void Rendering::DeleteFramebuffers( uint32_t a_Count, FramebufferHandle* a_Handles )
+{
+	RenderCapture::RecordHandles( RenderCapture::Call::DELETE_FRAMEBUFFERS, a_Count, a_Handles );
+	while ( a_Count-- > 0 )
+	{
+		// Zero and unknown handles are ignored, as in GL.
+		if ( !s_FramebufferRegistry.Valid( a_Handles[ a_Count ] ) )
+		{
+			continue;
+		}
+
+		// Deleting a bound framebuffer falls back to the window.
+		if ( s_DrawFramebuffer == a_Handles[ a_Count ] )
+		{
+			s_DrawFramebuffer = 0;
+		}
+
+		if ( s_ReadFramebuffer == a_Handles[ a_Count ] )
+		{
+			s_ReadFramebuffer = 0;
+		}
+
+		s_FramebufferRegistry.Destroy( a_Handles[ a_Count ] );
+		s_AttachmentDepths[ a_Handles[ a_Count ] - 1 ].Wrap( nullptr, Vector2Int::Zero );
+	}
+
+	UpdateDrawTarget();
+}
+
+bool Rendering::IsFramebuffer( FramebufferHandle a_Handle )
+{
+	return s_FramebufferRegistry.Valid( a_Handle );
+}
+
+void Rendering::FramebufferTexture2D( FramebufferTarget a_Target, FramebufferAttachment a_Attachment, TextureTarget a_TextureTarget, TextureHandle a_Texture, uint8_t a_MipMapLevel )
+{
+	RenderCapture::Record( RenderCapture::Call::FRAMEBUFFER_TEXTURE_2D, a_Target, a_Attachment, a_TextureTarget, a_Texture, a_MipMapLevel );
+	FramebufferHandle Handle = a_Target == FramebufferTarget::READ_FRAMEBUFFER ? s_ReadFramebuffer : s_DrawFramebuffer;
+
+	if ( Handle == 0 || a_TextureTarget != TextureTarget::TEXTURE_2D )
+	{
+		return;
+	}
+
+	Framebuffer& Target = s_FramebufferRegistry[ Handle ];
+	( a_Attachment == FramebufferAttachment::COLOUR_ATTACHMENT ? Target.ColourAttachment : Target.DepthAttachment ) = a_Texture;
+	UpdateDrawTarget();
+}
+
+void Rendering::BlitFramebuffer( int32_t a_SourceX0, int32_t a_SourceY0, int32_t a_SourceX1, int32_t a_SourceY1, int32_t a_DestinationX0, int32_t a_DestinationY0, int32_t a_DestinationX1, int32_t a_DestinationY1, uint8_t a_Mask, TextureSetting a_Filter )
+{
+	RenderCapture::RecordDraw( RenderCapture::Call::BLIT_FRAMEBUFFER, a_SourceX0, a_SourceY0, a_SourceX1, a_SourceY1, a_DestinationX0, a_DestinationY0, a_DestinationX1, a_DestinationY1, a_Mask, a_Filter );
+	// Both targets are looked up before either is written, the window resolves to the same storage each time.
+	DrawTarget Source = GetDrawTarget( s_ReadFramebuffer );
+	UpdateDrawTarget();
+
+	if ( a_DestinationX1 == a_DestinationX0 || a_DestinationY1 == a_DestinationY0 )
+	{
+		return;
+	}
+
+	// Destination pixels map back to source coordinates through their centres, the scissor applies.
+	Vector2Int Min, Max;
+	GetWriteBounds( Min, Max );
+	Vector2 Scale = {
+		static_cast< float >( a_SourceX1 - a_SourceX0 ) / ( a_DestinationX1 - a_DestinationX0 ),
+		static_cast< float >( a_SourceY1 - a_SourceY0 ) / ( a_DestinationY1 - a_DestinationY0 ) };
+
+	int32_t Left = Math::Max( Math::Min( a_DestinationX0, a_DestinationX1 ), Min.x );
+	int32_t Right = Math::Min( Math::Max( a_DestinationX0, a_DestinationX1 ) - 1, Max.x );
+	int32_t Bottom = Math::Max( Math::Min( a_DestinationY0, a_DestinationY1 ), Min.y );
+	int32_t Top = Math::Min( Math::Max( a_DestinationY0, a_DestinationY1 ) - 1, Max.y );
+	Vector2Int SourceMax = Source.Size - Vector2Int::One;
+
+	bool BlitColour = ( a_Mask & static_cast< uint8_t >( BufferFlag::COLOUR_BUFFER_BIT ) ) && Source.Colours && ( s_DrawTarget.Screen || s_DrawTarget.Colours );
+	bool BlitDepth = ( a_Mask & static_cast< uint8_t >( BufferFlag::DEPTH_BUFFER_BIT ) ) && Source.Depth && s_DrawTarget.Depth;
+
+	// Depth is never filtered.
+	bool Linear = a_Filter == TextureSetting::LINEAR;
+
+	for ( int32_t y = Bottom; y <= Top; ++y )
+	{
+		float SourceY = a_SourceY0 + ( y - a_DestinationY0 + 0.5f ) * Scale.y;
+
+		for ( int32_t x = Left; x <= Right; ++x )
+		{
+			float SourceX = a_SourceX0 + ( x - a_DestinationX0 + 0.5f ) * Scale.x;
+			Vector2Int Nearest = {
+				Math::Clamp( static_cast< int32_t >( Math::Floor( SourceX ) ), 0, SourceMax.x ),
+				Math::Clamp( static_cast< int32_t >( Math::Floor( SourceY ) ), 0, SourceMax.y ) };
+
+			if ( BlitColour )
+			{
+				Colour Result;
+
+				if ( Linear )
+				{
+					// Bilinear between the four nearest texel centres.
+					float FX = Math::Clamp( SourceX - 0.5f, 0.0f, static_cast< float >( SourceMax.x ) );
+					float FY = Math::Clamp( SourceY - 0.5f, 0.0f, static_cast< float >( SourceMax.y ) );
+					int32_t X0 = static_cast< int32_t >( FX ), Y0 = static_cast< int32_t >( FY );
+					int32_t X1 = Math::Min( X0 + 1, SourceMax.x ), Y1 = Math::Min( Y0 + 1, SourceMax.y );
+					float TX = FX - X0, TY = FY - Y0;
+
+					const Colour* Row0 = Source.Colours + static_cast< size_t >( Y0 ) * Source.Pitch;
+					const Colour* Row1 = Source.Colours + static_cast< size_t >( Y1 ) * Source.Pitch;
+					const Colour::Channel* C00 = &Row0[ X0 ].R;
+					const Colour::Channel* C10 = &Row0[ X1 ].R;
+					const Colour::Channel* C01 = &Row1[ X0 ].R;
+					const Colour::Channel* C11 = &Row1[ X1 ].R;
+					Colour::Channel* Out = &Result.R;
+
+					for ( uint32_t i = 0; i < 4; ++i )
+					{
+						float Upper = C00[ i ] + ( C10[ i ] - C00[ i ] ) * TX;
+						float Lower = C01[ i ] + ( C11[ i ] - C01[ i ] ) * TX;
+						Out[ i ] = static_cast< Colour::Channel >( Upper + ( Lower - Upper ) * TY + 0.5f );
+					}
+				}
+				else
+				{
+					Result = Source.Colours[ static_cast< size_t >( Nearest.y ) * Source.Pitch + Nearest.x ];
+				}
+
+				if ( s_DrawTarget.Screen )
+				{
+					s_DrawTarget.Screen->SetColour( { x, y }, Result );
+				}
+				else
+				{
+					s_DrawTarget.Colours[ static_cast< size_t >( y ) * s_DrawTarget.Pitch + x ] = Result;
+				}
+			}
+
+			if ( BlitDepth )
+			{
+				s_DrawTarget.Depth->Commit( x, y, Source.Depth->Get( Nearest.x, Nearest.y ) );
+			}
+		}
+	}
+}
+
+void Rendering::DrawPixels( int32_t a_X, int32_t a_Y, int32_t a_Width, int32_t a_Height, const Colour* a_Pixels )
+{
+	RenderCapture::RecordDraw( RenderCapture::Call::DRAW_PIXELS, a_X, a_Y, a_Width, a_Height, RenderCapture::Bytes{ a_Pixels, static_cast< size_t >( a_Width ) * a_Height * sizeof( Colour ) } );
+	UpdateDrawTarget();
+
+	if ( !s_DrawTarget.Screen && !s_DrawTarget.Colours )
+	{
+		return;
+	}
+
+	Vector2Int Min, Max;
+	GetWriteBounds( Min, Max );
+
+	int32_t Left = Math::Max( a_X, Min.x );
+	int32_t Right = Math::Min( a_X + a_Width - 1, Max.x );
+	int32_t Bottom = Math::Max( a_Y, Min.y );
+	int32_t Top = Math::Min( a_Y + a_Height - 1, Max.y );
+
+	for ( int32_t y = Bottom; y <= Top; ++y )
+	{
+		const Colour* Row = a_Pixels + static_cast< size_t >( y - a_Y ) * a_Width;
+
+		for ( int32_t x = Left; x <= Right; ++x )
+		{
+			if ( s_DrawTarget.Screen )
+			{
+				s_DrawTarget.Screen->SetColour( { x, y }, Row[ x - a_X ] );
+			}
+			else
+			{
+				s_DrawTarget.Colours[ static_cast< size_t >( y ) * s_DrawTarget.Pitch + x ] = Row[ x - a_X ];
+			}
+		}
+	}
+}
+
+void Rendering::BlendFunc( BlendFactor a_Source, BlendFactor a_Destination )
+{
+	RenderCapture::Record( RenderCapture::Call::BLEND_FUNC, a_Source, a_Destination );
+	s_BlendState.Source = a_Source;
+	s_BlendState.Destination = a_Destination;
+}
+
+void Rendering::BlendEquation( ::BlendEquation a_BlendEquation )
+{
+	RenderCapture::Record( RenderCapture::Call::BLEND_EQUATION, a_BlendEquation );
+	s_BlendState.Equation = a_BlendEquation;
+}
+
 void Rendering::GetBooleanv( RenderSetting a_RenderSetting, bool* a_Value )
 {
 	switch ( a_RenderSetting )
 	{
-		case RenderSetting::DEPTH_TEST: *a_Value = s_RenderState.DepthTest;
-		case RenderSetting::CULL_FACE: *a_Value = s_RenderState.CullFace;
+		case RenderSetting::DEPTH_TEST:   *a_Value = s_RenderState.DepthTest;   break;
+		case RenderSetting::CULL_FACE:    *a_Value = s_RenderState.CullFace;    break;
+		case RenderSetting::BLEND:        *a_Value = s_RenderState.AlphaBlend;  break;
+		case RenderSetting::VERTEX_CACHE: *a_Value = s_RenderState.VertexCache; break;
+		case RenderSetting::SCISSOR_TEST: *a_Value = s_RenderState.ScissorTest; break;
+		case RenderSetting::DEBUG_COUNTERS: *a_Value = s_RenderState.DebugCounters; break;
+		case RenderSetting::DEPTH_WRITEMASK: *a_Value = s_RenderState.DepthWrite; break;
+		default: break;
 	}
 }
 
+void Rendering::ResetStatistics()
+{
+	s_Statistics = RenderStatistics();
+	std::fill( s_Counters.Pixels.begin(), s_Counters.Pixels.end(), RenderCounters::Counter{} );
+	std::fill( s_Counters.TileTriangles.begin(), s_Counters.TileTriangles.end(), 0 );
+}
+
+const RenderStatistics& Rendering::GetStatistics()
+{
+	return s_Statistics;
+}
+
+const RenderCounters& Rendering::GetCounters()
+{
+	return s_Counters;
+}
+
 int32_t Rendering::GetUniformLocation( ShaderProgramHandle a_ShaderProgramHandle, const char* a_Name )
 {
 	auto& ShaderProgram = s_ShaderProgramRegistry[ a_ShaderProgramHandle ];
@@ -310,61 +708,73 @@ int32_t Rendering::GetUniformLocation( ShaderProgramHandle a_ShaderProgramHandle
 void Rendering::Uniform1f( int32_t a_Location, float a_V0 )
 {
 	*reinterpret_cast< float* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform2f( int32_t a_Location, float a_V0, float a_V1 )
 {
 	*reinterpret_cast< Vector2* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0, a_V1 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform3f( int32_t a_Location, float a_V0, float a_V1, float a_V2 )
 {
 	*reinterpret_cast< Vector3* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0, a_V1, a_V2 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform4f( int32_t a_Location, float a_V0, float a_V1, float a_V2, float a_V3 )
 {
 	*reinterpret_cast< Vector4* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0, a_V1, a_V2, a_V3 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform1i( int32_t a_Location, int32_t a_V0 )
 {
 	*reinterpret_cast< int32_t* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform2i( int32_t a_Location, int32_t a_V0, int32_t a_V1 )
 {
 	*reinterpret_cast< Vector2Int* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0, a_V1 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform3i( int32_t a_Location, int32_t a_V0, int32_t a_V1, int32_t a_V2 )
 {
 	*reinterpret_cast< Vector3Int* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0, a_V1, a_V2 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform4i( int32_t a_Location, int32_t a_V0, int32_t a_V1, int32_t a_V2, int32_t a_V3 )
 {
 	*reinterpret_cast< Vector4Int* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0, a_V1, a_V2, a_V3 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform1ui( int32_t a_Location, uint32_t a_V0 )
 {
 	*reinterpret_cast< uint32_t* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform2ui( int32_t a_Location, uint32_t a_V0, uint32_t a_V1 )
 {
 	*reinterpret_cast< Vector2UInt* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0, a_V1 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform3ui( int32_t a_Location, uint32_t a_V0, uint32_t a_V1, uint32_t a_V2 )
 {
 	*reinterpret_cast< Vector3UInt* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0, a_V1, a_V2 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform4ui( int32_t a_Location, uint32_t a_V0, uint32_t a_V1, uint32_t a_V2, uint32_t a_V3 )
 {
 	*reinterpret_cast< Vector4UInt* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = { a_V0, a_V1, a_V2, a_V3 };
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform1fv( int32_t a_Location, uint32_t a_Count, const float* a_Value )
@@ -372,6 +782,7 @@ void Rendering::Uniform1fv( int32_t a_Location, uint32_t a_Count, const float* a
 	typedef std::array< float, 1 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) = 
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform2fv( int32_t a_Location, uint32_t a_Count, const float* a_Value )
@@ -379,6 +790,7 @@ void Rendering::Uniform2fv( int32_t a_Location, uint32_t a_Count, const float* a
 	typedef std::array< float, 2 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform3fv( int32_t a_Location, uint32_t a_Count, const float* a_Value )
@@ -386,6 +798,7 @@ void Rendering::Uniform3fv( int32_t a_Location, uint32_t a_Count, const float* a
 	typedef std::array< float, 3 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform4fv( int32_t a_Location, uint32_t a_Count, const float* a_Value )
@@ -393,6 +806,7 @@ void Rendering::Uniform4fv( int32_t a_Location, uint32_t a_Count, const float* a
 	typedef std::array< float, 4 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform1iv( int32_t a_Location, uint32_t a_Count, const int32_t* a_Value )
@@ -400,6 +814,7 @@ void Rendering::Uniform1iv( int32_t a_Location, uint32_t a_Count, const int32_t*
 	typedef std::array< int32_t, 1 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform2iv( int32_t a_Location, uint32_t a_Count, const int32_t* a_Value )
@@ -407,6 +822,7 @@ void Rendering::Uniform2iv( int32_t a_Location, uint32_t a_Count, const int32_t*
 	typedef std::array< int32_t, 2 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform3iv( int32_t a_Location, uint32_t a_Count, const int32_t* a_Value )
@@ -414,6 +830,7 @@ void Rendering::Uniform3iv( int32_t a_Location, uint32_t a_Count, const int32_t*
 	typedef std::array< int32_t, 3 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform4iv( int32_t a_Location, uint32_t a_Count, const int32_t* a_Value )
@@ -421,6 +838,7 @@ void Rendering::Uniform4iv( int32_t a_Location, uint32_t a_Count, const int32_t*
 	typedef std::array< int32_t, 4 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform1uiv( int32_t a_Location, uint32_t a_Count, const uint32_t* a_Value )
@@ -428,6 +846,7 @@ void Rendering::Uniform1uiv( int32_t a_Location, uint32_t a_Count, const uint32_
 	typedef std::array< uint32_t, 1 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform2uiv( int32_t a_Location, uint32_t a_Count, const uint32_t* a_Value )
@@ -435,6 +854,7 @@ void Rendering::Uniform2uiv( int32_t a_Location, uint32_t a_Count, const uint32_
 	typedef std::array< uint32_t, 2 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform3uiv( int32_t a_Location, uint32_t a_Count, const uint32_t* a_Value )
@@ -442,6 +862,7 @@ void Rendering::Uniform3uiv( int32_t a_Location, uint32_t a_Count, const uint32_
 	typedef std::array< uint32_t, 3 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::Uniform4uiv( int32_t a_Location, uint32_t a_Count, const uint32_t* a_Value )
@@ -449,6 +870,7 @@ void Rendering::Uniform4uiv( int32_t a_Location, uint32_t a_Count, const uint32_
 	typedef std::array< uint32_t, 4 > Type;
 	*reinterpret_cast< Type* >( s_ShaderProgramRegistry[ s_ActiveShaderProgram ].m_Uniforms[ a_Location ] ) =
 		*reinterpret_cast< const Type* >( a_Value );
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::UniformMatrix2fv( uint32_t a_Location, uint32_t a_Count, bool a_Transpose, const float* a_Value )
@@ -474,6 +896,7 @@ void Rendering::UniformMatrix2fv( uint32_t a_Location, uint32_t a_Count, bool a_
 			UniformValue[ i ] = Value;
 		}
 	}
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::UniformMatrix3fv( uint32_t a_Location, uint32_t a_Count, bool a_Transpose, const float* a_Value )
@@ -499,6 +922,7 @@ void Rendering::UniformMatrix3fv( uint32_t a_Location, uint32_t a_Count, bool a_
 			UniformValue[ i ] = Value;
 		}
 	}
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::UniformMatrix4fv( uint32_t a_Location, uint32_t a_Count, bool a_Transpose, const float* a_Value )
@@ -524,6 +948,7 @@ void Rendering::UniformMatrix4fv( uint32_t a_Location, uint32_t a_Count, bool a_
 			UniformValue[ i ] = Value;
 		}
 	}
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::UniformMatrix2x3fv( uint32_t a_Location, uint32_t a_Count, bool a_Transpose, const float* a_Value )
@@ -550,6 +975,7 @@ void Rendering::UniformMatrix2x3fv( uint32_t a_Location, uint32_t a_Count, bool
 			UniformValue[ i ] = reinterpret_cast< Type& >( Value );
 		}
 	}
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::UniformMatrix3x2fv( uint32_t a_Location, uint32_t a_Count, bool a_Transpose, const float* a_Value )
@@ -576,6 +1002,7 @@ void Rendering::UniformMatrix3x2fv( uint32_t a_Location, uint32_t a_Count, bool
 			UniformValue[ i ] = reinterpret_cast< Type& >( Value );
 		}
 	}
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::UniformMatrix2x4fv( uint32_t a_Location, uint32_t a_Count, bool a_Transpose, const float* a_Value )
@@ -602,6 +1029,7 @@ void Rendering::UniformMatrix2x4fv( uint32_t a_Location, uint32_t a_Count, bool
 			UniformValue[ i ] = reinterpret_cast< Type& >( Value );
 		}
 	}
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::UniformMatrix4x2fv( uint32_t a_Location, uint32_t a_Count, bool a_Transpose, const float* a_Value )
@@ -628,6 +1056,7 @@ void Rendering::UniformMatrix4x2fv( uint32_t a_Location, uint32_t a_Count, bool
 			UniformValue[ i ] = reinterpret_cast< Type& >( Value );
 		}
 	}
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::UniformMatrix3x4fv( uint32_t a_Location, uint32_t a_Count, bool a_Transpose, const float* a_Value )
@@ -654,6 +1083,7 @@ void Rendering::UniformMatrix3x4fv( uint32_t a_Location, uint32_t a_Count, bool
 			UniformValue[ i ] = reinterpret_cast< Type& >( Value );
 		}
 	}
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 void Rendering::UniformMatrix4x3fv( uint32_t a_Location, uint32_t a_Count, bool a_Transpose, const float* a_Value )
@@ -680,12 +1110,14 @@ void Rendering::UniformMatrix4x3fv( uint32_t a_Location, uint32_t a_Count, bool
 			UniformValue[ i ] = reinterpret_cast< Type& >( Value );
 		}
 	}
+	RenderCapture::RecordUniform( s_ActiveShaderProgram, a_Location );
 }
 
 ShaderHandle Rendering::CreateShader( ShaderType a_ShaderType )
 {
 	ShaderHandle NewHandle = s_ShaderRegistry.Create();
 	s_ShaderRegistry[ NewHandle ].Type = a_ShaderType;
+	RenderCapture::Record( RenderCapture::Call::CREATE_SHADER, a_ShaderType, NewHandle );
 	return NewHandle;
 }
 
@@ -697,10 +1129,12 @@ void Rendering::ShaderSource( ShaderHandle a_ShaderHandle, uint32_t a_Count, con
 	}
 
 	s_ShaderRegistry[ a_ShaderHandle ].Callback = ( void(*)() )a_Sources[ 0 ];
+	RenderCapture::RecordShaderSource( a_ShaderHandle, a_Sources[ 0 ] );
 }
 
 void Rendering::CompileShader( ShaderHandle a_ShaderHandle )
 {
+	RenderCapture::Record( RenderCapture::Call::COMPILE_SHADER, a_ShaderHandle );
 	ShaderObject& ActiveShader = s_ShaderRegistry[ a_ShaderHandle ];
 
 	if ( !ActiveShader.Callback )
@@ -729,11 +1163,14 @@ void Rendering::GetShaderInfoLog( ShaderHandle a_ShaderHandle, size_t a_BufferSi
 
 ShaderProgramHandle Rendering::CreateProgram()
 {
-	return s_ShaderProgramRegistry.Create();
+	ShaderProgramHandle NewHandle = s_ShaderProgramRegistry.Create();
+	RenderCapture::Record( RenderCapture::Call::CREATE_PROGRAM, NewHandle );
+	return NewHandle;
 }
 
 void Rendering::AttachShader( ShaderProgramHandle a_ShaderProgramHandle, ShaderHandle a_ShaderHandle )
 {
+	RenderCapture::Record( RenderCapture::Call::ATTACH_SHADER, a_ShaderProgramHandle, a_ShaderHandle );
 	auto& Program = s_ShaderProgramRegistry[ a_ShaderProgramHandle ];
 	auto& ShaderObject  = s_ShaderRegistry[ a_ShaderHandle ];
 	Program.m_Shaders[ ( uint32_t )ShaderObject.Type ].Handle = a_ShaderHandle;
@@ -742,7 +1179,9 @@ void Rendering::AttachShader( ShaderProgramHandle a_ShaderProgramHandle, ShaderH
 
 void Rendering::LinkProgram( ShaderProgramHandle a_ShaderProgramHandle )
 {
+	RenderCapture::Record( RenderCapture::Call::LINK_PROGRAM, a_ShaderProgramHandle );
 	auto& Program = s_ShaderProgramRegistry[ a_ShaderProgramHandle ];
+	Program.m_VertexUniforms.clear();
 	
 	for ( uint32_t i = 0; i < 2; ++i )
 	{
@@ -762,6 +1201,11 @@ void Rendering::LinkProgram( ShaderProgramHandle a_ShaderProgramHandle )
 		
 		for ( auto& Pair : Uniforms )
 		{
+			if ( i == ( uint32_t )ShaderType::VERTEX_SHADER )
+			{
+				Program.m_VertexUniforms.emplace_back( Pair.second, s_UniformMap.GetSize( Pair.first ) );
+			}
+
 			// First check if that uniform is already a part of the program.
 			if ( Program.m_UniformLocations.find( Pair.first ) == Program.m_UniformLocations.end() )
 			{
@@ -783,6 +1227,7 @@ void Rendering::GetProgramInfoLog( ShaderProgramHandle a_ShaderProgramHandle, si
 
 void Rendering::DetachShader( ShaderProgramHandle a_ShaderProgramHandle, ShaderHandle a_ShaderHandle )
 {
+	RenderCapture::Record( RenderCapture::Call::DETACH_SHADER, a_ShaderProgramHandle, a_ShaderHandle );
 	auto& Program = s_ShaderProgramRegistry[ a_ShaderProgramHandle ];
 	auto& ShaderObject  = s_ShaderRegistry[ a_ShaderHandle ];
 	auto& Entry   = Program.m_Shaders[ ( uint32_t )ShaderObject.Type ];
@@ -792,86 +1237,122 @@ void Rendering::DetachShader( ShaderProgramHandle a_ShaderProgramHandle, ShaderH
 
 void Rendering::DeleteShader( ShaderHandle a_ShaderHandle )
 {
+	RenderCapture::Record( RenderCapture::Call::DELETE_SHADER, a_ShaderHandle );
 	s_ShaderRegistry.Destroy( a_ShaderHandle );
 }
 
 void Rendering::DeleteProgram( ShaderProgramHandle a_ShaderProgramHandle )
 {
+	RenderCapture::Record( RenderCapture::Call::DELETE_PROGRAM, a_ShaderProgramHandle );
 	s_ShaderProgramRegistry.Destroy( a_ShaderProgramHandle );
 }
 
 void Rendering::ActiveTexture( uint32_t a_ActiveTexture )
 {
+	RenderCapture::Record( RenderCapture::Call::ACTIVE_TEXTURE, a_ActiveTexture );
 	s_ActiveTextureUnit = a_ActiveTexture;
 }
 
 void Rendering::TexParameterf( TextureTarget a_TextureTarget, TextureParameter a_TextureParameter, float a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEX_PARAMETER, ( uint32_t )a_TextureTarget, a_TextureParameter, &a_Value );
 	TexParameterImpl( a_TextureTarget, a_TextureParameter, a_Value );
 }
 
 void Rendering::TexParameterfv( TextureTarget a_TextureTarget, TextureParameter a_TextureParameter, const float* a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEX_PARAMETER, ( uint32_t )a_TextureTarget, a_TextureParameter, a_Value );
 	TexParameterImpl( a_TextureTarget, a_TextureParameter, a_Value );
 }
 
 void Rendering::TexParameteri( TextureTarget a_TextureTarget, TextureParameter a_TextureParameter, int32_t a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEX_PARAMETER, ( uint32_t )a_TextureTarget, a_TextureParameter, &a_Value );
 	TexParameterImpl( a_TextureTarget, a_TextureParameter, a_Value );
 }
 
 void Rendering::TexParameteri( TextureTarget a_TextureTarget, TextureParameter a_TextureParameter, const int32_t* a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEX_PARAMETER, ( uint32_t )a_TextureTarget, a_TextureParameter, a_Value );
 	TexParameterImpl( a_TextureTarget, a_TextureParameter, a_Value );
 }
 
 void Rendering::TexParameterui( TextureTarget a_TextureTarget, TextureParameter a_TextureParameter, uint32_t a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEX_PARAMETER, ( uint32_t )a_TextureTarget, a_TextureParameter, &a_Value );
 	TexParameterImpl( a_TextureTarget, a_TextureParameter, a_Value );
 }
 
 void Rendering::TexParameterui( TextureTarget a_TextureTarget, TextureParameter a_TextureParameter, const uint32_t* a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEX_PARAMETER, ( uint32_t )a_TextureTarget, a_TextureParameter, a_Value );
 	TexParameterImpl( a_TextureTarget, a_TextureParameter, a_Value );
 }
 
 void Rendering::TextureParameterf( TextureHandle a_Handle, TextureParameter a_TextureParameter, float a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEXTURE_PARAMETER, a_Handle, a_TextureParameter, &a_Value );
 	TextureParameterImpl( a_Handle, a_TextureParameter, a_Value );
 }
 
 void Rendering::TextureParameterfv( TextureHandle a_Handle, TextureParameter a_TextureParameter, const float* a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEXTURE_PARAMETER, a_Handle, a_TextureParameter, a_Value );
 	TextureParameterImpl( a_Handle, a_TextureParameter, a_Value );
 }
 
 void Rendering::TextureParameteri( TextureHandle a_Handle, TextureParameter a_TextureParameter, int32_t a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEXTURE_PARAMETER, a_Handle, a_TextureParameter, &a_Value );
 	TextureParameterImpl( a_Handle, a_TextureParameter, a_Value );
 }
 
 void Rendering::TextureParameteri( TextureHandle a_Handle, TextureParameter a_TextureParameter, const int32_t* a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEXTURE_PARAMETER, a_Handle, a_TextureParameter, a_Value );
 	TextureParameterImpl( a_Handle, a_TextureParameter, a_Value );
 }
 
 void Rendering::TextureParameterui( TextureHandle a_Handle, TextureParameter a_TextureParameter, uint32_t a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEXTURE_PARAMETER, a_Handle, a_TextureParameter, &a_Value );
 	TextureParameterImpl( a_Handle, a_TextureParameter, a_Value );
 }
 
 void Rendering::TextureParameterui( TextureHandle a_Handle, TextureParameter a_TextureParameter, const uint32_t* a_Value )
 {
+	RenderCapture::RecordTexParameter( RenderCapture::Call::TEXTURE_PARAMETER, a_Handle, a_TextureParameter, a_Value );
 	TextureParameterImpl( a_Handle, a_TextureParameter, a_Value );
 }
 
 void Rendering::GenTextures( size_t a_Count, TextureHandle* a_Handles )
 {
+	uint32_t Count = static_cast< uint32_t >( a_Count );
 	while ( a_Count-- > 0 ) a_Handles[ a_Count ] = s_TextureRegistry.Create();
+	RenderCapture::RecordHandles( RenderCapture::Call::GEN_TEXTURES, Count, a_Handles );
+}
+
+void Rendering::DeleteTextures( uint32_t a_Count, TextureHandle* a_Handles )
+{
+	RenderCapture::RecordHandles( RenderCapture::Call::DELETE_TEXTURES, a_Count, a_Handles );
+	while ( a_Count-- > 0 )
+	{
+		// Unbind from every unit it is bound to.
+		for ( auto& Unit : s_TextureUnits )
+		{
+			for ( auto& Handle : Unit )
+			{
+				Handle = Handle == a_Handles[ a_Count ] ? 0 : Handle;
+			}
+		}
+
+		s_TextureRegistry.Destroy( a_Handles[ a_Count ] );
+	}
 }
 
 void Rendering::BindTexture( TextureTarget a_TextureTarget, TextureHandle a_Handle )
 {
+	RenderCapture::Record( RenderCapture::Call::BIND_TEXTURE, a_TextureTarget, a_Handle );
 	if ( s_TextureRegistry.Bind( a_TextureTarget, a_Handle ) )
 	{
 		s_ActiveTextureTarget = ( uint32_t )a_TextureTarget;
@@ -883,11 +1364,19 @@ void Rendering::BindTexture( TextureTarget a_TextureTarget, TextureHandle a_Hand
 
 void Rendering::TexImage2D( TextureTarget a_TextureTarget, uint8_t a_MipMapLevel, TextureFormat a_InternalFormat, int32_t a_Width, int32_t a_Height, int32_t a_Border, TextureFormat a_TextureFormat, TextureSetting a_DataLayout, const void* a_Data )
 {
+	RenderCapture::Record( RenderCapture::Call::TEX_IMAGE_2D, a_TextureTarget, a_MipMapLevel, a_InternalFormat, a_Width, a_Height, a_Border, a_TextureFormat, a_DataLayout, RenderCapture::Bytes{ a_Data, static_cast< size_t >( a_Width ) * a_Height * 4 } );
 	//TextureBuffer& Target = s_TextureRegistry[ s_TextureTargets[ ( uint32_t )a_TextureTarget ] ];
 	auto Handle = s_TextureUnits[ s_ActiveTextureUnit ][ ( uint32_t )a_TextureTarget ];
+
+	if ( !s_TextureRegistry.Valid( Handle ) )
+	{
+		return;
+	}
+
 	auto& Target = s_TextureRegistry[ Handle ];
 	Target.Data = a_Data;
 	Target.Dimensions = { a_Width, a_Height };
+	Target.Format = ( uint8_t )a_InternalFormat;
 
 	// Need to implement rest of all the settings.
 }
\ No newline at end of file
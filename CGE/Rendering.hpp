@@ -5,6 +5,12 @@
 #include <bitset>
 #include <type_traits>
 #include <map>
+#include <unordered_map>
+#include <limits>
+#include <algorithm>
+#if defined( _M_X64 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
 #include "Math.hpp"
 #include "Colour.hpp"
 #include "ConsoleWindow.hpp"
@@ -51,7 +57,7 @@
 // - Draw calls are inserted based on sorting criteria.
 // - Draw queue is processed and render commands are generated.
 // - Render commands are sent to rendering thread and processed.
-// - Post processing. Allow to render to target texture and use it for post processing.
+// - Post processing. Render to a framebuffer texture and use it for post processing.
 
 // SHADER:
 // - Vertex shader iterates over input vertex buffer and processes all of them converting them into clip space and copying into output vertex buffer
@@ -90,6 +96,19 @@ inline uint8_t operator |( BufferFlag a_FlagA, BufferFlag a_FlagB )
 	return static_cast< uint8_t >( a_FlagA ) | static_cast< uint8_t >( a_FlagB );
 }
 
+enum class FramebufferTarget : uint8_t
+{
+	FRAMEBUFFER,
+	DRAW_FRAMEBUFFER,
+	READ_FRAMEBUFFER
+};
+
+enum class FramebufferAttachment : uint8_t
+{
+	COLOUR_ATTACHMENT,
+	DEPTH_ATTACHMENT
+};
+
 enum class TextureTarget : uint8_t
 {
 	TEXTURE_1D,
@@ -177,6 +196,7 @@ enum class TextureSetting : uint32_t
 	UNSIGNED_SHORT_5_6_5,
 	UNSIGNED_SHORT_4_4_4_4,
 	UNSIGNED_SHORT_5_5_5_1,
+	FLOAT,
 };
 
 enum class TextureFormat : uint8_t
@@ -185,7 +205,8 @@ enum class TextureFormat : uint8_t
 	LUMINANCE,
 	LUMINANCE_ALPHA,
 	RGB,
-	RGBA
+	RGBA,
+	DEPTH_COMPONENT
 };
 
 enum class DataType : uint8_t
@@ -228,6 +249,15 @@ enum class RenderSetting
 {
 	DEPTH_TEST,
 	CULL_FACE,
+	BLEND,
+	// Reuses vertex shader output across draws with identical streams and vertex uniforms.
+	// Bound buffers must not change contents in place while enabled.
+	VERTEX_CACHE,
+	SCISSOR_TEST,
+	// Counts triangles, fragments and depth tests into the statistics and per pixel counters.
+	DEBUG_COUNTERS,
+	// Query only through GetBooleanv, set with DepthMask.
+	DEPTH_WRITEMASK,
 	// Incomplete
 };
 
@@ -245,6 +275,29 @@ enum class RenderMode : uint8_t
 	TRIANGLE
 };
 
+enum class BlendFactor : uint8_t
+{
+	ZERO,
+	ONE,
+	SRC_COLOUR,
+	ONE_MINUS_SRC_COLOUR,
+	DST_COLOUR,
+	ONE_MINUS_DST_COLOUR,
+	SRC_ALPHA,
+	ONE_MINUS_SRC_ALPHA,
+	DST_ALPHA,
+	ONE_MINUS_DST_ALPHA
+};
+
+enum class BlendEquation : uint8_t
+{
+	ADD,
+	SUBTRACT,
+	REVERSE_SUBTRACT,
+	MIN,
+	MAX
+};
+
 enum class ClipPlane : uint8_t
 {
 	CLIP_PLANE0,
@@ -307,6 +360,7 @@ typedef uint32_t ArrayHandle;
 typedef uint32_t TextureHandle;
 typedef uint32_t ShaderHandle;
 typedef uint32_t ShaderProgramHandle;
+typedef uint32_t FramebufferHandle;
 
 struct Sampler2D
 {
@@ -346,6 +400,7 @@ class ShaderProgram
 private:
 
 	friend class Rendering;
+	friend class RenderCapture;
 
 	typedef void( *ShaderCallback )( );
 
@@ -365,6 +420,39 @@ private:
 
 	std::map< Hash, uint32_t >  m_UniformLocations;
 	std::vector< void* >        m_Uniforms;
+
+	// Vertex stage uniforms and their sizes, used to key the vertex cache.
+	std::vector< std::pair< const void*, uint32_t > > m_VertexUniforms;
+};
+
+// Rasterizer counts since the last Rendering::ResetStatistics, kept while DEBUG_COUNTERS is enabled.
+struct RenderStatistics
+{
+	uint32_t TrianglesIn = 0;
+	uint32_t TrianglesCulled = 0;     // Facing away.
+	uint32_t TrianglesClipped = 0;    // Crossing or outside the view volume.
+	uint32_t TrianglesRasterized = 0; // Pieces left after clipping.
+	uint32_t Fragments = 0;
+	uint32_t DepthFailed = 0;
+	uint32_t Shaded = 0;              // Fragment shader invocations.
+};
+
+// The same counts per pixel of the draw target, and triangles touching each tile of it.
+struct RenderCounters
+{
+	static constexpr int32_t TileSize = 8;
+
+	struct Counter
+	{
+		uint32_t Fragments;
+		uint32_t DepthFailed;
+		uint32_t Shaded;
+	};
+
+	Vector2Int              Size;
+	Vector2Int              Tiles;
+	std::vector< Counter >  Pixels;
+	std::vector< uint32_t > TileTriangles;
 };
 
 class Rendering
@@ -377,6 +465,9 @@ public:
 	// Fragment out variables.
 	inline static Vector4 FragColour;
 
+	// Vertex in variables.
+	inline static uint32_t InstanceID;
+
 	// Shader functions
 	static ShaderHandle CreateShader( ShaderType a_ShaderType );
 	static void ShaderSource( ShaderHandle a_ShaderHandle, uint32_t a_Count, const void** a_Sources, uint32_t* a_Lengths );
@@ -412,19 +503,50 @@ public:
 	static void DisableVertexAttribArray( uint32_t a_Position );
 	static void VertexAttribPointer( uint32_t a_Index, uint32_t a_Size, DataType a_DataType, bool a_Normalized, size_t a_Stride, void* a_Offset );
 	static void DrawElements( RenderMode a_Mode, uint32_t a_Count, DataType a_DataType, const void* a_Indices );
+	static void DrawElementsInstanced( RenderMode a_Mode, uint32_t a_Count, DataType a_DataType, const void* a_Indices, uint32_t a_InstanceCount );
+	static void VertexAttribDivisor( uint32_t a_Index, uint32_t a_Divisor );
+	static void FlushVertexCache();
+	// Streams are only known by address, so a caller that rewrites one in place changes the tag to tell the
+	// vertex cache. The tag is part of every cached draw's key until it is set again.
+	static void VertexCacheTag( uint64_t a_Tag );
 	static void Enable( RenderSetting a_RenderSetting );
 	static void Disable( RenderSetting a_RenderSetting );
 	static void CullFace( CullFaceMode a_CullFace );
 	static void DepthFunc( TextureSetting a_TextureSetting );
+	static void DepthMask( bool a_Flag );
+	static void Scissor( int32_t a_X, int32_t a_Y, uint32_t a_Width, uint32_t a_Height );
+	static void Viewport( int32_t a_X, int32_t a_Y, uint32_t a_Width, uint32_t a_Height );
+
+	// Framebuffers, handle 0 is the console window. Colour attachments are RGBA textures and depth
+	// attachments DEPTH_COMPONENT textures holding one float per pixel, both of the same size.
+	static void GenFramebuffers( uint32_t a_Count, FramebufferHandle* a_Handles );
+	static void BindFramebuffer( FramebufferTarget a_Target, FramebufferHandle a_Handle );
+	static void DeleteFramebuffers( uint32_t a_Count, FramebufferHandle* a_Handles );
+	static bool IsFramebuffer( FramebufferHandle a_Handle );
+	static void FramebufferTexture2D( FramebufferTarget a_Target, FramebufferAttachment a_Attachment, TextureTarget a_TextureTarget, TextureHandle a_Texture, uint8_t a_MipMapLevel );
+	static void BlitFramebuffer( int32_t a_SourceX0, int32_t a_SourceY0, int32_t a_SourceX1, int32_t a_SourceY1, int32_t a_DestinationX0, int32_t a_DestinationY0, int32_t a_DestinationX1, int32_t a_DestinationY1, uint8_t a_Mask, TextureSetting a_Filter );
+
+	// Writes a_Width by a_Height RGBA pixels, rows in the same order as the target, to the bound draw framebuffer.
+	// The scissor applies, depth is left alone.
+	static void DrawPixels( int32_t a_X, int32_t a_Y, int32_t a_Width, int32_t a_Height, const Colour* a_Pixels );
+
+	static void BlendFunc( BlendFactor a_Source, BlendFactor a_Destination );
+	static void BlendEquation( ::BlendEquation a_BlendEquation );
 
 	static void GetBooleanv( RenderSetting a_RenderSetting, bool* a_Value );
 	// Need the other Get functions.
 
+	// Debug counters, see RenderSetting::DEBUG_COUNTERS.
+	static void ResetStatistics();
+	static const RenderStatistics& GetStatistics();
+	static const RenderCounters& GetCounters();
+
 	static void ClipPlane( const double* a_Equation );
 
 	// Textures
 	static void ActiveTexture( uint32_t a_ActiveTexture );
 	static void GenTextures( size_t a_Count, TextureHandle* a_Handles );
+	static void DeleteTextures( uint32_t a_Count, TextureHandle* a_Handles );
 	static void BindTexture( TextureTarget a_TextureTarget, TextureHandle a_Handle );
 	static void TexParameterf( TextureTarget a_TextureTarget, TextureParameter a_TextureParameter, float a_Value );
 	static void TexParameterfv( TextureTarget a_TextureTarget, TextureParameter a_TextureParameter, const float* a_Value );
@@ -485,6 +607,8 @@ public:
 
 private:
 
+	friend class RenderCapture;
+
 	template < typename _Type, Hash _Name >
 	class UniformCommon
 	{
@@ -503,6 +627,7 @@ private:
 			static bool Setup = []()
 			{
 				s_UniformMap[ _Name ] = &Value();
+				s_UniformMap.SetSize( _Name, sizeof( _Type ) );
 				return true;
 			}( );
 		}
@@ -717,6 +842,7 @@ private:
 		BufferHandle Buffer;
 		uint32_t     Offset;
 		uint32_t     Stride;
+		uint32_t     Divisor;
 		uint8_t      Normalized : 1;
 		uint8_t      Size : 4;
 		uint8_t      Type : 3;
@@ -793,6 +919,16 @@ private:
 			return m_Data;
 		}
 
+		inline const void* GetSource() const
+		{
+			return m_Begin;
+		}
+
+		inline uint32_t GetStride() const
+		{
+			return m_Stride;
+		}
+
 		AttributeIterator& operator++()
 		{
 			m_Data += m_Stride;
@@ -925,7 +1061,7 @@ private:
 
 	//typedef std::vector< uint8_t >           Buffer;
 	typedef const uint8_t* Buffer;
-	typedef std::array< VertexAttribute, 8 > Array;
+	typedef std::array< VertexAttribute, 16 > Array;
 	typedef std::map< void*, uint32_t >      StrideRegistry;
 	typedef std::array< TextureHandle, 10  > TextureUnit;
 	typedef bool( *DepthCompareFunc )( float, float );
@@ -1001,8 +1137,14 @@ private:
 	{
 	public:
 
+		// Zero when every slot is taken.
 		TextureHandle Create()
 		{
+			if ( m_Availability.all() )
+			{
+				return 0;
+			}
+
 			size_t Index = 0;
 			while ( m_Availability[ Index++ ] );
 			m_Availability[ Index - 1 ] = true;
@@ -1012,7 +1154,7 @@ private:
 
 		bool Bind( TextureTarget a_Target, TextureHandle a_Handle )
 		{
-			if ( m_Targets[ a_Handle - 1 ] != -1 )
+			if ( !Valid( a_Handle ) || m_Targets[ a_Handle - 1 ] != -1 )
 			{
 				return false;
 			}
@@ -1023,8 +1165,13 @@ private:
 
 		void Destroy( TextureHandle a_Handle )
 		{
+			if ( !Valid( a_Handle ) )
+			{
+				return;
+			}
+
 			m_Availability[ a_Handle - 1 ] = false;
-			// m_Textures[ a_Handle - 1 ] reset this
+			m_Textures[ a_Handle - 1 ] = Texture();
 			m_Targets[ a_Handle - 1 ] = -1;
 		}
 
@@ -1033,6 +1180,12 @@ private:
 			return m_Textures[ a_Handle - 1 ];
 		}
 
+		// The target the texture was first bound to, -1 before then.
+		inline int8_t GetTarget( TextureHandle a_Handle ) const
+		{
+			return m_Targets[ a_Handle - 1 ];
+		}
+
 		inline bool Valid( TextureHandle a_Handle )
 		{
 			return a_Handle - 1 < m_Availability.size() && m_Availability[ a_Handle - 1 ];
@@ -1044,6 +1197,50 @@ private:
 		std::bitset< 32 >         m_Availability;
 		std::array< Texture, 32 > m_Textures;
 	};
+	struct Framebuffer
+	{
+		TextureHandle ColourAttachment = 0;
+		TextureHandle DepthAttachment = 0;
+	};
+	class FramebufferRegistry
+	{
+	public:
+
+		// Zero when every slot is taken.
+		FramebufferHandle Create()
+		{
+			if ( m_Availability.all() )
+			{
+				return 0;
+			}
+
+			uint32_t Index = 0;
+			while ( m_Availability[ Index++ ] );
+			m_Availability[ Index - 1 ] = true;
+			m_Framebuffers[ Index - 1 ] = Framebuffer();
+			return Index;
+		}
+
+		void Destroy( FramebufferHandle a_Handle )
+		{
+			m_Availability[ a_Handle - 1 ] = false;
+		}
+
+		inline Framebuffer& operator[]( FramebufferHandle a_Handle )
+		{
+			return m_Framebuffers[ a_Handle - 1 ];
+		}
+
+		inline bool Valid( FramebufferHandle a_Handle )
+		{
+			return a_Handle - 1 < m_Availability.size() && m_Availability[ a_Handle - 1 ];
+		}
+
+	private:
+
+		std::bitset< 32 >             m_Availability;
+		std::array< Framebuffer, 32 > m_Framebuffers;
+	};
 	class AttributeRegistry
 	{
 	public:
@@ -1079,6 +1276,32 @@ private:
 			m_SeekFunction = Seek< void >;
 		}
 
+		// Attributes with a divisor are only advanced per instance.
+		inline void SetDivisor( uint32_t a_Position, uint32_t a_Divisor )
+		{
+			m_Divisors[ a_Position ] = a_Divisor;
+
+			if ( a_Divisor )
+			{
+				m_InstancedMask |= ( 1u << a_Position );
+			}
+			else
+			{
+				m_InstancedMask &= ~( 1u << a_Position );
+			}
+		}
+
+		void SetInstance( uint32_t a_Instance )
+		{
+			for ( uint32_t i = 0; i < 16; ++i )
+			{
+				if ( m_InstancedMask & ( 1u << i ) )
+				{
+					m_VertexAttributes[ i ] = a_Instance / m_Divisors[ i ];
+				}
+			}
+		}
+
 		inline void Reset()
 		{
 			*this = 0u;
@@ -1089,6 +1312,22 @@ private:
 			return m_VertexAttributes[ a_Position ];
 		}
 
+		// Folds the bound streams into a_Key, identifying them by address rather than contents.
+		void HashBindings( uint64_t& o_Key ) const
+		{
+			const void* Indices = m_SeekFunction == Seek< void > ? nullptr : m_Indices;
+			HashBytes( o_Key, &Indices, sizeof( Indices ) );
+			HashBytes( o_Key, &m_InstancedMask, sizeof( m_InstancedMask ) );
+
+			for ( auto& Attribute : m_VertexAttributes )
+			{
+				const void* Source = Attribute.GetSource();
+				uint32_t Stride = Attribute.GetStride();
+				HashBytes( o_Key, &Source, sizeof( Source ) );
+				HashBytes( o_Key, &Stride, sizeof( Stride ) );
+			}
+		}
+
 	private:
 
 		typedef void( *SeekFunction )( AttributeRegistry*, uint32_t );
@@ -1108,20 +1347,22 @@ private:
 			}
 
 			a_AttributeRegistry->m_Position = a_Index;
-			a_AttributeRegistry->m_VertexAttributes[ 0 ] = Index;
-			a_AttributeRegistry->m_VertexAttributes[ 1 ] = Index;
-			a_AttributeRegistry->m_VertexAttributes[ 2 ] = Index;
-			a_AttributeRegistry->m_VertexAttributes[ 3 ] = Index;
-			a_AttributeRegistry->m_VertexAttributes[ 4 ] = Index;
-			a_AttributeRegistry->m_VertexAttributes[ 5 ] = Index;
-			a_AttributeRegistry->m_VertexAttributes[ 6 ] = Index;
-			a_AttributeRegistry->m_VertexAttributes[ 7 ] = Index;
+
+			for ( uint32_t i = 0; i < 16; ++i )
+			{
+				if ( !( a_AttributeRegistry->m_InstancedMask & ( 1u << i ) ) )
+				{
+					a_AttributeRegistry->m_VertexAttributes[ i ] = Index;
+				}
+			}
 		}
 
 		const void* m_Indices;
 		uint32_t          m_Position;
 		SeekFunction      m_SeekFunction;
-		AttributeIterator m_VertexAttributes[ 8 ];
+		uint32_t          m_InstancedMask = 0;
+		uint32_t          m_Divisors[ 16 ];
+		AttributeIterator m_VertexAttributes[ 16 ];
 	};
 	class ClipPlaneRegistry
 	{
@@ -1225,13 +1466,25 @@ private:
 			Entry.emplace_back( a_UniformName, ( *this )[ a_UniformName ] );
 		}
 
+		inline void SetSize( Hash a_UniformName, uint32_t a_Size )
+		{
+			m_Sizes[ a_UniformName ] = a_Size;
+		}
+
+		inline uint32_t GetSize( Hash a_UniformName ) const
+		{
+			auto Where = m_Sizes.find( a_UniformName );
+			return Where == m_Sizes.end() ? 0 : Where->second;
+		}
+
 	private:
 
 		typedef std::map< void*, std::vector< std::pair< Hash, void* > > > ShaderLookup;
 		typedef std::map< Hash, void* > UniformArray;
 
-		ShaderLookup m_ShaderLookup;
-		UniformArray m_Uniforms;
+		ShaderLookup                 m_ShaderLookup;
+		UniformArray                 m_Uniforms;
+		std::map< Hash, uint32_t >   m_Sizes;
 	};
 
 	template < typename T = uint8_t >
@@ -1346,6 +1599,13 @@ private:
 			m_Stride = 0;
 		}
 
+		void Swap( DataStorage& a_DataStorage )
+		{
+			m_Data.swap( a_DataStorage.m_Data );
+			std::swap( m_Head, a_DataStorage.m_Head );
+			std::swap( m_Stride, a_DataStorage.m_Stride );
+		}
+
 	private:
 
 		std::vector< uint8_t > m_Data;
@@ -1463,6 +1723,17 @@ private:
 			return *this;
 		}
 
+		// this += a_AttribSpan * a_Scale
+		AttribSpan& AddScaled( const AttribSpan& a_AttribSpan, T a_Scale )
+		{
+			for ( size_t i = 0; i < m_Size; ++i )
+			{
+				m_Origin[ i ] += a_AttribSpan.m_Origin[ i ] * a_Scale;
+			}
+
+			return *this;
+		}
+
 		AttribSpan& operator/=( T a_Value )
 		{
 			float Inv = 1.0f / a_Value;
@@ -1532,24 +1803,51 @@ private:
 	public:
 
 		RenderState()
-			: AlphaBlend( false ) // Unimplemented
+			: AlphaBlend( false )
 			, Perspective( false )
-			, Viewport( false ) // Unimplemented
 			, CullFace( false )
 			, FrontCull( false )
 			, BackCull( true )
 			, DepthTest( true )
 			, Clip( true )
+			, DepthWrite( true )
+			, VertexCache( false )
+			, ScissorTest( false )
+			, DebugCounters( false )
 		{}
 
 		bool AlphaBlend : 1;
 		bool Perspective : 1;
-		bool Viewport : 1;
 		bool CullFace : 1;
 		bool FrontCull : 1;
 		bool BackCull : 1;
 		bool DepthTest : 1;
 		bool Clip : 1;
+		bool DepthWrite : 1;
+		bool VertexCache : 1;
+		bool ScissorTest : 1;
+		bool DebugCounters : 1;
+	};
+
+	class BlendState
+	{
+	public:
+
+		BlendState()
+			: Source( BlendFactor::SRC_ALPHA )
+			, Destination( BlendFactor::ONE_MINUS_SRC_ALPHA )
+			, Equation( ::BlendEquation::ADD )
+		{}
+
+		BlendFactor     Source;
+		BlendFactor     Destination;
+		::BlendEquation Equation;
+	};
+	struct VertexCacheEntry
+	{
+		DataStorage< float >   Vertices;
+		DataStorage< Vector4 > Positions;
+		uint64_t               LastUse = 0;
 	};
 	class DepthBuffer
 	{
@@ -1557,33 +1855,65 @@ private:
 
 		DepthBuffer()
 			: m_Size( 0 )
+			, m_Pitch( 0 )
 			, m_Buffer( nullptr )
+			, m_Owner( false )
 		{}
 
 		~DepthBuffer()
 		{
-			delete[] m_Buffer;
+			Release();
 		}
 
+		// Rows are padded and aligned like the screen's, so a row of depths lines up with its row of colours.
 		void Init( Vector2Int a_Size )
 		{
+			constexpr int32_t RowFloats = static_cast< int32_t >( ScreenBuffer::Alignment / sizeof( float ) );
+			Release();
 			m_Size = a_Size;
-			m_Buffer = new float[ a_Size.x * a_Size.y ];
+			m_Pitch = ( a_Size.x + RowFloats - 1 ) / RowFloats * RowFloats;
+			m_Buffer = static_cast< float* >( ::operator new[]( static_cast< size_t >( m_Pitch ) * a_Size.y * sizeof( float ), std::align_val_t( ScreenBuffer::Alignment ) ) );
+			m_Owner = true;
+		}
+
+		// Tests and writes go to storage owned elsewhere, such as a depth attachment, whose rows are packed.
+		void Wrap( float* a_Buffer, Vector2Int a_Size )
+		{
+			Release();
+			m_Size = a_Size;
+			m_Pitch = a_Size.x;
+			m_Buffer = a_Buffer;
+			m_Owner = false;
+		}
+
+		inline Vector2Int GetSize() const
+		{
+			return m_Size;
+		}
+
+		inline int32_t GetPitch() const
+		{
+			return m_Pitch;
+		}
+
+		inline float Get( uint32_t a_X, uint32_t a_Y ) const
+		{
+			return m_Buffer[ static_cast< size_t >( a_Y ) * m_Pitch + a_X ];
 		}
 
 		inline bool Test( uint32_t a_X, uint32_t a_Y, float a_Z )
 		{
-			return s_DepthCompareFunc( a_Z, m_Buffer[ a_Y * m_Size.x + a_X ] );
+			return s_DepthCompareFunc( a_Z, m_Buffer[ static_cast< size_t >( a_Y ) * m_Pitch + a_X ] );
 		}
 
 		void Commit( uint32_t a_X, uint32_t a_Y, float a_Z )
 		{
-			m_Buffer[ a_Y * m_Size.x + a_X ] = a_Z;
+			m_Buffer[ static_cast< size_t >( a_Y ) * m_Pitch + a_X ] = a_Z;
 		}
 
 		bool TestAndCommit( uint32_t a_X, uint32_t a_Y, float a_Z )
 		{
-			float& Point = m_Buffer[ a_Y * m_Size.x + a_X ];
+			float& Point = m_Buffer[ static_cast< size_t >( a_Y ) * m_Pitch + a_X ];
 
 			if ( s_DepthCompareFunc( a_Z, Point ) )
 			{
@@ -1596,7 +1926,7 @@ private:
 
 		void Reset( float a_Depth )
 		{
-			float* Begin = m_Buffer, * End = m_Buffer + ( m_Size.x * m_Size.y );
+			float* Begin = m_Buffer, * End = m_Buffer + static_cast< size_t >( m_Pitch ) * m_Size.y;
 
 			for ( ; Begin != End; ++Begin )
 			{
@@ -1604,10 +1934,44 @@ private:
 			}
 		}
 
+		// a_Rect is expected to lie within the buffer.
+		void Reset( float a_Depth, const RectInt& a_Rect )
+		{
+			for ( int32_t y = a_Rect.GetBottom(); y <= a_Rect.GetTop(); ++y )
+			{
+				float* Begin = m_Buffer + static_cast< size_t >( y ) * m_Pitch + a_Rect.GetLeft();
+				std::fill( Begin, Begin + a_Rect.Size.x, a_Depth );
+			}
+		}
+
 	private:
 
+		void Release()
+		{
+			if ( m_Owner )
+			{
+				::operator delete[]( m_Buffer, std::align_val_t( ScreenBuffer::Alignment ) );
+			}
+
+			m_Buffer = nullptr;
+			m_Owner = false;
+		}
+
 		Vector2Int m_Size;
-		float* m_Buffer;
+		int32_t    m_Pitch;
+		float*     m_Buffer;
+		bool       m_Owner;
+	};
+
+	// Where fragments, clears and blits of a framebuffer end up. Only the console window has a screen,
+	// a framebuffer without a colour or depth attachment leaves that pointer null.
+	struct DrawTarget
+	{
+		ScreenBuffer* Screen = nullptr;
+		Colour*       Colours = nullptr;
+		DepthBuffer*  Depth = nullptr;
+		Vector2Int    Size;
+		int32_t       Pitch = 0; // Colours from one row to the next.
 	};
 
 	template < uint8_t _Interface >
@@ -1618,9 +1982,9 @@ private:
 		static constexpr bool _CullFront = _Interface & ( 1u << 5u );
 		static constexpr bool _CullBack = _Interface & ( 1u << 4u );
 		static constexpr bool _DepthTest = _Interface & ( 1u << 3u );
-		static constexpr bool _Unused0 = _Interface & ( 1u << 2u );
-		static constexpr bool _Unused1 = _Interface & ( 1u << 1u );
-		static constexpr bool _Unused2 = _Interface & ( 1u << 0u );
+		static constexpr bool _AlphaBlend = _Interface & ( 1u << 2u );
+		static constexpr bool _DepthWrite = _Interface & ( 1u << 1u );
+		static constexpr bool _DebugCounters = _Interface & ( 1u << 0u );
 
 		// Culling - if enabled and incorrect orientation, continue.
 		if constexpr ( _CullFront || _CullBack )
@@ -1655,6 +2019,215 @@ private:
 		return true;
 	}
 
+#if defined( _M_X64 ) || defined( __SSE2__ )
+	// Blend factors work on 16 bit lanes holding RGBA in the low four lanes.
+	inline static __m128i GetBlendFactor( BlendFactor a_Factor, __m128i a_Source, __m128i a_Destination )
+	{
+		static const __m128i Max = _mm_set1_epi16( 255 );
+
+		switch ( a_Factor )
+		{
+			case BlendFactor::ZERO:                 return _mm_setzero_si128();
+			case BlendFactor::ONE:                  return Max;
+			case BlendFactor::SRC_COLOUR:           return a_Source;
+			case BlendFactor::ONE_MINUS_SRC_COLOUR: return _mm_sub_epi16( Max, a_Source );
+			case BlendFactor::DST_COLOUR:           return a_Destination;
+			case BlendFactor::ONE_MINUS_DST_COLOUR: return _mm_sub_epi16( Max, a_Destination );
+			case BlendFactor::SRC_ALPHA:            return _mm_shufflelo_epi16( a_Source, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+			case BlendFactor::ONE_MINUS_SRC_ALPHA:  return _mm_sub_epi16( Max, _mm_shufflelo_epi16( a_Source, _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+			case BlendFactor::DST_ALPHA:            return _mm_shufflelo_epi16( a_Destination, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+			case BlendFactor::ONE_MINUS_DST_ALPHA:  return _mm_sub_epi16( Max, _mm_shufflelo_epi16( a_Destination, _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+			default:                                return Max;
+		}
+	}
+
+	// ( a * b ) / 255 with rounding, exact for 8 bit inputs.
+	inline static __m128i MultiplyChannels( __m128i a_A, __m128i a_B )
+	{
+		__m128i Product = _mm_add_epi16( _mm_mullo_epi16( a_A, a_B ), _mm_set1_epi16( 128 ) );
+		return _mm_srli_epi16( _mm_add_epi16( Product, _mm_srli_epi16( Product, 8 ) ), 8 );
+	}
+
+	static Colour BlendColour( Colour a_Source, Colour a_Destination )
+	{
+		__m128i Source      = _mm_unpacklo_epi8( _mm_cvtsi32_si128( *reinterpret_cast< const int32_t* >( &a_Source ) ), _mm_setzero_si128() );
+		__m128i Destination = _mm_unpacklo_epi8( _mm_cvtsi32_si128( *reinterpret_cast< const int32_t* >( &a_Destination ) ), _mm_setzero_si128() );
+		__m128i SourceTerm      = MultiplyChannels( Source, GetBlendFactor( s_BlendState.Source, Source, Destination ) );
+		__m128i DestinationTerm = MultiplyChannels( Destination, GetBlendFactor( s_BlendState.Destination, Source, Destination ) );
+		__m128i Result;
+
+		switch ( s_BlendState.Equation )
+		{
+			case ::BlendEquation::SUBTRACT:         Result = _mm_subs_epu16( SourceTerm, DestinationTerm ); break;
+			case ::BlendEquation::REVERSE_SUBTRACT: Result = _mm_subs_epu16( DestinationTerm, SourceTerm ); break;
+			case ::BlendEquation::MIN:              Result = _mm_min_epi16( Source, Destination );          break;
+			case ::BlendEquation::MAX:              Result = _mm_max_epi16( Source, Destination );          break;
+			default:                                Result = _mm_adds_epu16( SourceTerm, DestinationTerm ); break;
+		}
+
+		int32_t Packed = _mm_cvtsi128_si32( _mm_packus_epi16( Result, Result ) );
+		return *reinterpret_cast< Colour* >( &Packed );
+	}
+#else
+	inline static int32_t GetBlendFactor( BlendFactor a_Factor, int32_t a_Source, int32_t a_SourceAlpha, int32_t a_Destination, int32_t a_DestinationAlpha )
+	{
+		switch ( a_Factor )
+		{
+			case BlendFactor::ZERO:                 return 0;
+			case BlendFactor::ONE:                  return 255;
+			case BlendFactor::SRC_COLOUR:           return a_Source;
+			case BlendFactor::ONE_MINUS_SRC_COLOUR: return 255 - a_Source;
+			case BlendFactor::DST_COLOUR:           return a_Destination;
+			case BlendFactor::ONE_MINUS_DST_COLOUR: return 255 - a_Destination;
+			case BlendFactor::SRC_ALPHA:            return a_SourceAlpha;
+			case BlendFactor::ONE_MINUS_SRC_ALPHA:  return 255 - a_SourceAlpha;
+			case BlendFactor::DST_ALPHA:            return a_DestinationAlpha;
+			case BlendFactor::ONE_MINUS_DST_ALPHA:  return 255 - a_DestinationAlpha;
+			default:                                return 255;
+		}
+	}
+
+	inline static int32_t MultiplyChannels( int32_t a_A, int32_t a_B )
+	{
+		int32_t Product = a_A * a_B + 128;
+		return ( Product + ( Product >> 8 ) ) >> 8;
+	}
+
+	static Colour BlendColour( Colour a_Source, Colour a_Destination )
+	{
+		Colour::Channel* Source = &a_Source.R;
+		Colour::Channel* Destination = &a_Destination.R;
+
+		for ( uint32_t i = 0; i < 4; ++i )
+		{
+			int32_t SourceTerm      = MultiplyChannels( Source[ i ], GetBlendFactor( s_BlendState.Source, Source[ i ], a_Source.A, Destination[ i ], a_Destination.A ) );
+			int32_t DestinationTerm = MultiplyChannels( Destination[ i ], GetBlendFactor( s_BlendState.Destination, Source[ i ], a_Source.A, Destination[ i ], a_Destination.A ) );
+			int32_t Result;
+
+			switch ( s_BlendState.Equation )
+			{
+				case ::BlendEquation::SUBTRACT:         Result = SourceTerm - DestinationTerm;                 break;
+				case ::BlendEquation::REVERSE_SUBTRACT: Result = DestinationTerm - SourceTerm;                 break;
+				case ::BlendEquation::MIN:              Result = Math::Min( Source[ i ], Destination[ i ] );   break;
+				case ::BlendEquation::MAX:              Result = Math::Max( Source[ i ], Destination[ i ] );   break;
+				default:                                Result = SourceTerm + DestinationTerm;                 break;
+			}
+
+			Destination[ i ] = static_cast< Colour::Channel >( Math::Clamp( Result, 0, 255 ) );
+		}
+
+		return a_Destination;
+	}
+#endif
+
+	// Depth test, fragment shader and colour output for a single fragment.
+	template < uint8_t _Interface >
+	inline static void ShadeFragment( const Vector4& a_P, int32_t a_Y, AttribSpan< float >& a_V, AttribSpan< float >& o_Interpolated, void( *a_FragmentShader )( ) )
+	{
+		static constexpr bool _Perspective = _Interface & ( 1u << 7u );
+		static constexpr bool _DepthTest = _Interface & ( 1u << 3u );
+		static constexpr bool _AlphaBlend = _Interface & ( 1u << 2u );
+		static constexpr bool _DepthWrite = _Interface & ( 1u << 1u );
+		static constexpr bool _DebugCounters = _Interface & ( 1u << 0u );
+
+		[[maybe_unused]] RenderCounters::Counter* Counter = nullptr;
+
+		if constexpr ( _DebugCounters )
+		{
+			Counter = &s_Counters.Pixels[ a_Y * s_Counters.Size.x + static_cast< int32_t >( a_P.x ) ];
+			++Counter->Fragments;
+			++s_Statistics.Fragments;
+		}
+
+		if constexpr ( _DepthTest )
+		{
+			// Without a depth attachment the test always passes.
+			if ( DepthBuffer* Depth = s_DrawTarget.Depth )
+			{
+				bool Passed;
+
+				if constexpr ( _DepthWrite )
+				{
+					Passed = Depth->TestAndCommit( a_P.x, a_P.y, a_P.z / a_P.w );
+				}
+				else
+				{
+					Passed = Depth->Test( a_P.x, a_P.y, a_P.z / a_P.w );
+				}
+
+				if ( !Passed )
+				{
+					if constexpr ( _DebugCounters )
+					{
+						++Counter->DepthFailed;
+						++s_Statistics.DepthFailed;
+					}
+
+					return;
+				}
+			}
+		}
+
+		if constexpr ( _DebugCounters )
+		{
+			++Counter->Shaded;
+			++s_Statistics.Shaded;
+		}
+
+		o_Interpolated = a_V;
+
+		if constexpr ( _Perspective )
+		{
+			o_Interpolated /= a_P.w;
+		}
+
+		a_FragmentShader();
+
+		Colour Source = Math::Clamp( FragColour, 0.0f, 1.0f );
+
+		if ( ScreenBuffer* Screen = s_DrawTarget.Screen )
+		{
+			Vector2Int Coord = { static_cast< int32_t >( a_P.x ), static_cast< int32_t >( a_Y ) };
+
+			if constexpr ( _AlphaBlend )
+			{
+				Source = BlendColour( Source, Screen->GetColour( Coord ) );
+			}
+
+			Screen->SetColour( Coord, Source );
+		}
+		else if ( s_DrawTarget.Colours )
+		{
+			Colour& Destination = s_DrawTarget.Colours[ static_cast< size_t >( a_Y ) * s_DrawTarget.Pitch + static_cast< int32_t >( a_P.x ) ];
+
+			if constexpr ( _AlphaBlend )
+			{
+				Source = BlendColour( Source, Destination );
+			}
+
+			Destination = Source;
+		}
+	}
+
+	// Moves the start of a span onto the scissor rectangle and returns where the span ends.
+	// Rows outside the rectangle return an end behind any start.
+	inline static int32_t ScissorSpan( float a_Y, float a_EndX, AttribSpan< Vector4 >& o_PBegin, const AttribSpan< Vector4 >& a_PStep, AttribSpan< float >& o_VBegin, const AttribSpan< float >& a_VStep )
+	{
+		if ( a_Y < s_ScissorMin.y || a_Y > s_ScissorMax.y )
+		{
+			return std::numeric_limits< int32_t >::min();
+		}
+
+		if ( o_PBegin->x < s_ScissorMin.x )
+		{
+			float Skip = Math::Ceil( s_ScissorMin.x - o_PBegin->x );
+			*o_PBegin += *a_PStep * Skip;
+			o_VBegin.AddScaled( a_VStep, Skip );
+		}
+
+		return Math::Min( static_cast< int32_t >( a_EndX ), s_ScissorMax.x + 1 );
+	}
+
 	template < uint8_t _Interface >
 	static void RasterizeTriangle( Vector4* a_P, AttribSpan< float >* a_V, uint32_t a_Stride, void( *a_FragmentShader )( ) )
 	{
@@ -1663,9 +2236,9 @@ private:
 		static constexpr bool _CullFront = _Interface & ( 1u << 5u );
 		static constexpr bool _CullBack = _Interface & ( 1u << 4u );
 		static constexpr bool _DepthTest = _Interface & ( 1u << 3u );
-		static constexpr bool _Unused0 = _Interface & ( 1u << 2u );
-		static constexpr bool _Unused1 = _Interface & ( 1u << 1u );
-		static constexpr bool _Unused2 = _Interface & ( 1u << 0u );
+		static constexpr bool _AlphaBlend = _Interface & ( 1u << 2u );
+		static constexpr bool _DepthWrite = _Interface & ( 1u << 1u );
+		static constexpr bool _DebugCounters = _Interface & ( 1u << 0u );
 
 		// Sort corners.
 		if ( a_P[ 0 ].y < a_P[ 1 ].y )
@@ -1691,6 +2264,11 @@ private:
 			return;
 		}
 
+		if constexpr ( _DebugCounters )
+		{
+			CountTriangle( a_P );
+		}
+
 		// Setup Position and Attribute values.
 		float SpanX, SpanY, Y;
 		static DataStorage< Vector4 > Positions;
@@ -1765,25 +2343,9 @@ private:
 				VStep -= VL;
 				VStep *= SpanX;
 
-				for ( ; PBegin->x < static_cast< int >( PR->x ); *PBegin += *PStep, VBegin += VStep )
+				for ( int32_t End = ScissorSpan( Y, PR->x, PBegin, PStep, VBegin, VStep ); PBegin->x < End; *PBegin += *PStep, VBegin += VStep )
 				{
-					if constexpr ( _DepthTest )
-					{
-						if ( !s_DepthBuffer.TestAndCommit( PBegin->x, PBegin->y, PBegin->z / PBegin->w ) )
-						{
-							continue;
-						}
-					}
-
-					InterpolatedValues = VBegin;
-
-					if constexpr ( _Perspective )
-					{
-						InterpolatedValues /= PBegin->w;
-					}
-
-					a_FragmentShader();
-					ConsoleWindow::GetCurrentContext()->GetScreenBuffer().SetColour( { PBegin->x, Y }, FragColour );
+					ShadeFragment< _Interface >( *PBegin, Y, VBegin, InterpolatedValues, a_FragmentShader );
 				}
 
 				*PL += *PStepL;
@@ -1825,26 +2387,9 @@ private:
 				VStep -= VL;
 				VStep *= SpanX;
 
-				for ( ; PBegin->x < static_cast< int >( PR->x ); *PBegin += *PStep, VBegin += VStep )
+				for ( int32_t End = ScissorSpan( Y, PR->x, PBegin, PStep, VBegin, VStep ); PBegin->x < End; *PBegin += *PStep, VBegin += VStep )
 				{
-
-					if constexpr ( _DepthTest )
-					{
-						if ( !s_DepthBuffer.TestAndCommit( PBegin->x, PBegin->y, PBegin->z / PBegin->w ) )
-						{
-							continue;
-						}
-					}
-
-					InterpolatedValues = VBegin;
-
-					if constexpr ( _Perspective )
-					{
-						InterpolatedValues /= PBegin->w;
-					}
-
-					a_FragmentShader();
-					ConsoleWindow::GetCurrentContext()->GetScreenBuffer().SetColour( { PBegin->x, Y }, FragColour );
+					ShadeFragment< _Interface >( *PBegin, Y, VBegin, InterpolatedValues, a_FragmentShader );
 				}
 
 				*PL += *PStepL;
@@ -1855,6 +2400,41 @@ private:
 		}
 	}
 
+	// Adds a rasterized triangle to the statistics and to every tile its bounds touch inside the write area.
+	static void CountTriangle( const Vector4* a_P )
+	{
+		++s_Statistics.TrianglesRasterized;
+
+		int32_t Left = Math::Max( static_cast< int32_t >( Math::Min( a_P[ 0 ].x, Math::Min( a_P[ 1 ].x, a_P[ 2 ].x ) ) ), s_ScissorMin.x );
+		int32_t Right = Math::Min( static_cast< int32_t >( Math::Max( a_P[ 0 ].x, Math::Max( a_P[ 1 ].x, a_P[ 2 ].x ) ) ), s_ScissorMax.x );
+		int32_t Bottom = Math::Max( static_cast< int32_t >( a_P[ 2 ].y ), s_ScissorMin.y );
+		int32_t Top = Math::Min( static_cast< int32_t >( a_P[ 0 ].y ), s_ScissorMax.y );
+
+		for ( int32_t y = Bottom / RenderCounters::TileSize; Left <= Right && y <= Top / RenderCounters::TileSize; ++y )
+		{
+			for ( int32_t x = Left / RenderCounters::TileSize; x <= Right / RenderCounters::TileSize; ++x )
+			{
+				++s_Counters.TileTriangles[ y * s_Counters.Tiles.x + x ];
+			}
+		}
+	}
+
+	// Whether a clip space triangle lies within every plane it would be clipped against.
+	static bool InsideClipVolume( const Vector4* a_P )
+	{
+		for ( uint32_t i = 0; i < 3; ++i )
+		{
+			const Vector4& P = a_P[ i ];
+
+			if ( P.x < -P.w || P.x > P.w || P.y < -P.w || P.y > P.w || P.z < -P.w )
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	template < uint8_t _Plane = 0 >
 	static void ViewportClipTriangle( Vector4* a_P, AttribSpan< float >* a_V, uint32_t a_Stride, void( *a_Rasterizer )( Vector4*, AttribSpan< float >*, uint32_t, void( * )( ) ), void( *a_Converter )( Vector4* ), void( *a_FragmentShader )( ) )
 	{
@@ -2009,6 +2589,223 @@ private:
 		}
 	}
 
+	static DrawTarget GetDrawTarget( FramebufferHandle a_Handle )
+	{
+		DrawTarget Target;
+
+		if ( a_Handle == 0 || !s_FramebufferRegistry.Valid( a_Handle ) )
+		{
+			// The window's depth buffer follows the window size.
+			ScreenBuffer& Screen = ConsoleWindow::GetCurrentContext()->GetScreenBuffer();
+			Target.Screen = &Screen;
+			Target.Colours = Screen.GetColourBuffer();
+			Target.Size = ConsoleWindow::GetCurrentContext()->GetSize();
+			Target.Pitch = Screen.GetPitch();
+
+			if ( s_DepthBuffer.GetSize() != Target.Size )
+			{
+				s_DepthBuffer.Init( Target.Size );
+			}
+
+			Target.Depth = &s_DepthBuffer;
+			return Target;
+		}
+
+		const Framebuffer& Source = s_FramebufferRegistry[ a_Handle ];
+
+		// Attachment data is owned by whoever specified the texture.
+		if ( Source.ColourAttachment && s_TextureRegistry.Valid( Source.ColourAttachment ) )
+		{
+			auto& Attachment = s_TextureRegistry[ Source.ColourAttachment ];
+			Target.Colours = static_cast< Colour* >( const_cast< void* >( Attachment.Data ) );
+			Target.Size = Attachment.Dimensions;
+			Target.Pitch = Attachment.Dimensions.x;
+		}
+
+		if ( Source.DepthAttachment && s_TextureRegistry.Valid( Source.DepthAttachment ) )
+		{
+			auto& Attachment = s_TextureRegistry[ Source.DepthAttachment ];
+			DepthBuffer& Depth = s_AttachmentDepths[ a_Handle - 1 ];
+			Depth.Wrap( static_cast< float* >( const_cast< void* >( Attachment.Data ) ), Attachment.Dimensions );
+			Target.Depth = &Depth;
+			Target.Size = Target.Colours ? Target.Size : Attachment.Dimensions;
+		}
+
+		if ( !Target.Colours && !Target.Depth )
+		{
+			Target.Size = Vector2Int::Zero;
+		}
+
+		return Target;
+	}
+
+	static void UpdateDrawTarget()
+	{
+		s_DrawTarget = GetDrawTarget( s_DrawFramebuffer );
+	}
+
+	// The viewport covers the draw target until one is set, its origin is the top left of the target.
+	static RectInt GetViewportArea()
+	{
+		Vector2Int Size = s_DrawTarget.Size;
+		return s_ViewportRect.Size.x > 0 && s_ViewportRect.Size.y > 0 ? s_ViewportRect : RectInt( 0, 0, Size.x, Size.y );
+	}
+
+	// Inclusive pixel bounds of the draw target, limited by the scissor rectangle when the test is enabled.
+	static void GetWriteBounds( Vector2Int& o_Min, Vector2Int& o_Max )
+	{
+		Vector2Int Size = s_DrawTarget.Size;
+		o_Min = { 0, 0 };
+		o_Max = { Size.x - 1, Size.y - 1 };
+
+		if ( s_RenderState.ScissorTest )
+		{
+			o_Min = { Math::Max( o_Min.x, s_ScissorRect.GetLeft() ), Math::Max( o_Min.y, s_ScissorRect.GetBottom() ) };
+			o_Max = { Math::Min( o_Max.x, s_ScissorRect.GetRight() ), Math::Min( o_Max.y, s_ScissorRect.GetTop() ) };
+		}
+	}
+
+	static void UpdateScreenSpace()
+	{
+		UpdateDrawTarget();
+		RectInt Area = GetViewportArea();
+		s_FullWindow = Vector2::One * 0.1f + Area.Size;
+		s_HalfWindow = 0.5f * s_FullWindow;
+		s_ViewportOrigin = { static_cast< float >( Area.Origin.x ), static_cast< float >( Area.Origin.y ) };
+
+		// Fragments stay inside the viewport as well.
+		GetWriteBounds( s_ScissorMin, s_ScissorMax );
+		s_ScissorMin = { Math::Max( s_ScissorMin.x, Area.GetLeft() ), Math::Max( s_ScissorMin.y, Area.GetBottom() ) };
+		s_ScissorMax = { Math::Min( s_ScissorMax.x, Area.GetRight() ), Math::Min( s_ScissorMax.y, Area.GetTop() ) };
+
+		// Counters follow the target they are counting, starting from zero when it changes size.
+		if ( s_RenderState.DebugCounters && s_Counters.Size != s_DrawTarget.Size )
+		{
+			s_Counters.Size = s_DrawTarget.Size;
+			s_Counters.Tiles = ( s_DrawTarget.Size + Vector2Int( RenderCounters::TileSize - 1, RenderCounters::TileSize - 1 ) ) / RenderCounters::TileSize;
+			s_Counters.Pixels.assign( static_cast< size_t >( s_Counters.Size.x ) * s_Counters.Size.y, RenderCounters::Counter{} );
+			s_Counters.TileTriangles.assign( static_cast< size_t >( s_Counters.Tiles.x ) * s_Counters.Tiles.y, 0 );
+		}
+	}
+
+	static void ConvertToScreenSpace( Vector4* a_P )
+	{
+		a_P->w = 1.0f / a_P->w;
+		a_P->x *= a_P->w;
+		a_P->y *= a_P->w;
+		a_P->z *= a_P->w;
+
+		a_P->x += 1.0f;
+		a_P->y += 1.0f;
+		a_P->x *= s_HalfWindow.x;
+		a_P->y *= s_HalfWindow.y;
+		a_P->y = static_cast< int >( s_FullWindow.y - a_P->y );
+		a_P->x += s_ViewportOrigin.x;
+		a_P->y += s_ViewportOrigin.y;
+	}
+
+	// Liang-Barsky against the same planes as triangles, in clip space.
+	static bool ClipLine( Vector4* a_P, AttribSpan< float >* a_V, Vector4* o_P, AttribSpan< float >* o_V )
+	{
+		static constexpr std::array< Vector4, 5 > _Normals = {
+			Vector4{  1,  0,  0,  1 }, // Left
+			Vector4{ -1,  0,  0,  1 }, // Right
+			Vector4{  0,  1,  0,  1 }, // Bottom
+			Vector4{  0, -1,  0,  1 }, // Top
+			Vector4{  0,  0,  1,  1 }, // Front
+		};
+
+		float TBegin = 0.0f, TEnd = 1.0f;
+
+		for ( const Vector4& Normal : _Normals )
+		{
+			float AD = Normal.x * a_P[ 0 ].x + Normal.y * a_P[ 0 ].y + Normal.z * a_P[ 0 ].z + a_P[ 0 ].w;
+			float BD = Normal.x * a_P[ 1 ].x + Normal.y * a_P[ 1 ].y + Normal.z * a_P[ 1 ].z + a_P[ 1 ].w;
+
+			if ( AD < 0.0f && BD < 0.0f )
+			{
+				return false;
+			}
+
+			if ( AD < 0.0f )
+			{
+				TBegin = Math::Max( TBegin, AD / ( AD - BD ) );
+			}
+			else if ( BD < 0.0f )
+			{
+				TEnd = Math::Min( TEnd, AD / ( AD - BD ) );
+			}
+		}
+
+		if ( TBegin > TEnd )
+		{
+			return false;
+		}
+
+		o_P[ 0 ] = ( a_P[ 1 ] - a_P[ 0 ] ) * TBegin + a_P[ 0 ];
+		o_P[ 1 ] = ( a_P[ 1 ] - a_P[ 0 ] ) * TEnd + a_P[ 0 ];
+
+		o_V[ 0 ] = a_V[ 1 ];
+		o_V[ 0 ] -= a_V[ 0 ];
+		o_V[ 1 ] = o_V[ 0 ];
+		o_V[ 0 ] *= TBegin;
+		o_V[ 0 ] += a_V[ 0 ];
+		o_V[ 1 ] *= TEnd;
+		o_V[ 1 ] += a_V[ 0 ];
+		return true;
+	}
+
+	// DDA along the major axis, interpolating position and attributes per step.
+	template < uint8_t _Interface >
+	static void RasterizeLine( Vector4* a_P, AttribSpan< float >* a_V, uint32_t a_Stride, void( *a_FragmentShader )( ) )
+	{
+		static DataStorage< float > Attributes;
+		static AttribSpan< float >  VStep, VBegin, InterpolatedValues;
+
+		Attributes.Prepare( a_Stride * 2 );
+		VStep.Set( Attributes.Data() + a_Stride * 0, a_Stride );
+		VBegin.Set( Attributes.Data() + a_Stride * 1, a_Stride );
+		InterpolatedValues.Set( s_InterpolatedStorage.Data(), a_Stride );
+
+		// One step per pixel along the major axis, both ends included. A line shorter than a pixel is one sample.
+		Vector4 Delta = a_P[ 1 ] - a_P[ 0 ];
+		uint32_t Steps = static_cast< uint32_t >( Math::Ceil( Math::Max( Math::Abs( Delta.x ), Math::Abs( Delta.y ) ) ) );
+		float InverseSteps = Steps ? 1.0f / Steps : 0.0f;
+		int32_t LastX = INT32_MIN, LastY = INT32_MIN;
+
+		Vector4 PStep = Delta * InverseSteps;
+		Vector4 PBegin = a_P[ 0 ];
+		VStep = a_V[ 1 ];
+		VStep -= a_V[ 0 ];
+		VStep *= InverseSteps;
+		VBegin = a_V[ 0 ];
+
+		for ( uint32_t i = 0; i <= Steps; ++i, PBegin += PStep, VBegin += VStep )
+		{
+			int32_t X = static_cast< int32_t >( PBegin.x );
+			int32_t Y = static_cast< int32_t >( PBegin.y );
+
+			// Steps shorter than a pixel can land on the same one twice, which would blend it twice.
+			if ( X == LastX && Y == LastY )
+			{
+				continue;
+			}
+
+			LastX = X;
+			LastY = Y;
+
+			if ( X < s_ScissorMin.x || Y < s_ScissorMin.y || X > s_ScissorMax.x || Y > s_ScissorMax.y )
+			{
+				continue;
+			}
+
+			Vector4 Fragment = PBegin;
+			Fragment.x = static_cast< float >( X );
+			Fragment.y = static_cast< float >( Y );
+			ShadeFragment< _Interface >( Fragment, Y, VBegin, InterpolatedValues, a_FragmentShader );
+		}
+	}
+
 	template < uint8_t _Interface >
 	static void ProcessVertices( uint32_t a_Begin, uint32_t a_End, uint32_t a_Stride, void( *a_VertexShader )( ) )
 	{
@@ -2017,9 +2814,9 @@ private:
 		static constexpr bool _CullFront = _Interface & ( 1u << 5u );
 		static constexpr bool _CullBack = _Interface & ( 1u << 4u );
 		static constexpr bool _DepthTest = _Interface & ( 1u << 3u );
-		static constexpr bool _Unused0 = _Interface & ( 1u << 2u );
-		static constexpr bool _Unused1 = _Interface & ( 1u << 1u );
-		static constexpr bool _Unused2 = _Interface & ( 1u << 0u );
+		static constexpr bool _AlphaBlend = _Interface & ( 1u << 2u );
+		static constexpr bool _DepthWrite = _Interface & ( 1u << 1u );
+		static constexpr bool _DebugCounters = _Interface & ( 1u << 0u );
 
 		s_VertexStorage.Prepare( a_End - a_Begin, a_Stride * sizeof( float ) );
 		s_PositionStorage.Prepare( a_End - a_Begin );
@@ -2065,28 +2862,12 @@ private:
 		static constexpr bool _CullFront = _Interface & ( 1u << 5u );
 		static constexpr bool _CullBack = _Interface & ( 1u << 4u );
 		static constexpr bool _DepthTest = _Interface & ( 1u << 3u );
-		static constexpr bool _Unused0 = _Interface & ( 1u << 2u );
-		static constexpr bool _Unused1 = _Interface & ( 1u << 1u );
-		static constexpr bool _Unused2 = _Interface & ( 1u << 0u );
+		static constexpr bool _AlphaBlend = _Interface & ( 1u << 2u );
+		static constexpr bool _DepthWrite = _Interface & ( 1u << 1u );
+		static constexpr bool _DebugCounters = _Interface & ( 1u << 0u );
 
 		// Prepare screen space size.
-		static Vector2 FullWindow, HalfWindow;
-		FullWindow = Vector2::One * 0.1f + ConsoleWindow::GetCurrentContext()->GetSize();
-		HalfWindow = 0.5f * FullWindow;
-
-		static constexpr auto ConvertToScreenSpace = []( Vector4* a_P )
-		{
-			a_P->w = 1.0f / a_P->w;
-			a_P->x *= a_P->w;
-			a_P->y *= a_P->w;
-			a_P->z *= a_P->w;
-
-			a_P->x += 1.0f;
-			a_P->y += 1.0f;
-			a_P->x *= HalfWindow.x;
-			a_P->y *= HalfWindow.y;
-			a_P->y = static_cast< int >( FullWindow.y - a_P->y );
-		};
+		UpdateScreenSpace();
 
 		// Get spans that will be set to vertex and position storage.
 		static AttribSpan< Vector4 > P[ 3 ];
@@ -2113,23 +2894,206 @@ private:
 			  , V[ 1 ].Advance( 3 )
 			  , V[ 2 ].Advance( 3 ) )
 		{
+			if constexpr ( _DebugCounters )
+			{
+				++s_Statistics.TrianglesIn;
+			}
+
 			if ( !CullCheck< _Interface >( &P[ 0 ][ 0 ] ) )
 			{
+				if constexpr ( _DebugCounters )
+				{
+					++s_Statistics.TrianglesCulled;
+				}
+
 				continue;
 			}
 
+			if constexpr ( _DebugCounters )
+			{
+				s_Statistics.TrianglesClipped += !InsideClipVolume( &P[ 0 ][ 0 ] );
+			}
+
 			ViewportClipTriangle( &P[ 0 ][ 0 ], V, a_Stride, RasterizeTriangle< _Interface >, ConvertToScreenSpace, a_FragmentShader );
 		}
 	}
 
+	template < uint8_t _Interface >
+	static void ProcessLines( uint32_t a_Begin, uint32_t a_End, uint32_t a_Stride, void( *a_FragmentShader )( ) )
+	{
+		UpdateScreenSpace();
+
+		static AttribSpan< Vector4 > P[ 2 ];
+		static AttribSpan< float   > V[ 2 ];
+		static DataStorage< float >  ClippedData;
+		static Vector4               PClipped[ 2 ];
+		static AttribSpan< float >   VClipped[ 2 ];
+
+		s_VertexStorage.Reset();
+		s_PositionStorage.Reset();
+		s_InterpolatedStorage.Prepare( a_Stride );
+		ClippedData.Prepare( a_Stride * 2 );
+
+		P[ 0 ].Set( s_PositionStorage.Head() + 0ul, 1 );
+		P[ 1 ].Set( s_PositionStorage.Head() + 1ul, 1 );
+		V[ 0 ].Set( s_VertexStorage.Head() + 0ul * a_Stride, a_Stride );
+		V[ 1 ].Set( s_VertexStorage.Head() + 1ul * a_Stride, a_Stride );
+		VClipped[ 0 ].Set( ClippedData.Data() + a_Stride * 0, a_Stride );
+		VClipped[ 1 ].Set( ClippedData.Data() + a_Stride * 1, a_Stride );
+
+		for ( ; a_Begin + 1 < a_End; a_Begin += 2
+			  , P[ 0 ].Advance( 2 )
+			  , P[ 1 ].Advance( 2 )
+			  , V[ 0 ].Advance( 2 )
+			  , V[ 1 ].Advance( 2 ) )
+		{
+			Vector4 PLine[ 2 ] = { P[ 0 ][ 0 ], P[ 1 ][ 0 ] };
+
+			if ( !ClipLine( PLine, V, PClipped, VClipped ) )
+			{
+				continue;
+			}
+
+			ConvertToScreenSpace( PClipped + 0 );
+			ConvertToScreenSpace( PClipped + 1 );
+			RasterizeLine< _Interface >( PClipped, VClipped, a_Stride, a_FragmentShader );
+		}
+	}
+
+	template < uint8_t _Interface >
+	static void ProcessPoints( uint32_t a_Begin, uint32_t a_End, uint32_t a_Stride, void( *a_FragmentShader )( ) )
+	{
+		UpdateScreenSpace();
+
+		static AttribSpan< float > V, InterpolatedValues;
+
+		s_VertexStorage.Reset();
+		s_PositionStorage.Reset();
+		s_InterpolatedStorage.Prepare( a_Stride );
+		V.Set( s_VertexStorage.Head(), a_Stride );
+		InterpolatedValues.Set( s_InterpolatedStorage.Data(), a_Stride );
+
+		Vector4* P = s_PositionStorage.Head();
+
+		for ( ; a_Begin < a_End; ++a_Begin, ++P, V.Advance() )
+		{
+			// Points are either entirely inside or rejected.
+			if ( P->x < -P->w || P->x > P->w || P->y < -P->w || P->y > P->w || P->z < -P->w )
+			{
+				continue;
+			}
+
+			Vector4 Fragment = *P;
+			ConvertToScreenSpace( &Fragment );
+
+			int32_t X = static_cast< int32_t >( Fragment.x );
+			int32_t Y = static_cast< int32_t >( Fragment.y );
+
+			if ( X < s_ScissorMin.x || Y < s_ScissorMin.y || X > s_ScissorMax.x || Y > s_ScissorMax.y )
+			{
+				continue;
+			}
+
+			Fragment.x = static_cast< float >( X );
+			ShadeFragment< _Interface >( Fragment, Y, V, InterpolatedValues, a_FragmentShader );
+		}
+	}
+
 	template < uint8_t _Interface >
 	static void DrawProcessor( uint32_t a_Begin, uint32_t a_Count )
 	{
 		auto& ActiveProgram = s_ShaderProgramRegistry[ s_ActiveShaderProgram ];
 		uint32_t AttribStride = s_VaryingStrides[ ActiveProgram[ ShaderType::VERTEX_SHADER ] ] / sizeof( float );
+		bool CacheHit = false;
+		VertexCacheEntry* CacheEntry = s_RenderState.VertexCache ? AcquireVertexCacheEntry( GetVertexCacheKey< _Interface >( a_Begin, a_Count ), CacheHit ) : nullptr;
 
-		ProcessVertices     < _Interface >( a_Begin, a_Begin + a_Count, AttribStride, ActiveProgram[ ShaderType::VERTEX_SHADER ] );
-		ProcessFragments    < _Interface >( a_Begin, a_Begin + a_Count, AttribStride, ActiveProgram[ ShaderType::FRAGMENT_SHADER ] );
+		// While the key holds only the raster stage runs.
+		if ( CacheHit )
+		{
+			s_VertexStorage.Swap( CacheEntry->Vertices );
+			s_PositionStorage.Swap( CacheEntry->Positions );
+		}
+		else
+		{
+			ProcessVertices < _Interface >( a_Begin, a_Begin + a_Count, AttribStride, ActiveProgram[ ShaderType::VERTEX_SHADER ] );
+		}
+
+		switch ( s_RenderMode )
+		{
+			case RenderMode::POINT:    ProcessPoints   < _Interface >( a_Begin, a_Begin + a_Count, AttribStride, ActiveProgram[ ShaderType::FRAGMENT_SHADER ] ); break;
+			case RenderMode::LINE:     ProcessLines    < _Interface >( a_Begin, a_Begin + a_Count, AttribStride, ActiveProgram[ ShaderType::FRAGMENT_SHADER ] ); break;
+			case RenderMode::TRIANGLE: ProcessFragments< _Interface >( a_Begin, a_Begin + a_Count, AttribStride, ActiveProgram[ ShaderType::FRAGMENT_SHADER ] ); break;
+			default: break;
+		}
+
+		// The entry keeps this draw's output, the working storage takes back whatever the entry held.
+		if ( CacheEntry )
+		{
+			s_VertexStorage.Swap( CacheEntry->Vertices );
+			s_PositionStorage.Swap( CacheEntry->Positions );
+		}
+	}
+
+	// FNV-1a.
+	static void HashBytes( uint64_t& o_Key, const void* a_Data, size_t a_Size )
+	{
+		for ( size_t i = 0; i < a_Size; ++i )
+		{
+			o_Key = ( o_Key ^ static_cast< const uint8_t* >( a_Data )[ i ] ) * 1099511628211ull;
+		}
+	}
+
+	// Everything the vertex stage reads: program, streams and their tag, range, instance and vertex uniforms.
+	template < uint8_t _Interface >
+	static uint64_t GetVertexCacheKey( uint32_t a_Begin, uint32_t a_Count )
+	{
+		static constexpr uint8_t _Perspective = _Interface & ( 1u << 7u );
+
+		auto& ActiveProgram = s_ShaderProgramRegistry[ s_ActiveShaderProgram ];
+		uint64_t Key = 14695981039346656037ull;
+		HashBytes( Key, &_Perspective, sizeof( _Perspective ) );
+		HashBytes( Key, &s_ActiveShaderProgram, sizeof( s_ActiveShaderProgram ) );
+		HashBytes( Key, &a_Begin, sizeof( a_Begin ) );
+		HashBytes( Key, &a_Count, sizeof( a_Count ) );
+		HashBytes( Key, &InstanceID, sizeof( InstanceID ) );
+		HashBytes( Key, &s_VertexCacheTag, sizeof( s_VertexCacheTag ) );
+		s_AttributeRegistry.HashBindings( Key );
+
+		for ( auto& Uniform : ActiveProgram.m_VertexUniforms )
+		{
+			HashBytes( Key, Uniform.first, Uniform.second );
+		}
+
+		return Key;
+	}
+
+	// Least recently used entries are recycled, keeping their storage allocated.
+	static VertexCacheEntry* AcquireVertexCacheEntry( uint64_t a_Key, bool& o_Hit )
+	{
+		auto Where = s_VertexCache.find( a_Key );
+		o_Hit = Where != s_VertexCache.end();
+
+		if ( !o_Hit )
+		{
+			if ( s_VertexCache.size() >= s_VertexCacheCapacity )
+			{
+				auto Oldest = std::min_element( s_VertexCache.begin(), s_VertexCache.end(), []( const auto& a_Left, const auto& a_Right )
+				{
+					return a_Left.second.LastUse < a_Right.second.LastUse;
+				} );
+
+				auto Node = s_VertexCache.extract( Oldest );
+				Node.key() = a_Key;
+				Where = s_VertexCache.insert( std::move( Node ) ).position;
+			}
+			else
+			{
+				Where = s_VertexCache.emplace( a_Key, VertexCacheEntry() ).first;
+			}
+		}
+
+		Where->second.LastUse = ++s_VertexCacheClock;
+		return &Where->second;
 	}
 
 	template < size_t... Idxs >
@@ -2151,9 +3115,9 @@ private:
 		//static constexpr bool _CullFront = _Interface & ( 1u << 5u );
 		//static constexpr bool _CullBack = _Interface & ( 1u << 4u );
 		//static constexpr bool _DepthTest = _Interface & ( 1u << 3u );
-		//static constexpr bool _Unused0 = _Interface & ( 1u << 2u );
-		//static constexpr bool _Unused1 = _Interface & ( 1u << 1u );
-		//static constexpr bool _Unused2 = _Interface & ( 1u << 0u );
+		//static constexpr bool _AlphaBlend = _Interface & ( 1u << 2u );
+		//static constexpr bool _DepthWrite = _Interface & ( 1u << 1u );
+		//static constexpr bool _DebugCounters = _Interface & ( 1u << 0u );
 
 		uint8_t Interface = 0;
 
@@ -2162,9 +3126,9 @@ private:
 		if ( s_RenderState.CullFace && s_RenderState.FrontCull ) Interface |= ( 1u << 5u );
 		if ( s_RenderState.CullFace && s_RenderState.BackCull ) Interface |= ( 1u << 4u );
 		if ( s_RenderState.DepthTest ) Interface |= ( 1u << 3u );
-		if ( true ) Interface |= ( 1u << 2u ); // Unused
-		if ( true ) Interface |= ( 1u << 1u ); // Unused
-		if ( true ) Interface |= ( 1u << 0u ); // Unused
+		if ( s_RenderState.AlphaBlend ) Interface |= ( 1u << 2u );
+		if ( s_RenderState.DepthWrite ) Interface |= ( 1u << 1u );
+		if ( s_RenderState.DebugCounters ) Interface |= ( 1u << 0u );
 
 		s_DrawProcessorFunc = GetDrawProcessor( Interface );
 	}
@@ -2643,14 +3607,36 @@ private:
 	inline static DataStorage< Vector4 >          s_ClippedPositionStorage;
 
 	inline static DataStorage< float >            s_InterpolatedStorage;
+
+	// Post transform cache.
+	inline static std::unordered_map< uint64_t, VertexCacheEntry > s_VertexCache;
+	inline static uint64_t                        s_VertexCacheClock = 0;
+	inline static size_t                          s_VertexCacheCapacity = 64;
+	inline static uint64_t                        s_VertexCacheTag = 0;
 	inline static StrideRegistry                  s_VaryingStrides;
 	inline static RenderState                     s_RenderState;
 	inline static DepthBuffer                     s_DepthBuffer;
-	inline static Pixel                           s_ClearColour;
+	inline static FramebufferRegistry             s_FramebufferRegistry;
+	inline static std::array< DepthBuffer, 32 >   s_AttachmentDepths; // Wrap each framebuffer's depth attachment.
+	inline static FramebufferHandle               s_DrawFramebuffer = 0;
+	inline static FramebufferHandle               s_ReadFramebuffer = 0;
+	inline static DrawTarget                      s_DrawTarget;
+	inline static RenderStatistics                s_Statistics;
+	inline static RenderCounters                  s_Counters;
+	inline static Colour                          s_ClearColour;
 	inline static float                           s_ClearDepth;
 	inline static std::array< TextureUnit, 32 >   s_TextureUnits;
 	inline static uint32_t                        s_ActiveTextureUnit;
 	inline static uint32_t                        s_ActiveTextureTarget;
+	inline static BlendState                      s_BlendState;
+	inline static RenderMode                      s_RenderMode = RenderMode::TRIANGLE;
+	inline static Vector2                         s_FullWindow;
+	inline static Vector2                         s_HalfWindow;
+	inline static RectInt                         s_ScissorRect;
+	inline static RectInt                         s_ViewportRect;
+	inline static Vector2                         s_ViewportOrigin;
+	inline static Vector2Int                      s_ScissorMin;
+	inline static Vector2Int                      s_ScissorMax;
 	inline static DepthCompareFunc                s_DepthCompareFunc = DepthCompare_LESS;
-	inline static DrawProcessorFunc               s_DrawProcessorFunc = DrawProcessor< 0b10011111 >;
+	inline static DrawProcessorFunc               s_DrawProcessorFunc = DrawProcessor< 0b10011010 >;
 };
\ No newline at end of file
@@ -9,9 +9,13 @@ public:
 	{
 		auto AllTransforms = Component::GetExactComponents< Transform >();
 
+		// Children are updated by their parents.
 		for ( auto Transform : AllTransforms )
 		{
-			Transform->UpdateTransform();
+			if ( Transform->m_Parent == GameObjectID( -1 ) )
+			{
+				Transform->UpdateTransform();
+			}
 		}
 	}
 
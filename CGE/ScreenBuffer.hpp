@@ -1,22 +1,87 @@
 #pragma once
+#include <new>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#if defined( _M_X64 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
 #include "Rect.hpp"
 #include "PixelColourMap.hpp"
+#include "Parallel.hpp"
 
+// Draws write colours, Resolve turns the finished frame into console cells once per pixel however often
+// it was drawn over. Cells are triple buffered: the game thread resolves into the back buffer and publishes
+// it, the presenting thread takes the latest published frame, and neither waits on the other.
+//
+// Rows are padded to a whole number of cache lines and every buffer starts on one, so rows can be walked with
+// aligned vector loads and split into tiles without two workers sharing a line. Rows are GetPitch() cells
+// apart, cells past the width are never shown.
 class ScreenBuffer
 {
 public:
 
-    void Initialize( Vector< short, 2 > a_BufferSize )
+    // The Windows console shows glyphs in 16 colours, terminals and headless runs take the colours themselves.
+#if CGE_CONSOLE_CELLS
+    typedef Pixel Cell;
+#else
+    typedef Colour Cell;
+#endif
+
+    enum class Dither
     {
-        m_FrontBuffer = new Pixel[ static_cast< size_t >( a_BufferSize.x ) * a_BufferSize.y ];
-        m_BackBuffer = new Pixel[ static_cast< size_t >( a_BufferSize.x ) * a_BufferSize.y ];;
-        m_ColourBuffer = new Colour[ static_cast< size_t >( a_BufferSize.x ) * a_BufferSize.y ];
+        NONE,     // Each pixel takes the console pixel nearest its colour.
+        ORDERED,  // A 4x4 Bayer pattern nudges neighbouring pixels towards different console pixels.
+        DIFFUSION // Floyd-Steinberg, each pixel's error is carried onto the pixels right of and below it.
+    };
+
+    // Bytes each buffer and row is aligned to.
+    static constexpr size_t Alignment = 64;
+
+    ~ScreenBuffer()
+    {
+        for ( auto& Buffer : m_PixelBuffers )
+        {
+            Free( Buffer );
+        }
+
+        Free( m_ColourBuffer );
+    }
+
+    // Also used to resize, which drops any frame waiting to be presented. The presenting thread must not be
+    // holding a frame.
+    void Initialize( Vector2Int a_BufferSize )
+    {
+        // Colours and cells share their indices, so both need whole rows of cache lines at the same pitch.
+        static_assert( sizeof( Colour ) == sizeof( Cell ) && Alignment % sizeof( Cell ) == 0, "Rows are padded in whole cells." );
+        constexpr int32_t RowCells = static_cast< int32_t >( Alignment / sizeof( Cell ) );
+        m_Pitch = ( a_BufferSize.x + RowCells - 1 ) / RowCells * RowCells;
+        size_t Cells = static_cast< size_t >( m_Pitch ) * a_BufferSize.y;
+
+        for ( auto& Buffer : m_PixelBuffers )
+        {
+            Free( Buffer );
+            Buffer = Allocate< Cell >( Cells );
+        }
+
+        Free( m_ColourBuffer );
+        m_ColourBuffer = Allocate< Colour >( Cells );
         m_Size = a_BufferSize;
+        m_Back = 0;
+        m_Front = 1;
+        m_Ready = 2;
+    }
+
+    inline Cell* GetPixelBuffer()
+    {
+        return m_PixelBuffers[ m_Back ];
     }
 
-    inline Pixel* GetPixelBuffer()
+    // The frame the presenting thread last acquired.
+    inline const Cell* GetPresentBuffer() const
     {
-        return m_BackBuffer;
+        return m_PixelBuffers[ m_Front ];
     }
 
     inline Colour* GetColourBuffer()
@@ -24,155 +89,300 @@ public:
         return m_ColourBuffer;
     }
 
-    inline Vector< short, 2 > GetSize()
+    inline Vector2Int GetSize()
     {
         return m_Size;
     }
 
-    inline short GetArea()
+    // Cells shown, the padding at the end of each row isn't counted.
+    inline int32_t GetArea()
     {
         return m_Size.x * m_Size.y;
     }
 
-    inline short GetWidth()
+    inline int32_t GetWidth()
     {
         return m_Size.x;
     }
 
-    inline short GetHeight()
+    inline int32_t GetHeight()
     {
         return m_Size.y;
     }
 
+    // Cells from the start of one row to the start of the next.
+    inline int32_t GetPitch()
+    {
+        return m_Pitch;
+    }
+
     inline Rect GetBufferRect()
     {
         return { 0.0f, 0.0f, static_cast< float >( m_Size.x ), static_cast< float >( m_Size.y ) };
     }
 
-    void SetPixel( Vector< short, 2 > a_Coord, Pixel a_Pixel )
+    inline Colour GetColour( Vector2Int a_Coord )
+    {
+        return m_ColourBuffer[ GetIndex( a_Coord ) ];
+    }
+
+    inline void SetColour( Vector2Int a_Coord, Colour a_Colour )
     {
-        m_BackBuffer[ a_Coord.y * m_Size.x + a_Coord.x ] = a_Pixel;
+        m_ColourBuffer[ GetIndex( a_Coord ) ] = a_Colour;
     }
 
-    void SetPixels( int a_Index, Pixel a_Pixel, short a_Count )
+    // a_Count runs on into the padding and the next row when it passes the end of one.
+    inline void SetColours( Vector2Int a_Coord, Colour a_Colour, int32_t a_Count )
     {
-        Pixel* PixelBegin = m_BackBuffer + a_Index;
+        SetColours( GetIndex( a_Coord ), a_Colour, a_Count );
+    }
 
-        for ( ; a_Count > 0; --a_Count )
+    void SetColours( int32_t a_Index, Colour a_Colour, int32_t a_Count )
+    {
+        if ( a_Count > 0 )
         {
-            *PixelBegin = a_Pixel;
-            ++PixelBegin;
+            std::fill_n( m_ColourBuffer + a_Index, a_Count, a_Colour );
         }
     }
 
-    void SetPixels( Vector< short, 2 > a_Coord, Pixel a_Pixel, short a_Count )
+    // The padding is filled too, it is one run that way.
+    inline void SetBuffer( Colour a_Colour )
+    {
+        SetColours( 0, a_Colour, m_Pitch * m_Size.y );
+    }
+
+    void SetRect( const Rect& a_Rect, Colour a_Colour )
     {
-        Pixel* PixelBegin = m_BackBuffer + GetIndex( a_Coord );
+        int32_t Index = GetIndex( {
+            static_cast< int32_t >( a_Rect.Origin.x ),
+            static_cast< int32_t >( a_Rect.Origin.y ) } );
 
-        for ( ; a_Count > 0; --a_Count )
+        for ( int32_t y = 0; y < a_Rect.Size.y; ++y )
         {
-            *PixelBegin = a_Pixel;
-            ++PixelBegin;
+            SetColours( Index, a_Colour, static_cast< int32_t >( a_Rect.Size.x ) );
+            Index += m_Pitch;
         }
     }
 
-    void SetColour( Vector< short, 2 > a_Coord, Colour a_Colour )
+    inline Dither GetDither() const
     {
-        int Index = GetIndex( a_Coord );
-        m_BackBuffer[ Index ] = PixelColourMap::Get().ConvertColour( a_Colour );
-        m_ColourBuffer[ Index ] = a_Colour;
+        return m_Dither;
     }
 
-    void SetColours( Vector< short, 2 > a_Coord, Colour a_Colour, short a_Count )
+    inline void SetDither( Dither a_Dither )
     {
-        int Index = GetIndex( a_Coord );
-        Pixel PixelToSet = PixelColourMap::Get().ConvertColour( a_Colour );
-        Pixel* PixelBegin = m_BackBuffer + Index;
-        Colour* ColourBegin = m_ColourBuffer + Index;
+        m_Dither = a_Dither;
+    }
 
-        for ( ; a_Count > 0; --a_Count )
+    // Converts the colour buffer into the back pixel buffer, rows split across the workers. Without console
+    // cells the colours are taken as they are, so the frame is only copied and dithering doesn't apply.
+    void Resolve()
+    {
+#if !CGE_CONSOLE_CELLS
+        Parallel::For( 0, m_Size.y, [ this ]( int32_t a_Begin, int32_t a_End )
         {
-            *PixelBegin = PixelToSet;
-            *ColourBegin = a_Colour;
-            ++PixelBegin;
-            ++ColourBegin;
-        }
+            std::copy( m_ColourBuffer + static_cast< size_t >( a_Begin ) * m_Pitch, m_ColourBuffer + static_cast< size_t >( a_End ) * m_Pitch, m_PixelBuffers[ m_Back ] + static_cast< size_t >( a_Begin ) * m_Pitch );
+        }, 16 );
+#else
+        // Error diffusion starts over at each chunk, larger chunks keep the seams between them few.
+        Parallel::For( 0, m_Size.y, [ this ]( int32_t a_Begin, int32_t a_End )
+        {
+            switch ( m_Dither )
+            {
+                case Dither::NONE:      ResolveNearest( a_Begin, a_End );  break;
+                case Dither::ORDERED:   ResolveOrdered( a_Begin, a_End );  break;
+                case Dither::DIFFUSION: ResolveDiffused( a_Begin, a_End ); break;
+            }
+        }, m_Dither == Dither::DIFFUSION ? 32 : 4 );
+#endif
+    }
+
+    // Hands the back buffer to the presenting thread and takes the spare one to resolve the next frame into.
+    // Returns false when the frame it replaces was never presented.
+    bool PublishPixelBuffer()
+    {
+        uint32_t Previous = m_Ready.exchange( m_Back | s_Fresh, std::memory_order_acq_rel );
+        m_Back = Previous & ~s_Fresh;
+        return !( Previous & s_Fresh );
     }
 
-    void SetColours( int a_Index, Colour a_Colour, short a_Count )
+    inline bool IsPublished() const
     {
-        Pixel PixelToSet = PixelColourMap::Get().ConvertColour( a_Colour );
-        Pixel* PixelBegin = m_BackBuffer + a_Index;
-        Colour* ColourBegin = m_ColourBuffer + a_Index;
+        return m_Ready.load( std::memory_order_acquire ) & s_Fresh;
+    }
 
-        for ( ; a_Count > 0; --a_Count )
+    // Takes the latest published frame for presenting, false when nothing was published since the last one.
+    bool AcquirePixelBuffer()
+    {
+        if ( !IsPublished() )
         {
-            *PixelBegin = PixelToSet;
-            *ColourBegin = a_Colour;
-            ++PixelBegin;
-            ++ColourBegin;
+            return false;
         }
+
+        m_Front = m_Ready.exchange( m_Front, std::memory_order_acq_rel ) & ~s_Fresh;
+        return true;
     }
 
-    inline void SetBuffer( Pixel a_Pixel )
+    inline Vector2Int GetCoordinate( int32_t a_Index )
     {
-        SetPixels( { 0, 0 }, a_Pixel, GetArea() );
+        int32_t Row = a_Index / m_Pitch;
+        return { a_Index - Row * m_Pitch, Row };
     }
 
-    inline void SetBuffer( Colour a_Colour )
+    inline int32_t GetIndex( Vector2Int a_Coord )
     {
-        SetColours( { 0, 0 }, a_Colour, GetArea() );
+        return a_Coord.y * m_Pitch + a_Coord.x;
     }
 
-    void SetRect( const Rect& a_Rect, Pixel a_Pixel )
+private:
+
+    friend class ConsoleWindow;
+
+#if CGE_CONSOLE_CELLS
+    void ResolveNearest( int32_t a_Begin, int32_t a_End )
     {
-        int Index = GetIndex( {
-            static_cast< short >( a_Rect.Origin.x ),
-            static_cast< short >( a_Rect.Origin.y ) } );
+        const PixelColourMap& Map = PixelColourMap::Get();
+        size_t End = static_cast< size_t >( a_End ) * m_Pitch;
 
-        for ( int y = 0; y < a_Rect.Size.y; ++y )
+        for ( size_t i = static_cast< size_t >( a_Begin ) * m_Pitch; i < End; ++i )
         {
-            SetPixels( Index, a_Pixel, a_Rect.Size.x );
-            Index += m_Size.x;
+            m_PixelBuffers[ m_Back ][ i ] = Map.ConvertColour( m_ColourBuffer[ i ] );
         }
     }
 
-    void SetRect( const Rect& a_Rect, Colour a_Colour )
+    void ResolveOrdered( int32_t a_Begin, int32_t a_End )
     {
-        int Index = GetIndex( {
-            static_cast< short >( a_Rect.Origin.x ),
-            static_cast< short >( a_Rect.Origin.y ) } );
+        const PixelColourMap& Map = PixelColourMap::Get();
+        int32_t Width = m_Size.x;
 
-        for ( int y = 0; y < a_Rect.Size.y; ++y )
+        for ( int32_t y = a_Begin; y < a_End; ++y )
         {
-            SetColours( Index, a_Colour, a_Rect.Size.x );
-            Index += m_Size.x;
+            const Colour* Source = m_ColourBuffer + static_cast< size_t >( y ) * m_Pitch;
+            Pixel* Target = m_PixelBuffers[ m_Back ] + static_cast< size_t >( y ) * m_Pitch;
+            const int16_t* Offsets = s_BayerOffsets[ y & 3 ];
+            int32_t x = 0;
+
+#if defined( _M_X64 ) || defined( __SSE2__ )
+            // The pattern repeats every four pixels, so one set of offsets nudges every four pixels of the row.
+            const __m128i Low = _mm_setr_epi16( Offsets[ 0 ], Offsets[ 0 ], Offsets[ 0 ], 0, Offsets[ 1 ], Offsets[ 1 ], Offsets[ 1 ], 0 );
+            const __m128i High = _mm_setr_epi16( Offsets[ 2 ], Offsets[ 2 ], Offsets[ 2 ], 0, Offsets[ 3 ], Offsets[ 3 ], Offsets[ 3 ], 0 );
+            const __m128i Zero = _mm_setzero_si128();
+            alignas( 16 ) Colour Nudged[ 4 ];
+
+            for ( ; x + 4 <= Width; x += 4 )
+            {
+                // Rows start on a cache line, so every four pixels do too.
+                __m128i Colours = _mm_load_si128( reinterpret_cast< const __m128i* >( Source + x ) );
+                __m128i Lower = _mm_add_epi16( _mm_unpacklo_epi8( Colours, Zero ), Low );
+                __m128i Upper = _mm_add_epi16( _mm_unpackhi_epi8( Colours, Zero ), High );
+                _mm_store_si128( reinterpret_cast< __m128i* >( Nudged ), _mm_packus_epi16( Lower, Upper ) );
+
+                Target[ x + 0 ] = Map.ConvertColour( Nudged[ 0 ] );
+                Target[ x + 1 ] = Map.ConvertColour( Nudged[ 1 ] );
+                Target[ x + 2 ] = Map.ConvertColour( Nudged[ 2 ] );
+                Target[ x + 3 ] = Map.ConvertColour( Nudged[ 3 ] );
+            }
+#endif
+
+            for ( ; x < Width; ++x )
+            {
+                int32_t Offset = Offsets[ x & 3 ];
+                Colour Nudged(
+                    static_cast< Colour::Channel >( Math::Clamp( Source[ x ].R + Offset, 0, 255 ) ),
+                    static_cast< Colour::Channel >( Math::Clamp( Source[ x ].G + Offset, 0, 255 ) ),
+                    static_cast< Colour::Channel >( Math::Clamp( Source[ x ].B + Offset, 0, 255 ) ),
+                    Source[ x ].A );
+                Target[ x ] = Map.ConvertColour( Nudged );
+            }
         }
     }
 
-    void SwapPixelBuffer()
+    void ResolveDiffused( int32_t a_Begin, int32_t a_End )
     {
-        std::swap( m_BackBuffer, m_FrontBuffer );
+        const PixelColourMap& Map = PixelColourMap::Get();
+        int32_t Width = m_Size.x;
+
+        // Error carried into this row and the next in sixteenths, three channels a pixel and a pixel of padding either side.
+        std::vector< int32_t > Errors( ( static_cast< size_t >( Width ) + 2 ) * 6, 0 );
+        int32_t* Current = Errors.data() + 3;
+        int32_t* Next = Current + ( Width + 2 ) * 3;
+
+        for ( int32_t y = a_Begin; y < a_End; ++y )
+        {
+            const Colour* Source = m_ColourBuffer + static_cast< size_t >( y ) * m_Pitch;
+            Pixel* Target = m_PixelBuffers[ m_Back ] + static_cast< size_t >( y ) * m_Pitch;
+
+            for ( int32_t x = 0; x < Width; ++x )
+            {
+                int32_t* Carried = Current + x * 3;
+                int32_t Wanted[ 3 ] =
+                {
+                    Math::Clamp( Source[ x ].R + Carried[ 0 ] / 16, 0, 255 ),
+                    Math::Clamp( Source[ x ].G + Carried[ 1 ] / 16, 0, 255 ),
+                    Math::Clamp( Source[ x ].B + Carried[ 2 ] / 16, 0, 255 )
+                };
+
+                uint32_t Seed = Map.FindSeed( Colour(
+                    static_cast< Colour::Channel >( Wanted[ 0 ] ),
+                    static_cast< Colour::Channel >( Wanted[ 1 ] ),
+                    static_cast< Colour::Channel >( Wanted[ 2 ] ),
+                    Source[ x ].A ) );
+                Target[ x ] = PixelColourMap::GetSeedPixel( Seed );
+
+                const Colour& Shown = PixelColourMap::SeedColours[ Seed ];
+                int32_t Error[ 3 ] = { Wanted[ 0 ] - Shown.R, Wanted[ 1 ] - Shown.G, Wanted[ 2 ] - Shown.B };
+
+                for ( int32_t c = 0; c < 3; ++c )
+                {
+                    Carried[ 3 + c ] += Error[ c ] * 7;
+                    Next[ x * 3 - 3 + c ] += Error[ c ] * 3;
+                    Next[ x * 3 + c ] += Error[ c ] * 5;
+                    Next[ x * 3 + 3 + c ] += Error[ c ];
+                }
+            }
+
+            std::swap( Current, Next );
+            std::fill( Next - 3, Next + ( Width + 1 ) * 3, 0 );
+        }
     }
 
-    inline Vector< short, 2 > GetCoordinate( int a_Index )
+#endif
+
+    template < typename T >
+    static T* Allocate( size_t a_Count )
     {
-        Vector< short, 2 > Coordinate = { 0, static_cast< short >( a_Index ) / m_Size.x };
-        Coordinate.x = a_Index - Coordinate.y * m_Size.y;
-        return Coordinate;
+        T* Buffer = static_cast< T* >( ::operator new[]( a_Count * sizeof( T ), std::align_val_t( Alignment ) ) );
+        std::uninitialized_fill_n( Buffer, a_Count, T() );
+        return Buffer;
     }
 
-    inline int GetIndex( Vector< short, 2 > a_Coord )
+    // Cells and colours are trivially destroyed, only the memory goes back.
+    static void Free( void* a_Buffer )
     {
-        return a_Coord.y * m_Size.x + a_Coord.x;
+        if ( a_Buffer )
+        {
+            ::operator delete[]( a_Buffer, std::align_val_t( Alignment ) );
+        }
     }
 
-private:
+    // Bayer thresholds as offsets centred on zero, spanning about the gap between neighbouring seed colours.
+    inline static const int16_t s_BayerOffsets[ 4 ][ 4 ] =
+    {
+        { -15,   1, -11,   5 },
+        {   9,  -7,  13,  -3 },
+        {  -9,   7, -13,   3 },
+        {  15,  -1,  11,  -5 }
+    };
 
-    friend class ConsoleWindow;
+    // Set on the ready index while it holds a frame the presenting thread hasn't taken.
+    static constexpr uint32_t s_Fresh = 0x4;
 
-    Pixel*             m_BackBuffer;
-    Pixel*             m_FrontBuffer;
-    Colour*            m_ColourBuffer;
-    Vector< short, 2 > m_Size;
+    Cell*                   m_PixelBuffers[ 3 ] = {};
+    uint32_t                m_Back = 0;  // Only touched by the game thread.
+    uint32_t                m_Front = 1; // Only touched by the presenting thread.
+    std::atomic< uint32_t > m_Ready = 2;
+    Colour*                 m_ColourBuffer = nullptr;
+    Vector2Int              m_Size;
+    int32_t                 m_Pitch = 0;
+    Dither                  m_Dither = Dither::NONE;
 };
\ No newline at end of file
@@ -3,12 +3,30 @@
 
 
 Shader Shader::Default;
-Shader Shader::Diffuse = Shader( "Diffuse"_N, "Vertex_Texel", "Fragment_Diffuse" );
+Shader Shader::Diffuse = Shader( "Diffuse"_N, "Vertex_Texel", "Fragment_Diffuse", "Vertex_Texel_Instanced", "Fragment_Diffuse_Instanced" );
 Shader Shader::Specular = Shader( "Specular"_N, "Vertex_Texel", "Fragment_Specular" );
 Shader Shader::Normal = Shader( "Normal"_N, "Vertex_Texel", "Fragment_Normal" );
 Shader Shader::Phong;//    = Shader( "Phong"_N,    "Vertex_Texel", "Phong_Fragment"    );
-Shader Shader::UnlitFlatColour = Shader( "UnlitFlatColour"_N, "Vertex_Default", "Fragment_Unlit_Flat_Colour" );
-Shader Shader::LitFlatColour = Shader( "LitFlatColour"_N, "Vertex_Lit_Flat_Colour", "Fragment_Lit_Flat_Colour" );
+Shader Shader::UnlitFlatColour = Shader( "UnlitFlatColour"_N, "Vertex_Default", "Fragment_Unlit_Flat_Colour", "Vertex_Default_Instanced", "Fragment_Unlit_Flat_Colour_Instanced" );
+Shader Shader::LitFlatColour = Shader( "LitFlatColour"_N, "Vertex_Lit_Flat_Colour", "Fragment_Lit_Flat_Colour", "Vertex_Lit_Flat_Colour_Instanced", "Fragment_Lit_Flat_Colour_Instanced" );
+Shader Shader::VertexColour = Shader( "VertexColour"_N, "Vertex_Colour", "Fragment_Colour" );
+Shader Shader::Lightmapped = Shader( "Lightmapped"_N, "Vertex_Lightmapped", "Fragment_Lightmapped" );
+Shader Shader::LightmappedDiffuse = Shader( "LightmappedDiffuse"_N, "Vertex_Texel_Lightmapped", "Fragment_Diffuse_Lightmapped" );
+
+const Shader* Shader::Find( Hash a_Name )
+{
+	static const Shader* BuiltIn[] = { &Default, &Diffuse, &Specular, &Normal, &Phong, &UnlitFlatColour, &LitFlatColour, &VertexColour, &Lightmapped, &LightmappedDiffuse };
+
+	for ( const Shader* Current : BuiltIn )
+	{
+		if ( Current->GetName().HashCode() == a_Name )
+		{
+			return Current;
+		}
+	}
+
+	return nullptr;
+}
 
 // Vertex Default
 DefineShader( Vertex_Default )
@@ -102,4 +120,160 @@ DefineShader( Fragment_Lit_Flat_Colour )
 	Rendering::FragColour.y = Intensity * diffuse_colour.y;
 	Rendering::FragColour.z = Intensity * diffuse_colour.z;
 	Rendering::FragColour.w = diffuse_colour.w;
+}
+
+// Vertex Colour
+DefineShader( Vertex_Colour )
+{
+	Uniform( Matrix4, u_PVM );
+	Attribute( 0, Vector3, a_Position );
+	Attribute( 2, Vector4, a_Colour );
+	Varying_Out( Vector4, VertexColour );
+
+	Rendering::Position = Math::Multiply( u_PVM, Vector4( a_Position, 1.0f ) );
+	VertexColour = a_Colour;
+}
+
+// Fragment Colour
+DefineShader( Fragment_Colour )
+{
+	Varying_In( Vector4, VertexColour );
+
+	Rendering::FragColour = VertexColour;
+}
+
+// Vertex Lightmapped
+DefineShader( Vertex_Lightmapped )
+{
+	Uniform( Matrix4, u_PVM );
+	Attribute( 0, Vector3, a_Position );
+	Attribute( 6, Vector2, a_LightmapTexel );
+	Varying_Out( Vector2, LightmapTexel );
+
+	Rendering::Position = Math::Multiply( u_PVM, Vector4( a_Position, 1.0f ) );
+	LightmapTexel = a_LightmapTexel;
+}
+
+// Vertex Texel Lightmapped
+DefineShader( Vertex_Texel_Lightmapped )
+{
+	Uniform( Matrix4, u_PVM );
+	Attribute( 0, Vector3, a_Position );
+	Attribute( 1, Vector2, a_Texel );
+	Attribute( 6, Vector2, a_LightmapTexel );
+	Varying_Out( Vector2, Texel );
+	Varying_Out( Vector2, LightmapTexel );
+
+	Rendering::Position = Math::Multiply( u_PVM, Vector4( a_Position, 1.0f ) );
+	Texel = a_Texel;
+	LightmapTexel = a_LightmapTexel;
+}
+
+// Fragment Lightmapped
+DefineShader( Fragment_Lightmapped )
+{
+	Uniform( Vector4, diffuse_colour );
+	Uniform( Sampler2D, texture_lightmap );
+	Varying_In( Vector2, LightmapTexel );
+
+	Vector4 Light = Rendering::Sample( texture_lightmap, LightmapTexel );
+	Rendering::FragColour.x = Light.x * diffuse_colour.x;
+	Rendering::FragColour.y = Light.y * diffuse_colour.y;
+	Rendering::FragColour.z = Light.z * diffuse_colour.z;
+	Rendering::FragColour.w = diffuse_colour.w;
+}
+
+// Fragment Diffuse Lightmapped
+DefineShader( Fragment_Diffuse_Lightmapped )
+{
+	Uniform( Sampler2D, texture_diffuse );
+	Uniform( Sampler2D, texture_lightmap );
+	Varying_In( Vector2, Texel );
+	Varying_In( Vector2, LightmapTexel );
+
+	Vector4 Light = Rendering::Sample( texture_lightmap, LightmapTexel );
+	Vector4 Diffuse = Rendering::Sample( texture_diffuse, Texel );
+	Rendering::FragColour.x = Light.x * Diffuse.x;
+	Rendering::FragColour.y = Light.y * Diffuse.y;
+	Rendering::FragColour.z = Light.z * Diffuse.z;
+	Rendering::FragColour.w = Diffuse.w;
+}
+
+// Vertex Default Instanced
+DefineShader( Vertex_Default_Instanced )
+{
+	Uniform( Matrix4, u_PV );
+	Attribute( 0, Vector3, a_Position );
+	Attribute( 8, Matrix4, a_Model );
+	Attribute( 9, Vector4, a_InstanceColour );
+	Varying_Out( Vector4, InstanceColour );
+
+	Rendering::Position = Math::Multiply( u_PV, Math::Multiply( a_Model, Vector4( a_Position, 1.0f ) ) );
+	InstanceColour = a_InstanceColour;
+}
+
+// Vertex Texel Instanced
+DefineShader( Vertex_Texel_Instanced )
+{
+	Uniform( Matrix4, u_PV );
+	Attribute( 0, Vector3, a_Position );
+	Attribute( 1, Vector2, a_Texel );
+	Attribute( 8, Matrix4, a_Model );
+	Attribute( 9, Vector4, a_InstanceColour );
+	Varying_Out( Vector2, Texel );
+	Varying_Out( Vector4, InstanceColour );
+
+	Rendering::Position = Math::Multiply( u_PV, Math::Multiply( a_Model, Vector4( a_Position, 1.0f ) ) );
+	Texel = a_Texel;
+	InstanceColour = a_InstanceColour;
+}
+
+// Vertex Lit Flat Colour Instanced
+DefineShader( Vertex_Lit_Flat_Colour_Instanced )
+{
+	Uniform( Matrix4, u_PV );
+	Attribute( 0, Vector3, a_Position );
+	Attribute( 3, Vector3, a_Normal );
+	Attribute( 8, Matrix4, a_Model );
+	Attribute( 9, Vector4, a_InstanceColour );
+	Varying_Out( Vector3, Normal );
+	Varying_Out( Vector4, InstanceColour );
+
+	Normal = Math::Multiply( a_Model, Vector4( a_Normal ) );
+	Rendering::Position = Math::Multiply( u_PV, Math::Multiply( a_Model, Vector4( a_Position, 1.0f ) ) );
+	InstanceColour = a_InstanceColour;
+}
+
+// Fragment Diffuse Instanced
+DefineShader( Fragment_Diffuse_Instanced )
+{
+	Uniform( Sampler2D, texture_diffuse );
+	Varying_In( Vector2, Texel );
+	Varying_In( Vector4, InstanceColour );
+
+	Rendering::FragColour = Rendering::Sample( texture_diffuse, Texel ) * InstanceColour;
+}
+
+// Fragment Unlit Flat Colour Instanced
+DefineShader( Fragment_Unlit_Flat_Colour_Instanced )
+{
+	Uniform( Vector4, diffuse_colour );
+	Varying_In( Vector4, InstanceColour );
+
+	Rendering::FragColour = diffuse_colour * InstanceColour;
+}
+
+// Fragment Lit Flat Colour Instanced
+DefineShader( Fragment_Lit_Flat_Colour_Instanced )
+{
+	Uniform( Vector4, diffuse_colour );
+	Uniform( Vector3, u_SunLight );
+	Varying_In( Vector3, Normal );
+	Varying_In( Vector4, InstanceColour );
+
+	float Intensity = Math::Clamp( -Math::Dot( u_SunLight, Normal ), 0.0f, 1.0f );
+	Rendering::FragColour.x = Intensity * diffuse_colour.x * InstanceColour.x;
+	Rendering::FragColour.y = Intensity * diffuse_colour.y * InstanceColour.y;
+	Rendering::FragColour.z = Intensity * diffuse_colour.z * InstanceColour.z;
+	Rendering::FragColour.w = diffuse_colour.w * InstanceColour.w;
 }
\ No newline at end of file
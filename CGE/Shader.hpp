@@ -15,10 +15,19 @@ public:
 	Shader( const Name& a_Name, const std::string& a_VertexShaderSource, const std::string& a_FragmentShaderSource )
 		: Resource( a_Name )
 		, m_ShaderProgramHandle( 0 )
+		, m_InstancedProgramHandle( 0 )
 		, m_VertexShaderSource( "Shader_" + a_VertexShaderSource )
 		, m_FragmentShaderSource( "Shader_" + a_FragmentShaderSource )
 	{ }
 
+	// The instanced program reads the model matrix from attribute 8 and a colour from attribute 9.
+	Shader( const Name& a_Name, const std::string& a_VertexShaderSource, const std::string& a_FragmentShaderSource, const std::string& a_InstancedVertexShaderSource, const std::string& a_InstancedFragmentShaderSource )
+		: Shader( a_Name, a_VertexShaderSource, a_FragmentShaderSource )
+	{
+		m_InstancedVertexShaderSource = "Shader_" + a_InstancedVertexShaderSource;
+		m_InstancedFragmentShaderSource = "Shader_" + a_InstancedFragmentShaderSource;
+	}
+
 	void SetSource( ShaderType a_ShaderType, const char* a_Source )
 	{
 		std::string* ResourceSource = nullptr;
@@ -65,29 +74,12 @@ public:
 			return;
 		}
 
-		ShaderHandle VertexShaderID = Rendering::CreateShader( ShaderType::VERTEX_SHADER );
-		ShaderHandle FragmentShaderID = Rendering::CreateShader( ShaderType::FRAGMENT_SHADER );
-
-		auto VertexShaderIter = Internal::ShaderFuncLookup::Value.find( CRC32_RT( m_VertexShaderSource.c_str() ) );
-		auto FragmentShaderIter = Internal::ShaderFuncLookup::Value.find( CRC32_RT( m_FragmentShaderSource.c_str() ) );
-
-		const void* VertexSource = VertexShaderIter != Internal::ShaderFuncLookup::Value.end() ? VertexShaderIter->second : nullptr;
-		const void* FragmentSource = FragmentShaderIter != Internal::ShaderFuncLookup::Value.end() ? FragmentShaderIter->second : nullptr;
-
-		Rendering::ShaderSource( VertexShaderID, 1, &VertexSource, nullptr );
-		Rendering::CompileShader( VertexShaderID );
-		Rendering::ShaderSource( FragmentShaderID, 1, &FragmentSource, nullptr );
-		Rendering::CompileShader( FragmentShaderID );
-
-		m_ShaderProgramHandle = Rendering::CreateProgram();
-		Rendering::AttachShader( m_ShaderProgramHandle, VertexShaderID );
-		Rendering::AttachShader( m_ShaderProgramHandle, FragmentShaderID );
-		Rendering::LinkProgram( m_ShaderProgramHandle );
+		m_ShaderProgramHandle = CompileProgram( m_VertexShaderSource, m_FragmentShaderSource );
 
-		Rendering::DetachShader( m_ShaderProgramHandle, VertexShaderID );
-		Rendering::DetachShader( m_ShaderProgramHandle, FragmentShaderID );
-		Rendering::DeleteShader( VertexShaderID );
-		Rendering::DeleteShader( FragmentShaderID );
+		if ( HasInstancing() )
+		{
+			m_InstancedProgramHandle = CompileProgram( m_InstancedVertexShaderSource, m_InstancedFragmentShaderSource );
+		}
 	}
 
 	void Decompile()
@@ -98,6 +90,13 @@ public:
 		}
 
 		Rendering::DeleteProgram( m_ShaderProgramHandle );
+		m_ShaderProgramHandle = 0;
+
+		if ( m_InstancedProgramHandle != 0 )
+		{
+			Rendering::DeleteProgram( m_InstancedProgramHandle );
+			m_InstancedProgramHandle = 0;
+		}
 	}
 
 	ShaderProgramHandle GetProgramHandle() const
@@ -105,16 +104,56 @@ public:
 		return m_ShaderProgramHandle;
 	}
 
+	ShaderProgramHandle GetInstancedProgramHandle() const
+	{
+		return m_InstancedProgramHandle;
+	}
+
+	inline bool HasInstancing() const
+	{
+		return !m_InstancedVertexShaderSource.empty();
+	}
+
 private:
 
 	friend class ResourcePackager;
 	friend class Serialization;
 
+	static ShaderProgramHandle CompileProgram( const std::string& a_VertexShaderSource, const std::string& a_FragmentShaderSource )
+	{
+		ShaderHandle VertexShaderID = Rendering::CreateShader( ShaderType::VERTEX_SHADER );
+		ShaderHandle FragmentShaderID = Rendering::CreateShader( ShaderType::FRAGMENT_SHADER );
+
+		auto VertexShaderIter = Internal::ShaderFuncLookup::Value.find( CRC32_RT( a_VertexShaderSource.c_str() ) );
+		auto FragmentShaderIter = Internal::ShaderFuncLookup::Value.find( CRC32_RT( a_FragmentShaderSource.c_str() ) );
+
+		const void* VertexSource = VertexShaderIter != Internal::ShaderFuncLookup::Value.end() ? VertexShaderIter->second : nullptr;
+		const void* FragmentSource = FragmentShaderIter != Internal::ShaderFuncLookup::Value.end() ? FragmentShaderIter->second : nullptr;
+
+		Rendering::ShaderSource( VertexShaderID, 1, &VertexSource, nullptr );
+		Rendering::CompileShader( VertexShaderID );
+		Rendering::ShaderSource( FragmentShaderID, 1, &FragmentSource, nullptr );
+		Rendering::CompileShader( FragmentShaderID );
+
+		ShaderProgramHandle ProgramHandle = Rendering::CreateProgram();
+		Rendering::AttachShader( ProgramHandle, VertexShaderID );
+		Rendering::AttachShader( ProgramHandle, FragmentShaderID );
+		Rendering::LinkProgram( ProgramHandle );
+
+		Rendering::DetachShader( ProgramHandle, VertexShaderID );
+		Rendering::DetachShader( ProgramHandle, FragmentShaderID );
+		Rendering::DeleteShader( VertexShaderID );
+		Rendering::DeleteShader( FragmentShaderID );
+		return ProgramHandle;
+	}
+
 	template < typename T >
 	void Serialize( T& a_Serializer ) const
 	{
 		a_Serializer << m_VertexShaderSource;
 		a_Serializer << m_FragmentShaderSource;
+		a_Serializer << m_InstancedVertexShaderSource;
+		a_Serializer << m_InstancedFragmentShaderSource;
 	}
 
 	template < typename T >
@@ -122,11 +161,16 @@ private:
 	{
 		a_Deserializer >> m_VertexShaderSource;
 		a_Deserializer >> m_FragmentShaderSource;
+		a_Deserializer >> m_InstancedVertexShaderSource;
+		a_Deserializer >> m_InstancedFragmentShaderSource;
 	}
 
 	ShaderProgramHandle m_ShaderProgramHandle;
+	ShaderProgramHandle m_InstancedProgramHandle;
 	std::string         m_VertexShaderSource;
 	std::string         m_FragmentShaderSource;
+	std::string         m_InstancedVertexShaderSource;
+	std::string         m_InstancedFragmentShaderSource;
 
 public:
 
@@ -137,5 +181,11 @@ public:
 	static Shader Phong;
 	static Shader UnlitFlatColour;
 	static Shader LitFlatColour;
+	static Shader VertexColour;
+	static Shader Lightmapped;        // diffuse_colour lit by texture_lightmap.
+	static Shader LightmappedDiffuse; // texture_diffuse lit by texture_lightmap.
 	// More lighting models.
+
+	// The built in shader called a_Name, or null.
+	static const Shader* Find( Hash a_Name );
 };
\ No newline at end of file
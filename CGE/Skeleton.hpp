@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include "Math.hpp"
+#include "Hash.hpp"
+#include "Resource.hpp"
+
+// The bone hierarchy skinned meshes and animation clips refer to by index. Parents always come before their children.
+class Skeleton : public Resource
+{
+public:
+
+	struct Bone
+	{
+		Hash    Name;
+		int32_t Parent;      // -1 for roots.
+		Matrix4 LocalBind;   // Relative to the parent in the rest pose.
+		Matrix4 InverseBind; // From mesh space to the bone's space in the rest pose.
+	};
+
+	inline uint32_t GetBoneCount() const
+	{
+		return static_cast< uint32_t >( m_Bones.size() );
+	}
+
+	inline const Bone& GetBone( uint32_t a_Index ) const
+	{
+		return m_Bones[ a_Index ];
+	}
+
+	// Index of the bone called a_Name, or -1.
+	int32_t FindBone( Hash a_Name ) const
+	{
+		for ( uint32_t i = 0; i < m_Bones.size(); ++i )
+		{
+			if ( m_Bones[ i ].Name == a_Name )
+			{
+				return static_cast< int32_t >( i );
+			}
+		}
+
+		return -1;
+	}
+
+private:
+
+	friend class ResourcePackager;
+	friend class Serialization;
+
+	template < typename _Serializer >
+	void Serialize( _Serializer& a_Serializer ) const
+	{
+		a_Serializer << *static_cast< const Resource* >( this );
+		a_Serializer << m_Bones;
+	}
+
+	template < typename _Deserializer >
+	void Deserialize( _Deserializer& a_Deserializer )
+	{
+		a_Deserializer >> *static_cast< Resource* >( this );
+		a_Deserializer >> m_Bones;
+	}
+
+	template < typename _Sizer >
+	void SizeOf( _Sizer& a_Sizer ) const
+	{
+		a_Sizer & *static_cast< const Resource* >( this );
+		a_Sizer & m_Bones;
+	}
+
+	std::vector< Bone > m_Bones;
+};
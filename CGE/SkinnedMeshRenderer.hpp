@@ -0,0 +1,249 @@
+#pragma once
+#if defined( _M_X64 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+#include "Renderer.hpp"
+#include "Mesh.hpp"
+#include "Material.hpp"
+#include "Transform.hpp"
+#include "GameObject.hpp"
+#include "Animator.hpp"
+#include "Parallel.hpp"
+
+// Draws a mesh deformed by the pose of the nearest Animator on this object or above it. Vertices are skinned on
+// the CPU each frame, four bones each, into a mesh relative to the animator. Without an animator or bone weights
+// the mesh is drawn as it is, like a MeshRenderer.
+DefineComponent( SkinnedMeshRenderer, Renderer )
+{
+public:
+
+	void OnRender( RenderQueue& a_Queue ) const override
+	{
+		const Mesh* Source = m_Mesh.Assure();
+
+		if ( !Source || !m_Material.Assure() )
+		{
+			return;
+		}
+
+		const Animator* Pose = Source->HasBones() ? FindAnimator() : nullptr;
+		const Mesh* Drawn = Source;
+		const Matrix4* Model = &this->GetOwner().GetTransform()->GetGlobalMatrix();
+
+		if ( Pose && Pose->GetSkeleton() )
+		{
+			const_cast< SkinnedMeshRenderer* >( this )->Skin( *Source, Pose->GetSkinMatrices() );
+			Drawn = &m_Skinned;
+			Model = &Pose->GetOwner().GetTransform()->GetGlobalMatrix();
+		}
+
+		RenderInstruction Instruction;
+		Instruction.Modification = RenderInstruction::Modification::SET;
+		Instruction.Object = RenderInstruction::Object::Mesh;
+		Instruction.ResourceSource = Drawn;
+		a_Queue += Instruction;
+
+		Instruction.Modification = RenderInstruction::Modification::SET;
+		Instruction.Object = RenderInstruction::Object::Material;
+		Instruction.ResourceSource = m_Material.Get();
+		a_Queue += Instruction;
+
+		Instruction.Modification = RenderInstruction::Modification::SET;
+		Instruction.Object = RenderInstruction::Object::Model;
+		Instruction.ResourceSource = Model;
+		a_Queue += Instruction;
+
+		Instruction.Modification = RenderInstruction::Modification::SET;
+		Instruction.Object = RenderInstruction::Object::Layer;
+		Instruction.Index = this->m_Layer;
+		a_Queue += Instruction;
+
+		Instruction.Modification = RenderInstruction::Modification::DRAW;
+		Instruction.Object = RenderInstruction::Object::None;
+		Instruction.ResourceSource = nullptr;
+		a_Queue += Instruction;
+	}
+
+	const Mesh* GetMesh() const
+	{
+		return m_Mesh.Assure();
+	}
+
+	Material* GetMaterial()
+	{
+		return m_Material.Assure();
+	}
+
+	void SetMesh( ResourceHandle< Mesh > a_Mesh )
+	{
+		m_Mesh = a_Mesh;
+	}
+
+	void SetMaterial( ResourceHandle< Material > a_Material )
+	{
+		m_Material = a_Material;
+	}
+
+private:
+
+	friend class ResourcePackager;
+	friend class Serialization;
+
+	const Animator* FindAnimator() const
+	{
+		for ( const Transform* Current = this->GetOwner().GetTransform(); Current; Current = Current->GetParent() )
+		{
+			if ( const Animator* Found = Current->GetOwner().GetComponent< Animator >() )
+			{
+				return Found;
+			}
+		}
+
+		return nullptr;
+	}
+
+	// Positions and directions of a_Source blended by up to four bone matrices each, split across the workers.
+	// Directions skip the inverse transpose, which only matters under non uniform bone scale.
+	void Skin( const Mesh& a_Source, const std::vector< Matrix4 >& a_Bones )
+	{
+		// Streams the bones don't move are copied when the source changes.
+		if ( m_SkinnedSource != &a_Source || m_Skinned.GetVertexCount() != a_Source.GetVertexCount() )
+		{
+			m_SkinnedSource = &a_Source;
+			m_Skinned.m_Indices = a_Source.m_Indices;
+			m_Skinned.m_Texels = a_Source.m_Texels;
+			m_Skinned.m_Colours = a_Source.m_Colours;
+			m_Skinned.m_Positions.resize( a_Source.m_Positions.size() );
+			m_Skinned.m_Normals.resize( a_Source.m_Normals.size() );
+			m_Skinned.m_Tangents.resize( a_Source.m_Tangents.size() );
+			m_Skinned.m_Bitangents.resize( a_Source.m_Bitangents.size() );
+		}
+
+		const Vector4Int* Indices = a_Source.GetBoneIndices();
+		const Vector4* Weights = a_Source.GetBoneWeights();
+		int32_t BoneCount = static_cast< int32_t >( a_Bones.size() );
+		bool Normals = a_Source.HasNormals();
+		bool Tangents = a_Source.HasTangents();
+		bool Bitangents = a_Source.HasBitangents();
+
+		Parallel::For( 0, static_cast< int32_t >( a_Source.GetVertexCount() ), [ & ]( int32_t a_Begin, int32_t a_End )
+		{
+			for ( int32_t i = a_Begin; i < a_End; ++i )
+			{
+				Rows Blended = Blend( a_Bones, BoneCount, Indices[ i ], Weights[ i ] );
+				m_Skinned.m_Positions[ i ] = Apply( Blended, a_Source.m_Positions[ i ], 1.0f );
+
+				if ( Normals )    m_Skinned.m_Normals   [ i ] = Math::Normalize( Apply( Blended, a_Source.m_Normals   [ i ], 0.0f ) );
+				if ( Tangents )   m_Skinned.m_Tangents  [ i ] = Math::Normalize( Apply( Blended, a_Source.m_Tangents  [ i ], 0.0f ) );
+				if ( Bitangents ) m_Skinned.m_Bitangents[ i ] = Math::Normalize( Apply( Blended, a_Source.m_Bitangents[ i ], 0.0f ) );
+			}
+		}, 256 );
+
+		m_Skinned.MarkModified();
+	}
+
+	// The top three rows of a weighted sum of bone matrices, the bottom row is always 0 0 0 1.
+#if defined( _M_X64 ) || defined( __SSE2__ )
+	struct Rows
+	{
+		__m128 Row[ 3 ];
+	};
+
+	inline static Rows Blend( const std::vector< Matrix4 >& a_Bones, int32_t a_BoneCount, const Vector4Int& a_Indices, const Vector4& a_Weights )
+	{
+		Rows Result = { { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() } };
+
+		for ( uint32_t i = 0; i < 4; ++i )
+		{
+			if ( a_Weights[ i ] == 0.0f || a_Indices[ i ] < 0 || a_Indices[ i ] >= a_BoneCount )
+			{
+				continue;
+			}
+
+			const float* Bone = a_Bones[ a_Indices[ i ] ].Data;
+			__m128 Weight = _mm_set1_ps( a_Weights[ i ] );
+			Result.Row[ 0 ] = _mm_add_ps( Result.Row[ 0 ], _mm_mul_ps( Weight, _mm_loadu_ps( Bone + 0 ) ) );
+			Result.Row[ 1 ] = _mm_add_ps( Result.Row[ 1 ], _mm_mul_ps( Weight, _mm_loadu_ps( Bone + 4 ) ) );
+			Result.Row[ 2 ] = _mm_add_ps( Result.Row[ 2 ], _mm_mul_ps( Weight, _mm_loadu_ps( Bone + 8 ) ) );
+		}
+
+		return Result;
+	}
+
+	inline static Vector3 Apply( const Rows& a_Rows, const Vector3& a_Vector, float a_W )
+	{
+		__m128 Input = _mm_set_ps( a_W, a_Vector.z, a_Vector.y, a_Vector.x );
+		__m128 X = _mm_mul_ps( a_Rows.Row[ 0 ], Input );
+		__m128 Y = _mm_mul_ps( a_Rows.Row[ 1 ], Input );
+		__m128 Z = _mm_mul_ps( a_Rows.Row[ 2 ], Input );
+		__m128 W = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS( X, Y, Z, W );
+
+		alignas( 16 ) float Output[ 4 ];
+		_mm_store_ps( Output, _mm_add_ps( _mm_add_ps( X, Y ), _mm_add_ps( Z, W ) ) );
+		return Vector3( Output[ 0 ], Output[ 1 ], Output[ 2 ] );
+	}
+#else
+	struct Rows
+	{
+		float Row[ 3 ][ 4 ];
+	};
+
+	inline static Rows Blend( const std::vector< Matrix4 >& a_Bones, int32_t a_BoneCount, const Vector4Int& a_Indices, const Vector4& a_Weights )
+	{
+		Rows Result = {};
+
+		for ( uint32_t i = 0; i < 4; ++i )
+		{
+			if ( a_Weights[ i ] == 0.0f || a_Indices[ i ] < 0 || a_Indices[ i ] >= a_BoneCount )
+			{
+				continue;
+			}
+
+			const float* Bone = a_Bones[ a_Indices[ i ] ].Data;
+
+			for ( uint32_t j = 0; j < 12; ++j )
+			{
+				Result.Row[ j / 4 ][ j % 4 ] += a_Weights[ i ] * Bone[ j ];
+			}
+		}
+
+		return Result;
+	}
+
+	inline static Vector3 Apply( const Rows& a_Rows, const Vector3& a_Vector, float a_W )
+	{
+		Vector3 Result;
+
+		for ( uint32_t j = 0; j < 3; ++j )
+		{
+			Result[ j ] = a_Rows.Row[ j ][ 0 ] * a_Vector.x + a_Rows.Row[ j ][ 1 ] * a_Vector.y + a_Rows.Row[ j ][ 2 ] * a_Vector.z + a_Rows.Row[ j ][ 3 ] * a_W;
+		}
+
+		return Result;
+	}
+#endif
+
+	template < typename _Serializer >
+	void Serialize( _Serializer& a_Serializer ) const
+	{
+		a_Serializer << m_Mesh << m_Material << this->m_Layer;
+	}
+
+	template < typename _Deserializer >
+	void Deserialize( _Deserializer& a_Deserializer )
+	{
+		a_Deserializer >> m_Mesh >> m_Material >> this->m_Layer;
+	}
+
+	template < typename _Sizer >
+	void SizeOf( _Sizer& a_Sizer ) const
+	{
+		a_Sizer & m_Mesh & m_Material & this->m_Layer;
+	}
+
+	ResourceHandle< Mesh     > m_Mesh;
+	ResourceHandle< Material > m_Material;
+	Mesh                       m_Skinned;
+	const Mesh*                m_SkinnedSource = nullptr;
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <list>
+#include "Mesh.hpp"
+#include "Material.hpp"
+#include "MeshRenderer.hpp"
+#include "Transform.hpp"
+#include "RenderQueue.hpp"
+#include "RayTracing.hpp"
+
+// Mesh renderers on static transforms are merged, in world space, into one mesh per material and layer
+// and drawn with a single call each. Batches are built on the first frame after an invalidation.
+class StaticBatching
+{
+public:
+
+	// Rebuilds the batches on the next frame, call after adding, removing or moving static objects.
+	static void Invalidate()
+	{
+		s_Built = false;
+	}
+
+	static size_t GetBatchCount()
+	{
+		return s_Batches.size();
+	}
+
+private:
+
+	friend class RenderPipeline;
+
+	struct Batch
+	{
+		Material* SourceMaterial;
+		uint8_t   Layer;
+		Mesh      Geometry;
+	};
+
+	static void Build()
+	{
+		// New batches may reuse the old addresses with different contents.
+		s_Batches.clear();
+		Rendering::FlushVertexCache();
+		RayTracer::FlushMeshes();
+
+		for ( auto Renderer : Component::GetExactComponents< MeshRenderer >() )
+		{
+			Renderer->m_IsBatched = false;
+			const Transform* RendererTransform = Renderer->GetOwner().GetTransform();
+
+			if ( !RendererTransform->IsStatic() )
+			{
+				continue;
+			}
+
+			const Mesh* SourceMesh = Renderer->m_Mesh.Assure();
+			Material* SourceMaterial = Renderer->m_Material.Assure();
+
+			// Renderers overriding their material draw on their own.
+			if ( !SourceMesh || !SourceMaterial || !SourceMesh->HasPositions() || SourceMesh->m_Indices.empty() || !Renderer->m_PropertyBlock.IsEmpty() )
+			{
+				continue;
+			}
+
+			auto Where = std::find_if( s_Batches.begin(), s_Batches.end(), [ & ]( const Batch& a_Batch )
+			{
+				return a_Batch.SourceMaterial == SourceMaterial && a_Batch.Layer == Renderer->GetLayer();
+			} );
+
+			if ( Where == s_Batches.end() )
+			{
+				Where = s_Batches.emplace( s_Batches.end() );
+				Where->SourceMaterial = SourceMaterial;
+				Where->Layer = Renderer->GetLayer();
+			}
+
+			Where->Geometry.Append( *SourceMesh, RendererTransform->GetGlobalMatrix() );
+			Renderer->m_IsBatched = true;
+		}
+
+		s_Built = true;
+	}
+
+	// Batches are already in world space so they draw with an identity model matrix.
+	static void Submit( RenderQueue& a_Queue )
+	{
+		if ( !s_Built )
+		{
+			Build();
+		}
+
+		for ( auto& Entry : s_Batches )
+		{
+			a_Queue += RenderQueue::MakeSet( RenderInstruction::Object::Mesh, &Entry.Geometry );
+			a_Queue += RenderQueue::MakeSet( RenderInstruction::Object::Material, Entry.SourceMaterial );
+			a_Queue += RenderQueue::MakeSet( RenderInstruction::Object::Model, &Matrix4::Identity );
+
+			RenderInstruction Layer;
+			Layer.Modification = RenderInstruction::Modification::SET;
+			Layer.Object = RenderInstruction::Object::Layer;
+			Layer.Index = Entry.Layer;
+			a_Queue += Layer;
+
+			RenderInstruction Draw;
+			Draw.Modification = RenderInstruction::Modification::DRAW;
+			Draw.Object = RenderInstruction::Object::None;
+			Draw.ResourceSource = nullptr;
+			a_Queue += Draw;
+		}
+	}
+
+	// List keeps mesh addresses stable for the render queue.
+	inline static std::list< Batch > s_Batches;
+	inline static bool               s_Built = false;
+};
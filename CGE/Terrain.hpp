@@ -0,0 +1,487 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include "Renderer.hpp"
+#include "Mesh.hpp"
+#include "Material.hpp"
+#include "Texture.hpp"
+#include "Transform.hpp"
+#include "Camera.hpp"
+#include "Rendering.hpp"
+#include "RayTracing.hpp"
+
+// Heightmap terrain drawn as a grid of chunks, each chunk its own draw so cameras cull them one by one.
+// Chunks further from the main camera use every second, fourth, ... sample of the heightmap. Neighbouring chunks
+// are kept within one level of each other and the finer side folds its extra edge vertices onto the coarser edge,
+// so no cracks open between them.
+DefineComponent( Terrain, Renderer )
+{
+public:
+
+	void OnRender( RenderQueue& a_Queue ) const override
+	{
+		auto* Mutable = const_cast< Terrain* >( this );
+
+		if ( !m_Material.Assure() || !Mutable->Prepare() )
+		{
+			return;
+		}
+
+		Mutable->UpdateLevels();
+		const Matrix4& Global = this->GetOwner().GetTransform()->GetGlobalMatrix();
+
+		for ( auto& Entry : Mutable->m_Chunks )
+		{
+			Entry.Model = Math::Multiply( Global, Matrix4::CreateTranslation( Entry.Centre ) );
+
+			RenderInstruction Instruction;
+			Instruction.Modification = RenderInstruction::Modification::SET;
+			Instruction.Object = RenderInstruction::Object::Mesh;
+			Instruction.ResourceSource = &Mutable->GetChunkMesh( Entry );
+			a_Queue += Instruction;
+
+			Instruction.Modification = RenderInstruction::Modification::SET;
+			Instruction.Object = RenderInstruction::Object::Material;
+			Instruction.ResourceSource = m_Material.Get();
+			a_Queue += Instruction;
+
+			Instruction.Modification = RenderInstruction::Modification::SET;
+			Instruction.Object = RenderInstruction::Object::Model;
+			Instruction.ResourceSource = &Entry.Model;
+			a_Queue += Instruction;
+
+			Instruction.Modification = RenderInstruction::Modification::SET;
+			Instruction.Object = RenderInstruction::Object::Layer;
+			Instruction.Index = this->m_Layer;
+			a_Queue += Instruction;
+
+			Instruction.Modification = RenderInstruction::Modification::DRAW;
+			Instruction.Object = RenderInstruction::Object::None;
+			Instruction.ResourceSource = nullptr;
+			a_Queue += Instruction;
+		}
+	}
+
+	// Brightness of each texel is its height, rows of the texture run along z.
+	void SetHeightmap( ResourceHandle< Texture2D > a_Heightmap )
+	{
+		m_Heightmap = a_Heightmap;
+		m_Dirty = true;
+	}
+
+	Material* GetMaterial()
+	{
+		return m_Material.Assure();
+	}
+
+	void SetMaterial( ResourceHandle< Material > a_Material )
+	{
+		m_Material = a_Material;
+	}
+
+	// Local extent of the terrain. The heightmap spans x and z, a white texel reaches y.
+	inline const Vector3& GetSize() const
+	{
+		return m_Size;
+	}
+
+	void SetSize( const Vector3& a_Size )
+	{
+		m_Size = a_Size;
+		m_Dirty = true;
+	}
+
+	// Heightmap cells along the edge of a chunk, a power of two.
+	inline uint32_t GetChunkSize() const
+	{
+		return m_ChunkSize;
+	}
+
+	void SetChunkSize( uint32_t a_ChunkSize )
+	{
+		m_ChunkSize = 2;
+
+		while ( m_ChunkSize < a_ChunkSize && m_ChunkSize < 256 )
+		{
+			m_ChunkSize <<= 1;
+		}
+
+		m_Dirty = true;
+	}
+
+	// Chunks closer than this to the main camera use every heightmap sample, each doubling of the distance halves them.
+	inline float GetLODDistance() const
+	{
+		return m_LODDistance;
+	}
+
+	inline void SetLODDistance( float a_Distance )
+	{
+		m_LODDistance = Math::Max( a_Distance, 0.001f );
+	}
+
+	inline uint32_t GetChunkCount() const
+	{
+		return static_cast< uint32_t >( m_Chunks.size() );
+	}
+
+	// True when a_Position lies over the terrain.
+	bool Contains( const Vector3& a_Position ) const
+	{
+		if ( !const_cast< Terrain* >( this )->Prepare() )
+		{
+			return false;
+		}
+
+		Vector3 Local = ToLocal( a_Position );
+		return Local.x >= 0.0f && Local.z >= 0.0f && Local.x <= m_Size.x && Local.z <= m_Size.z;
+	}
+
+	// World space height of the full resolution surface under a_Position, interpolated between samples.
+	// Positions off the edge take the height of the nearest edge.
+	float GetHeight( const Vector3& a_Position ) const
+	{
+		if ( !const_cast< Terrain* >( this )->Prepare() )
+		{
+			return a_Position.y;
+		}
+
+		Vector3 Local = ToLocal( a_Position );
+		Local.y = SampleHeight( Local.x, Local.z );
+		Vector4 World = Math::Multiply( this->GetOwner().GetTransform()->GetGlobalMatrix(), Vector4( Local.x, Local.y, Local.z, 1.0f ) );
+		return World.y;
+	}
+
+	// World space surface normal under a_Position.
+	Vector3 GetNormal( const Vector3& a_Position ) const
+	{
+		if ( !const_cast< Terrain* >( this )->Prepare() )
+		{
+			return Vector3::Up;
+		}
+
+		Vector3 Local = ToLocal( a_Position );
+		Vector2 Cell = ToCell( Local.x, Local.z );
+		int32_t X = Math::Clamp( static_cast< int32_t >( Cell.x + 0.5f ), 0, m_Samples.x - 1 );
+		int32_t Z = Math::Clamp( static_cast< int32_t >( Cell.y + 0.5f ), 0, m_Samples.y - 1 );
+		Vector3 Normal = GetSampleNormal( X, Z );
+		Vector4 World = Math::Multiply( this->GetOwner().GetTransform()->GetGlobalMatrix(), Vector4( Normal.x, Normal.y, Normal.z, 0.0f ) );
+		return Math::Normalize( Vector3( World.x, World.y, World.z ) );
+	}
+
+private:
+
+	// Edges of a chunk whose neighbour is one level coarser.
+	enum Edge : uint32_t
+	{
+		EDGE_LEFT  = 1u << 0,
+		EDGE_RIGHT = 1u << 1,
+		EDGE_NEAR  = 1u << 2,
+		EDGE_FAR   = 1u << 3
+	};
+
+	struct Chunk
+	{
+		Vector2Int Origin;  // First heightmap sample.
+		Vector3    Centre;  // Local, the chunk's vertices are relative to it.
+		Vector3    Min;
+		Vector3    Max;
+		uint32_t   Level;
+		uint32_t   Edges;
+		Matrix4    Model;
+
+		// Built on first use, by level and coarser edges. Meshes never change once built.
+		std::unordered_map< uint32_t, Mesh > Meshes;
+	};
+
+	// Reads the heightmap and lays out the chunks when anything they depend on changed.
+	bool Prepare()
+	{
+		const Texture2D* Source = m_Heightmap.Assure();
+
+		if ( !Source || Source->GetWidth() < 2 || Source->GetHeight() < 2 || !Source->GetData() )
+		{
+			return false;
+		}
+
+		if ( !m_Dirty && Source == m_Source )
+		{
+			return true;
+		}
+
+		m_Source = Source;
+		m_Dirty = false;
+		m_Samples = { Source->GetWidth(), Source->GetHeight() };
+		m_Heights.resize( static_cast< size_t >( m_Samples.x ) * m_Samples.y );
+
+		for ( size_t i = 0; i < m_Heights.size(); ++i )
+		{
+			Colour Texel = Source->GetData()[ i ];
+			m_Heights[ i ] = ( Texel.R + Texel.G + Texel.B ) * ( m_Size.y / ( 3.0f * 255.0f ) );
+		}
+
+		// The chunks' old meshes may share addresses with the new ones.
+		m_Chunks.clear();
+		Rendering::FlushVertexCache();
+		RayTracer::FlushMeshes();
+
+		int32_t ChunkSize = static_cast< int32_t >( m_ChunkSize );
+		m_ChunkCount = { ( m_Samples.x - 2 ) / ChunkSize + 1, ( m_Samples.y - 2 ) / ChunkSize + 1 };
+		m_Chunks.resize( static_cast< size_t >( m_ChunkCount.x ) * m_ChunkCount.y );
+
+		for ( int32_t ChunkZ = 0; ChunkZ < m_ChunkCount.y; ++ChunkZ )
+		{
+			for ( int32_t ChunkX = 0; ChunkX < m_ChunkCount.x; ++ChunkX )
+			{
+				Chunk& Entry = m_Chunks[ ChunkZ * m_ChunkCount.x + ChunkX ];
+				Entry.Origin = { ChunkX * ChunkSize, ChunkZ * ChunkSize };
+				Entry.Level = 0;
+				Entry.Edges = 0;
+
+				float Low = std::numeric_limits< float >::max(), High = -Low;
+
+				for ( int32_t Z = Entry.Origin.y; Z <= Math::Min( Entry.Origin.y + ChunkSize, m_Samples.y - 1 ); ++Z )
+				{
+					for ( int32_t X = Entry.Origin.x; X <= Math::Min( Entry.Origin.x + ChunkSize, m_Samples.x - 1 ); ++X )
+					{
+						Low = Math::Min( Low, GetSampleHeight( X, Z ) );
+						High = Math::Max( High, GetSampleHeight( X, Z ) );
+					}
+				}
+
+				Entry.Min = GetSamplePosition( Entry.Origin.x, Entry.Origin.y );
+				Entry.Max = GetSamplePosition( Entry.Origin.x + ChunkSize, Entry.Origin.y + ChunkSize );
+				Entry.Min.y = Low;
+				Entry.Max.y = High;
+				Entry.Centre = ( Entry.Min + Entry.Max ) * 0.5f;
+			}
+		}
+
+		return true;
+	}
+
+	// Picks every chunk's level from its distance to the main camera, then lowers levels until no chunk
+	// is more than one coarser than a neighbour.
+	void UpdateLevels()
+	{
+		uint32_t MaxLevel = 0;
+
+		while ( ( 2u << MaxLevel ) <= m_ChunkSize )
+		{
+			++MaxLevel;
+		}
+
+		const Camera* Viewer = Camera::GetMainCamera();
+		Vector3 Eye = Viewer ? ToLocal( Viewer->GetOwner().GetTransform()->GetGlobalPosition() ) : Vector3::Zero;
+
+		for ( auto& Entry : m_Chunks )
+		{
+			Vector3 Nearest = {
+				Math::Clamp( Eye.x, Entry.Min.x, Entry.Max.x ),
+				Math::Clamp( Eye.y, Entry.Min.y, Entry.Max.y ),
+				Math::Clamp( Eye.z, Entry.Min.z, Entry.Max.z ) };
+			float Distance = Viewer ? Math::Length( Eye - Nearest ) / m_LODDistance : 0.0f;
+
+			Entry.Level = 0;
+
+			while ( Distance >= 1.0f && Entry.Level < MaxLevel )
+			{
+				Distance *= 0.5f;
+				++Entry.Level;
+			}
+		}
+
+		for ( bool Changed = true; Changed; )
+		{
+			Changed = false;
+
+			for ( int32_t ChunkZ = 0; ChunkZ < m_ChunkCount.y; ++ChunkZ )
+			{
+				for ( int32_t ChunkX = 0; ChunkX < m_ChunkCount.x; ++ChunkX )
+				{
+					Chunk& Entry = m_Chunks[ ChunkZ * m_ChunkCount.x + ChunkX ];
+					ForEachNeighbour( ChunkX, ChunkZ, [ & ]( const Chunk& a_Neighbour, Edge )
+					{
+						if ( Entry.Level > a_Neighbour.Level + 1 )
+						{
+							Entry.Level = a_Neighbour.Level + 1;
+							Changed = true;
+						}
+					} );
+				}
+			}
+		}
+
+		for ( int32_t ChunkZ = 0; ChunkZ < m_ChunkCount.y; ++ChunkZ )
+		{
+			for ( int32_t ChunkX = 0; ChunkX < m_ChunkCount.x; ++ChunkX )
+			{
+				Chunk& Entry = m_Chunks[ ChunkZ * m_ChunkCount.x + ChunkX ];
+				Entry.Edges = 0;
+				ForEachNeighbour( ChunkX, ChunkZ, [ & ]( const Chunk& a_Neighbour, Edge a_Edge )
+				{
+					if ( a_Neighbour.Level > Entry.Level )
+					{
+						Entry.Edges |= a_Edge;
+					}
+				} );
+			}
+		}
+	}
+
+	template < typename _Function >
+	void ForEachNeighbour( int32_t a_ChunkX, int32_t a_ChunkZ, const _Function& a_Function ) const
+	{
+		if ( a_ChunkX > 0 )                    a_Function( m_Chunks[ a_ChunkZ * m_ChunkCount.x + a_ChunkX - 1 ], EDGE_LEFT );
+		if ( a_ChunkX < m_ChunkCount.x - 1 )   a_Function( m_Chunks[ a_ChunkZ * m_ChunkCount.x + a_ChunkX + 1 ], EDGE_RIGHT );
+		if ( a_ChunkZ > 0 )                    a_Function( m_Chunks[ ( a_ChunkZ - 1 ) * m_ChunkCount.x + a_ChunkX ], EDGE_NEAR );
+		if ( a_ChunkZ < m_ChunkCount.y - 1 )   a_Function( m_Chunks[ ( a_ChunkZ + 1 ) * m_ChunkCount.x + a_ChunkX ], EDGE_FAR );
+	}
+
+	// Samples every 2^Level along each axis. On an edge facing a coarser chunk the odd vertices move halfway
+	// between their even neighbours, which is exactly where the coarser chunk's edge runs.
+	Mesh& GetChunkMesh( Chunk& a_Chunk )
+	{
+		uint32_t Key = ( a_Chunk.Level << 4 ) | a_Chunk.Edges;
+		auto Where = a_Chunk.Meshes.find( Key );
+
+		if ( Where != a_Chunk.Meshes.end() )
+		{
+			return Where->second;
+		}
+
+		Mesh& Result = a_Chunk.Meshes[ Key ];
+		int32_t Step = 1 << a_Chunk.Level;
+		int32_t Count = static_cast< int32_t >( m_ChunkSize ) / Step + 1;
+
+		auto Vertex = [ & ]( int32_t a_I, int32_t a_J, Vector3& o_Position, Vector3& o_Normal, Vector2& o_Texel )
+		{
+			int32_t X = Math::Min( a_Chunk.Origin.x + a_I * Step, m_Samples.x - 1 );
+			int32_t Z = Math::Min( a_Chunk.Origin.y + a_J * Step, m_Samples.y - 1 );
+			o_Position = GetSamplePosition( X, Z );
+			o_Normal = GetSampleNormal( X, Z );
+			o_Texel = { static_cast< float >( X ) / ( m_Samples.x - 1 ), static_cast< float >( Z ) / ( m_Samples.y - 1 ) };
+		};
+
+		Result.m_Positions.reserve( Count * Count );
+		Result.m_Normals.reserve( Count * Count );
+		Result.m_Texels[ 0 ].reserve( Count * Count );
+
+		for ( int32_t J = 0; J < Count; ++J )
+		{
+			for ( int32_t I = 0; I < Count; ++I )
+			{
+				Vector3 Position, Normal;
+				Vector2 Texel;
+				Vertex( I, J, Position, Normal, Texel );
+
+				bool FoldX = ( I & 1 ) && ( ( J == 0 && ( a_Chunk.Edges & EDGE_NEAR ) ) || ( J == Count - 1 && ( a_Chunk.Edges & EDGE_FAR ) ) );
+				bool FoldZ = ( J & 1 ) && ( ( I == 0 && ( a_Chunk.Edges & EDGE_LEFT ) ) || ( I == Count - 1 && ( a_Chunk.Edges & EDGE_RIGHT ) ) );
+
+				if ( FoldX || FoldZ )
+				{
+					Vector3 PositionA, PositionB, NormalA, NormalB;
+					Vector2 TexelA, TexelB;
+					Vertex( FoldX ? I - 1 : I, FoldX ? J : J - 1, PositionA, NormalA, TexelA );
+					Vertex( FoldX ? I + 1 : I, FoldX ? J : J + 1, PositionB, NormalB, TexelB );
+					Position = ( PositionA + PositionB ) * 0.5f;
+					Normal = Math::Normalize( NormalA + NormalB );
+					Texel = ( TexelA + TexelB ) * 0.5f;
+				}
+
+				Result.m_Positions.push_back( Position - a_Chunk.Centre );
+				Result.m_Normals.push_back( Normal );
+				Result.m_Texels[ 0 ].push_back( Texel );
+			}
+		}
+
+		// Clockwise seen from above, the rasterizer's front faces.
+		Result.m_Indices.reserve( ( Count - 1 ) * ( Count - 1 ) * 6 );
+
+		for ( int32_t J = 0; J < Count - 1; ++J )
+		{
+			for ( int32_t I = 0; I < Count - 1; ++I )
+			{
+				uint32_t A = J * Count + I;
+				uint32_t B = A + 1;
+				uint32_t C = A + Count;
+				uint32_t D = C + 1;
+				Result.m_Indices.insert( Result.m_Indices.end(), { A, C, B, B, C, D } );
+			}
+		}
+
+		return Result;
+	}
+
+	inline float GetSampleHeight( int32_t a_X, int32_t a_Z ) const
+	{
+		a_X = Math::Clamp( a_X, 0, m_Samples.x - 1 );
+		a_Z = Math::Clamp( a_Z, 0, m_Samples.y - 1 );
+		return m_Heights[ a_Z * m_Samples.x + a_X ];
+	}
+
+	inline Vector3 GetSamplePosition( int32_t a_X, int32_t a_Z ) const
+	{
+		Vector2 Spacing = GetSpacing();
+		a_X = Math::Min( a_X, m_Samples.x - 1 );
+		a_Z = Math::Min( a_Z, m_Samples.y - 1 );
+		return Vector3( a_X * Spacing.x, GetSampleHeight( a_X, a_Z ), a_Z * Spacing.y );
+	}
+
+	// Central differences, one sided at the edges.
+	inline Vector3 GetSampleNormal( int32_t a_X, int32_t a_Z ) const
+	{
+		Vector2 Spacing = GetSpacing();
+		float Left = GetSampleHeight( a_X - 1, a_Z ), Right = GetSampleHeight( a_X + 1, a_Z );
+		float Near = GetSampleHeight( a_X, a_Z - 1 ), Far = GetSampleHeight( a_X, a_Z + 1 );
+		float SpanX = ( Math::Min( a_X + 1, m_Samples.x - 1 ) - Math::Max( a_X - 1, 0 ) ) * Spacing.x;
+		float SpanZ = ( Math::Min( a_Z + 1, m_Samples.y - 1 ) - Math::Max( a_Z - 1, 0 ) ) * Spacing.y;
+		return Math::Normalize( Vector3( ( Left - Right ) / SpanX, 1.0f, ( Near - Far ) / SpanZ ) );
+	}
+
+	inline Vector2 GetSpacing() const
+	{
+		return { m_Size.x / ( m_Samples.x - 1 ), m_Size.z / ( m_Samples.y - 1 ) };
+	}
+
+	// Local x and z in heightmap samples.
+	inline Vector2 ToCell( float a_X, float a_Z ) const
+	{
+		Vector2 Spacing = GetSpacing();
+		return { a_X / Spacing.x, a_Z / Spacing.y };
+	}
+
+	// Bilinear over the four samples around the local position.
+	float SampleHeight( float a_X, float a_Z ) const
+	{
+		Vector2 Cell = ToCell( a_X, a_Z );
+		Cell.x = Math::Clamp( Cell.x, 0.0f, static_cast< float >( m_Samples.x - 1 ) );
+		Cell.y = Math::Clamp( Cell.y, 0.0f, static_cast< float >( m_Samples.y - 1 ) );
+
+		int32_t X = Math::Min( static_cast< int32_t >( Cell.x ), m_Samples.x - 2 );
+		int32_t Z = Math::Min( static_cast< int32_t >( Cell.y ), m_Samples.y - 2 );
+		float TX = Cell.x - X, TZ = Cell.y - Z;
+
+		float Near = GetSampleHeight( X, Z ) + ( GetSampleHeight( X + 1, Z ) - GetSampleHeight( X, Z ) ) * TX;
+		float Far = GetSampleHeight( X, Z + 1 ) + ( GetSampleHeight( X + 1, Z + 1 ) - GetSampleHeight( X, Z + 1 ) ) * TX;
+		return Near + ( Far - Near ) * TZ;
+	}
+
+	inline Vector3 ToLocal( const Vector3& a_Position ) const
+	{
+		Vector4 Local = Math::Multiply( Math::Inverse( this->GetOwner().GetTransform()->GetGlobalMatrix() ), Vector4( a_Position.x, a_Position.y, a_Position.z, 1.0f ) );
+		return Vector3( Local.x, Local.y, Local.z );
+	}
+
+	ResourceHandle< Texture2D > m_Heightmap;
+	ResourceHandle< Material  > m_Material;
+	Vector3                     m_Size = Vector3( 256.0f, 32.0f, 256.0f );
+	uint32_t                    m_ChunkSize = 32;
+	float                       m_LODDistance = 64.0f;
+	bool                        m_Dirty = true;
+	const Texture2D*            m_Source = nullptr;
+	Vector2Int                  m_Samples;
+	Vector2Int                  m_ChunkCount;
+	std::vector< float >        m_Heights;
+	std::vector< Chunk >        m_Chunks;
+};
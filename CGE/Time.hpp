@@ -21,9 +21,10 @@ public:
 		return s_DeltaTime * s_TimeDilation;
 	}
 
+	// What the last frame actually took, even when the delta is simulated.
 	inline static float GetRealDeltaTime()
 	{
-		return s_DeltaTime;
+		return s_RealDeltaTime;
 	}
 
 	inline static float GetFixedTime()
@@ -31,11 +32,30 @@ public:
 		return s_FixedTime;
 	}
 
+	// Measured over the real frame times.
 	inline static float GetFPS()
 	{
 		return 1.0f / s_AverageDeltaTime;
 	}
 
+	// Every frame advances time by a_DeltaTime rather than the time it took, so runs play out the same however
+	// fast they go. Zero goes back to real time. GetRealDeltaTime and GetFPS keep measuring.
+	inline static void SetSimulatedDeltaTime( float a_DeltaTime )
+	{
+		s_SimulatedDeltaTime = Math::Max( a_DeltaTime, 0.0f );
+	}
+
+	inline static float GetSimulatedDeltaTime()
+	{
+		return s_SimulatedDeltaTime;
+	}
+
+	// Frames ticked since start, for work that should happen at most once a frame.
+	inline static uint64_t GetFrameCount()
+	{
+		return s_FrameCount;
+	}
+
 private:
 
 	friend class CGE;
@@ -48,16 +68,21 @@ private:
 		static std::chrono::time_point CurrentTime  = std::chrono::high_resolution_clock::now();
 
 		CurrentTime = std::chrono::high_resolution_clock::now();
-		s_DeltaTime = 0.000000001f * ( CurrentTime - PreviousTime ).count();
+		s_RealDeltaTime = 0.000000001f * ( CurrentTime - PreviousTime ).count();
+		s_DeltaTime = s_SimulatedDeltaTime > 0.0f ? s_SimulatedDeltaTime : s_RealDeltaTime;
 		PreviousTime = CurrentTime;
 		s_AverageDeltaTime -= DeltaTimes[ DeltaTimeIndex ] * 0.01f;
-		DeltaTimes[ DeltaTimeIndex ] = s_DeltaTime;
-		s_AverageDeltaTime += s_DeltaTime * 0.01f;
+		DeltaTimes[ DeltaTimeIndex ] = s_RealDeltaTime;
+		s_AverageDeltaTime += s_RealDeltaTime * 0.01f;
 		DeltaTimeIndex = ++DeltaTimeIndex >= 100 ? 0 : DeltaTimeIndex;
+		++s_FrameCount;
 	}
 	
 	inline static float s_TimeDilation     = 1.0f;
 	inline static float s_DeltaTime        = 0.0f;
+	inline static float s_RealDeltaTime    = 0.0f;
 	inline static float s_FixedTime        = 0.01f;
 	inline static float s_AverageDeltaTime = 0.0f;
+	inline static float s_SimulatedDeltaTime = 0.0f;
+	inline static uint64_t s_FrameCount    = 0;
 };
\ No newline at end of file
@@ -14,6 +14,7 @@ public:
 		, m_LocalPosition( Vector3::Zero )
 		, m_LocalScale( Vector3::One )
 		, m_IsDirty( true )
+		, m_IsStatic( false )
 		, m_Parent( GameObjectID( -1 ) )
 	{ }
 
@@ -22,6 +23,17 @@ public:
 		m_IsDirty = true;
 	}
 
+	// Static transforms are expected never to move, their mesh renderers get baked into static batches.
+	inline void SetStatic( bool a_IsStatic )
+	{
+		m_IsStatic = a_IsStatic;
+	}
+
+	inline bool IsStatic() const
+	{
+		return m_IsStatic;
+	}
+
 	inline Transform* GetParent()
 	{
 		return m_Parent == GameObjectID( -1 ) ? nullptr : reinterpret_cast< GameObject* >( &m_Parent )->GetTransform();
@@ -888,20 +900,20 @@ private:
 	template < typename _Serializer >
 	void Serialize( _Serializer& a_Serializer ) const
 	{
-		a_Serializer << m_LocalPosition << m_LocalRotation << m_LocalScale;
+		a_Serializer << m_LocalPosition << m_LocalRotation << m_LocalScale << m_IsStatic;
 	}
 
 	template < typename _Deserializer >
 	void Deserialize( _Deserializer& a_Deserializer )
 	{
-		a_Deserializer >> m_LocalPosition >> m_LocalRotation >> m_LocalScale;
+		a_Deserializer >> m_LocalPosition >> m_LocalRotation >> m_LocalScale >> m_IsStatic;
 		m_IsDirty = true;
 	}
 
 	template < typename _Sizer >
 	void SizeOf( _Sizer& a_Sizer ) const
 	{
-		a_Sizer & m_LocalPosition & m_LocalRotation & m_LocalScale;
+		a_Sizer & m_LocalPosition & m_LocalRotation & m_LocalScale & m_IsStatic;
 	}
 
 	Matrix4                     m_GlobalMatrix;
@@ -910,6 +922,7 @@ private:
 	Quaternion                  m_LocalRotation;
 	Vector3                     m_LocalScale;
 	bool                        m_IsDirty;
+	bool                        m_IsStatic;
 	GameObjectID                m_Parent;
 	std::vector< GameObjectID > m_Children;
 };
\ No newline at end of file
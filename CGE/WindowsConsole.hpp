@@ -0,0 +1,274 @@
+#pragma once
+#include "Platform.hpp"
+#include <vector>
+#include <climits>
+#include <cstring>
+#if defined( _M_X64 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+#include "Math.hpp"
+#include "Colour.hpp"
+#include "Pixel.hpp"
+#include "PixelColourMap.hpp"
+#include "ScreenBuffer.hpp"
+
+// The Windows console as ConsoleWindow's backend. Cells are glyphs over the 16 console colours, the colour
+// table is replaced with the seed colours the colour map was built from.
+class WindowsConsole
+{
+public:
+
+    typedef HANDLE     ConsoleHandle;
+    typedef HWND       WindowHandle;
+    typedef SMALL_RECT WindowRegion;
+
+    // Console coordinates are SHORTs, the padded rows written must fit in them.
+    static constexpr int32_t MaxExtent = SHRT_MAX;
+
+    // Rows are padded to ScreenBuffer's pitch, so this is the widest row whose pitch still fits.
+    static constexpr int32_t RowCells = static_cast< int32_t >( ScreenBuffer::Alignment / sizeof( ScreenBuffer::Cell ) );
+    static constexpr int32_t MaxWidth = MaxExtent / RowCells * RowCells;
+
+    // Sets the console up for io_Size cells, false when the screen can't fit that many or they are past what
+    // console coordinates hold.
+    bool Open( const char* a_Title, Vector2Int& io_Size, Vector< short, 2 >& io_PixelSize )
+    {
+        if ( io_Size.x <= 0 || io_Size.y <= 0 || io_Size.x > MaxWidth || io_Size.y > MaxExtent )
+        {
+            return false;
+        }
+
+        // Retrieve handles for console window.
+        m_ConsoleHandle = GetStdHandle( STD_OUTPUT_HANDLE );
+
+        if ( m_ConsoleHandle == INVALID_HANDLE_VALUE )
+        {
+            AllocConsole();
+            m_ConsoleHandle = GetStdHandle( STD_OUTPUT_HANDLE );
+        }
+
+        m_WindowHandle = GetConsoleWindow();
+
+        // Set console font.
+        io_PixelSize.x = Math::Min( io_PixelSize.x, static_cast< short >( 8 ) );
+        io_PixelSize.y = Math::Min( io_PixelSize.y, static_cast< short >( 8 ) );
+        CONSOLE_FONT_INFOEX FontInfo;
+        FontInfo.cbSize = sizeof( FontInfo );
+        FontInfo.nFont = 0;
+        FontInfo.dwFontSize = { io_PixelSize.x, io_PixelSize.y };
+        FontInfo.FontFamily = FF_DONTCARE;
+        FontInfo.FontWeight = FW_NORMAL;
+        wcscpy_s( FontInfo.FaceName, L"Terminal" );
+        SetCurrentConsoleFontEx( m_ConsoleHandle, false, &FontInfo );
+
+        // Get screen buffer info object.
+        CONSOLE_SCREEN_BUFFER_INFOEX ScreenBufferInfo;
+        ScreenBufferInfo.cbSize = sizeof( ScreenBufferInfo );
+        GetConsoleScreenBufferInfoEx( m_ConsoleHandle, &ScreenBufferInfo );
+
+        for ( int i = 0; i < 16; ++i )
+        {
+            COLORREF& ColourRef = ScreenBufferInfo.ColorTable[ i ];
+            Colour SeedColour = PixelColourMap::SeedColours[ i ];
+            ColourRef =
+                SeedColour.B << 16 |
+                SeedColour.G << 8  |
+                SeedColour.R;
+        }
+
+        SetConsoleScreenBufferInfoEx( m_ConsoleHandle, &ScreenBufferInfo );
+
+        // Get largest possible window size that can fit on screen.
+        COORD LargestWindow = GetLargestConsoleWindowSize( m_ConsoleHandle );
+
+        // If smaller than requested size, exit.
+        if ( LargestWindow.X < io_Size.x ||
+             LargestWindow.Y < io_Size.y )
+        {
+            return false;
+        }
+
+        // Set window region rect.
+        m_WindowRegion.Left = 0;
+        m_WindowRegion.Top = 0;
+        m_WindowRegion.Right = static_cast< SHORT >( io_Size.x - 1 );
+        m_WindowRegion.Bottom = static_cast< SHORT >( io_Size.y - 1 );
+
+        // Set console attributes.
+        SetConsoleScreenBufferSize( m_ConsoleHandle, { static_cast< SHORT >( io_Size.x ), static_cast< SHORT >( io_Size.y ) } );
+        SetConsoleWindowInfo( m_ConsoleHandle, true, &m_WindowRegion );
+        GetConsoleScreenBufferInfoEx( m_ConsoleHandle, &ScreenBufferInfo );
+        SetConsoleScreenBufferSize( m_ConsoleHandle, { static_cast< SHORT >( io_Size.x ), static_cast< SHORT >( io_Size.y ) } );
+
+        // Set cursor attributes.
+        CONSOLE_CURSOR_INFO CursorInfo;
+        GetConsoleCursorInfo( m_ConsoleHandle, &CursorInfo );
+        CursorInfo.bVisible = false;
+        SetConsoleCursorInfo( m_ConsoleHandle, &CursorInfo );
+
+        // Set window attributes.
+        SetWindowLong( m_WindowHandle, GWL_STYLE, WS_CAPTION | DS_MODALFRAME | WS_MINIMIZEBOX | WS_SYSMENU );
+        SetWindowPos( m_WindowHandle, 0, 0, 0, 0, 0, SWP_FRAMECHANGED | SWP_NOSIZE | SWP_NOMOVE | SWP_NOZORDER | SWP_SHOWWINDOW );
+        SetTitle( a_Title );
+        return true;
+    }
+
+    void SetTitle( const char* a_Title )
+    {
+        size_t Length = strlen( a_Title ) + 1;
+        Length = Length > 64 ? 64 : Length;
+        mbstowcs_s( nullptr, m_TitleBuffer, Length, a_Title, Length );
+        SetConsoleTitleW( m_TitleBuffer );
+    }
+
+    // The console keeps the size it was opened with.
+    inline bool PollResize( Vector2Int& o_Size )
+    {
+        return false;
+    }
+
+    inline ConsoleHandle GetConsoleHandle()
+    {
+        return m_ConsoleHandle;
+    }
+
+    inline WindowHandle GetWindowHandle()
+    {
+        return m_WindowHandle;
+    }
+
+    // Writes only what changed since the last write, each run of changed rows as one rectangle over their
+    // changed columns. Unchanged rows cost a compare and no console call. The first write after a resize
+    // covers the whole window. Rows are a_Pitch pixels apart, the copy of what was shown keeps the same layout.
+    void Write( const Pixel* a_Frame, Vector2Int a_Size, int32_t a_Pitch )
+    {
+        int32_t Width = a_Size.x;
+        int32_t Height = a_Size.y;
+
+        // Open turns away sizes this large, the SHORTs below would wrap.
+        if ( a_Pitch > MaxExtent || Height > MaxExtent )
+        {
+            return;
+        }
+
+        size_t Area = static_cast< size_t >( a_Pitch ) * Height;
+        COORD BufferSize = { static_cast< SHORT >( a_Pitch ), static_cast< SHORT >( Height ) };
+
+        if ( m_Presented.size() != Area )
+        {
+            m_Presented.assign( a_Frame, a_Frame + Area );
+            WindowRegion Region = m_WindowRegion;
+            WriteConsoleOutput( m_ConsoleHandle, a_Frame, BufferSize, { 0, 0 }, &Region );
+            return;
+        }
+
+        int32_t Top = -1;
+        int32_t Left = Width;
+        int32_t Right = -1;
+
+        auto Flush = [ & ]( int32_t a_Bottom )
+        {
+            if ( Top < 0 )
+            {
+                return;
+            }
+
+            // The region is written back with what was actually drawn, so it is copied for each call.
+            WindowRegion Region = {
+                static_cast< SHORT >( m_WindowRegion.Left + Left ),
+                static_cast< SHORT >( m_WindowRegion.Top + Top ),
+                static_cast< SHORT >( m_WindowRegion.Left + Right ),
+                static_cast< SHORT >( m_WindowRegion.Top + a_Bottom ) };
+            WriteConsoleOutput( m_ConsoleHandle, a_Frame, BufferSize, { static_cast< SHORT >( Left ), static_cast< SHORT >( Top ) }, &Region );
+            Top = -1;
+            Left = Width;
+            Right = -1;
+        };
+
+        for ( int32_t y = 0; y < Height; ++y )
+        {
+            const Pixel* Row = a_Frame + static_cast< size_t >( y ) * a_Pitch;
+            Pixel* Shown = m_Presented.data() + static_cast< size_t >( y ) * a_Pitch;
+            int32_t First, Last;
+
+            if ( !FindChanges( Row, Shown, Width, First, Last ) )
+            {
+                Flush( y - 1 );
+                continue;
+            }
+
+            // Changes that don't line up with the rows above start a rectangle of their own.
+            if ( Top >= 0 && ( Last < Left || First > Right ) )
+            {
+                Flush( y - 1 );
+            }
+
+            std::memcpy( Shown + First, Row + First, ( Last - First + 1 ) * sizeof( Pixel ) );
+            Top = Top < 0 ? y : Top;
+            Left = Math::Min( Left, First );
+            Right = Math::Max( Right, Last );
+        }
+
+        Flush( Height - 1 );
+    }
+
+private:
+
+    // The first and last columns where a_Row differs from a_Shown, false when the whole row matches.
+    static bool FindChanges( const Pixel* a_Row, const Pixel* a_Shown, int32_t a_Width, int32_t& o_First, int32_t& o_Last )
+    {
+        static_assert( sizeof( Pixel ) == sizeof( uint32_t ), "Pixels are compared as 32 bit words." );
+        const uint32_t* Row = reinterpret_cast< const uint32_t* >( a_Row );
+        const uint32_t* Shown = reinterpret_cast< const uint32_t* >( a_Shown );
+        int32_t First = 0;
+
+#if defined( _M_X64 ) || defined( __SSE2__ )
+        // Four pixels a compare until a block differs, the scalar loops find the pixel within it.
+        auto Equal = []( const uint32_t* a_Left, const uint32_t* a_Right )
+        {
+            __m128i Left = _mm_loadu_si128( reinterpret_cast< const __m128i* >( a_Left ) );
+            __m128i Right = _mm_loadu_si128( reinterpret_cast< const __m128i* >( a_Right ) );
+            return _mm_movemask_epi8( _mm_cmpeq_epi32( Left, Right ) ) == 0xFFFF;
+        };
+
+        while ( First + 4 <= a_Width && Equal( Row + First, Shown + First ) )
+        {
+            First += 4;
+        }
+#endif
+
+        while ( First < a_Width && Row[ First ] == Shown[ First ] )
+        {
+            ++First;
+        }
+
+        if ( First == a_Width )
+        {
+            return false;
+        }
+
+        int32_t Last = a_Width - 1;
+
+#if defined( _M_X64 ) || defined( __SSE2__ )
+        while ( Last - 3 > First && Equal( Row + Last - 3, Shown + Last - 3 ) )
+        {
+            Last -= 4;
+        }
+#endif
+
+        while ( Row[ Last ] == Shown[ Last ] )
+        {
+            --Last;
+        }
+
+        o_First = First;
+        o_Last = Last;
+        return true;
+    }
+
+    ConsoleHandle        m_ConsoleHandle;
+    WindowHandle         m_WindowHandle;
+    WindowRegion         m_WindowRegion;
+    wchar_t              m_TitleBuffer[ 64 ];
+    std::vector< Pixel > m_Presented; // What the console shows, only touched by the presenting thread.
+};
@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <cstring>
+#include "ConsoleWindow.hpp"
+#include "PixelColourMap.hpp"
+#include "Rendering.hpp"
+#include "RenderCapture.hpp"
+#include "Shader.hpp"
+
+// Replays a file written by RenderCapture and prints what each draw cost.
+//   CaptureReplay <capture> [--quiet] [--frames <path with %llu>]
+// --quiet leaves out the per draw lines, --frames saves each replayed frame as a PPM in headless builds.
+
+static const char* GetCallName( RenderCapture::Call a_Call )
+{
+	switch ( a_Call )
+	{
+		case RenderCapture::Call::CLEAR:                   return "Clear";
+		case RenderCapture::Call::DRAW_ARRAYS:             return "DrawArrays";
+		case RenderCapture::Call::DRAW_ELEMENTS:           return "DrawElements";
+		case RenderCapture::Call::DRAW_ELEMENTS_INSTANCED: return "DrawElementsInstanced";
+		case RenderCapture::Call::BLIT_FRAMEBUFFER:        return "BlitFramebuffer";
+		case RenderCapture::Call::DRAW_PIXELS:             return "DrawPixels";
+		default:                                           return "Unknown";
+	}
+}
+
+int main( int argc, const char** argv )
+{
+	if ( argc < 2 )
+	{
+		printf( "Usage: CaptureReplay <capture> [--quiet] [--frames <path with %%llu>]\n" );
+		return 1;
+	}
+
+	const char* FramePath = nullptr;
+	bool Quiet = false;
+
+	for ( int i = 2; i < argc; ++i )
+	{
+		if ( strcmp( argv[ i ], "--quiet" ) == 0 )
+		{
+			Quiet = true;
+		}
+		else if ( strcmp( argv[ i ], "--frames" ) == 0 && i + 1 < argc )
+		{
+			FramePath = argv[ ++i ];
+		}
+	}
+
+	RenderCapture::Header Header;
+
+	if ( !RenderCapture::ReadHeader( argv[ 1 ], Header ) )
+	{
+		printf( "%s isn't a capture.\n", argv[ 1 ] );
+		return 1;
+	}
+
+	auto Window = ConsoleWindow::Create( "Capture Replay", { Header.Width, Header.Height }, { 8, 8 } );
+
+	if ( !Window )
+	{
+		printf( "Couldn't open a %dx%d window.\n", Header.Width, Header.Height );
+		return 1;
+	}
+
+	ConsoleWindow::MakeContextCurrent( Window );
+	PixelColourMap::Init();
+	Rendering::Init();
+
+	// Shaders are looked up by name, referencing one keeps the engine's shaders from being dropped by the linker.
+	volatile const void* EngineShaders = &Shader::Diffuse;
+	( void )EngineShaders;
+
+#if CGE_HEADLESS
+	if ( FramePath )
+	{
+		Window->GetBackend().SetCapturePath( FramePath );
+	}
+#endif
+
+	RenderStatistics FrameTotals;
+	double FrameMilliseconds = 0.0;
+	uint32_t FrameDraws = 0;
+
+	Action< const RenderCapture::DrawRecord& > OnDraw = [ & ]( const RenderCapture::DrawRecord& a_Draw )
+	{
+		if ( !Quiet )
+		{
+			printf( "%4u %4u %-22s count %7u x%-4u program %2u array %2u target %2u %c%c%c%c %9.3f ms  tris %6u/%6u  culled %6u  clipped %6u  fragments %8u  depth failed %8u  shaded %8u\n",
+				a_Draw.Frame, a_Draw.Index, GetCallName( a_Draw.Type ), a_Draw.Count, a_Draw.Instances, a_Draw.Program, a_Draw.Array, a_Draw.Target,
+				a_Draw.DepthTest ? 'D' : '-', a_Draw.CullFace ? 'C' : '-', a_Draw.Blend ? 'B' : '-', a_Draw.ScissorTest ? 'S' : '-',
+				a_Draw.Milliseconds,
+				a_Draw.Statistics.TrianglesRasterized, a_Draw.Statistics.TrianglesIn, a_Draw.Statistics.TrianglesCulled, a_Draw.Statistics.TrianglesClipped,
+				a_Draw.Statistics.Fragments, a_Draw.Statistics.DepthFailed, a_Draw.Statistics.Shaded );
+		}
+
+		FrameTotals.TrianglesIn += a_Draw.Statistics.TrianglesIn;
+		FrameTotals.TrianglesCulled += a_Draw.Statistics.TrianglesCulled;
+		FrameTotals.TrianglesClipped += a_Draw.Statistics.TrianglesClipped;
+		FrameTotals.TrianglesRasterized += a_Draw.Statistics.TrianglesRasterized;
+		FrameTotals.Fragments += a_Draw.Statistics.Fragments;
+		FrameTotals.DepthFailed += a_Draw.Statistics.DepthFailed;
+		FrameTotals.Shaded += a_Draw.Statistics.Shaded;
+		FrameMilliseconds += a_Draw.Milliseconds;
+		++FrameDraws;
+	};
+
+	Action< uint32_t > OnFrame = [ & ]( uint32_t a_Frame )
+	{
+		printf( "Frame %u: %u draws, %.3f ms, %u triangles in, %u rasterized, %u fragments, %u shaded",
+			a_Frame, FrameDraws, FrameMilliseconds, FrameTotals.TrianglesIn, FrameTotals.TrianglesRasterized, FrameTotals.Fragments, FrameTotals.Shaded );
+#if CGE_HEADLESS
+		printf( ", checksum %08X", Window->GetBackend().GetChecksum() );
+#endif
+		printf( "\n" );
+
+		FrameTotals = RenderStatistics();
+		FrameMilliseconds = 0.0;
+		FrameDraws = 0;
+	};
+
+	if ( !RenderCapture::Replay( argv[ 1 ], OnDraw, OnFrame ) )
+	{
+		printf( "The replay stopped early, see above.\n" );
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,304 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "CGE.hpp"
+#include "Camera.hpp"
+#include "DebugDraw.hpp"
+#include "GameObject.hpp"
+#include "Light.hpp"
+
+// Checks the screen buffer's layout at the size asked for, renders a fixed scene headless for a fixed number of
+// frames and checks every frame's checksum against a golden file, then reports how long the frames really took.
+//   HeadlessCheck <golden> [--update] [--frames <count>] [--size <width>x<height>] [--timings <csv>] [--checksums <path>]
+// Only --update writes the golden file. Without one the run is skipped, its checksums can still go to --checksums
+// to be reviewed and copied in. Checksums depend on the compiler's floating point, so each platform keeps its own
+// golden files.
+
+// Tells the test runner the run was skipped rather than passed or failed.
+static const int SkippedCode = 77;
+
+static bool ReadGolden( const char* a_Path, std::vector< uint32_t >& o_Checksums )
+{
+	FILE* File = nullptr;
+
+	if ( fopen_s( &File, a_Path, "r" ) != 0 || !File )
+	{
+		return false;
+	}
+
+	unsigned int Checksum;
+
+	while ( fscanf( File, "%x", &Checksum ) == 1 )
+	{
+		o_Checksums.push_back( Checksum );
+	}
+
+	fclose( File );
+	return true;
+}
+
+static bool WriteGolden( const char* a_Path, const std::vector< uint32_t >& a_Checksums )
+{
+	FILE* File = nullptr;
+
+	if ( fopen_s( &File, a_Path, "w" ) != 0 || !File )
+	{
+		return false;
+	}
+
+	for ( uint32_t Checksum : a_Checksums )
+	{
+		fprintf( File, "%08X\n", Checksum );
+	}
+
+	fclose( File );
+	return true;
+}
+
+static bool WriteTimings( const char* a_Path, const std::vector< float >& a_FrameTimes )
+{
+	FILE* File = nullptr;
+
+	if ( fopen_s( &File, a_Path, "w" ) != 0 || !File )
+	{
+		return false;
+	}
+
+	fprintf( File, "frame,milliseconds\n" );
+
+	for ( size_t i = 0; i < a_FrameTimes.size(); ++i )
+	{
+		fprintf( File, "%zu,%.4f\n", i, a_FrameTimes[ i ] );
+	}
+
+	fclose( File );
+	return true;
+}
+
+// Index arithmetic has to hold past 32K cells, where 16 bit indices would wrap, and every row has to start on
+// its own cache line. Returns the number of failures.
+static int CheckLayout( ScreenBuffer& a_Buffer, Vector2Int a_Size )
+{
+	int Failures = 0;
+
+	auto Check = [ & ]( bool a_Passed, const char* a_What, int64_t a_Value )
+	{
+		if ( !a_Passed )
+		{
+			printf( "Layout: %s (%lld).\n", a_What, static_cast< long long >( a_Value ) );
+			++Failures;
+		}
+	};
+
+	int32_t Pitch = a_Buffer.GetPitch();
+	Check( a_Buffer.GetArea() == a_Size.x * a_Size.y, "the area isn't width times height", a_Buffer.GetArea() );
+	Check( Pitch >= a_Size.x, "the pitch is narrower than a row", Pitch );
+
+	int32_t Last = ( a_Size.y - 1 ) * Pitch + a_Size.x - 1;
+	int32_t Indices[] = { 0, 32766, 32767, 32768, 32769, 65535, 65536, Last };
+
+	for ( int32_t Index : Indices )
+	{
+		if ( Index > Last || Index % Pitch >= a_Size.x )
+		{
+			continue;
+		}
+
+		Vector2Int Coordinate = a_Buffer.GetCoordinate( Index );
+		Check( Coordinate.x == Index % Pitch && Coordinate.y == Index / Pitch, "an index maps to the wrong coordinate", Index );
+		Check( a_Buffer.GetIndex( Coordinate ) == Index, "a coordinate doesn't map back to its index", Index );
+	}
+
+	Vector2Int Corners[] = { { 0, 0 }, { a_Size.x - 1, 0 }, { 0, a_Size.y - 1 }, { a_Size.x - 1, a_Size.y - 1 } };
+
+	for ( Vector2Int Corner : Corners )
+	{
+		int32_t Index = a_Buffer.GetIndex( Corner );
+		Vector2Int Coordinate = a_Buffer.GetCoordinate( Index );
+		Check( Coordinate.x == Corner.x && Coordinate.y == Corner.y, "a corner doesn't map back to itself", Index );
+	}
+
+	for ( int32_t y = 0; y < a_Size.y; ++y )
+	{
+		uintptr_t Colours = reinterpret_cast< uintptr_t >( a_Buffer.GetColourBuffer() + static_cast< size_t >( y ) * Pitch );
+		uintptr_t Cells = reinterpret_cast< uintptr_t >( a_Buffer.GetPixelBuffer() + static_cast< size_t >( y ) * Pitch );
+		Check( Colours % ScreenBuffer::Alignment == 0, "a colour row isn't aligned", y );
+		Check( Cells % ScreenBuffer::Alignment == 0, "a cell row isn't aligned", y );
+	}
+
+	return Failures;
+}
+
+// The first frame includes start up, so it is left out of the summary.
+static void PrintTimings( const std::vector< float >& a_FrameTimes )
+{
+	if ( a_FrameTimes.size() < 2 )
+	{
+		return;
+	}
+
+	std::vector< float > Sorted( a_FrameTimes.begin() + 1, a_FrameTimes.end() );
+	std::sort( Sorted.begin(), Sorted.end() );
+	double Total = 0.0;
+
+	for ( float FrameTime : Sorted )
+	{
+		Total += FrameTime;
+	}
+
+	printf( "Frame times over %zu frames: mean %.3f ms, median %.3f ms, 95th %.3f ms, max %.3f ms\n",
+		Sorted.size(), Total / Sorted.size(), Sorted[ Sorted.size() / 2 ], Sorted[ ( Sorted.size() * 95 ) / 100 ], Sorted.back() );
+}
+
+int main( int argc, const char** argv )
+{
+	if ( argc < 2 )
+	{
+		printf( "Usage: HeadlessCheck <golden> [--update] [--frames <count>] [--size <width>x<height>] [--timings <csv>] [--checksums <path>]\n" );
+		return 1;
+	}
+
+	const char* GoldenPath = argv[ 1 ];
+	const char* TimingsPath = nullptr;
+	const char* ChecksumsPath = nullptr;
+	bool Update = false;
+	uint64_t FrameCount = 120;
+	Vector2Int Size = { 160, 90 };
+
+	for ( int i = 2; i < argc; ++i )
+	{
+		if ( strcmp( argv[ i ], "--update" ) == 0 )
+		{
+			Update = true;
+		}
+		else if ( strcmp( argv[ i ], "--frames" ) == 0 && i + 1 < argc )
+		{
+			FrameCount = strtoull( argv[ ++i ], nullptr, 10 );
+		}
+		else if ( strcmp( argv[ i ], "--size" ) == 0 && i + 1 < argc )
+		{
+			sscanf( argv[ ++i ], "%dx%d", &Size.x, &Size.y );
+		}
+		else if ( strcmp( argv[ i ], "--timings" ) == 0 && i + 1 < argc )
+		{
+			TimingsPath = argv[ ++i ];
+		}
+		else if ( strcmp( argv[ i ], "--checksums" ) == 0 && i + 1 < argc )
+		{
+			ChecksumsPath = argv[ ++i ];
+		}
+	}
+
+	auto Window = ConsoleWindow::Create( "Headless Check", Size, { 8, 8 } );
+
+	if ( !Window )
+	{
+		printf( "Couldn't open a %dx%d window.\n", Size.x, Size.y );
+		return 1;
+	}
+
+	ConsoleWindow::MakeContextCurrent( Window );
+	CGE::Init();
+
+	if ( int Failures = CheckLayout( Window->GetScreenBuffer(), Size ) )
+	{
+		printf( "%d layout checks failed at %dx%d.\n", Failures, Size.x, Size.y );
+		return 1;
+	}
+
+	// Every frame advances the same amount, so the frames don't depend on how fast the machine is.
+	Time::SetSimulatedDeltaTime( 1.0f / 30.0f );
+
+	GameObject SunObject = GameObject::Instantiate( "Sun"_N );
+	Light* Sun = SunObject.AddComponent< Light >();
+	Sun->SetDirection( Math::Normalize( Vector3( -1.0f, -2.0f, 1.0f ) ) );
+	Light::SetSun( Sun );
+
+	GameObject CameraObject = GameObject::Instantiate( "Camera"_N );
+	Camera* CameraComponent = CameraObject.AddComponent< Camera >();
+	CameraComponent->SetAspect( static_cast< float >( Size.x ) / Size.y );
+	CameraComponent->SetFOV( Math::Radians( 60.0f ) );
+	Camera::SetMainCamera( CameraComponent );
+	CameraObject.GetTransform()->SetLocalPosition( Vector3( 0.0f, 1.5f, -6.0f ) );
+
+	// Debug geometry needs no resources, and covers lines, points, depth and the partial redraws.
+	Action<> Scene = [ & ]()
+	{
+		float Angle = static_cast< float >( Time::GetFrameCount() ) * Time::GetSimulatedDeltaTime();
+		Matrix4 Spin = Matrix4::CreateTransform( Vector3::Zero, Quaternion::ToQuaternion( Vector3::Up, Angle ), Vector3::One );
+
+		DebugDraw::Box( Spin, Vector3( -1.0f, -1.0f, -1.0f ), Vector3( 1.0f, 1.0f, 1.0f ), Colour::ORANGE );
+		DebugDraw::Sphere( Vector3( Math::Cos( Angle ) * 2.5f, 0.0f, Math::Sin( Angle ) * 2.5f ), 0.5f, Colour::LIGHT_GREEN );
+		DebugDraw::Axes( Spin, 1.5f );
+
+		for ( int32_t x = -5; x <= 5; ++x )
+		{
+			DebugDraw::Line( Vector3( static_cast< float >( x ), -1.0f, -5.0f ), Vector3( static_cast< float >( x ), -1.0f, 5.0f ), Colour::DARK_GREY );
+			DebugDraw::Line( Vector3( -5.0f, -1.0f, static_cast< float >( x ) ), Vector3( 5.0f, -1.0f, static_cast< float >( x ) ), Colour::DARK_GREY );
+			DebugDraw::Point( Vector3( x * 0.5f, 2.0f + Math::Sin( Angle + x ), 0.0f ), Colour::WHITE );
+		}
+	};
+
+	CGE::Run( Scene, FrameCount );
+
+	const std::vector< uint32_t >& Checksums = Window->GetBackend().GetChecksums();
+	const std::vector< float >& FrameTimes = Window->GetBackend().GetFrameTimes();
+	PrintTimings( FrameTimes );
+
+	if ( TimingsPath && !WriteTimings( TimingsPath, FrameTimes ) )
+	{
+		printf( "Couldn't write %s.\n", TimingsPath );
+	}
+
+	if ( ChecksumsPath && !WriteGolden( ChecksumsPath, Checksums ) )
+	{
+		printf( "Couldn't write %s.\n", ChecksumsPath );
+	}
+
+	if ( Update )
+	{
+		if ( !WriteGolden( GoldenPath, Checksums ) )
+		{
+			printf( "Couldn't write %s.\n", GoldenPath );
+			return 1;
+		}
+
+		printf( "Recorded %zu frames to %s.\n", Checksums.size(), GoldenPath );
+		return 0;
+	}
+
+	std::vector< uint32_t > Golden;
+
+	if ( !ReadGolden( GoldenPath, Golden ) )
+	{
+		printf( "No golden file at %s, skipped. Run with --update to record one.\n", GoldenPath );
+		return SkippedCode;
+	}
+
+	size_t Mismatches = 0;
+
+	for ( size_t i = 0; i < Checksums.size(); ++i )
+	{
+		if ( i >= Golden.size() || Checksums[ i ] != Golden[ i ] )
+		{
+			if ( !Mismatches )
+			{
+				printf( "Frame %zu is %08X, the golden file has %08X.\n", i, Checksums[ i ], i < Golden.size() ? Golden[ i ] : 0u );
+			}
+
+			++Mismatches;
+		}
+	}
+
+	if ( Mismatches || Checksums.size() != Golden.size() )
+	{
+		printf( "%zu of %zu frames differ from %s, which has %zu frames.\n", Mismatches, Checksums.size(), GoldenPath, Golden.size() );
+		return 1;
+	}
+
+	printf( "All %zu frames match %s.\n", Checksums.size(), GoldenPath );
+	return 0;
+}
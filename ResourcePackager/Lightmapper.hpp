@@ -0,0 +1,554 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <assimp/scene.h>
+#include "Math.hpp"
+#include "Mesh.hpp"
+#include "Colour.hpp"
+#include "Parallel.hpp"
+
+// How a prefab's static lighting is baked, read from the "Lightmap" object of its manifest entry.
+struct LightmapSettings
+{
+	uint32_t Size = 0;                    // Texels along each side of a mesh's lightmap, nothing is baked at 0.
+	uint32_t Samples = 32;                // Occlusion rays per texel.
+	float    Distance = 1.0f;             // Occluders further away than this don't shade the ambient light.
+	float    Ambient = 0.3f;
+	Vector3  Sun = { 0.3f, -1.0f, 0.2f }; // Direction the sunlight travels in.
+	Vector3  SunColour = Vector3::One;
+};
+
+// Bakes sunlight and ambient occlusion into one lightmap per mesh, casting rays against every static mesh of the
+// scene as its nodes place them. Skinned meshes move, so they neither cast shadows nor get baked. A mesh placed
+// by several nodes is baked where it is first placed.
+class Lightmapper
+{
+public:
+
+	Lightmapper( const aiScene* a_Scene, const LightmapSettings& a_Settings )
+		: m_Settings( a_Settings )
+		, m_Placements( a_Scene->mNumMeshes, Matrix4::Identity )
+		, m_Placed( a_Scene->mNumMeshes, false )
+	{
+		m_Settings.Sun = Math::Normalize( a_Settings.Sun );
+		Place( a_Scene, a_Scene->mRootNode, Matrix4::Identity );
+
+		if ( m_Triangles.empty() )
+		{
+			return;
+		}
+
+		// Rays leave surfaces a little above them, scaled to the scene so they don't hit where they start.
+		Vector3 Min = m_Triangles.front().A;
+		Vector3 Max = Min;
+
+		for ( const auto& Current : m_Triangles )
+		{
+			Grow( Min, Max, Current.A );
+		}
+
+		m_Bias = Math::Max( Math::Length( Max - Min ) * 1.0e-4f, 1.0e-5f );
+
+		std::vector< Triangle > Unordered = m_Triangles;
+		std::vector< uint32_t > Order( m_Triangles.size() );
+
+		for ( uint32_t i = 0; i < Order.size(); ++i )
+		{
+			Order[ i ] = i;
+		}
+
+		BuildNode( Unordered, Order, 0, static_cast< uint32_t >( Order.size() ) );
+
+		for ( uint32_t i = 0; i < Order.size(); ++i )
+		{
+			m_Triangles[ i ] = Unordered[ Order[ i ] ];
+		}
+	}
+
+	inline bool IsPlaced( uint32_t a_Mesh ) const
+	{
+		return a_Mesh < m_Placed.size() && m_Placed[ a_Mesh ];
+	}
+
+	// Lights mesh a_Mesh of the scene into a lightmap of the configured size, addressed by texel channel 1. Meshes
+	// without that channel are given one first, see Unwrap.
+	std::vector< Colour > Bake( uint32_t a_Mesh, Mesh& io_Mesh ) const
+	{
+		int32_t Size = static_cast< int32_t >( m_Settings.Size );
+		std::vector< Colour > Texels( static_cast< size_t >( Size ) * Size, Colour( 0, 0, 0, 255 ) );
+
+		if ( Size <= 1 || io_Mesh.GetIndexCount() < 3 )
+		{
+			return Texels;
+		}
+
+		if ( !io_Mesh.HasTexels( 1 ) )
+		{
+			Unwrap( io_Mesh );
+		}
+
+		// Which triangle each texel centre lands on and where, texels just past an edge take the nearest triangle
+		// so bilinear lookups along seams don't pick up black.
+		std::vector< int32_t > Owners( Texels.size(), -1 );
+		std::vector< float   > Distances( Texels.size(), -std::numeric_limits< float >::max() );
+		std::vector< Vector3 > Weights( Texels.size() );
+		float Scale = static_cast< float >( Size - 1 );
+
+		for ( uint32_t t = 0; t + 2 < io_Mesh.GetIndexCount(); t += 3 )
+		{
+			Vector2 Corners[ 3 ];
+
+			for ( uint32_t i = 0; i < 3; ++i )
+			{
+				Corners[ i ] = io_Mesh.m_Texels[ 1 ][ io_Mesh.m_Indices[ t + i ] ] * Scale;
+			}
+
+			float Area = Edge( Corners[ 0 ], Corners[ 1 ], Corners[ 2 ] );
+
+			if ( Math::Abs( Area ) < 1.0e-8f )
+			{
+				continue;
+			}
+
+			int32_t Left = Math::Max( static_cast< int32_t >( Math::Floor( Math::Min( Corners[ 0 ].x, Math::Min( Corners[ 1 ].x, Corners[ 2 ].x ) ) ) ) - 1, 0 );
+			int32_t Right = Math::Min( static_cast< int32_t >( Math::Ceil( Math::Max( Corners[ 0 ].x, Math::Max( Corners[ 1 ].x, Corners[ 2 ].x ) ) ) ) + 1, Size - 1 );
+			int32_t Bottom = Math::Max( static_cast< int32_t >( Math::Floor( Math::Min( Corners[ 0 ].y, Math::Min( Corners[ 1 ].y, Corners[ 2 ].y ) ) ) ) - 1, 0 );
+			int32_t Top = Math::Min( static_cast< int32_t >( Math::Ceil( Math::Max( Corners[ 0 ].y, Math::Max( Corners[ 1 ].y, Corners[ 2 ].y ) ) ) ) + 1, Size - 1 );
+
+			for ( int32_t y = Bottom; y <= Top; ++y )
+			{
+				for ( int32_t x = Left; x <= Right; ++x )
+				{
+					Vector2 Centre = { x + 0.5f, y + 0.5f };
+					Vector3 Barycentric = {
+						Edge( Corners[ 1 ], Corners[ 2 ], Centre ) / Area,
+						Edge( Corners[ 2 ], Corners[ 0 ], Centre ) / Area,
+						Edge( Corners[ 0 ], Corners[ 1 ], Centre ) / Area };
+
+					// Signed distance in texels to the nearest edge, positive inside.
+					float Distance = std::numeric_limits< float >::max();
+
+					for ( uint32_t i = 0; i < 3; ++i )
+					{
+						float Length = Math::Length( Corners[ ( i + 2 ) % 3 ] - Corners[ ( i + 1 ) % 3 ] );
+						Distance = Math::Min( Distance, Barycentric[ i ] * Math::Abs( Area ) / Math::Max( Length, 1.0e-8f ) );
+					}
+
+					size_t Index = static_cast< size_t >( y ) * Size + x;
+
+					if ( Distance < -0.75f || Distance <= Distances[ Index ] )
+					{
+						continue;
+					}
+
+					Barycentric = Math::Clamp( Barycentric, 0.0f, 1.0f );
+					Owners[ Index ] = static_cast< int32_t >( t );
+					Distances[ Index ] = Distance;
+					Weights[ Index ] = Barycentric / ( Barycentric.x + Barycentric.y + Barycentric.z );
+				}
+			}
+		}
+
+		const Matrix4& World = m_Placements[ a_Mesh ];
+
+		Parallel::For( 0, Size, [ & ]( int32_t a_Begin, int32_t a_End )
+		{
+			for ( int32_t y = a_Begin; y < a_End; ++y )
+			{
+				for ( int32_t x = 0; x < Size; ++x )
+				{
+					size_t Index = static_cast< size_t >( y ) * Size + x;
+					int32_t Owner = Owners[ Index ];
+
+					if ( Owner < 0 )
+					{
+						continue;
+					}
+
+					const uint32_t* Corners = io_Mesh.m_Indices.data() + Owner;
+					const Vector3& W = Weights[ Index ];
+					Vector3 Position = io_Mesh.m_Positions[ Corners[ 0 ] ] * W.x + io_Mesh.m_Positions[ Corners[ 1 ] ] * W.y + io_Mesh.m_Positions[ Corners[ 2 ] ] * W.z;
+					Vector3 Normal = io_Mesh.HasNormals() ?
+						io_Mesh.m_Normals[ Corners[ 0 ] ] * W.x + io_Mesh.m_Normals[ Corners[ 1 ] ] * W.y + io_Mesh.m_Normals[ Corners[ 2 ] ] * W.z :
+						Math::Cross( io_Mesh.m_Positions[ Corners[ 1 ] ] - io_Mesh.m_Positions[ Corners[ 0 ] ], io_Mesh.m_Positions[ Corners[ 2 ] ] - io_Mesh.m_Positions[ Corners[ 0 ] ] );
+
+					Position = Vector3( Math::Multiply( World, Vector4( Position, 1.0f ) ) );
+					Normal = Math::Normalize( Vector3( Math::Multiply( World, Vector4( Normal, 0.0f ) ) ) );
+					Vector3 Light = Math::Clamp( Shade( Position, Normal, static_cast< uint32_t >( Index ) ), 0.0f, 1.0f );
+					Texels[ Index ] = Colour( Vector4( Light, 1.0f ) );
+				}
+			}
+		}, 4 );
+
+		Dilate( Texels, Owners, Size );
+		Dilate( Texels, Owners, Size );
+		return Texels;
+	}
+
+private:
+
+	// Corner A and the two edges leaving it, as the intersection test uses them.
+	struct Triangle
+	{
+		Vector3 A;
+		Vector3 AB;
+		Vector3 AC;
+	};
+
+	// Interior nodes have no triangles, their left child follows them and Start is the right child.
+	struct Node
+	{
+		Vector3  Min;
+		Vector3  Max;
+		uint32_t Start;
+		uint32_t Count;
+	};
+
+	void Place( const aiScene* a_Scene, const aiNode* a_Node, const Matrix4& a_Parent )
+	{
+		Matrix4 Global = Math::Multiply( a_Parent, *reinterpret_cast< const Matrix4* >( &a_Node->mTransformation.a1 ) );
+
+		for ( uint32_t i = 0; i < a_Node->mNumMeshes; ++i )
+		{
+			uint32_t Index = a_Node->mMeshes[ i ];
+			const aiMesh* Source = a_Scene->mMeshes[ Index ];
+
+			if ( Source->HasBones() )
+			{
+				continue;
+			}
+
+			if ( !m_Placed[ Index ] )
+			{
+				m_Placed[ Index ] = true;
+				m_Placements[ Index ] = Global;
+			}
+
+			for ( uint32_t j = 0; j < Source->mNumFaces; ++j )
+			{
+				const aiFace& Face = Source->mFaces[ j ];
+
+				if ( Face.mNumIndices != 3 )
+				{
+					continue;
+				}
+
+				Vector3 Corners[ 3 ];
+
+				for ( uint32_t k = 0; k < 3; ++k )
+				{
+					const aiVector3D& Vertex = Source->mVertices[ Face.mIndices[ k ] ];
+					Corners[ k ] = Vector3( Math::Multiply( Global, Vector4( Vertex.x, Vertex.y, Vertex.z, 1.0f ) ) );
+				}
+
+				m_Triangles.push_back( { Corners[ 0 ], Corners[ 1 ] - Corners[ 0 ], Corners[ 2 ] - Corners[ 0 ] } );
+			}
+		}
+
+		for ( uint32_t i = 0; i < a_Node->mNumChildren; ++i )
+		{
+			Place( a_Scene, a_Node->mChildren[ i ], Global );
+		}
+	}
+
+	// Splits at the median centroid along the longest axis, four triangles or fewer to a leaf.
+	uint32_t BuildNode( const std::vector< Triangle >& a_Triangles, std::vector< uint32_t >& io_Order, uint32_t a_Start, uint32_t a_Count )
+	{
+		uint32_t Index = static_cast< uint32_t >( m_Nodes.size() );
+		Node Current = { a_Triangles[ io_Order[ a_Start ] ].A, a_Triangles[ io_Order[ a_Start ] ].A, a_Start, a_Count };
+
+		for ( uint32_t i = a_Start; i < a_Start + a_Count; ++i )
+		{
+			const Triangle& Source = a_Triangles[ io_Order[ i ] ];
+			Grow( Current.Min, Current.Max, Source.A );
+			Grow( Current.Min, Current.Max, Source.A + Source.AB );
+			Grow( Current.Min, Current.Max, Source.A + Source.AC );
+		}
+
+		m_Nodes.push_back( Current );
+
+		if ( a_Count <= 4 )
+		{
+			return Index;
+		}
+
+		Vector3 Extent = Current.Max - Current.Min;
+		uint32_t Axis = Extent.x > Extent.y ? ( Extent.x > Extent.z ? 0 : 2 ) : ( Extent.y > Extent.z ? 1 : 2 );
+		uint32_t Half = a_Count / 2;
+
+		std::nth_element( io_Order.begin() + a_Start, io_Order.begin() + a_Start + Half, io_Order.begin() + a_Start + a_Count, [ & ]( uint32_t a_Left, uint32_t a_Right )
+		{
+			const Triangle& Left = a_Triangles[ a_Left ];
+			const Triangle& Right = a_Triangles[ a_Right ];
+			return ( Left.A[ Axis ] * 3.0f + Left.AB[ Axis ] + Left.AC[ Axis ] ) < ( Right.A[ Axis ] * 3.0f + Right.AB[ Axis ] + Right.AC[ Axis ] );
+		} );
+
+		BuildNode( a_Triangles, io_Order, a_Start, Half );
+		uint32_t RightChild = BuildNode( a_Triangles, io_Order, a_Start + Half, a_Count - Half );
+		m_Nodes[ Index ].Start = RightChild;
+		m_Nodes[ Index ].Count = 0;
+		return Index;
+	}
+
+	// Whether anything lies along the ray closer than a_Distance.
+	bool Occluded( const Vector3& a_Origin, const Vector3& a_Direction, float a_Distance ) const
+	{
+		if ( m_Nodes.empty() )
+		{
+			return false;
+		}
+
+		Vector3 Inverse = { 1.0f / a_Direction.x, 1.0f / a_Direction.y, 1.0f / a_Direction.z };
+		uint32_t Stack[ 64 ];
+		uint32_t Depth = 0;
+		Stack[ Depth++ ] = 0;
+
+		while ( Depth )
+		{
+			uint32_t Index = Stack[ --Depth ];
+			const Node& Current = m_Nodes[ Index ];
+			float Enter = 0.0f;
+			float Leave = a_Distance;
+
+			for ( uint32_t Axis = 0; Axis < 3; ++Axis )
+			{
+				float Near = ( Current.Min[ Axis ] - a_Origin[ Axis ] ) * Inverse[ Axis ];
+				float Far = ( Current.Max[ Axis ] - a_Origin[ Axis ] ) * Inverse[ Axis ];
+				Enter = Math::Max( Enter, Math::Min( Near, Far ) );
+				Leave = Math::Min( Leave, Math::Max( Near, Far ) );
+			}
+
+			if ( Enter > Leave )
+			{
+				continue;
+			}
+
+			if ( !Current.Count )
+			{
+				Stack[ Depth++ ] = Index + 1;
+				Stack[ Depth++ ] = Current.Start;
+				continue;
+			}
+
+			for ( uint32_t i = Current.Start; i < Current.Start + Current.Count; ++i )
+			{
+				if ( Intersects( m_Triangles[ i ], a_Origin, a_Direction, a_Distance ) )
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	// Moller-Trumbore, either side of the triangle.
+	inline static bool Intersects( const Triangle& a_Triangle, const Vector3& a_Origin, const Vector3& a_Direction, float a_Distance )
+	{
+		Vector3 P = Math::Cross( a_Direction, a_Triangle.AC );
+		float Determinant = Math::Dot( a_Triangle.AB, P );
+
+		if ( Math::Abs( Determinant ) < 1.0e-12f )
+		{
+			return false;
+		}
+
+		float Inverse = 1.0f / Determinant;
+		Vector3 T = a_Origin - a_Triangle.A;
+		float U = Math::Dot( T, P ) * Inverse;
+
+		if ( U < 0.0f || U > 1.0f )
+		{
+			return false;
+		}
+
+		Vector3 Q = Math::Cross( T, a_Triangle.AB );
+		float V = Math::Dot( a_Direction, Q ) * Inverse;
+
+		if ( V < 0.0f || U + V > 1.0f )
+		{
+			return false;
+		}
+
+		float Distance = Math::Dot( a_Triangle.AC, Q ) * Inverse;
+		return Distance > 0.0f && Distance < a_Distance;
+	}
+
+	// Sunlight where the sun is in view, plus ambient light scaled by how much of the hemisphere is open.
+	// Occlusion rays are cosine weighted Hammersley directions, turned per texel so neighbours don't band.
+	Vector3 Shade( const Vector3& a_Position, const Vector3& a_Normal, uint32_t a_Seed ) const
+	{
+		Vector3 Origin = a_Position + a_Normal * m_Bias;
+		float Sun = Math::Max( -Math::Dot( a_Normal, m_Settings.Sun ), 0.0f );
+
+		if ( Sun > 0.0f && Occluded( Origin, -m_Settings.Sun, std::numeric_limits< float >::max() ) )
+		{
+			Sun = 0.0f;
+		}
+
+		Vector3 Tangent = Math::Normalize( Math::Cross( Math::Abs( a_Normal.y ) < 0.99f ? Vector3::Up : Vector3::Right, a_Normal ) );
+		Vector3 Bitangent = Math::Cross( a_Normal, Tangent );
+		float Turn = static_cast< float >( ( a_Seed * 2654435761u ) >> 8 ) / static_cast< float >( 1u << 24 );
+		uint32_t Open = 0;
+
+		for ( uint32_t i = 0; i < m_Settings.Samples; ++i )
+		{
+			float Radius = Math::Sqrt( ( i + 0.5f ) / m_Settings.Samples );
+			float Angle = 2.0f * Math::Pi() * Math::Fract( RadicalInverse( i ) + Turn );
+			Vector3 Direction =
+				Tangent * ( Radius * Math::Cos( Angle ) ) +
+				Bitangent * ( Radius * Math::Sin( Angle ) ) +
+				a_Normal * Math::Sqrt( Math::Max( 1.0f - Radius * Radius, 0.0f ) );
+
+			Open += !Occluded( Origin, Direction, m_Settings.Distance );
+		}
+
+		float Openness = m_Settings.Samples ? static_cast< float >( Open ) / m_Settings.Samples : 1.0f;
+		return m_Settings.SunColour * Sun + Vector3::One * ( m_Settings.Ambient * Openness );
+	}
+
+	inline static void Grow( Vector3& io_Min, Vector3& io_Max, const Vector3& a_Point )
+	{
+		for ( uint32_t Axis = 0; Axis < 3; ++Axis )
+		{
+			io_Min[ Axis ] = Math::Min( io_Min[ Axis ], a_Point[ Axis ] );
+			io_Max[ Axis ] = Math::Max( io_Max[ Axis ], a_Point[ Axis ] );
+		}
+	}
+
+	inline static float RadicalInverse( uint32_t a_Index )
+	{
+		a_Index = ( a_Index << 16u ) | ( a_Index >> 16u );
+		a_Index = ( ( a_Index & 0x55555555u ) << 1u ) | ( ( a_Index & 0xAAAAAAAAu ) >> 1u );
+		a_Index = ( ( a_Index & 0x33333333u ) << 2u ) | ( ( a_Index & 0xCCCCCCCCu ) >> 2u );
+		a_Index = ( ( a_Index & 0x0F0F0F0Fu ) << 4u ) | ( ( a_Index & 0xF0F0F0F0u ) >> 4u );
+		a_Index = ( ( a_Index & 0x00FF00FFu ) << 8u ) | ( ( a_Index & 0xFF00FF00u ) >> 8u );
+		return static_cast< float >( a_Index ) * 2.3283064365386963e-10f;
+	}
+
+	inline static float Edge( const Vector2& a_A, const Vector2& a_B, const Vector2& a_P )
+	{
+		return ( a_B.x - a_A.x ) * ( a_P.y - a_A.y ) - ( a_B.y - a_A.y ) * ( a_P.x - a_A.x );
+	}
+
+	// Gives every triangle its own corners, then lays triangles out in pairs, one square cell of the lightmap per
+	// pair with each filling the half below or above its diagonal. Cells are inset so neighbours don't share texels.
+	void Unwrap( Mesh& io_Mesh ) const
+	{
+		static auto Split = []( auto& io_Stream, const std::vector< uint32_t >& a_Indices )
+		{
+			if ( io_Stream.empty() )
+			{
+				return;
+			}
+
+			std::remove_reference_t< decltype( io_Stream ) > Result( a_Indices.size() );
+
+			for ( size_t i = 0; i < a_Indices.size(); ++i )
+			{
+				Result[ i ] = io_Stream[ a_Indices[ i ] ];
+			}
+
+			io_Stream.swap( Result );
+		};
+
+		const std::vector< uint32_t >& Indices = io_Mesh.m_Indices;
+		Split( io_Mesh.m_Positions, Indices );
+		Split( io_Mesh.m_Normals, Indices );
+		Split( io_Mesh.m_Tangents, Indices );
+		Split( io_Mesh.m_Bitangents, Indices );
+		Split( io_Mesh.m_BoneIndices, Indices );
+		Split( io_Mesh.m_BoneWeights, Indices );
+
+		for ( uint32_t i = 0; i < 8; ++i )
+		{
+			Split( io_Mesh.m_Texels[ i ], Indices );
+			Split( io_Mesh.m_Colours[ i ], Indices );
+		}
+
+		uint32_t TriangleCount = static_cast< uint32_t >( Indices.size() / 3 );
+		uint32_t Cells = static_cast< uint32_t >( Math::Ceil( Math::Sqrt( static_cast< float >( ( TriangleCount + 1 ) / 2 ) ) ) );
+		float Cell = 1.0f / Math::Max( Cells, 1u );
+		float Inset = 1.5f / m_Settings.Size;
+		std::vector< Vector2 >& Texels = io_Mesh.m_Texels[ 1 ];
+		Texels.resize( Indices.size() );
+
+		for ( uint32_t t = 0; t < TriangleCount; ++t )
+		{
+			uint32_t Pair = t / 2;
+			Vector2 Low = { ( Pair % Cells ) * Cell, ( Pair / Cells ) * Cell };
+			Vector2 High = Low + Vector2::One * Cell;
+
+			if ( t % 2 == 0 )
+			{
+				Texels[ t * 3 + 0 ] = { Low.x + Inset, Low.y + Inset };
+				Texels[ t * 3 + 1 ] = { High.x - Inset * 2.0f, Low.y + Inset };
+				Texels[ t * 3 + 2 ] = { Low.x + Inset, High.y - Inset * 2.0f };
+			}
+			else
+			{
+				Texels[ t * 3 + 0 ] = { High.x - Inset, High.y - Inset };
+				Texels[ t * 3 + 1 ] = { Low.x + Inset * 2.0f, High.y - Inset };
+				Texels[ t * 3 + 2 ] = { High.x - Inset, Low.y + Inset * 2.0f };
+			}
+		}
+
+		for ( uint32_t i = 0; i < Indices.size(); ++i )
+		{
+			io_Mesh.m_Indices[ i ] = i;
+		}
+	}
+
+	// Spreads lit texels one texel into the unlit ones around them.
+	static void Dilate( std::vector< Colour >& io_Texels, std::vector< int32_t >& io_Owners, int32_t a_Size )
+	{
+		std::vector< Colour > Source = io_Texels;
+		std::vector< int32_t > Owners = io_Owners;
+
+		for ( int32_t y = 0; y < a_Size; ++y )
+		{
+			for ( int32_t x = 0; x < a_Size; ++x )
+			{
+				size_t Index = static_cast< size_t >( y ) * a_Size + x;
+
+				if ( Owners[ Index ] >= 0 )
+				{
+					continue;
+				}
+
+				Vector4 Sum = Vector4::Zero;
+				uint32_t Count = 0;
+
+				for ( int32_t j = Math::Max( y - 1, 0 ); j <= Math::Min( y + 1, a_Size - 1 ); ++j )
+				{
+					for ( int32_t i = Math::Max( x - 1, 0 ); i <= Math::Min( x + 1, a_Size - 1 ); ++i )
+					{
+						size_t Neighbour = static_cast< size_t >( j ) * a_Size + i;
+
+						if ( Owners[ Neighbour ] >= 0 )
+						{
+							const Colour& Lit = Source[ Neighbour ];
+							Sum += Vector4( Lit.R, Lit.G, Lit.B, Lit.A );
+							++Count;
+						}
+					}
+				}
+
+				if ( Count )
+				{
+					Sum /= static_cast< float >( Count * 255 );
+					io_Texels[ Index ] = Colour( Sum );
+					io_Owners[ Index ] = 0;
+				}
+			}
+		}
+	}
+
+	LightmapSettings        m_Settings;
+	std::vector< Matrix4 >  m_Placements;
+	std::vector< bool >     m_Placed;
+	std::vector< Triangle > m_Triangles;
+	std::vector< Node >     m_Nodes;
+	float                   m_Bias = 1.0e-4f;
+};
@@ -1,5 +1,6 @@
 #include "ResourcePackager.hpp"
 #include <string>
+#include <optional>
 #include "File.hpp"
 #include "Name.hpp"
 #include "JSON.hpp"
@@ -14,16 +15,23 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "STBI.hpp"
 
+// Static lighting
+#include "Lightmapper.hpp"
+
 // Resource types
 #include "Prefab.hpp"
 #include "Texture.hpp"
 #include "Mesh.hpp"
 #include "Material.hpp"
 #include "AudioClip.hpp"
+#include "Skeleton.hpp"
+#include "AnimationClip.hpp"
 
 // Component types
 #include "Transform.hpp"
 #include "MeshRenderer.hpp"
+#include "SkinnedMeshRenderer.hpp"
+#include "Animator.hpp"
 #include "Alias.hpp"
 // #include "AudioSource.hpp"
 // #include "AudioListener.hpp"
@@ -38,6 +46,8 @@ uint32_t ConvertToType( const std::string& a_Extension )
 	if ( a_Extension == "material"  ) return 3; // MATERIAL
 	if ( a_Extension == "texture"   ) return 4; // TEXTURE
 	if ( a_Extension == "audioclip" ) return 5; // AUDIOCLIP
+	if ( a_Extension == "skeleton"  ) return 6; // SKELETON
+	if ( a_Extension == "animation" ) return 7; // ANIMATION
 
 	return 0; // NONE
 }
@@ -51,6 +61,8 @@ std::string ConvertToExtension( uint32_t a_Type )
 		case 3: return ".material";
 		case 4: return ".texture";
 		case 5: return ".audioclip";
+		case 6: return ".skeleton";
+		case 7: return ".animation";
 	}
 
 	return "";
@@ -93,6 +105,8 @@ inline std::string ConvertPath( const char* a_Path )
 // 3 - MATERIAL
 // 4 - TEXTURE
 // 5 - AUDIOCLIP
+// 6 - SKELETON
+// 7 - ANIMATION
 
 // ResourceLoaders
 // 0 - NONE
@@ -109,14 +123,55 @@ inline std::string ConvertPath( const char* a_Path )
 
 struct ResourceEntry
 {
-	uint32_t    ResourceType;
-	uint32_t    ResourceLoader;
-	uint32_t    ResourceIndex;
-	std::string ResourceFilePath;
-	std::string ResourceName;
-	const void* ResourceSource;
+	uint32_t           ResourceType;
+	uint32_t           ResourceLoader;
+	uint32_t           ResourceIndex;
+	std::string        ResourceFilePath;
+	std::string        ResourceName;
+	const void*        ResourceSource;
+	LightmapSettings   Lightmap;          // Prefabs, baked when the size is set.
+	const Lightmapper* Baker = nullptr;   // Meshes, bakes the mesh's lightmap alongside it.
+	std::string        LightmapTexture;   // Materials, the baked lightmap they are lit by.
 };
 
+// Every node of the scene, depth first so parents come before their children. Bones and animation channels
+// name their nodes, so a node's place in this list is its bone index.
+void CollectNodes( const aiNode* a_Node, std::vector< const aiNode* >& o_Nodes )
+{
+	o_Nodes.push_back( a_Node );
+
+	for ( uint32_t i = 0; i < a_Node->mNumChildren; ++i )
+	{
+		CollectNodes( a_Node->mChildren[ i ], o_Nodes );
+	}
+}
+
+int32_t FindNode( const std::vector< const aiNode* >& a_Nodes, const aiString& a_Name )
+{
+	for ( uint32_t i = 0; i < a_Nodes.size(); ++i )
+	{
+		if ( a_Nodes[ i ]->mName == a_Name )
+		{
+			return static_cast< int32_t >( i );
+		}
+	}
+
+	return -1;
+}
+
+bool HasBones( const aiScene* a_Scene )
+{
+	for ( uint32_t i = 0; i < a_Scene->mNumMeshes; ++i )
+	{
+		if ( a_Scene->mMeshes[ i ]->HasBones() )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void ValidateResources( Json& a_Resources )
 {
 	for ( auto Begin = a_Resources.begin(), End = a_Resources.end(); Begin != End; ++Begin )
@@ -178,6 +233,14 @@ File ProcessResourceEntry( ResourceEntry& a_Entry, Directory& a_TempDirectory )
 					std::vector< File > TempMaterials;
 					std::vector< File > TempTextures;
 
+					// Static lighting is cast against the whole scene, so the baker sees every mesh before any is written.
+					std::optional< Lightmapper > Baker;
+
+					if ( a_Entry.Lightmap.Size )
+					{
+						Baker.emplace( ThisScene, a_Entry.Lightmap );
+					}
+
 					// Process all subordinates first.
 					for ( uint32_t i = 0; i < ThisScene->mNumMeshes; ++i )
 					{
@@ -187,6 +250,7 @@ File ProcessResourceEntry( ResourceEntry& a_Entry, Directory& a_TempDirectory )
 						NewMesh.ResourceName = a_Entry.ResourceName + "_mesh" + std::to_string( i );
 						NewMesh.ResourceType = 2; /*MESH*/
 						NewMesh.ResourceSource = a_Entry.ResourceSource;
+						NewMesh.Baker = Baker ? &*Baker : nullptr;
 						TempMeshes.push_back( ProcessResourceEntry( NewMesh, a_TempDirectory ) );
 					}
 
@@ -201,6 +265,52 @@ File ProcessResourceEntry( ResourceEntry& a_Entry, Directory& a_TempDirectory )
 						TempMaterials.push_back( ProcessResourceEntry( NewMaterial, a_TempDirectory ) );
 					}
 
+					// Each baked mesh gets its own copy of its material, lit by the mesh's lightmap.
+					std::vector< std::string > LightmappedMaterials( ThisScene->mNumMeshes );
+
+					for ( uint32_t i = 0; Baker && i < ThisScene->mNumMeshes; ++i )
+					{
+						if ( !Baker->IsPlaced( i ) )
+						{
+							continue;
+						}
+
+						ResourceEntry NewMaterial;
+						NewMaterial.ResourceIndex = ThisScene->mMeshes[ i ]->mMaterialIndex;
+						NewMaterial.ResourceLoader = 1; /*ASSIMP*/
+						NewMaterial.ResourceName = a_Entry.ResourceName + "_mesh" + std::to_string( i ) + "_material";
+						NewMaterial.ResourceType = 3; /*MATERIAL*/
+						NewMaterial.ResourceSource = a_Entry.ResourceSource;
+						NewMaterial.LightmapTexture = a_Entry.ResourceName + "_mesh" + std::to_string( i ) + "_lightmap";
+						LightmappedMaterials[ i ] = ProcessResourceEntry( NewMaterial, a_TempDirectory ).GetStem();
+					}
+
+					// Skinned scenes share one skeleton between their meshes and animations.
+					bool Skinned = HasBones( ThisScene );
+					std::vector< File > TempAnimations;
+
+					if ( Skinned )
+					{
+						ResourceEntry NewSkeleton;
+						NewSkeleton.ResourceIndex = 0;
+						NewSkeleton.ResourceLoader = 1; /*ASSIMP*/
+						NewSkeleton.ResourceName = a_Entry.ResourceName + "_skeleton";
+						NewSkeleton.ResourceType = 6; /*SKELETON*/
+						NewSkeleton.ResourceSource = a_Entry.ResourceSource;
+						ProcessResourceEntry( NewSkeleton, a_TempDirectory );
+
+						for ( uint32_t i = 0; i < ThisScene->mNumAnimations; ++i )
+						{
+							ResourceEntry NewAnimation;
+							NewAnimation.ResourceIndex = i;
+							NewAnimation.ResourceLoader = 1; /*ASSIMP*/
+							NewAnimation.ResourceName = a_Entry.ResourceName + "_animation" + std::to_string( i );
+							NewAnimation.ResourceType = 7; /*ANIMATION*/
+							NewAnimation.ResourceSource = a_Entry.ResourceSource;
+							TempAnimations.push_back( ProcessResourceEntry( NewAnimation, a_TempDirectory ) );
+						}
+					}
+
 					static auto AttachAlias = [&]( Prefab& a_Prefab, const std::string& a_Name )
 						{
 							Alias Comp;
@@ -226,6 +336,20 @@ File ProcessResourceEntry( ResourceEntry& a_Entry, Directory& a_TempDirectory )
 							Comp.SetMaterial( ResourceHandle< Material >( a_Material ) );
 							a_Prefab.AddComponent( Comp );
 						};
+					static auto AttachSkinnedMeshRenderer = [&]( Prefab& a_Prefab, Hash a_Mesh, Hash a_Material )
+						{
+							SkinnedMeshRenderer Comp;
+							Comp.SetMesh( ResourceHandle< Mesh >( a_Mesh ) );
+							Comp.SetMaterial( ResourceHandle< Material >( a_Material ) );
+							a_Prefab.AddComponent( Comp );
+						};
+					static auto AttachAnimator = [&]( Prefab& a_Prefab, Hash a_Skeleton, Hash a_Clip )
+						{
+							Animator Comp;
+							Comp.SetSkeleton( ResourceHandle< Skeleton >( a_Skeleton ) );
+							Comp.SetDefaultClip( ResourceHandle< AnimationClip >( a_Clip ) );
+							a_Prefab.AddComponent( Comp );
+						};
 					static auto AttachCamera = [&]( Prefab& a_Prefab, aiCamera* a_Camera )
 						{
 							Camera Comp;
@@ -257,8 +381,16 @@ File ProcessResourceEntry( ResourceEntry& a_Entry, Directory& a_TempDirectory )
 							AttachTransform( NewChild, aiMatrix4x4() );
 							uint32_t MeshIndex = a_Node->mMeshes[ i ];
 							Hash MeshName = CRC32_RT( TempMeshes[ MeshIndex ].GetStem().c_str() );
-							Hash MaterialName = CRC32_RT( TempMaterials[ a_Scene->mMeshes[ MeshIndex ]->mMaterialIndex ].GetStem().c_str() );
-							AttachMeshRenderer( o_Prefab, MeshName, MaterialName );
+							Hash MaterialName = CRC32_RT( !LightmappedMaterials[ MeshIndex ].empty() ? LightmappedMaterials[ MeshIndex ].c_str() : TempMaterials[ a_Scene->mMeshes[ MeshIndex ]->mMaterialIndex ].GetStem().c_str() );
+
+							if ( a_Scene->mMeshes[ MeshIndex ]->HasBones() )
+							{
+								AttachSkinnedMeshRenderer( o_Prefab, MeshName, MaterialName );
+							}
+							else
+							{
+								AttachMeshRenderer( o_Prefab, MeshName, MaterialName );
+							}
 						}
 
 						for ( uint32_t i = 0; i < a_Node->mNumChildren; ++i )
@@ -272,6 +404,15 @@ File ProcessResourceEntry( ResourceEntry& a_Entry, Directory& a_TempDirectory )
 					ThisPrefab.SetName( a_Entry.ResourceName );
 					AttachAlias( ThisPrefab, a_Entry.ResourceName );
 					AttachTransform( ThisPrefab, aiMatrix4x4() );
+
+					// The animator sits above the root node, where the skeleton's space begins.
+					if ( Skinned )
+					{
+						Hash SkeletonName = CRC32_RT( ( a_Entry.ResourceName + "_skeleton" ).c_str() );
+						Hash ClipName = TempAnimations.empty() ? 0 : CRC32_RT( TempAnimations.front().GetStem().c_str() );
+						AttachAnimator( ThisPrefab, SkeletonName, ClipName );
+					}
+
 					AttachMeshRenderers( ThisScene, ThisScene->mRootNode, *ThisPrefab.AddChild() );
 					File ThisTemp = a_TempDirectory.NewFile( ( a_Entry.ResourceName + ConvertToExtension( a_Entry.ResourceType ) ).c_str(), Serialization::GetSizeOf( ThisPrefab ) );
 					ThisTemp.Open();
@@ -409,6 +550,74 @@ File ProcessResourceEntry( ResourceEntry& a_Entry, Directory& a_TempDirectory )
 						}
 					}
 
+					// Keep the four heaviest bones of each vertex, renormalised.
+					if ( ThisMeshSource->HasBones() )
+					{
+						std::vector< const aiNode* > Nodes;
+						CollectNodes( ThisScene->mRootNode, Nodes );
+						ThisMesh.m_BoneIndices.assign( ThisMeshSource->mNumVertices, Vector4Int( 0, 0, 0, 0 ) );
+						ThisMesh.m_BoneWeights.assign( ThisMeshSource->mNumVertices, Vector4( 0.0f, 0.0f, 0.0f, 0.0f ) );
+
+						for ( uint32_t i = 0; i < ThisMeshSource->mNumBones; ++i )
+						{
+							const aiBone* Bone = ThisMeshSource->mBones[ i ];
+							int32_t BoneIndex = FindNode( Nodes, Bone->mName );
+
+							if ( BoneIndex < 0 )
+							{
+								continue;
+							}
+
+							for ( uint32_t j = 0; j < Bone->mNumWeights; ++j )
+							{
+								uint32_t Vertex = Bone->mWeights[ j ].mVertexId;
+								Vector4& Weights = ThisMesh.m_BoneWeights[ Vertex ];
+								uint32_t Lightest = 0;
+
+								for ( uint32_t k = 1; k < 4; ++k )
+								{
+									Lightest = Weights[ k ] < Weights[ Lightest ] ? k : Lightest;
+								}
+
+								if ( Bone->mWeights[ j ].mWeight > Weights[ Lightest ] )
+								{
+									Weights[ Lightest ] = Bone->mWeights[ j ].mWeight;
+									ThisMesh.m_BoneIndices[ Vertex ][ Lightest ] = BoneIndex;
+								}
+							}
+						}
+
+						for ( auto& Weights : ThisMesh.m_BoneWeights )
+						{
+							float Total = Weights[ 0 ] + Weights[ 1 ] + Weights[ 2 ] + Weights[ 3 ];
+
+							if ( Total > 0.0f )
+							{
+								Weights = Weights * ( 1.0f / Total );
+							}
+						}
+					}
+
+					// Baking can unwrap the mesh into a second texel channel, so it happens before the mesh is written.
+					if ( a_Entry.Baker && a_Entry.Baker->IsPlaced( a_Entry.ResourceIndex ) )
+					{
+						std::vector< Colour > Texels = a_Entry.Baker->Bake( a_Entry.ResourceIndex, ThisMesh );
+						int32_t Size = static_cast< int32_t >( Math::Sqrt( static_cast< float >( Texels.size() ) ) + 0.5f );
+						Texture2D ThisLightmap;
+						ThisLightmap.SetName( a_Entry.ResourceName + "_lightmap" );
+						uint8_t*& TextureData = ResourcePackager::GetTextureData( ThisLightmap );
+						Vector2Int& TextureSize = ResourcePackager::GetTextureSize( ThisLightmap );
+						TextureData = reinterpret_cast< uint8_t* >( Texels.data() );
+						TextureSize = { Size, Size };
+
+						File LightmapTemp = a_TempDirectory.NewFile( ( a_Entry.ResourceName + "_lightmap" + ConvertToExtension( 4 /*TEXTURE*/ ) ).c_str(), Serialization::GetSizeOf( ThisLightmap ) );
+						LightmapTemp.Open();
+						FileSerializer LightmapSerializer( LightmapTemp );
+						LightmapSerializer << ThisLightmap;
+						LightmapTemp.Close();
+						TextureData = nullptr;
+					}
+
 					File ThisTemp = a_TempDirectory.NewFile( ( a_Entry.ResourceName + ConvertToExtension( a_Entry.ResourceType ) ).c_str(), Serialization::GetSizeOf( ThisMesh ) );
 					ThisTemp.Open();
 					FileSerializer Serializer( ThisTemp );
@@ -496,6 +705,20 @@ File ProcessResourceEntry( ResourceEntry& a_Entry, Directory& a_TempDirectory )
 					AddTextures( aiTextureType::aiTextureType_SPECULAR, "texture_specular" );
 					AddTextures( aiTextureType::aiTextureType_TRANSMISSION, "texture_transmission" );
 
+					// Lit by a baked lightmap instead of at runtime.
+					if ( !a_Entry.LightmapTexture.empty() )
+					{
+						Name LightmapName = a_Entry.LightmapTexture;
+						ThisMaterial.AddTexture( "texture_lightmap"_N, { LightmapName } );
+
+						if ( !ThisMaterial.HasProperty( "diffuse_colour"_N ) )
+						{
+							ThisMaterial.AddProperty( "diffuse_colour"_N, Vector4::One );
+						}
+
+						ThisMaterial.SetShader( ThisMaterial.HasTexture( "texture_diffuse"_N ) ? Shader::LightmappedDiffuse : Shader::Lightmapped );
+					}
+
 					File ThisTemp = a_TempDirectory.NewFile( ( a_Entry.ResourceName + ConvertToExtension( a_Entry.ResourceType ) ).c_str(), Serialization::GetSizeOf( ThisMaterial ) );
 					ThisTemp.Open();
 					FileSerializer Serializer( ThisTemp );
@@ -533,6 +756,95 @@ File ProcessResourceEntry( ResourceEntry& a_Entry, Directory& a_TempDirectory )
 					}
 					return ThisTemp;
 				}
+				case 6: /*SKELETON*/
+				{
+					// One bone per node, bind poses from whichever mesh is skinned to it.
+					Skeleton ThisSkeleton;
+					ThisSkeleton.SetName( a_Entry.ResourceName );
+					std::vector< Skeleton::Bone >& Bones = ResourcePackager::GetSkeletonBones( ThisSkeleton );
+					std::vector< const aiNode* > Nodes;
+					CollectNodes( ThisScene->mRootNode, Nodes );
+
+					for ( const aiNode* Node : Nodes )
+					{
+						Skeleton::Bone& NewBone = Bones.emplace_back();
+						NewBone.Name = CRC32_RT( Node->mName.C_Str() );
+						NewBone.Parent = Node->mParent ? static_cast< int32_t >( std::find( Nodes.begin(), Nodes.end(), Node->mParent ) - Nodes.begin() ) : -1;
+						NewBone.LocalBind = *reinterpret_cast< const Matrix4* >( &Node->mTransformation.a1 );
+						NewBone.InverseBind = Matrix4::Identity;
+					}
+
+					for ( uint32_t i = 0; i < ThisScene->mNumMeshes; ++i )
+					{
+						for ( uint32_t j = 0; j < ThisScene->mMeshes[ i ]->mNumBones; ++j )
+						{
+							const aiBone* Bone = ThisScene->mMeshes[ i ]->mBones[ j ];
+
+							if ( int32_t BoneIndex = FindNode( Nodes, Bone->mName ); BoneIndex >= 0 )
+							{
+								Bones[ BoneIndex ].InverseBind = *reinterpret_cast< const Matrix4* >( &Bone->mOffsetMatrix.a1 );
+							}
+						}
+					}
+
+					File ThisTemp = a_TempDirectory.NewFile( ( a_Entry.ResourceName + ConvertToExtension( a_Entry.ResourceType ) ).c_str(), Serialization::GetSizeOf( ThisSkeleton ) );
+					ThisTemp.Open();
+					FileSerializer Serializer( ThisTemp );
+					Serializer << ThisSkeleton;
+					ThisTemp.Close();
+					return ThisTemp;
+				}
+				case 7: /*ANIMATION*/
+				{
+					// Key times are converted from ticks to seconds.
+					AnimationClip ThisClip;
+					ThisClip.SetName( a_Entry.ResourceName );
+					const aiAnimation* ThisAnimationSource = ThisScene->mAnimations[ a_Entry.ResourceIndex ];
+					float SecondsPerTick = 1.0f / static_cast< float >( ThisAnimationSource->mTicksPerSecond > 0.0 ? ThisAnimationSource->mTicksPerSecond : 25.0 );
+					ResourcePackager::GetClipDuration( ThisClip ) = static_cast< float >( ThisAnimationSource->mDuration ) * SecondsPerTick;
+					std::vector< AnimationClip::Channel >& Channels = ResourcePackager::GetClipChannels( ThisClip );
+					std::vector< const aiNode* > Nodes;
+					CollectNodes( ThisScene->mRootNode, Nodes );
+
+					for ( uint32_t i = 0; i < ThisAnimationSource->mNumChannels; ++i )
+					{
+						const aiNodeAnim* ChannelSource = ThisAnimationSource->mChannels[ i ];
+						int32_t BoneIndex = FindNode( Nodes, ChannelSource->mNodeName );
+
+						if ( BoneIndex < 0 )
+						{
+							continue;
+						}
+
+						AnimationClip::Channel& NewChannel = Channels.emplace_back();
+						NewChannel.Bone = static_cast< uint32_t >( BoneIndex );
+
+						for ( uint32_t j = 0; j < ChannelSource->mNumPositionKeys; ++j )
+						{
+							const aiVectorKey& Key = ChannelSource->mPositionKeys[ j ];
+							NewChannel.Positions.push_back( { static_cast< float >( Key.mTime ) * SecondsPerTick, Vector3( Key.mValue.x, Key.mValue.y, Key.mValue.z ) } );
+						}
+
+						for ( uint32_t j = 0; j < ChannelSource->mNumRotationKeys; ++j )
+						{
+							const aiQuatKey& Key = ChannelSource->mRotationKeys[ j ];
+							NewChannel.Rotations.push_back( { static_cast< float >( Key.mTime ) * SecondsPerTick, Quaternion( Key.mValue.w, Key.mValue.x, Key.mValue.y, Key.mValue.z ) } );
+						}
+
+						for ( uint32_t j = 0; j < ChannelSource->mNumScalingKeys; ++j )
+						{
+							const aiVectorKey& Key = ChannelSource->mScalingKeys[ j ];
+							NewChannel.Scales.push_back( { static_cast< float >( Key.mTime ) * SecondsPerTick, Vector3( Key.mValue.x, Key.mValue.y, Key.mValue.z ) } );
+						}
+					}
+
+					File ThisTemp = a_TempDirectory.NewFile( ( a_Entry.ResourceName + ConvertToExtension( a_Entry.ResourceType ) ).c_str(), Serialization::GetSizeOf( ThisClip ) );
+					ThisTemp.Open();
+					FileSerializer Serializer( ThisTemp );
+					Serializer << ThisClip;
+					ThisTemp.Close();
+					return ThisTemp;
+				}
 			}
 
 			if ( ThisScopeOwnsScene )
@@ -600,6 +912,27 @@ bool ResourcePackager::Build() const
 		Entry.ResourceName = Begin.key();
 		Entry.ResourceType = Begin->find( "Type" )->get< uint32_t >();
 		Entry.ResourceSource = nullptr;
+
+		// "Lightmap": { "Size": 128, "Samples": 32, "Distance": 1.0, "Ambient": 0.3, "Sun": [ 0.3, -1.0, 0.2 ] }
+		if ( auto ThisLightmap = Begin->find( "Lightmap" ); ThisLightmap != Begin->end() && ThisLightmap->is_object() )
+		{
+			LightmapSettings& Settings = Entry.Lightmap;
+			Settings.Size = ThisLightmap->value( "Size", Settings.Size );
+			Settings.Samples = ThisLightmap->value( "Samples", Settings.Samples );
+			Settings.Distance = ThisLightmap->value( "Distance", Settings.Distance );
+			Settings.Ambient = ThisLightmap->value( "Ambient", Settings.Ambient );
+
+			if ( auto ThisSun = ThisLightmap->find( "Sun" ); ThisSun != ThisLightmap->end() && ThisSun->is_array() && ThisSun->size() == 3 )
+			{
+				Settings.Sun = { ( *ThisSun )[ 0 ].get< float >(), ( *ThisSun )[ 1 ].get< float >(), ( *ThisSun )[ 2 ].get< float >() };
+			}
+
+			if ( auto ThisColour = ThisLightmap->find( "SunColour" ); ThisColour != ThisLightmap->end() && ThisColour->is_array() && ThisColour->size() == 3 )
+			{
+				Settings.SunColour = { ( *ThisColour )[ 0 ].get< float >(), ( *ThisColour )[ 1 ].get< float >(), ( *ThisColour )[ 2 ].get< float >() };
+			}
+		}
+
 		ProcessResourceEntry( Entry, TempDirectory );
 	}
 
@@ -623,6 +956,8 @@ bool ResourcePackager::Build() const
 			else if ( ResourceExtension == ".texture"   ) std::get< 2 >( NewHeader ) = typeid( Texture2D ).name();
 			else if ( ResourceExtension == ".prefab"    ) std::get< 2 >( NewHeader ) = typeid( Prefab    ).name();
 			else if ( ResourceExtension == ".audioclip" ) std::get< 2 >( NewHeader ) = typeid( AudioClip ).name();
+			else if ( ResourceExtension == ".skeleton"  ) std::get< 2 >( NewHeader ) = typeid( Skeleton  ).name();
+			else if ( ResourceExtension == ".animation" ) std::get< 2 >( NewHeader ) = typeid( AnimationClip ).name();
 
 			ResourceFile.Open();
 			ResourcesSize += ResourceFile.Size();
@@ -1,6 +1,8 @@
 #pragma once
 #include "File.hpp"
 #include "Prefab.hpp"
+#include "Skeleton.hpp"
+#include "AnimationClip.hpp"
 
 class ResourceEntry;
 
@@ -30,6 +32,18 @@ private:
 	{
 		return ( uint8_t*& )a_Texture.m_Data;
 	}
+	inline static std::vector< Skeleton::Bone >& GetSkeletonBones( Skeleton& a_Skeleton )
+	{
+		return a_Skeleton.m_Bones;
+	}
+	inline static float& GetClipDuration( AnimationClip& a_Clip )
+	{
+		return a_Clip.m_Duration;
+	}
+	inline static std::vector< AnimationClip::Channel >& GetClipChannels( AnimationClip& a_Clip )
+	{
+		return a_Clip.m_Channels;
+	}
 
 	Directory m_Source;
 	Directory m_Output;